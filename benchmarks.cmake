@@ -0,0 +1,49 @@
+dbot_add_benchmark(
+    NAME    kinect_image_model
+    SOURCES source/dbot/benchmark/kinect_image_model_benchmark.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_benchmark(
+    NAME    particle_filter
+    SOURCES source/dbot/benchmark/particle_filter_benchmark.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_benchmark(
+    NAME    pose_refiner
+    SOURCES source/dbot/benchmark/pose_refiner_benchmark.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_benchmark(
+    NAME    tiled_evaluation
+    SOURCES source/dbot/benchmark/tiled_evaluation_benchmark.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_benchmark(
+    NAME    occlusion_pruning
+    SOURCES source/dbot/benchmark/occlusion_pruning_benchmark.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_benchmark(
+    NAME    multi_instance
+    SOURCES source/dbot/benchmark/multi_instance_benchmark.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_benchmark(
+    NAME    precision
+    SOURCES source/dbot/benchmark/precision_benchmark.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_benchmark(
+    NAME    point_cloud
+    SOURCES source/dbot/benchmark/point_cloud_benchmark.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_benchmark(
+    NAME    annealing
+    SOURCES source/dbot/benchmark/annealing_benchmark.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_benchmark(
+    NAME    observation_context
+    SOURCES source/dbot/benchmark/observation_context_benchmark.cpp
+    LIBS    ${dbot_LIBRARIES})
@@ -0,0 +1,31 @@
+##
+## This is part of the Bayesian Object Tracking (bot),
+## (https://github.com/bayesian-object-tracking)
+##
+## Copyright (c) 2015 Max Planck Society,
+## 				 Autonomous Motion Department,
+## 			     Institute for Intelligent Systems
+##
+## This Source Code Form is subject to the terms of the GNU General Public
+## License License (GNU GPL). A copy of the license can be found in the LICENSE
+## file distributed with this source code.
+##
+
+##
+## Date October 2016
+##
+
+include(CMakeParseArguments)
+
+function(${PROJECT_NAME}_add_benchmark)
+    set(options)
+    set(oneValueArgs NAME)
+    set(multiValueArgs SOURCES LIBS)
+    cmake_parse_arguments(${PROJECT_NAME}
+        "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN})
+
+    set(BENCHMARK_NAME "${${PROJECT_NAME}_NAME}_benchmark")
+
+    add_executable(${BENCHMARK_NAME} ${${PROJECT_NAME}_SOURCES})
+    target_link_libraries(${BENCHMARK_NAME} ${${PROJECT_NAME}_LIBS})
+endfunction(${PROJECT_NAME}_add_benchmark)
@@ -0,0 +1,191 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file benchmark.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <dbot/rigid_body_renderer.h>
+#include <dbot/test_meshes.h>
+
+namespace dbot
+{
+namespace benchmark
+{
+/**
+ * \brief Wall clock timing of repeated runs in milliseconds
+ */
+struct Timing
+{
+    double mean;
+    double min;
+    double max;
+};
+
+/**
+ * \brief Runs the function once for warm up and then the given number of
+ *        times while measuring each run
+ */
+template <typename Function>
+Timing measure(int iterations, Function&& function)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    function();
+
+    Timing timing;
+    timing.mean = 0;
+    timing.min = std::numeric_limits<double>::infinity();
+    timing.max = 0;
+    for (int i = 0; i < iterations; ++i)
+    {
+        auto start = Clock::now();
+        function();
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() -
+                                                              start)
+                        .count();
+
+        timing.mean += ms / iterations;
+        timing.min = std::min(timing.min, ms);
+        timing.max = std::max(timing.max, ms);
+    }
+
+    return timing;
+}
+
+inline void print(const std::string& name, const Timing& timing)
+{
+    std::printf("%-40s mean %10.3f ms  min %10.3f ms  max %10.3f ms\n",
+                name.c_str(),
+                timing.mean,
+                timing.min,
+                timing.max);
+}
+
+/**
+ * \brief Synthetic scene of a single cube in front of a pinhole camera.
+ *
+ * The observation is the rendered cube slightly displaced from the nominal
+ * pose with a vertical occluder strip in front of it. Benchmarks use it in
+ * place of recorded data.
+ */
+class CubeScene
+{
+public:
+    CubeScene(int rows, int cols, double half_size = 0.05, double depth = 0.6)
+        : rows_(rows),
+          cols_(cols),
+          vertices_(1, cube_vertices(half_size)),
+          indices_(1, box_indices())
+    {
+        // the cube covers about a third of the image width
+        double focal = cols * depth / (6.0 * half_size);
+        camera_matrix_ << focal, 0, cols / 2.0, 0, focal, rows / 2.0, 0, 0, 1;
+
+        pose_ = Eigen::Affine3d::Identity();
+        pose_.translation() = Eigen::Vector3d(0.0, 0.0, depth);
+        pose_.rotate(Eigen::AngleAxisd(
+            0.3, Eigen::Vector3d(1.0, 1.0, 0.0).normalized()));
+    }
+
+    std::shared_ptr<RigidBodyRenderer> create_renderer() const
+    {
+        return std::make_shared<RigidBodyRenderer>(vertices_, indices_);
+    }
+
+    /**
+     * \brief Nominal pose of the cube in the camera frame
+     */
+    const Eigen::Affine3d& pose() const { return pose_; }
+
+    /**
+     * \brief Column vector of rows * cols depth values
+     */
+    Eigen::MatrixXd observation() const
+    {
+        Eigen::Affine3d displaced = pose_;
+        displaced.translation()(0) += 0.004;
+
+        Eigen::MatrixXd image = render(displaced);
+
+        for (int col = cols_ / 2; col < cols_ / 2 + cols_ / 20; ++col)
+        {
+            for (int row = 0; row < rows_; ++row)
+            {
+                image(row * cols_ + col) = 0.4;
+            }
+        }
+
+        return image;
+    }
+
+    /**
+     * \brief Column vector of the depth of the cube at the given pose in
+     *        front of a background plane at 2 m
+     */
+    Eigen::MatrixXd render(const Eigen::Affine3d& pose) const
+    {
+        auto renderer = create_renderer();
+        std::vector<RigidBodyRenderer::Affine> poses(1, pose);
+        renderer->set_poses(poses);
+
+        std::vector<float> depth;
+        renderer->Render(camera_matrix_, rows_, cols_, depth);
+
+        Eigen::MatrixXd image(rows_ * cols_, 1);
+        for (int i = 0; i < rows_ * cols_; ++i)
+        {
+            image(i) = std::isinf(depth[i]) ? 2.0 : depth[i];
+        }
+
+        return image;
+    }
+
+    const Eigen::Matrix3d& camera_matrix() const { return camera_matrix_; }
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+
+    const std::vector<std::vector<Eigen::Vector3d>>& vertices() const
+    {
+        return vertices_;
+    }
+
+    const std::vector<std::vector<std::vector<int>>>& indices() const
+    {
+        return indices_;
+    }
+
+private:
+    int rows_;
+    int cols_;
+    Eigen::Matrix3d camera_matrix_;
+    Eigen::Affine3d pose_;
+    std::vector<std::vector<Eigen::Vector3d>> vertices_;
+    std::vector<std::vector<std::vector<int>>> indices_;
+};
+}
+}
@@ -0,0 +1,142 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file kinect_image_model_benchmark.cpp
+ * \date October 2016
+ *
+ * Measures the CPU image model update for each huge page policy.
+ *
+ * Usage: kinect_image_model_benchmark [particles] [iterations] [workers]
+ *                                     [rows] [cols]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include <dbot/benchmark/benchmark.h>
+#include <dbot/huge_page_allocator.h>
+#include <dbot/model/kinect_image_model.h>
+#include <dbot/pose/free_floating_rigid_bodies_state.h>
+
+typedef dbot::FreeFloatingRigidBodiesState<> State;
+typedef dbot::KinectImageModel<double, State> Model;
+
+static int argument(int argc, char** argv, int index, int default_value)
+{
+    return argc > index ? std::atoi(argv[index]) : default_value;
+}
+
+static const char* name(dbot::HugePagePolicy policy)
+{
+    switch (policy)
+    {
+        case dbot::HugePagePolicy::Disabled:
+            return "disabled";
+        case dbot::HugePagePolicy::Transparent:
+            return "transparent";
+        case dbot::HugePagePolicy::Explicit:
+            return "explicit";
+    }
+    return "";
+}
+
+int main(int argc, char** argv)
+{
+    const int particles = argument(argc, argv, 1, 64);
+    const int iterations = argument(argc, argv, 2, 10);
+    const int workers = argument(argc, argv, 3, 1);
+    const int rows = argument(argc, argv, 4, 480);
+    const int cols = argument(argc, argv, 5, 640);
+
+    std::printf("%d particles, %dx%d pixels, %d workers, huge page %zu KiB\n",
+                particles,
+                cols,
+                rows,
+                workers,
+                dbot::huge_page_size() / 1024);
+
+    dbot::benchmark::CubeScene scene(rows, cols);
+    const Eigen::MatrixXd observation = scene.observation();
+
+    // particles spread around the nominal pose
+    std::mt19937 generator(1);
+    std::normal_distribution<double> noise(0.0, 0.003);
+    Model::StateArray deltas(particles);
+    for (auto& delta : deltas)
+    {
+        delta = State(1);
+        delta.setZero();
+        delta.component(0).position() =
+            Eigen::Vector3d(noise(generator), noise(generator), 0.0);
+        delta.component(0).orientation() =
+            Eigen::Vector3d(10 * noise(generator), 10 * noise(generator), 0.0);
+    }
+
+    State pose(1);
+    pose.component(0).position() = scene.pose().translation();
+    pose.component(0).orientation().quaternion(
+        Eigen::Quaterniond(scene.pose().rotation()));
+
+    const dbot::HugePagePolicy policies[] = {dbot::HugePagePolicy::Disabled,
+                                             dbot::HugePagePolicy::Transparent,
+                                             dbot::HugePagePolicy::Explicit};
+
+    for (auto policy : policies)
+    {
+        Model model(scene.camera_matrix(),
+                    rows,
+                    cols,
+                    scene.create_renderer(),
+                    std::make_shared<dbot::KinectPixelModel>(
+                        0.01, 0.003, 0.00142478),
+                    std::make_shared<dbot::OcclusionModel>(0.1, 0.7),
+                    0.1,
+                    0.03);
+        model.set_huge_page_policy(policy);
+        if (workers != 1)
+        {
+            model.set_executor(std::make_shared<dbot::Executor>(workers));
+        }
+        model.integrated_poses() = pose;
+
+        auto usage = dbot::huge_page_usage();
+
+        // the first update expands the single initial occlusion row to one
+        // row per particle
+        Model::IntArray indices = Model::IntArray::Zero(particles);
+        model.set_observation(observation);
+        model.loglikes(deltas, indices, true);
+
+        // resampling to random parents, as after a filter step, such that
+        // the occlusion rows are read in random order
+        std::uniform_int_distribution<int> parent(0, particles - 1);
+        auto timing = dbot::benchmark::measure(iterations, [&]() {
+            for (int i = 0; i < particles; ++i) indices[i] = parent(generator);
+            model.set_observation(observation);
+            model.loglikes(deltas, indices, true);
+        });
+
+        auto after = dbot::huge_page_usage();
+        dbot::benchmark::print(std::string("update, huge pages ") + name(policy),
+                               timing);
+        std::printf("    allocated MiB: explicit %zu, transparent %zu, "
+                    "regular %zu\n",
+                    (after.explicit_bytes - usage.explicit_bytes) >> 20,
+                    (after.transparent_bytes - usage.transparent_bytes) >> 20,
+                    (after.regular_bytes - usage.regular_bytes) >> 20);
+    }
+
+    return 0;
+}
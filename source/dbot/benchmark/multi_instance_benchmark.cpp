@@ -0,0 +1,330 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file multi_instance_benchmark.cpp
+ * \date October 2016
+ *
+ * Tracks several instances of a small cube side by side, once jointly as the
+ * parts of one state with factorized weights, and once with an independent
+ * filter per instance. Reports the frame time and the mean position error
+ * over the number of instances.
+ *
+ * Usage: multi_instance_benchmark [runs] [frames] [particles] [rows] [cols]
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include <dbot/benchmark/benchmark.h>
+#include <dbot/builder/object_transition_builder.h>
+#include <dbot/filter/rao_blackwell_coordinate_particle_filter.h>
+#include <dbot/model/kinect_image_model.h>
+#include <dbot/pose/free_floating_rigid_bodies_state.h>
+
+typedef dbot::FreeFloatingRigidBodiesState<> State;
+typedef dbot::ObjectTransitionBuilder<State> TransitionBuilder;
+typedef TransitionBuilder::Model Transition;
+typedef dbot::RbSensor<State> Sensor;
+typedef dbot::RaoBlackwellCoordinateParticleFilter<Transition, Sensor> Filter;
+typedef dbot::KinectImageModel<double, State> Model;
+
+typedef std::vector<std::vector<Eigen::Vector3d>> Vertices;
+typedef std::vector<std::vector<std::vector<int>>> Indices;
+
+static int argument(int argc, char** argv, int index, int default_value)
+{
+    return argc > index ? std::atoi(argv[index]) : default_value;
+}
+
+/**
+ * \brief Instances of the scene's cube at 40 % of its size in a row across
+ *        the image, at alternating depths
+ */
+class InstanceScene
+{
+public:
+    InstanceScene(const dbot::benchmark::CubeScene& scene, int instances)
+        : scene_(scene), instances_(instances)
+    {
+        for (int i = 0; i < instances_; ++i)
+        {
+            vertices_.push_back(scene.vertices()[0]);
+            indices_.push_back(scene.indices()[0]);
+            for (auto& vertex : vertices_.back()) vertex *= 0.4;
+        }
+    }
+
+    /**
+     * \brief Pose of the given instance at the given time, each instance
+     *        sways with its own phase
+     */
+    Eigen::Affine3d pose(int instance, double time) const
+    {
+        const double phase = 2 * M_PI * time / 3.0 + instance;
+
+        Eigen::Affine3d pose = scene_.pose();
+        pose.pretranslate(Eigen::Vector3d(
+            0.06 * (instance - (instances_ - 1) / 2.0) +
+                0.015 * std::sin(phase),
+            0.01 * std::sin(2 * phase),
+            -0.02 * (instance % 2)));
+        pose.rotate(Eigen::AngleAxisd(0.4 * std::sin(phase),
+                                      Eigen::Vector3d(0.0, 1.0, 0.0)));
+        return pose;
+    }
+
+    /**
+     * \brief Observation of all instances at the given time in front of a
+     *        background plane at 2 m, with depth noise of the Kinect model
+     */
+    Eigen::MatrixXd observe(double time, std::mt19937& generator) const
+    {
+        dbot::RigidBodyRenderer renderer(vertices_, indices_);
+        std::vector<dbot::RigidBodyRenderer::Affine> poses;
+        for (int i = 0; i < instances_; ++i) poses.push_back(pose(i, time));
+        renderer.set_poses(poses);
+
+        std::vector<float> depth;
+        renderer.Render(
+            scene_.camera_matrix(), scene_.rows(), scene_.cols(), depth);
+
+        std::normal_distribution<double> noise(0.0, 1.0);
+        Eigen::MatrixXd image(depth.size(), 1);
+        for (size_t i = 0; i < depth.size(); ++i)
+        {
+            const double d = std::isinf(depth[i]) ? 2.0 : depth[i];
+            image(i) = d + (0.003 + 0.00142478 * d * d) * noise(generator);
+        }
+        return image;
+    }
+
+    const dbot::benchmark::CubeScene& scene() const { return scene_; }
+
+    /// mesh of the given instances [begin, end)
+    Vertices vertices(int begin, int end) const
+    {
+        return Vertices(vertices_.begin() + begin, vertices_.begin() + end);
+    }
+
+    Indices indices(int begin, int end) const
+    {
+        return Indices(indices_.begin() + begin, indices_.begin() + end);
+    }
+
+private:
+    const dbot::benchmark::CubeScene& scene_;
+    int instances_;
+    Vertices vertices_;
+    Indices indices_;
+};
+
+/**
+ * \brief Filter of the instances [begin, end) as the parts of one state,
+ *        with factorized weights for more than one part
+ */
+class InstanceTracker
+{
+public:
+    InstanceTracker(const InstanceScene& scene,
+                    int begin,
+                    int end,
+                    int particles,
+                    double delta_time)
+        : begin_(begin), parts_(end - begin)
+    {
+        const auto& cube = scene.scene();
+
+        TransitionBuilder::Parameters transition;
+        transition.linear_sigma_x = 0.002;
+        transition.linear_sigma_y = 0.002;
+        transition.linear_sigma_z = 0.002;
+        transition.angular_sigma_x = 0.01;
+        transition.angular_sigma_y = 0.01;
+        transition.angular_sigma_z = 0.01;
+        transition.velocity_factor = 0.8;
+        transition.part_count = parts_;
+
+        auto model = std::make_shared<Model>(
+            cube.camera_matrix(),
+            cube.rows(),
+            cube.cols(),
+            std::make_shared<dbot::RigidBodyRenderer>(
+                scene.vertices(begin, end), scene.indices(begin, end)),
+            std::make_shared<dbot::KinectPixelModel>(0.01, 0.003, 0.00142478),
+            std::make_shared<dbot::OcclusionModel>(0.1, 0.7),
+            0.1,
+            delta_time);
+
+        std::vector<std::vector<int>> blocks(parts_);
+        for (int part = 0; part < parts_; ++part)
+        {
+            for (int i = 0; i < 6; ++i) blocks[part].push_back(6 * part + i);
+        }
+
+        filter_ = std::make_shared<Filter>(
+            TransitionBuilder(transition).build(), model, blocks, 2.0);
+        if (parts_ > 1) filter_->set_factorized_weights(true);
+
+        // start at the true initial poses, as the tracker after
+        // initialization
+        auto& integrated_poses = filter_->sensor()->integrated_poses();
+        integrated_poses = State(parts_);
+        integrated_poses.setZero();
+        for (int part = 0; part < parts_; ++part)
+        {
+            const Eigen::Affine3d initial = scene.pose(begin_ + part, 0);
+            integrated_poses.component(part).position() =
+                initial.translation();
+            integrated_poses.component(part).orientation().quaternion(
+                Eigen::Quaterniond(initial.rotation()));
+        }
+
+        State zero(parts_);
+        zero.setZero();
+        filter_->set_particles(std::vector<State>(1, zero));
+        filter_->resample(particles);
+    }
+
+    /**
+     * \brief Filters the observation and returns the summed position error
+     *        of the instances
+     */
+    double filter(const InstanceScene& scene,
+                  const Eigen::MatrixXd& image,
+                  double time)
+    {
+        filter_->filter(image, Transition::Input::Zero(parts_));
+
+        // recenter the particles on the mean, as the particle tracker does
+        auto& integrated_poses = filter_->sensor()->integrated_poses();
+        State delta_mean = filter_->belief().mean();
+        for (int i = 0; i < filter_->belief().size(); i++)
+        {
+            filter_->belief().location(i).subtract(delta_mean);
+        }
+        integrated_poses.apply_delta(delta_mean);
+
+        double error = 0;
+        for (int part = 0; part < parts_; ++part)
+        {
+            error += (integrated_poses.component(part).position() -
+                      scene.pose(begin_ + part, time).translation())
+                         .norm();
+        }
+        return error;
+    }
+
+private:
+    int begin_;
+    int parts_;
+    std::shared_ptr<Filter> filter_;
+};
+
+/**
+ * \brief Tracks the instances jointly or independently and returns the mean
+ *        position error over all instances and frames after the first ten
+ */
+static double track(const InstanceScene& scene,
+                    int instances,
+                    int particles,
+                    int frames,
+                    bool joint,
+                    unsigned seed)
+{
+    const double delta_time = 1.0 / 30.0;
+
+    std::vector<InstanceTracker> trackers;
+    if (joint)
+    {
+        trackers.emplace_back(scene, 0, instances, particles, delta_time);
+    }
+    else
+    {
+        for (int i = 0; i < instances; ++i)
+        {
+            trackers.emplace_back(scene, i, i + 1, particles, delta_time);
+        }
+    }
+
+    std::mt19937 generator(seed);
+    double error = 0;
+    for (int frame = 1; frame <= frames; ++frame)
+    {
+        const double time = frame * delta_time;
+        const Eigen::MatrixXd image = scene.observe(time, generator);
+
+        double frame_error = 0;
+        for (auto& tracker : trackers)
+        {
+            frame_error += tracker.filter(scene, image, time);
+        }
+
+        if (frame > 10) error += frame_error / instances / (frames - 10);
+    }
+
+    return error;
+}
+
+int main(int argc, char** argv)
+{
+    const int runs = argument(argc, argv, 1, 3);
+    const int frames = argument(argc, argv, 2, 60);
+    const int particles = argument(argc, argv, 3, 100);
+    const int rows = argument(argc, argv, 4, 120);
+    const int cols = argument(argc, argv, 5, 160);
+
+    std::printf("%d runs of %d frames, %d particles per filter, %dx%d "
+                "pixels\n",
+                runs,
+                frames,
+                particles,
+                cols,
+                rows);
+    std::printf("%-10s %-12s %16s %12s\n",
+                "instances",
+                "filters",
+                "position [mm]",
+                "frame [ms]");
+
+    dbot::benchmark::CubeScene cube(rows, cols);
+
+    const int counts[] = {1, 2, 4};
+    for (int instances : counts)
+    {
+        InstanceScene scene(cube, instances);
+
+        for (bool joint : {false, true})
+        {
+            if (joint && instances == 1) continue;
+
+            double error = 0;
+            unsigned seed = 1;
+            auto timing = dbot::benchmark::measure(runs, [&]() {
+                error += track(
+                    scene, instances, particles, frames, joint, seed++);
+            });
+
+            // the warm up run of measure() is included in the sum
+            std::printf("%-10d %-12s %16.3f %12.3f\n",
+                        instances,
+                        joint ? "joint" : "independent",
+                        1e3 * error / (runs + 1),
+                        timing.mean / frames);
+        }
+    }
+
+    return 0;
+}
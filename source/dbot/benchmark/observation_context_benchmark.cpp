@@ -0,0 +1,91 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file observation_context_benchmark.cpp
+ * \date October 2016
+ *
+ * Measures setting one frame on several image models of the same camera,
+ * once with a copy of the observation per model and once through a shared
+ * observation context built once per frame.
+ *
+ * Usage: observation_context_benchmark [iterations] [rows] [cols]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <dbot/benchmark/benchmark.h>
+#include <dbot/model/kinect_image_model.h>
+#include <dbot/observation_context.h>
+#include <dbot/pose/free_floating_rigid_bodies_state.h>
+
+typedef dbot::FreeFloatingRigidBodiesState<> State;
+typedef dbot::KinectImageModel<double, State> Model;
+
+static int argument(int argc, char** argv, int index, int default_value)
+{
+    return argc > index ? std::atoi(argv[index]) : default_value;
+}
+
+int main(int argc, char** argv)
+{
+    const int iterations = argument(argc, argv, 1, 50);
+    const int rows = argument(argc, argv, 2, 480);
+    const int cols = argument(argc, argv, 3, 640);
+
+    std::printf("%d iterations, %dx%d pixels\n", iterations, cols, rows);
+
+    dbot::benchmark::CubeScene scene(rows, cols);
+    const Eigen::MatrixXd observation = scene.observation();
+
+    const int counts[] = {1, 4, 10};
+    for (int count : counts)
+    {
+        dbot::ObservationSource source(scene.camera_matrix(), rows, cols);
+
+        std::vector<std::shared_ptr<Model>> models;
+        for (int i = 0; i < count; ++i)
+        {
+            models.push_back(std::make_shared<Model>(
+                scene.camera_matrix(),
+                rows,
+                cols,
+                scene.create_renderer(),
+                std::make_shared<dbot::KinectPixelModel>(
+                    0.01, 0.003, 0.00142478),
+                std::make_shared<dbot::OcclusionModel>(0.1, 0.7),
+                0.1,
+                1.0 / 30.0));
+            models.back()->subscribe(source);
+        }
+
+        auto own = dbot::benchmark::measure(iterations, [&]() {
+            for (auto& model : models) model->set_observation(observation);
+        });
+        dbot::benchmark::print(std::to_string(count) + " models, own copies",
+                               own);
+
+        auto shared = dbot::benchmark::measure(iterations, [&]() {
+            auto context = source.publish(observation.data());
+            for (auto& model : models) model->set_observation_context(context);
+        });
+        dbot::benchmark::print(std::to_string(count) + " models, shared",
+                               shared);
+    }
+
+    return 0;
+}
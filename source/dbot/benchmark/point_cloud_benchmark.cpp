@@ -0,0 +1,80 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file point_cloud_benchmark.cpp
+ * \date October 2016
+ *
+ * Measures the back projection of a depth image into a point cloud, with
+ * the per pixel helper DepthImage2CartVectors and with the converter on
+ * cached rays, at full resolution and downsampled.
+ *
+ * Usage: point_cloud_benchmark [iterations] [rows] [cols]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <dbot/benchmark/benchmark.h>
+#include <dbot/helper_functions.h>
+#include <dbot/point_cloud.h>
+
+static int argument(int argc, char** argv, int index, int default_value)
+{
+    return argc > index ? std::atoi(argv[index]) : default_value;
+}
+
+int main(int argc, char** argv)
+{
+    const int iterations = argument(argc, argv, 1, 20);
+    const int rows = argument(argc, argv, 2, 480);
+    const int cols = argument(argc, argv, 3, 640);
+
+    std::printf("%dx%d pixels\n", cols, rows);
+
+    dbot::benchmark::CubeScene scene(rows, cols);
+    const Eigen::MatrixXd observation = scene.observation();
+
+    std::vector<float> depth(observation.data(),
+                             observation.data() + observation.size());
+    std::vector<double> wide_depth(observation.data(),
+                                   observation.data() + observation.size());
+
+    dbot::benchmark::print(
+        "DepthImage2CartVectors",
+        dbot::benchmark::measure(iterations, [&]() {
+            auto points = dbot::hf::DepthImage2CartVectors(
+                wide_depth, rows, cols, scene.camera_matrix());
+            if (points.empty()) std::abort();
+        }));
+
+    dbot::PointCloudConverter converter(scene.camera_matrix(), rows, cols);
+    std::vector<float> x(rows * cols), y(rows * cols), z(rows * cols);
+    std::vector<unsigned char> valid(rows * cols);
+    const dbot::PointCloud points = {x.data(), y.data(), z.data(), valid.data()};
+
+    for (int step : {1, 2, 4})
+    {
+        const auto region = converter.image(step);
+        int valid_count = 0;
+        auto timing = dbot::benchmark::measure(iterations, [&]() {
+            valid_count = converter.to_points(depth.data(), region, points);
+        });
+        dbot::benchmark::print(
+            "converter, step " + std::to_string(step), timing);
+        std::printf("    %d of %d points valid\n", valid_count, region.size());
+    }
+
+    return 0;
+}
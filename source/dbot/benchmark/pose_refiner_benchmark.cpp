@@ -0,0 +1,250 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file pose_refiner_benchmark.cpp
+ * \date October 2016
+ *
+ * Tracks a synthetic cube trajectory with the coordinate particle filter and
+ * compares the tracking error and frame time with and without the
+ * point-to-plane refinement of the estimate over the particle count. The
+ * observation has depth noise and a bar occluding part of the cube.
+ *
+ * Usage: pose_refiner_benchmark [runs] [frames] [rows] [cols]
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include <dbot/benchmark/benchmark.h>
+#include <dbot/builder/object_transition_builder.h>
+#include <dbot/filter/rao_blackwell_coordinate_particle_filter.h>
+#include <dbot/model/kinect_image_model.h>
+#include <dbot/pose/free_floating_rigid_bodies_state.h>
+#include <dbot/tracker/pose_refiner.h>
+
+typedef dbot::FreeFloatingRigidBodiesState<> State;
+typedef dbot::ObjectTransitionBuilder<State> TransitionBuilder;
+typedef TransitionBuilder::Model Transition;
+typedef dbot::RbSensor<State> Sensor;
+typedef dbot::RaoBlackwellCoordinateParticleFilter<Transition, Sensor> Filter;
+typedef dbot::KinectImageModel<double, State> Model;
+
+static int argument(int argc, char** argv, int index, int default_value)
+{
+    return argc > index ? std::atoi(argv[index]) : default_value;
+}
+
+/**
+ * \brief Pose of the cube at the given time, a slow sway around the nominal
+ *        pose of the scene
+ */
+static Eigen::Affine3d true_pose(const dbot::benchmark::CubeScene& scene,
+                                 double time)
+{
+    const double phase = 2 * M_PI * time / 3.0;
+
+    Eigen::Affine3d pose = scene.pose();
+    pose.pretranslate(Eigen::Vector3d(
+        0.03 * std::sin(phase), 0.02 * std::sin(2 * phase), 0.0));
+    pose.rotate(Eigen::AngleAxisd(0.4 * std::sin(phase),
+                                  Eigen::Vector3d(0.0, 1.0, 0.0)));
+    return pose;
+}
+
+struct Error
+{
+    double position;
+    double angle;
+};
+
+/**
+ * \brief Observation of the cube at the given pose with depth noise of the
+ *        Kinect model and an occluding bar
+ */
+static Eigen::MatrixXd observe(const dbot::benchmark::CubeScene& scene,
+                               const Eigen::Affine3d& pose,
+                               std::mt19937& generator)
+{
+    std::normal_distribution<double> noise(0.0, 1.0);
+
+    Eigen::MatrixXd image = scene.render(pose);
+    for (int i = 0; i < image.size(); ++i)
+    {
+        double& depth = image(i);
+        if (std::isinf(depth)) continue;
+        depth += (0.003 + 0.00142478 * depth * depth) * noise(generator);
+    }
+
+    for (int row = 0; row < scene.rows(); ++row)
+    {
+        for (int col = scene.cols() / 2; col < scene.cols() / 2 + 8; ++col)
+        {
+            image(row * scene.cols() + col) = 0.4;
+        }
+    }
+
+    return image;
+}
+
+/**
+ * \brief Tracks the trajectory and returns the mean error over all frames
+ *        after the first ten
+ */
+static Error track(const dbot::benchmark::CubeScene& scene,
+                   int particles,
+                   int frames,
+                   bool refine,
+                   unsigned seed)
+{
+    const double delta_time = 1.0 / 30.0;
+
+    TransitionBuilder::Parameters transition;
+    transition.linear_sigma_x = 0.002;
+    transition.linear_sigma_y = 0.002;
+    transition.linear_sigma_z = 0.002;
+    transition.angular_sigma_x = 0.01;
+    transition.angular_sigma_y = 0.01;
+    transition.angular_sigma_z = 0.01;
+    transition.velocity_factor = 0.8;
+    transition.part_count = 1;
+
+    auto model = std::make_shared<Model>(
+        scene.camera_matrix(),
+        scene.rows(),
+        scene.cols(),
+        scene.create_renderer(),
+        std::make_shared<dbot::KinectPixelModel>(0.01, 0.003, 0.00142478),
+        std::make_shared<dbot::OcclusionModel>(0.1, 0.7),
+        0.1,
+        delta_time);
+
+    auto filter = std::make_shared<Filter>(
+        TransitionBuilder(transition).build(),
+        model,
+        std::vector<std::vector<int>>(1, {0, 1, 2, 3, 4, 5}),
+        2.0);
+
+    dbot::PoseRefiner refiner(
+        scene.create_renderer(), scene.camera_matrix(), scene.rows(),
+        scene.cols());
+    std::vector<float> depth(scene.rows() * scene.cols());
+    std::mt19937 generator(seed);
+
+    // start at the true initial pose, as the tracker after initialization
+    auto& integrated_poses = filter->sensor()->integrated_poses();
+    Eigen::Affine3d initial = true_pose(scene, 0);
+    integrated_poses = State(1);
+    integrated_poses.setZero();
+    integrated_poses.component(0).position() = initial.translation();
+    integrated_poses.component(0).orientation().quaternion(
+        Eigen::Quaterniond(initial.rotation()));
+
+    State zero(1);
+    zero.setZero();
+    filter->set_particles(std::vector<State>(1, zero));
+    filter->resample(particles);
+
+    const Transition::Input input = Transition::Input::Zero(1);
+
+    Error error = {0, 0};
+    for (int frame = 1; frame <= frames; ++frame)
+    {
+        const Eigen::Affine3d truth = true_pose(scene, frame * delta_time);
+        const Eigen::MatrixXd image = observe(scene, truth, generator);
+        filter->filter(image, input);
+
+        // recenter the particles on the mean, as the particle tracker does
+        State delta_mean = filter->belief().mean();
+        for (int i = 0; i < filter->belief().size(); i++)
+        {
+            filter->belief().location(i).subtract(delta_mean);
+        }
+        integrated_poses.apply_delta(delta_mean);
+
+        Eigen::Affine3d estimate = integrated_poses.component(0).affine();
+        if (refine)
+        {
+            // refine the mean and feed it back as a particle, as the
+            // particle tracker does
+            for (int i = 0; i < image.size(); ++i) depth[i] = image(i);
+            std::vector<Eigen::Affine3d> poses(1, estimate);
+            refiner.refine(depth.data(), poses);
+            estimate = poses[0];
+
+            State delta = integrated_poses;
+            delta.component(0).pose().affine(estimate);
+            delta.subtract(integrated_poses);
+            filter->inject_particle(delta);
+        }
+
+        if (frame <= 10) continue;
+
+        error.position +=
+            (estimate.translation() - truth.translation()).norm() /
+            (frames - 10);
+        error.angle +=
+            Eigen::AngleAxisd(estimate.rotation().transpose() *
+                              truth.rotation())
+                .angle() /
+            (frames - 10);
+    }
+
+    return error;
+}
+
+int main(int argc, char** argv)
+{
+    const int runs = argument(argc, argv, 1, 5);
+    const int frames = argument(argc, argv, 2, 100);
+    const int rows = argument(argc, argv, 3, 120);
+    const int cols = argument(argc, argv, 4, 160);
+
+    std::printf(
+        "%d runs of %d frames, %dx%d pixels\n", runs, frames, cols, rows);
+    std::printf("%-10s %-10s %16s %16s %12s\n",
+                "refinement",
+                "particles",
+                "position [mm]",
+                "angle [deg]",
+                "frame [ms]");
+
+    dbot::benchmark::CubeScene scene(rows, cols);
+
+    const int particle_counts[] = {10, 25, 50, 100, 200};
+    for (int particles : particle_counts)
+    {
+        for (bool refine : {false, true})
+        {
+            Error error = {0, 0};
+            unsigned seed = 1;
+            auto timing = dbot::benchmark::measure(runs, [&]() {
+                Error run = track(scene, particles, frames, refine, seed++);
+                error.position += run.position;
+                error.angle += run.angle;
+            });
+
+            // the warm up run of measure() is included in the sums
+            std::printf("%-10s %-10d %16.3f %16.3f %12.3f\n",
+                        refine ? "on" : "off",
+                        particles,
+                        1e3 * error.position / (runs + 1),
+                        180 / M_PI * error.angle / (runs + 1),
+                        timing.mean / frames);
+        }
+    }
+
+    return 0;
+}
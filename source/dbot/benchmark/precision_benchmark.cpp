@@ -0,0 +1,190 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file precision_benchmark.cpp
+ * \date October 2016
+ *
+ * Measures the pixel model kernel and the CPU image model update with the
+ * pixel model evaluated in double and in single precision, and reports the
+ * largest difference of the log likelihoods.
+ *
+ * Usage: precision_benchmark [particles] [iterations] [rows] [cols]
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <dbot/benchmark/benchmark.h>
+#include <dbot/cpu_kernels.h>
+#include <dbot/model/kinect_image_model.h>
+#include <dbot/pose/free_floating_rigid_bodies_state.h>
+
+typedef dbot::FreeFloatingRigidBodiesState<> State;
+typedef dbot::RbSensor<State> Sensor;
+
+static int argument(int argc, char** argv, int index, int default_value)
+{
+    return argc > index ? std::atoi(argv[index]) : default_value;
+}
+
+/**
+ * \brief Times the update of a model evaluating the pixel model in Scalar
+ *        and returns the log likelihoods of the last update
+ */
+template <typename Scalar>
+static Sensor::RealArray update(const dbot::benchmark::CubeScene& scene,
+                                const Eigen::MatrixXd& observation,
+                                const Sensor::StateArray& deltas,
+                                int iterations,
+                                const char* name)
+{
+    const int particles = deltas.size();
+
+    dbot::KinectImageModel<Scalar, State> model(
+        scene.camera_matrix(),
+        scene.rows(),
+        scene.cols(),
+        scene.create_renderer(),
+        std::make_shared<dbot::KinectPixelModel>(0.01, 0.003, 0.00142478),
+        std::make_shared<dbot::OcclusionModel>(0.1, 0.7),
+        0.1,
+        0.03);
+
+    State pose(1);
+    pose.component(0).position() = scene.pose().translation();
+    pose.component(0).orientation().quaternion(
+        Eigen::Quaterniond(scene.pose().rotation()));
+    model.integrated_poses() = pose;
+
+    // the first update expands the single initial occlusion row to one
+    // row per particle
+    Sensor::IntArray indices = Sensor::IntArray::Zero(particles);
+    Sensor::RealArray log_likes(particles);
+    model.set_observation(observation);
+    model.loglikes(deltas, indices, log_likes, true);
+
+    auto timing = dbot::benchmark::measure(iterations, [&]() {
+        for (int i = 0; i < particles; ++i) indices[i] = i;
+        model.set_observation(observation);
+        model.loglikes(deltas, indices, log_likes, true);
+    });
+
+    dbot::benchmark::print(name, timing);
+    return log_likes;
+}
+
+int main(int argc, char** argv)
+{
+    const int particles = argument(argc, argv, 1, 64);
+    const int iterations = argument(argc, argv, 2, 10);
+    const int rows = argument(argc, argv, 3, 480);
+    const int cols = argument(argc, argv, 4, 640);
+
+    std::printf("%d particles, %dx%d pixels, kernels %s\n",
+                particles,
+                cols,
+                rows,
+                dbot::cpu_kernels_report().c_str());
+
+    // the pixel model kernel alone on one image worth of pixels ------------
+    const int count = rows * cols;
+    const dbot::PixelModelParameters parameters = {
+        -std::log(0.5), 0.01, 0.003, 0.00142478, 6.0};
+
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<float> depth(0.5f, 2.0f);
+    std::normal_distribution<float> offset(0.0f, 0.005f);
+    std::uniform_real_distribution<float> probability(0.0f, 1.0f);
+    std::vector<float> observations(count);
+    std::vector<float> predictions(count);
+    std::vector<float> occlusions(count);
+    for (int i = 0; i < count; ++i)
+    {
+        predictions[i] = depth(generator);
+        observations[i] = predictions[i] + offset(generator);
+        occlusions[i] = probability(generator);
+    }
+
+    const dbot::CpuKernels& kernels = dbot::cpu_kernels();
+    std::vector<float> infinities(count);
+    kernels.infinity_probs(
+        parameters, observations.data(), count, infinities.data());
+
+    std::vector<float> posterior_occlusions(count);
+    std::vector<double> double_scores(count);
+    dbot::benchmark::print(
+        "pixel kernel, double",
+        dbot::benchmark::measure(iterations, [&]() {
+            kernels.pixel_loglikes(parameters,
+                                   observations.data(),
+                                   predictions.data(),
+                                   occlusions.data(),
+                                   infinities.data(),
+                                   count,
+                                   double_scores.data(),
+                                   posterior_occlusions.data());
+        }));
+
+    std::vector<float> float_scores(count);
+    dbot::benchmark::print(
+        "pixel kernel, float",
+        dbot::benchmark::measure(iterations, [&]() {
+            kernels.pixel_loglikes_single(parameters,
+                                          observations.data(),
+                                          predictions.data(),
+                                          occlusions.data(),
+                                          infinities.data(),
+                                          count,
+                                          float_scores.data(),
+                                          posterior_occlusions.data());
+        }));
+
+    // the image model update with particles spread around the pose --------
+    dbot::benchmark::CubeScene scene(rows, cols);
+    const Eigen::MatrixXd observation = scene.observation();
+
+    std::normal_distribution<double> noise(0.0, 0.003);
+    Sensor::StateArray deltas(particles);
+    for (auto& delta : deltas)
+    {
+        delta = State(1);
+        delta.setZero();
+        delta.component(0).position() =
+            Eigen::Vector3d(noise(generator), noise(generator), 0.0);
+        delta.component(0).orientation() =
+            Eigen::Vector3d(10 * noise(generator), 10 * noise(generator), 0.0);
+    }
+
+    auto wide = update<double>(
+        scene, observation, deltas, iterations, "update, double");
+    auto narrow = update<float>(
+        scene, observation, deltas, iterations, "update, float");
+
+    double difference = 0;
+    double magnitude = 0;
+    for (int i = 0; i < particles; ++i)
+    {
+        difference = std::max(difference, std::fabs(wide(i) - narrow(i)));
+        magnitude = std::max(magnitude, std::fabs(wide(i)));
+    }
+    std::printf("largest log likelihood difference %g of magnitude %g\n",
+                difference,
+                magnitude);
+
+    return 0;
+}
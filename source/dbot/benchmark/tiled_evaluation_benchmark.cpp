@@ -0,0 +1,129 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file tiled_evaluation_benchmark.cpp
+ * \date October 2016
+ *
+ * Measures the latency of the CPU image model update for few particles on a
+ * large image, distributing the particles over the workers compared to
+ * splitting each particle into tiles of image rows.
+ *
+ * Usage: tiled_evaluation_benchmark [particles] [iterations] [tile rows]
+ *                                   [rows] [cols] [max workers]
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+
+#include <dbot/benchmark/benchmark.h>
+#include <dbot/model/kinect_image_model.h>
+#include <dbot/pose/free_floating_rigid_bodies_state.h>
+
+typedef dbot::FreeFloatingRigidBodiesState<> State;
+typedef dbot::KinectImageModel<double, State> Model;
+
+static int argument(int argc, char** argv, int index, int default_value)
+{
+    return argc > index ? std::atoi(argv[index]) : default_value;
+}
+
+int main(int argc, char** argv)
+{
+    const int particles = argument(argc, argv, 1, 1);
+    const int iterations = argument(argc, argv, 2, 20);
+    const int tile_rows = argument(argc, argv, 3, 16);
+    const int rows = argument(argc, argv, 4, 720);
+    const int cols = argument(argc, argv, 5, 1280);
+    const int max_workers = argument(
+        argc, argv, 6, std::max(1u, std::thread::hardware_concurrency()));
+
+    std::printf("%d particles, %dx%d pixels, tiles of %d rows\n",
+                particles,
+                cols,
+                rows,
+                tile_rows);
+    std::printf("%-8s %-10s %12s %16s\n",
+                "workers",
+                "split",
+                "update [ms]",
+                "max |score diff|");
+
+    // the cube fills a large part of the image, as for a close object
+    dbot::benchmark::CubeScene scene(rows, cols);
+    const Eigen::MatrixXd observation = scene.observation();
+
+    std::mt19937 generator(1);
+    std::normal_distribution<double> noise(0.0, 0.003);
+    Model::StateArray deltas(particles);
+    for (auto& delta : deltas)
+    {
+        delta = State(1);
+        delta.setZero();
+        delta.component(0).position() =
+            Eigen::Vector3d(noise(generator), noise(generator), 0.0);
+    }
+
+    State pose(1);
+    pose.component(0).position() = scene.pose().translation();
+    pose.component(0).orientation().quaternion(
+        Eigen::Quaterniond(scene.pose().rotation()));
+
+    Model::RealArray reference;
+
+    for (int workers = 1; workers <= max_workers; workers *= 2)
+    {
+        for (bool tiled : {false, true})
+        {
+            if (workers == 1 && tiled) continue;
+
+            Model model(scene.camera_matrix(),
+                        rows,
+                        cols,
+                        scene.create_renderer(),
+                        std::make_shared<dbot::KinectPixelModel>(
+                            0.01, 0.003, 0.00142478),
+                        std::make_shared<dbot::OcclusionModel>(0.1, 0.7),
+                        0.1,
+                        0.03);
+            if (workers > 1)
+            {
+                model.set_executor(std::make_shared<dbot::Executor>(workers));
+            }
+            if (tiled) model.set_tile_rows(tile_rows);
+            model.integrated_poses() = pose;
+
+            Model::IntArray indices = Model::IntArray::Zero(particles);
+            model.set_observation(observation);
+            Model::RealArray log_likes = model.loglikes(deltas, indices, true);
+            if (reference.size() == 0) reference = log_likes;
+
+            auto timing = dbot::benchmark::measure(iterations, [&]() {
+                model.set_observation(observation);
+                model.loglikes(deltas, indices, true);
+            });
+
+            std::printf("%-8d %-10s %12.3f %16.3g\n",
+                        workers,
+                        tiled ? "tiles" : "particles",
+                        timing.mean,
+                        (log_likes - reference).abs().maxCoeff());
+        }
+    }
+
+    return 0;
+}
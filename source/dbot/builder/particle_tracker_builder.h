@@ -34,7 +34,10 @@
 #include <dbot/object_model_loader.h>
 #include <dbot/object_resource_identifier.h>
 #include <dbot/tracker/particle_tracker.h>
+#include <dbot/tracker/pose_refiner.h>
 #include <exception>
+#include <random>
+#include <vector>
 
 namespace dbot
 {
@@ -68,6 +71,53 @@ public:
         double moving_average_update_rate;
         double max_kl_divergence;
         bool center_object_frame;
+
+        /// seed of the filter, 0 draws one from std::random_device
+        unsigned seed = 0;
+
+        /// draws the block noise from a scrambled Halton sequence
+        bool low_discrepancy_noise = false;
+
+        /// weights and resamples the object parts independently
+        bool factorized_weights = false;
+
+        /// evaluations of the reduced update of frames which the sensor
+        /// reports as unchanged, 0 disables the reduced update
+        int static_evaluation_count = 0;
+
+        /// point-to-plane refinement of the estimate after each update
+        struct Refinement
+        {
+            bool enabled = false;
+            int iterations = 5;
+
+            /// maximum depth difference of a model and observed point pair
+            double max_distance = 0.01;
+
+            /// minimum point pairs for a part to be moved
+            int min_pixels = 50;
+
+            /// particles of the highest weight which are refined in
+            /// addition to the mean
+            int particles = 0;
+        };
+
+        Refinement refinement;
+
+        /// tempered weighting of each sampling block, see
+        /// RaoBlackwellCoordinateParticleFilter::set_annealing()
+        struct Annealing
+        {
+            /// exponents of the layers before the full loglikelihood, empty
+            /// disables annealing
+            std::vector<double> betas;
+
+            /// noise added to the copies after a layer, in units of the
+            /// transition noise
+            double diffusion = 0.5;
+        };
+
+        Annealing annealing;
     };
 
 public:
@@ -80,6 +130,23 @@ public:
         const std::shared_ptr<SensorBuilder>& sensor_builder,
         const std::shared_ptr<ObjectModel>& object_model,
         const Parameters& params)
+        : ParticleTrackerBuilder(transition_builder,
+                                 sensor_builder,
+                                 ready_object_model(object_model),
+                                 params)
+    {
+    }
+
+    /**
+     * \brief Creates a ParticleTrackerBuilder of an object model which may
+     *        still be loading. build() waits for the model only where it is
+     *        needed.
+     */
+    ParticleTrackerBuilder(
+        const std::shared_ptr<TransitionBuilder>& transition_builder,
+        const std::shared_ptr<SensorBuilder>& sensor_builder,
+        const ObjectModelFuture& object_model,
+        const Parameters& params)
         : transition_builder_(transition_builder),
           sensor_builder_(sensor_builder),
           object_model_(object_model),
@@ -96,33 +163,70 @@ public:
 
         auto tracker = std::make_shared<ParticleTracker>(
             filter,
-            object_model_,
+            object_model_.get(),
             params_.evaluation_count,
             params_.moving_average_update_rate,
             params_.center_object_frame);
 
+        if (params_.refinement.enabled)
+        {
+            tracker->set_refinement(create_refiner(),
+                                    params_.refinement.particles);
+        }
+
         return tracker;
     }
 
+    /**
+     * \brief Creates the pose refiner of the refinement stage
+     */
+    virtual std::shared_ptr<PoseRefiner> create_refiner() const
+    {
+        auto camera_data = sensor_builder_->camera_data();
+
+        return std::make_shared<PoseRefiner>(
+            sensor_builder_->create_renderer(),
+            camera_data->camera_matrix(),
+            camera_data->resolution().height,
+            camera_data->resolution().width,
+            params_.refinement.iterations,
+            params_.refinement.max_distance,
+            params_.refinement.min_pixels);
+    }
+
     /**
      * \brief Creates an instance of the Rbc particle filter
      *
      * \throws NoGpuSupportException if compile with DBOT_BUILD_GPU=OFF and
      *         attempting to build a tracker with GPU support
+     * \throws FactorizedWeightsException if factorized weights are requested
+     *         with a sensor which does not attribute pixels to parts
      */
     virtual std::shared_ptr<Filter> create_filter(
-        const std::shared_ptr<ObjectModel>& object_model,
+        const ObjectModelFuture& object_model,
         double max_kl_divergence)
     {
         auto transition = transition_builder_->build();
         auto sensor = sensor_builder_->build();
 
+        // the sensor is set up while the object model loads, which is
+        // awaited for the sampling blocks only
+        const int part_count = object_model.get()->count_parts();
         auto sampling_blocks = create_sampling_blocks(
-            object_model->count_parts(),
-            transition->noise_dimension() / object_model->count_parts());
+            part_count, transition->noise_dimension() / part_count);
 
         auto filter = std::shared_ptr<Filter>(
             new Filter(transition, sensor, sampling_blocks, max_kl_divergence));
+        filter->set_seed(params_.seed ? params_.seed : std::random_device()());
+        filter->set_low_discrepancy_noise(params_.low_discrepancy_noise,
+                                          filter->seed());
+        filter->set_factorized_weights(params_.factorized_weights);
+        filter->set_static_update(params_.static_evaluation_count /
+                                  sampling_blocks.size());
+        filter->set_annealing(
+            std::vector<fl::Real>(params_.annealing.betas.begin(),
+                                  params_.annealing.betas.end()),
+            params_.annealing.diffusion);
         return filter;
     }
 
@@ -152,7 +256,7 @@ public:
 protected:
     std::shared_ptr<TransitionBuilder> transition_builder_;
     std::shared_ptr<SensorBuilder> sensor_builder_;
-    std::shared_ptr<ObjectModel> object_model_;
+    ObjectModelFuture object_model_;
     Parameters params_;
 };
 }
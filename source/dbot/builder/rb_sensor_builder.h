@@ -32,15 +32,24 @@
 #include <Eigen/Dense>
 #include <dbot/camera_data.h>
 #include <dbot/default_shader_provider.h>
+#include <dbot/executor.h>
 #include <dbot/file_shader_provider.h>
+#include <dbot/huge_page_allocator.h>
+#include <dbot/impostor_atlas.h>
+#include <dbot/model/background_model.h>
 #include <dbot/model/kinect_image_model.h>
 #include <dbot/model/kinect_pixel_model.h>
 #include <dbot/model/occlusion_model.h>
 #include <dbot/model/rao_blackwell_sensor.h>
+#include <dbot/model/scene_change_detector.h>
+#include <dbot/model/sharded_image_model.h>
 #include <dbot/object_model.h>
 #include <dbot/pose/euler_vector.h>
 #include <dbot/rigid_body_renderer.h>
+#include <future>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace dbot
 {
@@ -56,6 +65,24 @@ class NoGpuSupportException : public std::exception
     }
 };
 
+/**
+ * \brief The ShardedSensorException class
+ */
+class ShardedSensorException : public std::exception
+{
+public:
+    explicit ShardedSensorException(const std::string& feature)
+        : message_("Sharded sensor: " + feature +
+                   " is not supported with worker processes")
+    {
+    }
+
+    const char* what() const noexcept { return message_.c_str(); }
+
+private:
+    std::string message_;
+};
+
 template <typename State>
 class RbSensorBuilder
 {
@@ -68,6 +95,9 @@ public:
             double p_occluded_visible;
             double p_occluded_occluded;
             double initial_occlusion_prob;
+            // pixels whose predicted occlusion probability reaches this
+            // threshold are scored approximately, above one disables it
+            double prune_threshold = 2.0;
         };
 
         /* -- Kinect pixel observation model parameters -- */
@@ -88,6 +118,94 @@ public:
         std::string vertex_shader_file;
         std::string fragment_shader_file;
         std::string geometry_shader_file;
+
+        /* -- CPU model precision -- */
+        // evaluate the pixel model in single precision instead of fl::Real
+        bool single_precision = false;
+
+        /* -- CPU model parallel evaluation -- */
+        // number of workers evaluating the particles, 0 for one per hardware
+        // thread. Each worker process evaluates single threaded, hence only
+        // 1 is supported with process_count > 0
+        int worker_count = 1;
+        // partition particles and place buffers per NUMA node, not supported
+        // with process_count > 0
+        bool numa_aware = false;
+        // split the evaluation of each particle into tiles of this many
+        // image rows rendered and scored by the workers, 0 to distribute
+        // the particles instead. Suits few particles on large images
+        int tile_rows = 0;
+        // rasterize only the triangles which may face the camera, using
+        // sets precomputed per view direction
+        bool cull_triangles = false;
+        // page backing of the per-particle occlusion and observation buffers
+        HugePagePolicy huge_pages = HugePagePolicy::Disabled;
+        // number of worker processes the particles are sharded over, 0 to
+        // evaluate in this process. Shared occlusion state is reserved for
+        // sample_count particles. The sensor must be built before the
+        // process starts any other thread, see ProcessPool
+        int process_count = 0;
+
+        /* -- Static background of a fixed camera -- */
+        struct Background
+        {
+            // background model file, learned from the first frames if empty
+            std::string file;
+            // number of frames to learn from, 0 disables the background
+            // unless a file is given
+            int learning_frames = 0;
+            // tolerance of a background match in standard deviations
+            double match_sigmas = 3.0;
+            // weight of a matching depth in the incremental update, 0 keeps
+            // the learned background fixed
+            double update_rate = 0.0;
+        };
+
+        // not supported with worker processes, i.e. process_count > 0
+        Background background;
+
+        /* -- Impostor prefilter -- */
+        struct Impostors
+        {
+            // fraction of the particles rendered exactly, 1 disables the
+            // prefilter
+            double keep_fraction = 1.0;
+            // subdivisions of the view sphere and view resolution in pixels
+            int view_subdivisions = 3;
+            int view_resolution = 64;
+        };
+
+        // not supported with worker processes, i.e. process_count > 0
+        Impostors impostors;
+
+        /* -- Change detection for the reduced update of static frames -- */
+        struct ChangeDetection
+        {
+            bool enabled = false;
+            // significant depth change in standard deviations of the noise
+            double threshold_sigmas = 4.0;
+            // fraction of changed pixels around the object below which the
+            // frame is static
+            double max_changed_fraction = 0.01;
+            // margin around the object in pixels
+            int margin = 8;
+        };
+
+        // not supported with worker processes, i.e. process_count > 0
+        ChangeDetection change_detection;
+
+        /* -- Known occluders -- */
+        struct Occluders
+        {
+            // meshes of fixtures in front of the object whose poses are
+            // known, e.g. a bin wall or the robot base, null for none
+            std::shared_ptr<ObjectModel> model;
+            // pose of each part of the model in the camera frame
+            std::vector<RigidBodyRenderer::Affine> poses;
+        };
+
+        // not supported with worker processes, i.e. process_count > 0
+        Occluders occluders;
     };
 
     typedef RbSensor<State> Model;
@@ -97,8 +215,34 @@ public:
                     const std::shared_ptr<CameraData>& camera_data,
                     const Parameters& params);
 
+    /**
+     * \brief Creates a builder of an object model which may still be
+     *        loading. build() sets up the parts of the sensor which do not
+     *        depend on the model while it loads.
+     */
+    RbSensorBuilder(const ObjectModelFuture& object_model,
+                    const std::shared_ptr<CameraData>& camera_data,
+                    const Parameters& params);
+
+    /**
+     * \throws ShardedSensorException if worker processes are combined with
+     *         a feature they do not support
+     */
     virtual std::shared_ptr<Model> build() const;
 
+    const std::shared_ptr<CameraData>& camera_data() const
+    {
+        return camera_data_;
+    }
+
+    /**
+     * \brief Returns the object model, waiting for it to be loaded
+     */
+    const std::shared_ptr<ObjectModel>& object_model() const
+    {
+        return object_model_.get();
+    }
+
 public:
     /* GPU model factor functions */
     virtual std::shared_ptr<Model> create_gpu_based_model() const;
@@ -114,8 +258,33 @@ public:
 
     virtual std::shared_ptr<RigidBodyRenderer> create_renderer() const;
 
+    virtual std::shared_ptr<Executor> create_executor() const;
+
+    virtual std::shared_ptr<BackgroundModel> create_background_model() const;
+
+    virtual std::shared_ptr<ImpostorAtlas> create_impostor_atlas() const;
+
+    virtual std::shared_ptr<SceneChangeDetector> create_change_detector()
+        const;
+
+protected:
+    /// throws ShardedSensorException if a feature requires the model to be
+    /// evaluated in this process
+    void check_worker_processes() const;
+
+    /// assembles the CPU model evaluating the pixel model in Scalar
+    template <typename Scalar>
+    std::shared_ptr<Model> create_image_model(
+        const std::shared_ptr<RigidBodyRenderer>& renderer,
+        const std::shared_ptr<KinectPixelModel>& pixel_model,
+        const std::shared_ptr<OcclusionModel>& occlusion_process,
+        const std::shared_ptr<Executor>& executor,
+        const std::shared_ptr<BackgroundModel>& background,
+        std::future<std::shared_ptr<ImpostorAtlas>>& impostors,
+        const std::shared_ptr<SceneChangeDetector>& change_detector) const;
+
 protected:
-    std::shared_ptr<ObjectModel> object_model_;
+    ObjectModelFuture object_model_;
     std::shared_ptr<CameraData> camera_data_;
     Parameters params_;
 };
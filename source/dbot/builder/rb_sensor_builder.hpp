@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <future>
+
 #include <dbot/builder/rb_sensor_builder.h>
 #include <dbot/model/kinect_image_model.h>
 
@@ -43,6 +45,17 @@ RbSensorBuilder<State>::RbSensorBuilder(
     const std::shared_ptr<ObjectModel>& object_model,
     const std::shared_ptr<CameraData>& camera_data,
     const Parameters& params)
+    : object_model_(ready_object_model(object_model)),
+      camera_data_(camera_data),
+      params_(params)
+{
+}
+
+template <typename State>
+RbSensorBuilder<State>::RbSensorBuilder(
+    const ObjectModelFuture& object_model,
+    const std::shared_ptr<CameraData>& camera_data,
+    const Parameters& params)
     : object_model_(object_model), camera_data_(camera_data), params_(params)
 {
 }
@@ -74,8 +87,8 @@ auto RbSensorBuilder<State>::create_gpu_based_model() const
         camera_data_->resolution().height,
         camera_data_->resolution().width,
         params_.sample_count,
-        object_model_->vertices(),
-        object_model_->triangle_indices(),
+        object_model()->vertices(),
+        object_model()->triangle_indices(),
         create_shader_provider(),
         false,  // TODO should be a parameter from the config file
         false,  // TODO should be a parameter from the config file
@@ -112,20 +125,146 @@ template <typename State>
 auto RbSensorBuilder<State>::create_cpu_based_model() const
     -> std::shared_ptr<Model>
 {
+    if (params_.process_count > 0) check_worker_processes();
+
+    // the parts which depend on the object model wait for it to be loaded,
+    // hence they are built in the background while the others are set up
+    auto renderer = std::async(std::launch::async,
+                               [this]() { return create_renderer(); });
+    std::future<std::shared_ptr<ImpostorAtlas>> impostors;
+    if (params_.process_count == 0 && params_.impostors.keep_fraction < 1.0)
+    {
+        impostors = std::async(std::launch::async,
+                               [this]() { return create_impostor_atlas(); });
+    }
+
     auto pixel_model = create_pixel_model();
     auto occlusion_process = create_occlusion_process();
-    auto renderer = create_renderer();
 
-    auto sensor =
-        std::shared_ptr<Model>(new dbot::KinectImageModel<fl::Real, State>(
-            camera_data_->camera_matrix(),
+    std::shared_ptr<Executor> executor;
+    std::shared_ptr<BackgroundModel> background;
+    std::shared_ptr<SceneChangeDetector> change_detector;
+    if (params_.process_count == 0)
+    {
+        executor = create_executor();
+        background = create_background_model();
+        change_detector = create_change_detector();
+    }
+
+    if (params_.single_precision)
+    {
+        return create_image_model<float>(renderer.get(),
+                                         pixel_model,
+                                         occlusion_process,
+                                         executor,
+                                         background,
+                                         impostors,
+                                         change_detector);
+    }
+
+    return create_image_model<fl::Real>(renderer.get(),
+                                        pixel_model,
+                                        occlusion_process,
+                                        executor,
+                                        background,
+                                        impostors,
+                                        change_detector);
+}
+
+template <typename State>
+void RbSensorBuilder<State>::check_worker_processes() const
+{
+    // the workers evaluate a copy of the model single threaded, on the
+    // frames as published. The following features are not carried over to
+    // them
+    if (params_.worker_count != 1 || params_.numa_aware)
+    {
+        throw ShardedSensorException("parallel evaluation");
+    }
+    if (!params_.background.file.empty() ||
+        params_.background.learning_frames > 0)
+    {
+        throw ShardedSensorException("the background model");
+    }
+    if (params_.impostors.keep_fraction < 1.0)
+    {
+        throw ShardedSensorException("the impostor prefilter");
+    }
+    if (params_.change_detection.enabled)
+    {
+        throw ShardedSensorException("change detection");
+    }
+    if (params_.occluders.model)
+    {
+        throw ShardedSensorException("known occluders");
+    }
+}
+
+template <typename State>
+template <typename Scalar>
+auto RbSensorBuilder<State>::create_image_model(
+    const std::shared_ptr<RigidBodyRenderer>& renderer,
+    const std::shared_ptr<KinectPixelModel>& pixel_model,
+    const std::shared_ptr<OcclusionModel>& occlusion_process,
+    const std::shared_ptr<Executor>& executor,
+    const std::shared_ptr<BackgroundModel>& background,
+    std::future<std::shared_ptr<ImpostorAtlas>>& impostors,
+    const std::shared_ptr<SceneChangeDetector>& change_detector) const
+    -> std::shared_ptr<Model>
+{
+    auto sensor = std::make_shared<dbot::KinectImageModel<Scalar, State>>(
+        camera_data_->camera_matrix(),
+        camera_data_->resolution().height,
+        camera_data_->resolution().width,
+        renderer,
+        pixel_model,
+        occlusion_process,
+        params_.occlusion.initial_occlusion_prob,
+        params_.delta_time);
+
+    sensor->set_huge_page_policy(params_.huge_pages);
+    sensor->set_occlusion_pruning(params_.occlusion.prune_threshold);
+
+    if (params_.process_count > 0)
+    {
+        // the workers are forked with a copy of the model and evaluate it
+        // single threaded. The loaders above have been joined, such that
+        // the process runs no other thread of the builder
+        return std::make_shared<ShardedImageModel<State, Scalar>>(
+            sensor,
+            params_.process_count,
+            params_.sample_count,
             camera_data_->resolution().height,
             camera_data_->resolution().width,
-            renderer,
-            pixel_model,
-            occlusion_process,
             params_.occlusion.initial_occlusion_prob,
-            params_.delta_time));
+            params_.delta_time);
+    }
+
+    if (executor)
+    {
+        sensor->set_executor(executor);
+        sensor->set_tile_rows(params_.tile_rows);
+    }
+
+    if (background) sensor->set_background_model(background);
+
+    if (impostors.valid())
+    {
+        sensor->set_impostor_prefilter(impostors.get(),
+                                       params_.impostors.keep_fraction);
+    }
+
+    if (change_detector) sensor->set_change_detector(change_detector);
+
+    if (params_.occluders.model)
+    {
+        // the configured poses hold until the tracker moves the occluders,
+        // see ParticleTracker::set_occluder_poses()
+        sensor->set_occluders(std::make_shared<RigidBodyRenderer>(
+            params_.occluders.model->vertices(),
+            params_.occluders.model->triangle_indices()));
+        sensor->set_occluder_poses(params_.occluders.poses);
+    }
 
     return sensor;
 }
@@ -152,12 +291,80 @@ auto RbSensorBuilder<State>::create_occlusion_process() const
     return occlusion_process;
 }
 
+template <typename State>
+auto RbSensorBuilder<State>::create_executor() const
+    -> std::shared_ptr<Executor>
+{
+    if (params_.worker_count == 1 && !params_.numa_aware)
+    {
+        return std::shared_ptr<Executor>();
+    }
+
+    return std::make_shared<Executor>(params_.worker_count,
+                                      params_.numa_aware);
+}
+
+template <typename State>
+auto RbSensorBuilder<State>::create_background_model() const
+    -> std::shared_ptr<BackgroundModel>
+{
+    const auto& background = params_.background;
+
+    if (!background.file.empty())
+    {
+        return std::make_shared<BackgroundModel>(
+            BackgroundModel::load(background.file,
+                                  background.match_sigmas,
+                                  background.update_rate));
+    }
+
+    if (background.learning_frames <= 0)
+    {
+        return std::shared_ptr<BackgroundModel>();
+    }
+
+    return std::make_shared<BackgroundModel>(
+        camera_data_->resolution().height * camera_data_->resolution().width,
+        background.learning_frames,
+        background.match_sigmas,
+        background.update_rate);
+}
+
+template <typename State>
+auto RbSensorBuilder<State>::create_impostor_atlas() const
+    -> std::shared_ptr<ImpostorAtlas>
+{
+    return std::make_shared<ImpostorAtlas>(object_model()->vertices(),
+                                           object_model()->triangle_indices(),
+                                           params_.impostors.view_subdivisions,
+                                           params_.impostors.view_resolution);
+}
+
+template <typename State>
+auto RbSensorBuilder<State>::create_change_detector() const
+    -> std::shared_ptr<SceneChangeDetector>
+{
+    const auto& detection = params_.change_detection;
+
+    if (!detection.enabled) return std::shared_ptr<SceneChangeDetector>();
+
+    return std::make_shared<SceneChangeDetector>(
+        camera_data_->resolution().height,
+        camera_data_->resolution().width,
+        params_.kinect.sigma_factor,
+        detection.threshold_sigmas,
+        detection.max_changed_fraction,
+        detection.margin);
+}
+
 template <typename State>
 auto RbSensorBuilder<State>::create_renderer() const
     -> std::shared_ptr<RigidBodyRenderer>
 {
     std::shared_ptr<RigidBodyRenderer> renderer(new RigidBodyRenderer(
-        object_model_->vertices(), object_model_->triangle_indices()));
+        object_model()->vertices(), object_model()->triangle_indices()));
+
+    if (params_.cull_triangles) renderer->compute_visible_sets();
 
     return renderer;
 }
@@ -0,0 +1,210 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file cpu_kernels.cpp
+ * \date October 2016
+ *
+ * Baseline kernels and the runtime selection of the variant
+ */
+
+#define DBOT_CPU_KERNELS_NAMESPACE cpu_kernels_baseline
+#define DBOT_CPU_KERNELS_VARIANT CpuVariant::Baseline
+#include <dbot/cpu_kernels.hpp>
+
+#include <cstdlib>
+
+namespace dbot
+{
+// the variants compiled in, see the CPU variant sources in CMakeLists.txt
+#ifdef DBOT_CPU_KERNELS_SSE42
+namespace cpu_kernels_sse42
+{
+CpuKernels kernels();
+}
+#endif
+#ifdef DBOT_CPU_KERNELS_AVX2
+namespace cpu_kernels_avx2
+{
+CpuKernels kernels();
+}
+#endif
+#ifdef DBOT_CPU_KERNELS_AVX512
+namespace cpu_kernels_avx512
+{
+CpuKernels kernels();
+}
+#endif
+
+namespace
+{
+const CpuVariant all_variants[] = {CpuVariant::Baseline,
+                                   CpuVariant::Sse42,
+                                   CpuVariant::Avx2,
+                                   CpuVariant::Avx512};
+
+struct ActiveKernels
+{
+    const CpuKernels* kernels;
+    std::string report;
+};
+
+ActiveKernels select_kernels()
+{
+    ActiveKernels active;
+
+    const CpuVariant detected = detect_cpu_variant();
+    active.kernels = &cpu_kernels(detected);
+    active.report = std::string(cpu_variant_name(detected)) + " (detected)";
+
+    const char* name = std::getenv("DBOT_CPU_VARIANT");
+    if (!name || !*name) return active;
+
+    // the selection runs in a static initializer, hence a bad override falls
+    // back to the detected variant instead of throwing
+    CpuVariant variant;
+    try
+    {
+        variant = parse_cpu_variant(name);
+    }
+    catch (const CpuVariantException&)
+    {
+        active.report = std::string(cpu_variant_name(detected)) +
+                        " (detected, DBOT_CPU_VARIANT=" + name +
+                        " is unknown)";
+        return active;
+    }
+
+    if (cpu_variant_supported(variant))
+    {
+        active.kernels = &cpu_kernels(variant);
+        active.report = std::string(name) + " (DBOT_CPU_VARIANT)";
+    }
+    else
+    {
+        active.report = std::string(cpu_variant_name(detected)) +
+                        " (detected, DBOT_CPU_VARIANT=" + name +
+                        " is not supported)";
+    }
+
+    return active;
+}
+
+const ActiveKernels& active_kernels()
+{
+    static const ActiveKernels active = select_kernels();
+    return active;
+}
+}
+
+bool cpu_variant_supported(CpuVariant variant)
+{
+    switch (variant)
+    {
+        case CpuVariant::Baseline:
+            return true;
+#ifdef DBOT_CPU_KERNELS_SSE42
+        case CpuVariant::Sse42:
+            return __builtin_cpu_supports("sse4.2");
+#endif
+#ifdef DBOT_CPU_KERNELS_AVX2
+        case CpuVariant::Avx2:
+            return __builtin_cpu_supports("avx2") &&
+                   __builtin_cpu_supports("fma");
+#endif
+#ifdef DBOT_CPU_KERNELS_AVX512
+        case CpuVariant::Avx512:
+            return __builtin_cpu_supports("avx512f") &&
+                   __builtin_cpu_supports("avx512dq") &&
+                   __builtin_cpu_supports("avx512bw") &&
+                   __builtin_cpu_supports("avx512vl") &&
+                   __builtin_cpu_supports("avx2") &&
+                   __builtin_cpu_supports("fma");
+#endif
+        default:
+            return false;
+    }
+}
+
+CpuVariant detect_cpu_variant()
+{
+    CpuVariant best = CpuVariant::Baseline;
+    for (CpuVariant variant : all_variants)
+    {
+        if (cpu_variant_supported(variant)) best = variant;
+    }
+    return best;
+}
+
+CpuVariant parse_cpu_variant(const std::string& name)
+{
+    for (CpuVariant variant : all_variants)
+    {
+        if (name == cpu_variant_name(variant)) return variant;
+    }
+
+    throw CpuVariantException("unknown variant '" + name +
+                              "', expected one of baseline, sse4.2, avx2 or "
+                              "avx512");
+}
+
+const char* cpu_variant_name(CpuVariant variant)
+{
+    switch (variant)
+    {
+        case CpuVariant::Baseline:
+            return "baseline";
+        case CpuVariant::Sse42:
+            return "sse4.2";
+        case CpuVariant::Avx2:
+            return "avx2";
+        case CpuVariant::Avx512:
+            return "avx512";
+    }
+    return "unknown";
+}
+
+const CpuKernels& cpu_kernels(CpuVariant variant)
+{
+    if (!cpu_variant_supported(variant))
+    {
+        throw CpuVariantException(std::string(cpu_variant_name(variant)) +
+                                  " is not supported by this build or CPU");
+    }
+
+    static const CpuKernels baseline = cpu_kernels_baseline::kernels();
+#ifdef DBOT_CPU_KERNELS_SSE42
+    static const CpuKernels sse42 = cpu_kernels_sse42::kernels();
+    if (variant == CpuVariant::Sse42) return sse42;
+#endif
+#ifdef DBOT_CPU_KERNELS_AVX2
+    static const CpuKernels avx2 = cpu_kernels_avx2::kernels();
+    if (variant == CpuVariant::Avx2) return avx2;
+#endif
+#ifdef DBOT_CPU_KERNELS_AVX512
+    static const CpuKernels avx512 = cpu_kernels_avx512::kernels();
+    if (variant == CpuVariant::Avx512) return avx512;
+#endif
+    return baseline;
+}
+
+const CpuKernels& cpu_kernels()
+{
+    return *active_kernels().kernels;
+}
+
+std::string cpu_kernels_report()
+{
+    return active_kernels().report;
+}
+}
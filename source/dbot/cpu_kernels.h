@@ -0,0 +1,246 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file cpu_kernels.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <exception>
+#include <string>
+
+namespace dbot
+{
+/**
+ * \brief Instruction set variants the hot kernels are compiled for, ordered
+ *        by preference
+ */
+enum class CpuVariant
+{
+    Baseline,
+    Sse42,
+    Avx2,
+    Avx512
+};
+
+class CpuVariantException : public std::exception
+{
+public:
+    explicit CpuVariantException(const std::string& message)
+        : message_("CPU variant: " + message)
+    {
+    }
+
+    const char* what() const noexcept { return message_.c_str(); }
+
+private:
+    std::string message_;
+};
+
+/**
+ * \brief Parameters of the Kinect pixel model, see KinectPixelModel
+ */
+struct PixelModelParameters
+{
+    double lambda;
+    double tail_weight;
+    double model_sigma;
+    double sigma_factor;
+    double max_depth;
+};
+
+/**
+ * \brief Hot loops of the renderer and the image model on plain arrays. Each
+ *        kernel is compiled once per CPU variant, the table of the variant
+ *        selected at startup is returned by cpu_kernels().
+ *
+ * Matrices are 3 x 3 in column major order, points are interleaved x y z.
+ */
+struct CpuKernels
+{
+    CpuVariant variant;
+
+    /**
+     * \brief Transforms count points by rotation and translation into the
+     *        camera frame and projects them with the camera matrix onto the
+     *        image plane, writing interleaved x y z and u v
+     */
+    void (*transform_points)(const double* rotation,
+                             const double* translation,
+                             const double* camera_matrix,
+                             const double* points,
+                             int count,
+                             double* transformed,
+                             double* projected);
+
+    /**
+     * \brief Rasterizes the rows [row_begin, row_end) of one column of a
+     *        triangle with the given plane normal and offset. Each pixel
+     *        keeps the closest depth and, if part_image is not null, the
+     *        part of that depth.
+     */
+    void (*rasterize_column)(const double* inverse_camera_matrix,
+                             const double* normal,
+                             float offset,
+                             int col,
+                             int row_begin,
+                             int row_end,
+                             int n_cols,
+                             int part,
+                             float* depth_image,
+                             int* part_image);
+
+    /**
+     * \brief Evaluates the Kinect pixel model for count pixels. Returns the
+     *        log likelihood ratio of each observation given the prediction
+     *        and the occlusion prior against an infinitely distant object,
+     *        and the posterior occlusion probability. The probabilities of
+     *        the observations given the infinitely distant object are
+     *        passed in, see infinity_probs. A NaN observation scores 0 and
+     *        keeps its prior.
+     */
+    void (*pixel_loglikes)(const PixelModelParameters& model,
+                           const float* observations,
+                           const float* predictions,
+                           const float* occlusions,
+                           const float* infinities,
+                           int count,
+                           double* scores,
+                           float* posterior_occlusions);
+
+    /**
+     * \brief Single precision pixel_loglikes, computed in float throughout
+     */
+    void (*pixel_loglikes_single)(const PixelModelParameters& model,
+                                  const float* observations,
+                                  const float* predictions,
+                                  const float* occlusions,
+                                  const float* infinities,
+                                  int count,
+                                  float* scores,
+                                  float* posterior_occlusions);
+
+    /**
+     * \brief Computes the probabilities of count observations given an
+     *        occluded object at infinite distance, the reference of the
+     *        pixel_loglikes ratio. They depend on the observations only,
+     *        hence are computed once per frame.
+     */
+    void (*infinity_probs)(const PixelModelParameters& model,
+                           const float* observations,
+                           int count,
+                           float* probabilities);
+
+    /**
+     * \brief Maps count occlusion probabilities o to offset + scale * o,
+     *        clamped to [0, 1]. The output may alias the input.
+     */
+    void (*predict_occlusions)(double scale,
+                               double offset,
+                               const float* occlusions,
+                               float* new_occlusions,
+                               int count);
+
+    /**
+     * \brief Back projects count depths, stride elements apart in the depth
+     *        and ray arrays, along their pixel rays into contiguous x y z
+     *        arrays. Depths which are NaN, infinite or not positive yield
+     *        NaN points and a zero mask. Returns the number of valid points.
+     */
+    int (*backproject_depth)(const float* ray_x,
+                             const float* ray_y,
+                             const float* ray_z,
+                             const float* depth,
+                             int count,
+                             int stride,
+                             float* x,
+                             float* y,
+                             float* z,
+                             unsigned char* valid);
+
+    /**
+     * \brief Converts count depths between the double precision
+     *        observations and the single precision image buffers
+     */
+    void (*narrow_depth)(const double* depth, float* narrow, int count);
+    void (*widen_depth)(const float* depth, double* wide, int count);
+};
+
+/**
+ * \brief Returns the best variant that is compiled in and supported by the
+ *        host CPU
+ */
+CpuVariant detect_cpu_variant();
+
+/**
+ * \brief Returns whether the variant is compiled in and supported by the
+ *        host CPU
+ */
+bool cpu_variant_supported(CpuVariant variant);
+
+/**
+ * \brief Parses a variant name, one of baseline, sse4.2, avx2 or avx512
+ *
+ * \throws CpuVariantException if the name is unknown
+ */
+CpuVariant parse_cpu_variant(const std::string& name);
+
+/**
+ * \brief Returns the name of the variant as accepted by parse_cpu_variant()
+ */
+const char* cpu_variant_name(CpuVariant variant);
+
+/**
+ * \brief Returns the kernels of the given variant
+ *
+ * \throws CpuVariantException if the variant is not supported
+ */
+const CpuKernels& cpu_kernels(CpuVariant variant);
+
+/**
+ * \brief Returns the kernels of the active variant. It is selected with the
+ *        first call, from the environment variable DBOT_CPU_VARIANT if set
+ *        and otherwise by detect_cpu_variant(). An override which names no
+ *        variant or one the host does not support falls back to the
+ *        detected variant, see cpu_kernels_report().
+ */
+const CpuKernels& cpu_kernels();
+
+/**
+ * \brief Describes the active variant and how it was selected, e.g.
+ *        "avx2 (detected)"
+ */
+std::string cpu_kernels_report();
+
+/**
+ * \brief Converts count depths with the kernels of the active variant. The
+ *        overloads let callers convert fl::Real buffers of either precision.
+ */
+inline void convert_depth(const double* depth, float* converted, int count)
+{
+    cpu_kernels().narrow_depth(depth, converted, count);
+}
+
+inline void convert_depth(const float* depth, double* converted, int count)
+{
+    cpu_kernels().widen_depth(depth, converted, count);
+}
+
+inline void convert_depth(const float* depth, float* converted, int count)
+{
+    std::copy(depth, depth + count, converted);
+}
+}
@@ -0,0 +1,297 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file cpu_kernels.hpp
+ * \date October 2016
+ *
+ * Kernel implementations, included once per CPU variant by a translation
+ * unit compiled with the instruction set flags of that variant. The unit
+ * defines DBOT_CPU_KERNELS_NAMESPACE and DBOT_CPU_KERNELS_VARIANT first.
+ *
+ * Only plain C++ is used here. Inline functions of template heavy headers
+ * such as Eigen would be emitted by every variant, and the linker may pick
+ * the copy compiled for a newer instruction set than the host supports.
+ */
+
+#include <dbot/cpu_kernels.h>
+
+#include <cmath>
+#include <limits>
+
+namespace dbot
+{
+namespace DBOT_CPU_KERNELS_NAMESPACE
+{
+namespace
+{
+void transform_points(const double* rotation,
+                      const double* translation,
+                      const double* camera_matrix,
+                      const double* points,
+                      int count,
+                      double* transformed,
+                      double* projected)
+{
+    const double* r = rotation;
+    const double* k = camera_matrix;
+
+    for (int i = 0; i < count; ++i)
+    {
+        const double* p = points + 3 * i;
+        double* t = transformed + 3 * i;
+
+        t[0] = r[0] * p[0] + r[3] * p[1] + r[6] * p[2] + translation[0];
+        t[1] = r[1] * p[0] + r[4] * p[1] + r[7] * p[2] + translation[1];
+        t[2] = r[2] * p[0] + r[5] * p[1] + r[8] * p[2] + translation[2];
+
+        projected[2 * i] = (k[0] * t[0] + k[3] * t[1] + k[6] * t[2]) / t[2];
+        projected[2 * i + 1] =
+            (k[1] * t[0] + k[4] * t[1] + k[7] * t[2]) / t[2];
+    }
+}
+
+void rasterize_column(const double* inverse_camera_matrix,
+                      const double* normal,
+                      float offset,
+                      int col,
+                      int row_begin,
+                      int row_end,
+                      int n_cols,
+                      int part,
+                      float* depth_image,
+                      int* part_image)
+{
+    const double* k = inverse_camera_matrix;
+
+    // the line through the pixel is the inverse camera matrix times
+    // (col, row, 1), its depth is the z component
+    const double base[3] = {k[0] * col, k[1] * col, k[2] * col};
+
+    // the selects store unconditionally, which lets the loop vectorize
+    for (int row = row_begin; row < row_end; ++row)
+    {
+        const double line_x = base[0] + k[3] * row + k[6];
+        const double line_y = base[1] + k[4] * row + k[7];
+        const double line_z = base[2] + k[5] * row + k[8];
+        const float depth = std::fabs(
+            offset / (normal[0] * line_x + normal[1] * line_y +
+                      normal[2] * line_z));
+
+        const int pixel = row * n_cols + col;
+        const bool closer = depth < depth_image[pixel];
+        depth_image[pixel] = closer ? depth : depth_image[pixel];
+        if (part_image)
+        {
+            part_image[pixel] = closer ? part : part_image[pixel];
+        }
+    }
+}
+
+// the pixel model in the precision of the scores, constants and
+// intermediates are of that precision as well such that the single
+// precision variant vectorizes twice as wide
+template <typename Real>
+void pixel_loglikes_of(const PixelModelParameters& model,
+                       const float* observations,
+                       const float* predictions,
+                       const float* occlusions,
+                       const float* infinities,
+                       int count,
+                       Real* scores,
+                       float* posterior_occlusions)
+{
+    const Real lambda = model.lambda;
+    const Real tail = model.tail_weight / model.max_depth;
+    const Real body = 1 - model.tail_weight;
+    const Real sqrt_2 = std::sqrt(2.0);
+    const Real sqrt_2_pi = std::sqrt(2 * M_PI);
+
+    for (int i = 0; i < count; ++i)
+    {
+        const Real observation = observations[i];
+        if (std::isnan(observation))
+        {
+            scores[i] = 0;
+            posterior_occlusions[i] = occlusions[i];
+            continue;
+        }
+
+        const Real prediction = predictions[i];
+        const float occlusion = occlusions[i];
+        const Real sigma = model.model_sigma +
+                           model.sigma_factor * observation * observation;
+        const Real error = prediction - observation;
+
+        // visible object at the predicted depth
+        const Real p_visible =
+            tail +
+            body * std::exp(-(error * error / (2 * sigma * sigma))) /
+                (sqrt_2_pi * sigma);
+
+        // occluded object, the occluder lies in front of the prediction
+        const Real p_occluded =
+            tail +
+            body * lambda *
+                std::exp(Real(0.5) * lambda * (2 * prediction -
+                                               2 * observation +
+                                               lambda * sigma * sigma)) *
+                (1 + std::erf((error + lambda * sigma * sigma) /
+                              (sqrt_2 * sigma))) /
+                (2 * (std::exp(prediction * lambda) - 1));
+
+        const float p_obsIpred_vis = p_visible * (Real(1) - occlusion);
+        const float p_obsIpred_occl = p_occluded * occlusion;
+        const float p_obsIinf = infinities[i];
+
+        const float ratio = (p_obsIpred_vis + p_obsIpred_occl) / p_obsIinf;
+        scores[i] = std::log(Real(ratio));
+        posterior_occlusions[i] =
+            p_obsIpred_occl / (p_obsIpred_vis + p_obsIpred_occl);
+    }
+}
+
+void pixel_loglikes(const PixelModelParameters& model,
+                    const float* observations,
+                    const float* predictions,
+                    const float* occlusions,
+                    const float* infinities,
+                    int count,
+                    double* scores,
+                    float* posterior_occlusions)
+{
+    pixel_loglikes_of(model,
+                      observations,
+                      predictions,
+                      occlusions,
+                      infinities,
+                      count,
+                      scores,
+                      posterior_occlusions);
+}
+
+void pixel_loglikes_single(const PixelModelParameters& model,
+                           const float* observations,
+                           const float* predictions,
+                           const float* occlusions,
+                           const float* infinities,
+                           int count,
+                           float* scores,
+                           float* posterior_occlusions)
+{
+    pixel_loglikes_of(model,
+                      observations,
+                      predictions,
+                      occlusions,
+                      infinities,
+                      count,
+                      scores,
+                      posterior_occlusions);
+}
+
+void infinity_probs(const PixelModelParameters& model,
+                    const float* observations,
+                    int count,
+                    float* probabilities)
+{
+    const double lambda = model.lambda;
+    const double tail = model.tail_weight / model.max_depth;
+    const double body = 1 - model.tail_weight;
+
+    for (int i = 0; i < count; ++i)
+    {
+        const double observation = observations[i];
+        const double sigma = model.model_sigma +
+                             model.sigma_factor * observation * observation;
+
+        // occluded object at infinity
+        probabilities[i] =
+            tail +
+            body * lambda *
+                std::exp(0.5 * lambda *
+                         (-2 * observation + lambda * sigma * sigma));
+    }
+}
+
+void predict_occlusions(double scale,
+                        double offset,
+                        const float* occlusions,
+                        float* new_occlusions,
+                        int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        const double occlusion = offset + scale * occlusions[i];
+        new_occlusions[i] =
+            occlusion < 0. ? 0. : (occlusion > 1. ? 1. : occlusion);
+    }
+}
+
+int backproject_depth(const float* ray_x,
+                      const float* ray_y,
+                      const float* ray_z,
+                      const float* depth,
+                      int count,
+                      int stride,
+                      float* x,
+                      float* y,
+                      float* z,
+                      unsigned char* valid)
+{
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+
+    // the selects store unconditionally, which lets the loop vectorize
+    int valid_count = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        const int pixel = i * stride;
+        const float d = depth[pixel];
+        const bool is_valid = d > 0 && d < std::numeric_limits<float>::max();
+
+        x[i] = is_valid ? d * ray_x[pixel] : nan;
+        y[i] = is_valid ? d * ray_y[pixel] : nan;
+        z[i] = is_valid ? d * ray_z[pixel] : nan;
+        valid[i] = is_valid;
+        valid_count += is_valid;
+    }
+    return valid_count;
+}
+
+void narrow_depth(const double* depth, float* narrow, int count)
+{
+    for (int i = 0; i < count; ++i) narrow[i] = depth[i];
+}
+
+void widen_depth(const float* depth, double* wide, int count)
+{
+    for (int i = 0; i < count; ++i) wide[i] = depth[i];
+}
+}
+
+CpuKernels kernels()
+{
+    CpuKernels k;
+    k.variant = DBOT_CPU_KERNELS_VARIANT;
+    k.transform_points = &transform_points;
+    k.rasterize_column = &rasterize_column;
+    k.pixel_loglikes = &pixel_loglikes;
+    k.pixel_loglikes_single = &pixel_loglikes_single;
+    k.infinity_probs = &infinity_probs;
+    k.predict_occlusions = &predict_occlusions;
+    k.backproject_depth = &backproject_depth;
+    k.narrow_depth = &narrow_depth;
+    k.widen_depth = &widen_depth;
+    return k;
+}
+}
+}
@@ -0,0 +1,23 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file cpu_kernels_sse42.cpp
+ * \date October 2016
+ *
+ * Kernels compiled for SSE4.2
+ */
+
+#define DBOT_CPU_KERNELS_NAMESPACE cpu_kernels_sse42
+#define DBOT_CPU_KERNELS_VARIANT CpuVariant::Sse42
+#include <dbot/cpu_kernels.hpp>
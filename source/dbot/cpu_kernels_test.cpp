@@ -0,0 +1,387 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file cpu_kernels_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <dbot/cpu_kernels.h>
+
+using namespace dbot;
+
+namespace
+{
+const CpuVariant variants[] = {CpuVariant::Baseline,
+                               CpuVariant::Sse42,
+                               CpuVariant::Avx2,
+                               CpuVariant::Avx512};
+
+// the variants may contract multiply adds, hence results match up to
+// rounding only
+void expect_near(double expected, double actual)
+{
+    EXPECT_NEAR(expected, actual, 1e-5 * std::max(1.0, std::fabs(expected)));
+}
+}
+
+TEST(CpuKernelsTests, names_round_trip)
+{
+    for (CpuVariant variant : variants)
+    {
+        EXPECT_EQ(variant, parse_cpu_variant(cpu_variant_name(variant)));
+    }
+    EXPECT_THROW(parse_cpu_variant("avx3"), CpuVariantException);
+}
+
+TEST(CpuKernelsTests, detected_variant_is_supported)
+{
+    EXPECT_TRUE(cpu_variant_supported(CpuVariant::Baseline));
+    EXPECT_TRUE(cpu_variant_supported(detect_cpu_variant()));
+    EXPECT_EQ(detect_cpu_variant(),
+              cpu_kernels(detect_cpu_variant()).variant);
+}
+
+TEST(CpuKernelsTests, active_variant_is_reported)
+{
+    const std::string report = cpu_kernels_report();
+    EXPECT_EQ(0u, report.find(cpu_variant_name(cpu_kernels().variant)));
+}
+
+TEST(CpuKernelsTests, unknown_override_falls_back_to_detected)
+{
+    // the active variant is selected once per process, hence the override is
+    // checked in a freshly started child
+    ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+    EXPECT_EXIT(
+        {
+            setenv("DBOT_CPU_VARIANT", "avx3", 1);
+            std::cerr << cpu_kernels_report();
+            std::exit(cpu_kernels().variant == detect_cpu_variant() ? 0 : 1);
+        },
+        ::testing::ExitedWithCode(0),
+        "detected, DBOT_CPU_VARIANT=avx3 is unknown");
+}
+
+TEST(CpuKernelsTests, unsupported_variant_throws)
+{
+    for (CpuVariant variant : variants)
+    {
+        if (!cpu_variant_supported(variant))
+        {
+            EXPECT_THROW(cpu_kernels(variant), CpuVariantException);
+        }
+    }
+}
+
+TEST(CpuKernelsTests, transform_points)
+{
+    // rotation about z by 90 degrees, column major
+    const double rotation[9] = {0, 1, 0, -1, 0, 0, 0, 0, 1};
+    const double translation[3] = {0.1, 0.0, 1.0};
+    const double camera_matrix[9] = {100, 0, 0, 0, 100, 0, 50, 40, 1};
+    const double points[6] = {0.1, 0.0, 0.0, 0.0, 0.2, 0.5};
+
+    for (CpuVariant variant : variants)
+    {
+        if (!cpu_variant_supported(variant)) continue;
+
+        double transformed[6];
+        double projected[4];
+        cpu_kernels(variant).transform_points(rotation,
+                                              translation,
+                                              camera_matrix,
+                                              points,
+                                              2,
+                                              transformed,
+                                              projected);
+
+        expect_near(0.1, transformed[0]);
+        expect_near(0.1, transformed[1]);
+        expect_near(1.0, transformed[2]);
+        expect_near(-0.1, transformed[3]);
+        expect_near(0.0, transformed[4]);
+        expect_near(1.5, transformed[5]);
+
+        expect_near(60, projected[0]);
+        expect_near(50, projected[1]);
+        expect_near(50 - 10 / 1.5, projected[2]);
+        expect_near(40, projected[3]);
+    }
+}
+
+TEST(CpuKernelsTests, rasterize_column_keeps_closest_depth)
+{
+    const int rows = 8;
+    const int cols = 4;
+
+    // identity camera, plane z = 2 facing the camera
+    const double inverse_camera_matrix[9] = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+    const double normal[3] = {0, 0, -1};
+
+    for (CpuVariant variant : variants)
+    {
+        if (!cpu_variant_supported(variant)) continue;
+
+        std::vector<float> depth(rows * cols, 1.5f);
+        std::vector<int> parts(rows * cols, 7);
+        for (int row = 4; row < rows; ++row) depth[row * cols + 2] = 3.0f;
+
+        cpu_kernels(variant).rasterize_column(inverse_camera_matrix,
+                                              normal,
+                                              -2.0f,
+                                              2,
+                                              1,
+                                              7,
+                                              cols,
+                                              3,
+                                              depth.data(),
+                                              parts.data());
+
+        for (int row = 0; row < rows; ++row)
+        {
+            bool drawn = row >= 4 && row < 7;
+            EXPECT_EQ(drawn ? 2.0f : (row >= 4 ? 3.0f : 1.5f),
+                      depth[row * cols + 2]);
+            EXPECT_EQ(drawn ? 3 : 7, parts[row * cols + 2]);
+            EXPECT_EQ(1.5f, depth[row * cols + 1]);
+        }
+    }
+}
+
+TEST(CpuKernelsTests, variants_agree_on_pixel_loglikes)
+{
+    const int count = 1000;
+    const PixelModelParameters model = {
+        -std::log(0.5), 0.01, 0.003, 0.00142478, 6.0};
+
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<float> depth(0.5f, 2.0f);
+    std::uniform_real_distribution<float> offset(-0.05f, 0.05f);
+    std::uniform_real_distribution<float> probability(0.0f, 1.0f);
+
+    std::vector<float> observations(count);
+    std::vector<float> predictions(count);
+    std::vector<float> occlusions(count);
+    for (int i = 0; i < count; ++i)
+    {
+        predictions[i] = depth(generator);
+        observations[i] = predictions[i] + offset(generator);
+        occlusions[i] = probability(generator);
+    }
+    observations[3] = std::numeric_limits<float>::quiet_NaN();
+
+    std::vector<float> infinities(count);
+    cpu_kernels(CpuVariant::Baseline)
+        .infinity_probs(model, observations.data(), count, infinities.data());
+
+    std::vector<double> expected_scores(count);
+    std::vector<float> expected_occlusions(count);
+    cpu_kernels(CpuVariant::Baseline)
+        .pixel_loglikes(model,
+                        observations.data(),
+                        predictions.data(),
+                        occlusions.data(),
+                        infinities.data(),
+                        count,
+                        expected_scores.data(),
+                        expected_occlusions.data());
+
+    EXPECT_EQ(0, expected_scores[3]);
+    EXPECT_EQ(occlusions[3], expected_occlusions[3]);
+
+    for (CpuVariant variant : variants)
+    {
+        if (!cpu_variant_supported(variant)) continue;
+
+        std::vector<float> variant_infinities(count);
+        cpu_kernels(variant).infinity_probs(
+            model, observations.data(), count, variant_infinities.data());
+
+        std::vector<double> scores(count);
+        std::vector<float> posterior_occlusions(count);
+        cpu_kernels(variant).pixel_loglikes(model,
+                                            observations.data(),
+                                            predictions.data(),
+                                            occlusions.data(),
+                                            variant_infinities.data(),
+                                            count,
+                                            scores.data(),
+                                            posterior_occlusions.data());
+
+        for (int i = 0; i < count; ++i)
+        {
+            if (i != 3) expect_near(infinities[i], variant_infinities[i]);
+            expect_near(expected_scores[i], scores[i]);
+            expect_near(expected_occlusions[i], posterior_occlusions[i]);
+        }
+    }
+}
+
+TEST(CpuKernelsTests, single_precision_pixel_loglikes)
+{
+    const int count = 1000;
+    const PixelModelParameters model = {
+        -std::log(0.5), 0.01, 0.003, 0.00142478, 6.0};
+
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<float> depth(0.5f, 2.0f);
+    std::uniform_real_distribution<float> offset(-0.01f, 0.01f);
+    std::uniform_real_distribution<float> probability(0.0f, 1.0f);
+
+    std::vector<float> observations(count);
+    std::vector<float> predictions(count);
+    std::vector<float> occlusions(count);
+    for (int i = 0; i < count; ++i)
+    {
+        predictions[i] = depth(generator);
+        observations[i] = predictions[i] + offset(generator);
+        occlusions[i] = probability(generator);
+    }
+    observations[3] = std::numeric_limits<float>::quiet_NaN();
+
+    std::vector<float> infinities(count);
+    cpu_kernels(CpuVariant::Baseline)
+        .infinity_probs(model, observations.data(), count, infinities.data());
+
+    std::vector<double> expected_scores(count);
+    std::vector<float> expected_occlusions(count);
+    cpu_kernels(CpuVariant::Baseline)
+        .pixel_loglikes(model,
+                        observations.data(),
+                        predictions.data(),
+                        occlusions.data(),
+                        infinities.data(),
+                        count,
+                        expected_scores.data(),
+                        expected_occlusions.data());
+
+    for (CpuVariant variant : variants)
+    {
+        if (!cpu_variant_supported(variant)) continue;
+
+        std::vector<float> scores(count);
+        std::vector<float> posterior_occlusions(count);
+        cpu_kernels(variant).pixel_loglikes_single(model,
+                                                   observations.data(),
+                                                   predictions.data(),
+                                                   occlusions.data(),
+                                                   infinities.data(),
+                                                   count,
+                                                   scores.data(),
+                                                   posterior_occlusions.data());
+
+        EXPECT_EQ(0, scores[3]);
+        EXPECT_EQ(occlusions[3], posterior_occlusions[3]);
+        for (int i = 0; i < count; ++i)
+        {
+            EXPECT_NEAR(expected_scores[i],
+                        scores[i],
+                        1e-4 * std::max(1.0, std::fabs(expected_scores[i])));
+            EXPECT_NEAR(expected_occlusions[i], posterior_occlusions[i], 1e-5);
+        }
+    }
+}
+
+TEST(CpuKernelsTests, predict_occlusions_clamps)
+{
+    const float occlusions[4] = {0.0f, 0.25f, 0.5f, 1.0f};
+
+    for (CpuVariant variant : variants)
+    {
+        if (!cpu_variant_supported(variant)) continue;
+
+        float predicted[4];
+        cpu_kernels(variant).predict_occlusions(
+            2.0, -0.25, occlusions, predicted, 4);
+
+        EXPECT_EQ(0.0f, predicted[0]);
+        EXPECT_FLOAT_EQ(0.25f, predicted[1]);
+        EXPECT_FLOAT_EQ(0.75f, predicted[2]);
+        EXPECT_EQ(1.0f, predicted[3]);
+    }
+}
+
+TEST(CpuKernelsTests, backproject_depth)
+{
+    const float ray_x[4] = {-0.5f, 0.0f, 0.5f, 1.0f};
+    const float ray_y[4] = {0.25f, 0.25f, 0.25f, 0.25f};
+    const float ray_z[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    const float depth[4] = {2.0f,
+                            std::numeric_limits<float>::quiet_NaN(),
+                            4.0f,
+                            std::numeric_limits<float>::infinity()};
+
+    for (CpuVariant variant : variants)
+    {
+        if (!cpu_variant_supported(variant)) continue;
+
+        // every second pixel
+        float x[2], y[2], z[2];
+        unsigned char valid[2];
+        EXPECT_EQ(2,
+                  cpu_kernels(variant).backproject_depth(
+                      ray_x, ray_y, ray_z, depth, 2, 2, x, y, z, valid));
+        EXPECT_EQ(-1.0f, x[0]);
+        EXPECT_EQ(0.5f, y[0]);
+        EXPECT_EQ(2.0f, z[0]);
+        EXPECT_EQ(2.0f, x[1]);
+        EXPECT_EQ(1, valid[1]);
+
+        // the invalid depths
+        EXPECT_EQ(0,
+                  cpu_kernels(variant).backproject_depth(ray_x + 1,
+                                                         ray_y + 1,
+                                                         ray_z + 1,
+                                                         depth + 1,
+                                                         2,
+                                                         2,
+                                                         x,
+                                                         y,
+                                                         z,
+                                                         valid));
+        for (int i = 0; i < 2; ++i)
+        {
+            EXPECT_TRUE(std::isnan(x[i]) && std::isnan(y[i]) &&
+                        std::isnan(z[i]));
+            EXPECT_EQ(0, valid[i]);
+        }
+    }
+}
+
+TEST(CpuKernelsTests, convert_depth)
+{
+    const double depth[3] = {0.5, std::numeric_limits<double>::infinity(),
+                             1.25};
+
+    for (CpuVariant variant : variants)
+    {
+        if (!cpu_variant_supported(variant)) continue;
+
+        float narrow[3];
+        double wide[3];
+        cpu_kernels(variant).narrow_depth(depth, narrow, 3);
+        cpu_kernels(variant).widen_depth(narrow, wide, 3);
+
+        for (int i = 0; i < 3; ++i) EXPECT_EQ(depth[i], wide[i]);
+    }
+}
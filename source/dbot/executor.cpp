@@ -0,0 +1,173 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file executor.cpp
+ * \date October 2016
+ */
+
+#include <dbot/executor.h>
+
+#include <algorithm>
+
+namespace dbot
+{
+Executor::Executor(int worker_count, bool numa_aware)
+    : node_count_(1),
+      task_(nullptr),
+      generation_(0),
+      pending_(0),
+      stop_(false)
+{
+    if (numa_aware)
+    {
+        init(worker_count, NumaTopology::detect(), true);
+    }
+    else
+    {
+        init(worker_count, NumaTopology(std::vector<int>()), false);
+    }
+}
+
+Executor::Executor(int worker_count, const NumaTopology& topology)
+    : node_count_(1),
+      task_(nullptr),
+      generation_(0),
+      pending_(0),
+      stop_(false)
+{
+    init(worker_count, topology, true);
+}
+
+void Executor::init(int worker_count, const NumaTopology& topology, bool bind)
+{
+    if (worker_count <= 0)
+    {
+        worker_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // contiguous groups of workers per node, such that contiguous particle
+    // ranges end up on the same node
+    node_count_ = std::min(topology.count_nodes(), worker_count);
+    worker_nodes_.resize(worker_count);
+    for (int worker = 0; worker < worker_count; ++worker)
+    {
+        worker_nodes_[worker] = worker * node_count_ / worker_count;
+    }
+
+    if (worker_count == 1 && !bind) return;
+
+    for (int worker = 0; worker < worker_count; ++worker)
+    {
+        threads_.emplace_back(
+            [this, worker, topology, bind]() { work(worker, topology, bind); });
+    }
+}
+
+Executor::~Executor()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    task_ready_.notify_all();
+
+    for (auto& thread : threads_) thread.join();
+}
+
+void Executor::run(const Task& task)
+{
+    if (threads_.empty())
+    {
+        task(0);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    task_ = &task;
+    pending_ = threads_.size();
+    error_ = nullptr;
+    ++generation_;
+    task_ready_.notify_all();
+
+    task_done_.wait(lock, [this]() { return pending_ == 0; });
+    task_ = nullptr;
+
+    if (error_) std::rethrow_exception(error_);
+}
+
+void Executor::work(int worker, const NumaTopology& topology, bool bind)
+{
+    if (bind) topology.bind_current_thread(worker_nodes_[worker]);
+
+    unsigned long generation = 0;
+    while (true)
+    {
+        const Task* task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            task_ready_.wait(lock, [this, generation]() {
+                return stop_ || generation_ != generation;
+            });
+            if (stop_) return;
+
+            generation = generation_;
+            task = task_;
+        }
+
+        std::exception_ptr error;
+        try
+        {
+            (*task)(worker);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (error && !error_) error_ = error;
+            if (--pending_ == 0) task_done_.notify_all();
+        }
+    }
+}
+
+int Executor::count_workers() const
+{
+    return worker_nodes_.size();
+}
+
+int Executor::count_nodes() const
+{
+    return node_count_;
+}
+
+int Executor::node(int worker) const
+{
+    return worker_nodes_[worker];
+}
+
+int Executor::first_worker(int node) const
+{
+    return std::lower_bound(worker_nodes_.begin(), worker_nodes_.end(), node) -
+           worker_nodes_.begin();
+}
+
+void Executor::partition(int count, int worker, int& begin, int& end) const
+{
+    int workers = count_workers();
+    begin = int((long(count) * worker) / workers);
+    end = int((long(count) * (worker + 1)) / workers);
+}
+}
@@ -0,0 +1,115 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file executor.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <dbot/numa_topology.h>
+
+namespace dbot
+{
+/**
+ * \brief Fixed pool of worker threads.
+ *
+ * A task is run once on every worker and receives the worker index, hence the
+ * caller decides which worker processes which part of the data. This keeps
+ * the assignment of data to workers, and with it the placement of memory
+ * first touched by a worker, identical from call to call.
+ *
+ * In NUMA aware mode the workers are distributed in contiguous groups over
+ * the nodes of the host and each worker is bound to the CPUs of its node.
+ */
+class Executor
+{
+public:
+    typedef std::function<void(int worker)> Task;
+
+public:
+    /**
+     * \brief Creates an executor
+     *
+     * \param worker_count
+     *          Number of workers. If zero, one worker per hardware thread is
+     *          created. A single worker runs tasks on the calling thread.
+     * \param numa_aware
+     *          Whether to distribute and bind workers to NUMA nodes
+     */
+    Executor(int worker_count, bool numa_aware = false);
+
+    Executor(int worker_count, const NumaTopology& topology);
+
+    virtual ~Executor();
+
+    /**
+     * \brief Runs the task once on every worker and returns when all workers
+     *        are done. The first exception thrown by a worker is rethrown.
+     */
+    void run(const Task& task);
+
+    /**
+     * \brief Returns the number of workers
+     */
+    int count_workers() const;
+
+    /**
+     * \brief Returns the number of NUMA nodes the workers are spread over
+     */
+    int count_nodes() const;
+
+    /**
+     * \brief Returns the NUMA node of the given worker
+     */
+    int node(int worker) const;
+
+    /**
+     * \brief Returns the index of the first worker of the given node
+     */
+    int first_worker(int node) const;
+
+    /**
+     * \brief Returns the half-open range [begin, end) of items assigned to
+     *        the given worker if count items are split evenly
+     */
+    void partition(int count, int worker, int& begin, int& end) const;
+
+private:
+    void init(int worker_count, const NumaTopology& topology, bool bind);
+    void work(int worker, const NumaTopology& topology, bool bind);
+
+private:
+    std::vector<int> worker_nodes_;
+    int node_count_;
+
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable task_ready_;
+    std::condition_variable task_done_;
+    const Task* task_;
+    unsigned long generation_;
+    int pending_;
+    bool stop_;
+    std::exception_ptr error_;
+};
+}
@@ -0,0 +1,101 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file executor_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <dbot/executor.h>
+#include <dbot/numa_topology.h>
+
+TEST(ExecutorTests, runs_task_once_per_worker)
+{
+    dbot::Executor executor(4);
+    std::vector<std::atomic<int>> calls(4);
+    for (auto& c : calls) c = 0;
+
+    for (int i = 0; i < 10; ++i)
+    {
+        executor.run([&](int worker) { calls[worker]++; });
+    }
+
+    for (auto& c : calls) EXPECT_EQ(c, 10);
+}
+
+TEST(ExecutorTests, single_worker_runs_inline)
+{
+    dbot::Executor executor(1);
+    std::thread::id id;
+
+    executor.run([&](int) { id = std::this_thread::get_id(); });
+
+    EXPECT_EQ(id, std::this_thread::get_id());
+}
+
+TEST(ExecutorTests, rethrows_worker_exception)
+{
+    dbot::Executor executor(3);
+
+    EXPECT_THROW(executor.run([](int worker) {
+        if (worker == 1) throw std::runtime_error("failure");
+    }),
+                 std::runtime_error);
+
+    // the executor remains usable
+    std::atomic<int> calls(0);
+    executor.run([&](int) { calls++; });
+    EXPECT_EQ(calls, 3);
+}
+
+TEST(ExecutorTests, partition_covers_all_items)
+{
+    dbot::Executor executor(3);
+
+    int expected_begin = 0;
+    for (int worker = 0; worker < 3; ++worker)
+    {
+        int begin, end;
+        executor.partition(10, worker, begin, end);
+        EXPECT_EQ(begin, expected_begin);
+        expected_begin = end;
+    }
+    EXPECT_EQ(expected_begin, 10);
+}
+
+TEST(ExecutorTests, workers_are_grouped_by_node)
+{
+    dbot::NumaTopology topology(std::vector<std::vector<int>>{{0}, {0}});
+    dbot::Executor executor(4, topology);
+
+    EXPECT_EQ(executor.count_nodes(), 2);
+    EXPECT_EQ(executor.node(0), 0);
+    EXPECT_EQ(executor.node(1), 0);
+    EXPECT_EQ(executor.node(2), 1);
+    EXPECT_EQ(executor.node(3), 1);
+    EXPECT_EQ(executor.first_worker(1), 2);
+}
+
+TEST(NumaTopologyTests, parse_cpu_list)
+{
+    auto cpus = dbot::NumaTopology::parse_cpu_list("0-2,5,8-9\n");
+
+    EXPECT_EQ(cpus, std::vector<int>({0, 1, 2, 5, 8, 9}));
+}
@@ -0,0 +1,157 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file halton_sequence.cpp
+ * \date October 2016
+ */
+
+#include <dbot/filter/halton_sequence.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace dbot
+{
+double inverse_normal_cdf(double p)
+{
+    // rational approximation of P. J. Acklam, relative error below 1.2e-9,
+    // refined by one step of Halley's method
+    static const double a[] = {-3.969683028665376e+01,
+                               2.209460984245205e+02,
+                               -2.759285104469687e+02,
+                               1.383577518672690e+02,
+                               -3.066479806614716e+01,
+                               2.506628277459239e+00};
+    static const double b[] = {-5.447609879822406e+01,
+                               1.615858368580409e+02,
+                               -1.556989798598866e+02,
+                               6.680131188771972e+01,
+                               -1.328068155288572e+01};
+    static const double c[] = {-7.784894002430293e-03,
+                               -3.223964580411365e-01,
+                               -2.400758277161838e+00,
+                               -2.549732539343734e+00,
+                               4.374664141464968e+00,
+                               2.938163982698783e+00};
+    static const double d[] = {7.784695709041462e-03,
+                               3.224671290700398e-01,
+                               2.445134137142996e+00,
+                               3.754408661907416e+00};
+    const double low = 0.02425;
+
+    double x;
+    if (p < low)
+    {
+        double q = std::sqrt(-2 * std::log(p));
+        x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q +
+             c[5]) /
+            ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+    }
+    else if (p <= 1 - low)
+    {
+        double q = p - 0.5;
+        double r = q * q;
+        x = (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r +
+             a[5]) *
+            q /
+            (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+    }
+    else
+    {
+        double q = std::sqrt(-2 * std::log(1 - p));
+        x = -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q +
+              c[5]) /
+            ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+    }
+
+    double e = 0.5 * std::erfc(-x / std::sqrt(2.)) - p;
+    double u = e * std::sqrt(2 * M_PI) * std::exp(x * x / 2);
+    return x - u / (1 + x * u / 2);
+}
+
+ScrambledHaltonSequence::ScrambledHaltonSequence(int dimension, unsigned seed)
+    : generator_(seed)
+{
+    // the first primes as bases
+    for (int candidate = 2; int(bases_.size()) < dimension; ++candidate)
+    {
+        bool prime = true;
+        for (int base : bases_)
+        {
+            if (base * base > candidate) break;
+            if (candidate % base == 0)
+            {
+                prime = false;
+                break;
+            }
+        }
+        if (prime) bases_.push_back(candidate);
+    }
+
+    std::size_t size = 0;
+    for (int base : bases_)
+    {
+        digits_.push_back(std::ceil(53 * std::log(2.) / std::log(base)));
+        offsets_.push_back(size);
+        size += digits_.back() * base;
+    }
+    permutations_.resize(size);
+
+    randomize();
+}
+
+void ScrambledHaltonSequence::randomize()
+{
+    for (int coordinate = 0; coordinate < dimension(); ++coordinate)
+    {
+        const int base = bases_[coordinate];
+        for (int digit = 0; digit < digits_[coordinate]; ++digit)
+        {
+            auto begin =
+                permutations_.begin() + offsets_[coordinate] + digit * base;
+            std::iota(begin, begin + base, 0);
+            std::shuffle(begin, begin + base, generator_);
+        }
+    }
+}
+
+double ScrambledHaltonSequence::uniform(unsigned index, int coordinate) const
+{
+    const int base = bases_[coordinate];
+    const std::uint16_t* permutation = &permutations_[offsets_[coordinate]];
+
+    double value = 0;
+    double factor = 1. / base;
+    for (int digit = 0; digit < digits_[coordinate]; ++digit)
+    {
+        value += permutation[index % base] * factor;
+        index /= base;
+        factor /= base;
+        permutation += base;
+    }
+
+    return value;
+}
+
+double ScrambledHaltonSequence::normal(unsigned index, int coordinate) const
+{
+    // the permuted trailing digits keep the value away from 0 and 1 almost
+    // surely, the bounds only guard the quantile against the limits
+    const double bound = 1e-12;
+    double p = std::min(std::max(uniform(index, coordinate), bound), 1 - bound);
+
+    return inverse_normal_cdf(p);
+}
+}
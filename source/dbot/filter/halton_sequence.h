@@ -0,0 +1,88 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file halton_sequence.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace dbot
+{
+/**
+ * \brief Returns the quantile of the standard normal distribution at the
+ *        given probability in (0, 1)
+ */
+double inverse_normal_cdf(double p);
+
+/**
+ * \brief Randomized Halton sequence with random digit permutations.
+ *
+ * Coordinate d of point i is the radical inverse of i in the base of the d-th
+ * prime, where every digit position of every coordinate maps its digits
+ * through its own random permutation. Each randomization yields a point set
+ * which is uniformly distributed as a whole while keeping the low
+ * discrepancy of the Halton sequence, and breaks up the correlation between
+ * coordinates with large bases.
+ */
+class ScrambledHaltonSequence
+{
+public:
+    explicit ScrambledHaltonSequence(int dimension, unsigned seed = 1);
+
+    /**
+     * \brief Draws new digit permutations
+     */
+    void randomize();
+
+    /**
+     * \brief Generator of the permutations. Restoring it reproduces the
+     *        following randomizations.
+     */
+    const std::mt19937& generator() const { return generator_; }
+    void set_generator(const std::mt19937& generator)
+    {
+        generator_ = generator;
+    }
+
+    int dimension() const { return bases_.size(); }
+
+    /**
+     * \brief Returns the given coordinate of the point with the given index,
+     *        uniform in [0, 1)
+     */
+    double uniform(unsigned index, int coordinate) const;
+
+    /**
+     * \brief Returns the given coordinate of the point with the given index
+     *        mapped to a standard normal variate
+     */
+    double normal(unsigned index, int coordinate) const;
+
+private:
+    std::vector<int> bases_;
+    // number of digits resolved per coordinate, enough for double precision
+    std::vector<int> digits_;
+    // offset of each coordinate's permutations in permutations_
+    std::vector<std::size_t> offsets_;
+    // per coordinate and digit position a permutation of the base's digits
+    std::vector<std::uint16_t> permutations_;
+
+    std::mt19937 generator_;
+};
+}
@@ -0,0 +1,141 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file halton_sequence_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <dbot/filter/halton_sequence.h>
+
+namespace
+{
+/**
+ * \brief Largest deviation of the empirical distribution of the 1-D points
+ *        from the uniform distribution
+ */
+double star_discrepancy(std::vector<double> points)
+{
+    std::sort(points.begin(), points.end());
+
+    const double n = points.size();
+    double discrepancy = 0;
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        discrepancy = std::max(discrepancy, std::abs(points[i] - i / n));
+        discrepancy = std::max(discrepancy, std::abs(points[i] - (i + 1) / n));
+    }
+    return discrepancy;
+}
+}
+
+TEST(HaltonSequenceTests, inverse_normal_cdf)
+{
+    for (double x = -6; x <= 6; x += 0.25)
+    {
+        double p = 0.5 * std::erfc(-x / std::sqrt(2.));
+        EXPECT_NEAR(dbot::inverse_normal_cdf(p), x, 1e-8 * (1 + std::abs(x)));
+    }
+}
+
+TEST(HaltonSequenceTests, coordinates_are_stratified)
+{
+    // every coordinate of the first base^k points falls into distinct
+    // intervals of width base^-k, whatever the permutations
+    const int bases[] = {2, 3, 5, 7, 11, 13};
+    dbot::ScrambledHaltonSequence sequence(6, 7);
+
+    for (int coordinate = 0; coordinate < 6; ++coordinate)
+    {
+        const int base = bases[coordinate];
+        const int count = base * base;
+
+        std::vector<int> cells(count, 0);
+        for (int i = 0; i < count; ++i)
+        {
+            double u = sequence.uniform(i, coordinate);
+            ASSERT_GE(u, 0);
+            ASSERT_LT(u, 1);
+            cells[int(u * count)]++;
+        }
+        EXPECT_EQ(std::count(cells.begin(), cells.end(), 1), count);
+    }
+}
+
+TEST(HaltonSequenceTests, lower_discrepancy_than_random_points)
+{
+    const int count = 100;
+    const int dimension = 12;
+
+    dbot::ScrambledHaltonSequence sequence(dimension);
+    std::mt19937 generator(3);
+    std::uniform_real_distribution<double> uniform;
+
+    for (int coordinate = 0; coordinate < dimension; ++coordinate)
+    {
+        std::vector<double> halton, random;
+        for (int i = 0; i < count; ++i)
+        {
+            halton.push_back(sequence.uniform(i, coordinate));
+            random.push_back(uniform(generator));
+        }
+
+        // the random discrepancy is about 0.87 / sqrt(count)
+        EXPECT_LT(star_discrepancy(halton), 0.05);
+        EXPECT_GT(star_discrepancy(random), star_discrepancy(halton));
+    }
+}
+
+TEST(HaltonSequenceTests, normal_moments)
+{
+    const int count = 1000;
+    const int dimension = 12;
+
+    dbot::ScrambledHaltonSequence sequence(dimension);
+
+    for (int coordinate = 0; coordinate < dimension; ++coordinate)
+    {
+        double mean = 0, second = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            double x = sequence.normal(i, coordinate);
+            mean += x / count;
+            second += x * x / count;
+        }
+
+        // well within the standard error of independent samples
+        EXPECT_NEAR(mean, 0, 0.01);
+        EXPECT_NEAR(second, 1, 0.05);
+    }
+}
+
+TEST(HaltonSequenceTests, randomize_changes_points)
+{
+    dbot::ScrambledHaltonSequence sequence(6);
+
+    std::vector<double> before;
+    for (int i = 0; i < 10; ++i) before.push_back(sequence.uniform(i, 5));
+
+    sequence.randomize();
+
+    int changed = 0;
+    for (int i = 0; i < 10; ++i) changed += sequence.uniform(i, 5) != before[i];
+    EXPECT_GT(changed, 0);
+}
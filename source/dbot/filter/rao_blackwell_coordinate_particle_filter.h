@@ -28,6 +28,12 @@
 #include <limits>
 #include <string>
 #include <memory>
+#include <random>
+#include <chrono>
+#include <numeric>
+#include <sstream>
+#include <algorithm>
+#include <exception>
 
 #include <Eigen/Core>
 
@@ -37,10 +43,47 @@
 #include <fl/util/profiling.hpp>
 
 #include <dbot/traits.h>
+#include <dbot/frame_arena.h>
+#include <dbot/filter/halton_sequence.h>
+#include <dbot/observation_context.h>
 #include <dbot/model/rao_blackwell_sensor.h>
 
 namespace dbot
 {
+/**
+ * \brief The FactorizedWeightsException class
+ */
+class FactorizedWeightsException : public std::exception
+{
+public:
+    explicit FactorizedWeightsException(const std::string& message)
+        : message_("Factorized weights: " + message)
+    {
+    }
+
+    const char* what() const noexcept { return message_.c_str(); }
+
+private:
+    std::string message_;
+};
+
+/**
+ * \brief The AnnealingException class
+ */
+class AnnealingException : public std::exception
+{
+public:
+    explicit AnnealingException(const std::string& message)
+        : message_("Annealing: " + message)
+    {
+    }
+
+    const char* what() const noexcept { return message_.c_str(); }
+
+private:
+    std::string message_;
+};
+
 template <typename Transition, typename Sensor>
 class RaoBlackwellCoordinateParticleFilter
 {
@@ -52,11 +95,49 @@ public:
     typedef Eigen::Array<State, -1, 1> StateArray;
     typedef Eigen::Array<fl::Real, -1, 1> RealArray;
     typedef Eigen::Array<int, -1, 1> IntArray;
+    typedef Eigen::Array<fl::Real, -1, -1> RealPartArray;
 
     typedef typename Sensor::Observation Observation;
 
     typedef fl::DiscreteDistribution<State> Belief;
 
+    /**
+     * \brief Wall time of the stages of the last filter() call in
+     *        milliseconds
+     */
+    struct Timings
+    {
+        // sampling the noise and propagating the particles
+        double propagation = 0;
+        // loglikelihoods of the sensor
+        double evaluation = 0;
+        // weight updates and resampling
+        double resampling = 0;
+    };
+
+    /**
+     * \brief Particles, weights and random state of the filter and the
+     *        integrated poses and per particle state of the sensor, see
+     *        snapshot() and restore()
+     */
+    struct Snapshot
+    {
+        std::vector<State> particles;
+        // rows of the sensor state of the particles
+        IntArray indices;
+        RealArray log_weights;
+        RealArray loglikes;
+        RealPartArray part_loglikes;
+        RealPartArray part_log_weights;
+        State integrated_poses;
+        typename Sensor::Snapshot sensor;
+        size_t dynamic_particle_count = 0;
+        bool static_frame = false;
+        // seed of the filter, the generators continue from random_state
+        unsigned seed = 0;
+        std::string random_state;
+    };
+
 public:
     /// constructor and destructor *********************************************
     RaoBlackwellCoordinateParticleFilter(
@@ -64,9 +145,16 @@ public:
         const std::shared_ptr<Sensor> sensor,
         const std::vector<std::vector<int>>& sampling_blocks,
         const fl::Real& max_kl_divergence = 0)
-        : sensor_(sensor),
+        : annealing_diffusion_(0),
+          sensor_(sensor),
           transition_(transition),
-          max_kl_divergence_(max_kl_divergence)
+          max_kl_divergence_(max_kl_divergence),
+          factorized_weights_(false),
+          static_particle_count_(0),
+          dynamic_particle_count_(0),
+          static_frame_(false),
+          seed_(std::mt19937::default_seed),
+          generator_(seed_)
     {
         sampling_blocks_ = sampling_blocks;
 
@@ -88,12 +176,402 @@ public:
     /// the filter functions ***************************************************
     void filter(const Observation& observation, const Input& input)
     {
+        // temporaries of the sensor and renderer are released at frame end
+        FrameArena::Scope frame_scope(FrameArena::local());
+
+        const auto start = Clock::now();
         sensor_->set_observation(observation);
+        update(input, start);
+    }
+
+    /**
+     * \brief Filters an observation shared with the other filters of the
+     *        camera, see ObservationContext
+     */
+    void filter(const std::shared_ptr<const ObservationContext>& context,
+                const Input& input)
+    {
+        FrameArena::Scope frame_scope(FrameArena::local());
+
+        const auto start = Clock::now();
+        sensor_->set_observation_context(context);
+        update(input, start);
+    }
+
+    void resample(const size_t& sample_count)
+    {
+        // the resampled particles are gathered into persistent buffers which
+        // are swapped with the current ones, such that no memory is allocated
+        // once the particle count is stable
+        resampled_indices_.resize(sample_count);
+        resampled_noises_.resize(sample_count);
+        resampled_particles_.resize(sample_count);
+        resampled_locations_.resize(sample_count);
+        resampled_loglikes_.resize(sample_count);
+        if (factorized_weights_)
+        {
+            resampled_part_loglikes_.resize(sample_count, count_parts());
+        }
+
+        // the indices are drawn from the filter's own generator, such that
+        // the random state of the filter is captured by random_state()
+        cumulative_weights_ = belief_.log_prob_mass();
+        cumulative_weights_ =
+            (cumulative_weights_ - cumulative_weights_.maxCoeff()).exp();
+        std::partial_sum(cumulative_weights_.data(),
+                         cumulative_weights_.data() + belief_.size(),
+                         cumulative_weights_.data());
+        std::uniform_real_distribution<fl::Real> uniform(
+            0, cumulative_weights_[belief_.size() - 1]);
+
+        for (size_t i = 0; i < sample_count; i++)
+        {
+            const fl::Real* begin = cumulative_weights_.data();
+            const int index =
+                std::upper_bound(
+                    begin, begin + belief_.size() - 1, uniform(generator_)) -
+                begin;
+            resampled_locations_[i] = belief_.location(index);
+
+            resampled_indices_[i] = indices_[index];
+            resampled_noises_[i] = noises_[index];
+            resampled_particles_[i] = old_particles_[index];
+            resampled_loglikes_[i] = loglikes_[index];
+            if (factorized_weights_)
+            {
+                resampled_part_loglikes_.row(i) = part_loglikes_.row(index);
+            }
+        }
+
+        belief_.set_uniform(sample_count);
+        for (size_t i = 0; i < sample_count; i++)
+        {
+            belief_.location(i) = resampled_locations_[i];
+        }
+
+        indices_.swap(resampled_indices_);
+        noises_.swap(resampled_noises_);
+        old_particles_.swap(resampled_particles_);
+        loglikes_.swap(resampled_loglikes_);
+
+        if (factorized_weights_)
+        {
+            // the parts of a particle are drawn together, which leaves all
+            // part weights uniform
+            part_loglikes_.swap(resampled_part_loglikes_);
+            part_log_weights_.setZero(sample_count, count_parts());
+        }
+    }
+
+    /// accessors **************************************************************
+    std::vector<std::vector<int>> sampling_blocks() const
+    {
+        return sampling_blocks_;
+    }
+
+    /// whether the last observation was processed by the reduced update
+    bool static_frame() const { return static_frame_; }
+
+    /// stage timings of the last filter() call
+    const Timings& timings() const { return timings_; }
+
+    /// particles evaluated by the sensor in the last filter() call
+    size_t evaluations() const { return evaluations_; }
+
+    /**
+     * \brief State of the random number generators as text. Restoring it
+     *        with set_random_state() reproduces the following samples.
+     */
+    std::string random_state() const
+    {
+        std::ostringstream state;
+        state << generator_ << ' ' << unit_gaussian_;
+        if (noise_sequence_) state << ' ' << noise_sequence_->generator();
+        return state.str();
+    }
+
+    /**
+     * \brief Seeds the generator of the filter. Filters of the same seed
+     *        draw the same samples.
+     */
+    void set_seed(unsigned seed)
+    {
+        seed_ = seed;
+        generator_.seed(seed_);
+        unit_gaussian_.reset();
+    }
+
+    unsigned seed() const { return seed_; }
+
+    void set_random_state(const std::string& random_state)
+    {
+        std::istringstream state(random_state);
+        state >> generator_ >> unit_gaussian_;
+        if (noise_sequence_)
+        {
+            std::mt19937 sequence_generator;
+            state >> sequence_generator;
+            noise_sequence_->set_generator(sequence_generator);
+        }
+    }
+
+    /**
+     * \brief Captures the particles, their weights, the random state and
+     *        the integrated poses of the sensor, and its per particle state
+     *        if with_sensor is set. The latter is the bulk of a snapshot.
+     */
+    Snapshot snapshot(bool with_sensor = true)
+    {
+        Snapshot snapshot;
+        snapshot.particles.assign(
+            belief_.locations().data(),
+            belief_.locations().data() + belief_.size());
+        snapshot.indices = indices_;
+        snapshot.log_weights = belief_.log_prob_mass();
+        snapshot.loglikes = loglikes_;
+        snapshot.part_loglikes = part_loglikes_;
+        snapshot.part_log_weights = part_log_weights_;
+        snapshot.integrated_poses = sensor_->integrated_poses();
+        if (with_sensor) snapshot.sensor = sensor_->snapshot();
+        snapshot.dynamic_particle_count = dynamic_particle_count_;
+        snapshot.static_frame = static_frame_;
+        snapshot.seed = seed_;
+        snapshot.random_state = random_state();
+        return snapshot;
+    }
 
+    /**
+     * \brief Continues from a snapshot. The sensor continues from its
+     *        captured state, or from the prior if the snapshot holds none.
+     */
+    void restore(const Snapshot& snapshot)
+    {
+        set_particles(snapshot.particles);
+        if (snapshot.indices.size() == belief_.size())
+        {
+            indices_ = snapshot.indices;
+        }
+        belief_.log_unnormalized_prob_mass(snapshot.log_weights);
+        loglikes_ = snapshot.loglikes;
+        if (snapshot.part_loglikes.size() > 0)
+        {
+            part_loglikes_ = snapshot.part_loglikes;
+            part_log_weights_ = snapshot.part_log_weights;
+        }
+        sensor_->integrated_poses() = snapshot.integrated_poses;
+        sensor_->restore(snapshot.sensor);
+        dynamic_particle_count_ = snapshot.dynamic_particle_count;
+        static_frame_ = snapshot.static_frame;
+        seed_ = snapshot.seed;
+        set_random_state(snapshot.random_state);
+    }
+
+    /// mutators ***************************************************************
+    Belief& belief() { return belief_; }
+    void set_particles(const std::vector<State>& samples)
+    {
+        belief_.set_uniform(samples.size());
+        for (int i = 0; i < belief_.size(); i++)
+            belief_.location(i) = samples[i];
+
+        indices_ = IntArray::Zero(belief_.size());
         loglikes_ = RealArray::Zero(belief_.size());
-        noises_ = std::vector<Noise>(
-            belief_.size(), Noise::Zero(transition_->noise_dimension()));
+        part_loglikes_.setZero(belief_.size(), count_parts());
+        part_log_weights_.setZero(belief_.size(), count_parts());
+        reset_noises(belief_.size());
+        old_particles_ = belief_.locations();
+
+        sensor_->reset();
+    }
+
+    /**
+     * \brief Replaces the particle of the lowest weight by the given state,
+     *        e.g. an estimate refined outside of the filter. The new particle
+     *        takes over the weight and the sensor state of the particle of
+     *        the highest weight. Returns the index of the new particle.
+     */
+    size_t inject_particle(const State& state)
+    {
+        typename Belief::Function log_weights = belief_.log_prob_mass();
+
+        int lowest, highest;
+        log_weights.minCoeff(&lowest);
+        log_weights.maxCoeff(&highest);
+
+        belief_.location(lowest) = state;
+        indices_[lowest] = indices_[highest];
+        loglikes_[lowest] = loglikes_[highest];
+        if (factorized_weights_)
+        {
+            part_loglikes_.row(lowest) = part_loglikes_.row(highest);
+            part_log_weights_.row(lowest) = part_log_weights_.row(highest);
+        }
+
+        log_weights(lowest) = log_weights(highest);
+        belief_.log_unnormalized_prob_mass(log_weights);
+
+        return lowest;
+    }
+
+    std::shared_ptr<Sensor> sensor()
+    {
+        return sensor_;
+    }
+
+    std::shared_ptr<Transition> transition()
+    {
+        return transition_;
+    }
+
+    /**
+     * \brief Draws the block noise from a scrambled Halton sequence over the
+     *        full noise dimension instead of independent Gaussian samples.
+     *
+     * Particle i takes the i-th point of the sequence, which is randomized
+     * anew for every frame. A low discrepancy point set covers the noise
+     * space more evenly than independent samples, such that fewer particles
+     * reach the same accuracy.
+     */
+    void set_low_discrepancy_noise(bool enabled, unsigned seed = 1)
+    {
+        noise_sequence_.reset();
+        if (enabled)
+        {
+            noise_sequence_ = std::make_shared<ScrambledHaltonSequence>(
+                transition_->noise_dimension(), seed);
+        }
+    }
+
+    /**
+     * \brief Enables a reduced update for observations which the sensor
+     *        reports as unchanged. The particles are then resampled down to
+     *        the given count before the update, and back up to the previous
+     *        count with the first changed observation. A count of 0 disables
+     *        the reduced update.
+     */
+    void set_static_update(size_t particle_count)
+    {
+        static_particle_count_ = particle_count;
+    }
+
+    /**
+     * \brief Weights and resamples the object parts independently, for
+     *        parts which are coupled weakly. Sampling block i must hold the
+     *        noise of part i.
+     *
+     * The sensor attributes every pixel to a part, and the weights of a part
+     * accumulate the loglikelihood contributions of that part only. After
+     * the block of a part is sampled and evaluated, the part is resampled on
+     * its own, such that a particle with one good and one bad part keeps the
+     * good part. The weight of a particle is the product of its part weights.
+     * The particle count then grows about linearly instead of exponentially
+     * with the number of parts. Each block evaluates only the pixels of its
+     * part, see RbSensor::part_loglikes(), such that the evaluation also
+     * grows about linearly with the number of parts.
+     *
+     * \throws FactorizedWeightsException if the sensor does not attribute
+     *         the loglikelihoods to the parts
+     */
+    void set_factorized_weights(bool enabled)
+    {
+        if (enabled && !annealing_betas_.empty())
+        {
+            throw FactorizedWeightsException(
+                "the weights of annealing layers cannot be factorized");
+        }
+        if (enabled && !sensor_->has_part_loglikes())
+        {
+            throw FactorizedWeightsException(
+                "the sensor does not attribute the loglikelihoods to the "
+                "object parts");
+        }
+
+        factorized_weights_ = enabled;
+        part_loglikes_.setZero(belief_.size(), count_parts());
+        part_log_weights_.setZero(belief_.size(), count_parts());
+    }
+
+    /**
+     * \brief Weights each sampling block in layers of tempered
+     *        loglikelihoods, as in an annealed particle filter.
+     *
+     * Layer k weights the particles with the loglikelihood scaled by
+     * betas[k], resamples them and diffuses the copies by perturbing the
+     * noise of the block. The final layer weights with the full
+     * loglikelihood. The layers pull the particles towards the peaks of the
+     * likelihood gradually, such that fewer particles reach the accuracy of
+     * a single weighting. The first copy of a resampled particle keeps its
+     * state and loglikelihood, hence only the diffused copies are evaluated
+     * again, except in the update of the last block, which advances the
+     * occlusions of all particles.
+     *
+     * \param betas      Increasing exponents in (0, 1) of the layers before
+     *                   the final one, an empty schedule disables annealing
+     * \param diffusion  Standard deviation of the noise added to the block
+     *                   noise of a copy, in units of the transition noise.
+     *                   It shrinks by 1 - beta of the layer.
+     *
+     * \throws AnnealingException if the schedule is invalid or the weights
+     *         are factorized
+     */
+    void set_annealing(const std::vector<fl::Real>& betas,
+                       fl::Real diffusion)
+    {
+        if (!betas.empty() && factorized_weights_)
+        {
+            throw AnnealingException(
+                "the weights of annealing layers cannot be factorized");
+        }
+        for (size_t i = 0; i < betas.size(); i++)
+        {
+            if (!(betas[i] > (i > 0 ? betas[i - 1] : 0) && betas[i] < 1))
+            {
+                throw AnnealingException(
+                    "the exponents must increase within (0, 1)");
+            }
+        }
+        if (!(diffusion >= 0))
+        {
+            throw AnnealingException("the diffusion must not be negative");
+        }
+
+        annealing_betas_ = betas;
+        annealing_diffusion_ = diffusion;
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    size_t count_parts() const { return sampling_blocks_.size(); }
+
+    /// adds the time since the start of a stage to its timing and returns
+    /// the start of the next stage
+    static Clock::time_point stop_stage(double& timing,
+                                        const Clock::time_point& start)
+    {
+        const auto now = Clock::now();
+        timing +=
+            std::chrono::duration<double, std::milli>(now - start).count();
+        return now;
+    }
+
+    /// samples, weights and resamples the particles against the observation
+    /// of the sensor, the stages are timed from the given start
+    void update(const Input& input, Clock::time_point stage_start)
+    {
+        timings_ = Timings();
+        evaluations_ = 0;
+
+        if (static_particle_count_ > 0) adapt_particle_count();
+
+        loglikes_.setZero(belief_.size());
+        if (factorized_weights_)
+        {
+            part_loglikes_.setZero(belief_.size(), count_parts());
+        }
+        reset_noises(belief_.size());
         old_particles_ = belief_.locations();
+        if (noise_sequence_) noise_sequence_->randomize();
         for (size_t i_block = 0; i_block < sampling_blocks_.size(); i_block++)
         {
             // add noise of this block -----------------------------------------
@@ -101,8 +579,11 @@ public:
             {
                 for (size_t i = 0; i < sampling_blocks_[i_block].size(); i++)
                 {
-                    noises_[i_sampl](sampling_blocks_[i_block][i]) =
-                        unit_gaussian_.sample()(0);
+                    const int dimension = sampling_blocks_[i_block][i];
+                    noises_[i_sampl](dimension) =
+                        noise_sequence_
+                            ? noise_sequence_->normal(i_sampl, dimension)
+                            : unit_gaussian_(generator_);
                 }
             }
 
@@ -113,82 +594,315 @@ public:
                     old_particles_[i_sampl], noises_[i_sampl], input);
             }
 
+            stage_start = stop_stage(timings_.propagation, stage_start);
+
             // compute likelihood ----------------------------------------------
             bool update = (i_block == sampling_blocks_.size() - 1);
-            RealArray new_loglikes = sensor_->loglikes(
-                belief_.locations(), indices_, update);
+            new_loglikes_.resize(belief_.size());
+            moved_.clear();
+            if (factorized_weights_)
+            {
+                // only the part of this block moved, hence only its
+                // contribution is evaluated again
+                new_part_loglikes_ = part_loglikes_;
+                sensor_->part_loglikes(belief_.locations(),
+                                       indices_,
+                                       i_block,
+                                       new_part_loglikes_,
+                                       update);
+                new_loglikes_ = new_part_loglikes_.rowwise().sum();
+                evaluations_ += belief_.size();
+                stage_start = stop_stage(timings_.evaluation, stage_start);
+                update_part_weights(i_block);
+                stage_start = stop_stage(timings_.resampling, stage_start);
+                continue;
+            }
+
+            // tempered layers, each resampled and diffused -------------------
+            fl::Real beta = 0;
+            for (const fl::Real layer_beta : annealing_betas_)
+            {
+                evaluate(false);
+                stage_start = stop_stage(timings_.evaluation, stage_start);
+
+                delta_loglikes_ =
+                    (layer_beta - beta) * (new_loglikes_ - loglikes_);
+                belief_.delta_log_prob_mass(delta_loglikes_);
+                resample_layer();
+                stage_start = stop_stage(timings_.resampling, stage_start);
+
+                diffuse(
+                    i_block, (1 - layer_beta) * annealing_diffusion_, input);
+                stage_start = stop_stage(timings_.propagation, stage_start);
+                beta = layer_beta;
+            }
+
+            evaluate(update);
+            stage_start = stop_stage(timings_.evaluation, stage_start);
 
             // update the weights and resample if necessary --------------------
-            belief_.delta_log_prob_mass(new_loglikes - loglikes_);
-            loglikes_ = new_loglikes;
+            delta_loglikes_ = new_loglikes_ - loglikes_;
+            if (beta > 0) delta_loglikes_ *= 1 - beta;
+            belief_.delta_log_prob_mass(delta_loglikes_);
+            loglikes_.swap(new_loglikes_);
 
             if (belief_.kl_given_uniform() > max_kl_divergence_)
             {
                 resample(belief_.size());
             }
+            stage_start = stop_stage(timings_.resampling, stage_start);
         }
     }
 
-    void resample(const size_t& sample_count)
+    /// shrinks the particle set on static observations and restores it once
+    /// the observation changes
+    void adapt_particle_count()
+    {
+        static_frame_ = !sensor_->observation_changed();
+
+        if (static_frame_ && belief_.size() > static_particle_count_)
+        {
+            dynamic_particle_count_ = belief_.size();
+            resample(static_particle_count_);
+        }
+        else if (!static_frame_ && belief_.size() < dynamic_particle_count_)
+        {
+            resample(dynamic_particle_count_);
+        }
+    }
+
+    /// adds the change of the part contributions to the part weights and
+    /// resamples the part of the given block if its weights degenerated
+    void update_part_weights(size_t i_block)
     {
-        IntArray indices(sample_count);
-        std::vector<Noise> noises(sample_count);
-        StateArray next_samples(sample_count);
-        RealArray loglikes(sample_count);
+        if (size_t(new_part_loglikes_.cols()) != count_parts())
+        {
+            throw FactorizedWeightsException(
+                "the sensor reports " +
+                std::to_string(new_part_loglikes_.cols()) + " parts for " +
+                std::to_string(count_parts()) + " sampling blocks");
+        }
+
+        part_log_weights_ += new_part_loglikes_ - part_loglikes_;
+        part_loglikes_.swap(new_part_loglikes_);
+        loglikes_.swap(new_loglikes_);
 
-        Belief new_belief(sample_count);
+        belief_.log_unnormalized_prob_mass(part_log_weights_.rowwise().sum());
+
+        if (kl_given_uniform(part_log_weights_.col(i_block)) >
+            max_kl_divergence_)
+        {
+            resample_part(i_block);
+        }
+    }
+
+    /// draws the part of the given block of each particle from the part
+    /// weights by systematic resampling, leaving the other parts in place
+    void resample_part(size_t i_block)
+    {
+        const size_t sample_count = belief_.size();
+        const int part_size = old_particles_[0].size() / count_parts();
+        const int offset = i_block * part_size;
+
+        RealArray weights = part_log_weights_.col(i_block);
+        weights = (weights - weights.maxCoeff()).exp();
+        weights /= weights.sum();
+
+        resampled_indices_.resize(sample_count);
+        std::uniform_real_distribution<fl::Real> start(0, 1. / sample_count);
+        fl::Real position = start(generator_);
+        fl::Real cumulative = weights[0];
+        int index = 0;
+        for (size_t i = 0; i < sample_count; i++)
+        {
+            while (position > cumulative && index < int(sample_count) - 1)
+            {
+                cumulative += weights[++index];
+            }
+            resampled_indices_[i] = index;
+            position += 1. / sample_count;
+        }
 
+        resampled_locations_ = belief_.locations();
+        resampled_particles_ = old_particles_;
+        resampled_noises_ = noises_;
+        resampled_part_loglikes_ = part_loglikes_;
         for (size_t i = 0; i < sample_count; i++)
         {
-            int index;
-            new_belief.location(i) = belief_.sample(index);
+            const int parent = resampled_indices_[i];
 
-            indices[i] = indices_[index];
-            noises[i] = noises_[index];
-            next_samples[i] = old_particles_[index];
-            loglikes[i] = loglikes_[index];
+            resampled_locations_[i].segment(offset, part_size) =
+                belief_.location(parent).segment(offset, part_size);
+            resampled_particles_[i].segment(offset, part_size) =
+                old_particles_[parent].segment(offset, part_size);
+            for (int dimension : sampling_blocks_[i_block])
+            {
+                resampled_noises_[i](dimension) = noises_[parent](dimension);
+            }
+
+            loglikes_[i] += part_loglikes_(parent, i_block) -
+                            part_loglikes_(i, i_block);
+            resampled_part_loglikes_(i, i_block) =
+                part_loglikes_(parent, i_block);
+        }
+
+        for (size_t i = 0; i < sample_count; i++)
+        {
+            belief_.location(i) = resampled_locations_[i];
         }
-        belief_ = new_belief;
-        indices_ = indices;
-        noises_ = noises;
-        old_particles_ = next_samples;
-        loglikes_ = loglikes;
+        old_particles_.swap(resampled_particles_);
+        noises_.swap(resampled_noises_);
+        part_loglikes_.swap(resampled_part_loglikes_);
+
+        part_log_weights_.col(i_block).setZero();
+        belief_.log_unnormalized_prob_mass(part_log_weights_.rowwise().sum());
     }
 
-    /// accessors **************************************************************
-    std::vector<std::vector<int>> sampling_blocks() const
+    /// evaluates the particles which moved since the last layer, the others
+    /// keep their loglikelihood in new_loglikes_. An update evaluates all
+    /// particles since the sensor advances the occlusions of each.
+    void evaluate(bool update)
     {
-        return sampling_blocks_;
+        const size_t sample_count = belief_.size();
+        const size_t moved_count =
+            std::count(moved_.begin(), moved_.end(), true);
+
+        if (update || moved_.size() != sample_count ||
+            moved_count == sample_count)
+        {
+            sensor_->loglikes(
+                belief_.locations(), indices_, new_loglikes_, update);
+            evaluations_ += sample_count;
+            return;
+        }
+        if (moved_count == 0) return;
+
+        moved_locations_.resize(moved_count);
+        moved_indices_.resize(moved_count);
+        moved_loglikes_.resize(moved_count);
+        for (size_t i = 0, j = 0; i < sample_count; i++)
+        {
+            if (!moved_[i]) continue;
+            moved_locations_[j] = belief_.location(i);
+            moved_indices_[j] = indices_[i];
+            j++;
+        }
+
+        sensor_->loglikes(
+            moved_locations_, moved_indices_, moved_loglikes_, false);
+        evaluations_ += moved_count;
+
+        for (size_t i = 0, j = 0; i < sample_count; i++)
+        {
+            if (moved_[i]) new_loglikes_[i] = moved_loglikes_[j++];
+        }
     }
 
-    /// mutators ***************************************************************
-    Belief& belief() { return belief_; }
-    void set_particles(const std::vector<State>& samples)
+    /// draws the particles of an annealing layer by systematic resampling
+    /// and marks all copies of a particle but the first one as moved
+    void resample_layer()
     {
-        belief_.set_uniform(samples.size());
-        for (int i = 0; i < belief_.size(); i++)
-            belief_.location(i) = samples[i];
+        const size_t sample_count = belief_.size();
+
+        resampled_indices_.resize(sample_count);
+        resampled_noises_.resize(sample_count);
+        resampled_particles_.resize(sample_count);
+        resampled_locations_.resize(sample_count);
+        resampled_loglikes_.resize(sample_count);
+        resampled_new_loglikes_.resize(sample_count);
+        moved_.resize(sample_count);
+
+        cumulative_weights_ = belief_.log_prob_mass();
+        cumulative_weights_ =
+            (cumulative_weights_ - cumulative_weights_.maxCoeff()).exp();
+        std::partial_sum(cumulative_weights_.data(),
+                         cumulative_weights_.data() + sample_count,
+                         cumulative_weights_.data());
+
+        const fl::Real step = cumulative_weights_[sample_count - 1] /
+                              sample_count;
+        std::uniform_real_distribution<fl::Real> start(0, step);
+        fl::Real position = start(generator_);
+        int index = 0;
+        for (size_t i = 0; i < sample_count; i++)
+        {
+            const int previous = index;
+            while (position > cumulative_weights_[index] &&
+                   index < int(sample_count) - 1)
+            {
+                index++;
+            }
+            resampled_locations_[i] = belief_.location(index);
+            resampled_indices_[i] = indices_[index];
+            resampled_noises_[i] = noises_[index];
+            resampled_particles_[i] = old_particles_[index];
+            resampled_loglikes_[i] = loglikes_[index];
+            resampled_new_loglikes_[i] = new_loglikes_[index];
+            moved_[i] = i > 0 && index == previous;
+            position += step;
+        }
 
-        indices_ = IntArray::Zero(belief_.size());
-        loglikes_ = RealArray::Zero(belief_.size());
-        noises_ = std::vector<Noise>(
-            belief_.size(), Noise::Zero(transition_->noise_dimension()));
-        old_particles_ = belief_.locations();
+        belief_.set_uniform(sample_count);
+        for (size_t i = 0; i < sample_count; i++)
+        {
+            belief_.location(i) = resampled_locations_[i];
+        }
 
-        sensor_->reset();
+        indices_.swap(resampled_indices_);
+        noises_.swap(resampled_noises_);
+        old_particles_.swap(resampled_particles_);
+        loglikes_.swap(resampled_loglikes_);
+        new_loglikes_.swap(resampled_new_loglikes_);
     }
 
-    std::shared_ptr<Sensor> sensor()
+    /// perturbs the block noise of the moved particles and propagates them
+    /// again. Without diffusion the copies keep the state of their parent,
+    /// such that none has to be evaluated again.
+    void diffuse(size_t i_block, fl::Real deviation, const Input& input)
     {
-        return sensor_;
+        if (deviation <= 0)
+        {
+            std::fill(moved_.begin(), moved_.end(), false);
+            return;
+        }
+
+        for (size_t i_sampl = 0; i_sampl < belief_.size(); i_sampl++)
+        {
+            if (!moved_[i_sampl]) continue;
+            for (const int dimension : sampling_blocks_[i_block])
+            {
+                noises_[i_sampl](dimension) +=
+                    deviation * unit_gaussian_(generator_);
+            }
+            belief_.location(i_sampl) = transition_->state(
+                old_particles_[i_sampl], noises_[i_sampl], input);
+        }
     }
 
-    std::shared_ptr<Transition> transition()
+    /// KL divergence of the normalized weights from the uniform distribution
+    static fl::Real kl_given_uniform(const RealArray& log_weights)
     {
-        return transition_;
+        RealArray weights = (log_weights - log_weights.maxCoeff()).exp();
+        weights /= weights.sum();
+
+        fl::Real kl = std::log(fl::Real(weights.size()));
+        for (int i = 0; i < weights.size(); i++)
+        {
+            if (weights[i] > 0) kl += weights[i] * std::log(weights[i]);
+        }
+        return kl;
+    }
+
+    /// zeroes the noise of each particle, reusing the existing vectors
+    void reset_noises(const size_t& sample_count)
+    {
+        noises_.resize(sample_count);
+        for (auto& noise : noises_)
+        {
+            noise.setZero(transition_->noise_dimension());
+        }
     }
 
-private:
     /// member variables *******************************************************
     Belief belief_;
     IntArray indices_;
@@ -197,6 +911,32 @@ private:
     StateArray old_particles_;
     RealArray loglikes_;
 
+    // per frame buffers, kept to avoid reallocation
+    RealArray new_loglikes_;
+    RealArray delta_loglikes_;
+
+    // factorized weights, one column per part
+    RealPartArray part_loglikes_;
+    RealPartArray new_part_loglikes_;
+    RealPartArray part_log_weights_;
+    RealPartArray resampled_part_loglikes_;
+
+    // resampling buffers, swapped with the above on each resampling
+    IntArray resampled_indices_;
+    std::vector<Noise> resampled_noises_;
+    StateArray resampled_particles_;
+    StateArray resampled_locations_;
+    RealArray resampled_loglikes_;
+    RealArray resampled_new_loglikes_;
+
+    // annealing layers, particles moved since their last evaluation
+    std::vector<fl::Real> annealing_betas_;
+    fl::Real annealing_diffusion_;
+    std::vector<bool> moved_;
+    StateArray moved_locations_;
+    IntArray moved_indices_;
+    RealArray moved_loglikes_;
+
     // models
     std::shared_ptr<Sensor> sensor_;
     std::shared_ptr<Transition> transition_;
@@ -204,8 +944,21 @@ private:
     // parameters
     std::vector<std::vector<int>> sampling_blocks_;
     fl::Real max_kl_divergence_;
-
-    // distribution for sampling
-    fl::Gaussian<Eigen::Matrix<fl::Real, 1, 1>> unit_gaussian_;
+    bool factorized_weights_;
+
+    // reduced update of static observations, disabled for a count of 0
+    size_t static_particle_count_;
+    size_t dynamic_particle_count_;
+    bool static_frame_;
+
+    // distribution for sampling, all samples are drawn from generator_
+    std::normal_distribution<fl::Real> unit_gaussian_;
+    std::shared_ptr<ScrambledHaltonSequence> noise_sequence_;
+    unsigned seed_;
+    std::mt19937 generator_;
+    RealArray cumulative_weights_;
+
+    Timings timings_;
+    size_t evaluations_ = 0;
 };
 }
@@ -0,0 +1,441 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file rao_blackwell_coordinate_particle_filter_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <random>
+#include <set>
+#include <vector>
+
+#include <dbot/filter/rao_blackwell_coordinate_particle_filter.h>
+#include <dbot/pose/free_floating_rigid_bodies_state.h>
+
+namespace
+{
+typedef dbot::FreeFloatingRigidBodiesState<> State;
+
+/**
+ * \brief Moves the position of each part by its block of the noise
+ */
+class StubTransition
+{
+public:
+    typedef ::State State;
+    typedef Eigen::VectorXd Noise;
+    typedef Eigen::VectorXd Input;
+
+    explicit StubTransition(const std::vector<double>& sigmas)
+        : sigmas_(sigmas)
+    {
+    }
+
+    size_t noise_dimension() const { return 3 * sigmas_.size(); }
+
+    State state(const State& state, const Noise& noise, const Input&) const
+    {
+        State next = state;
+        for (size_t part = 0; part < sigmas_.size(); ++part)
+        {
+            next.component(part).position() +=
+                sigmas_[part] * noise.segment(3 * part, 3);
+        }
+        return next;
+    }
+
+private:
+    std::vector<double> sigmas_;
+};
+
+/**
+ * \brief Scores each part by the distance of its position to a target and
+ *        records the particles of every evaluation
+ */
+class StubSensor : public dbot::RbSensor<State>
+{
+public:
+    StubSensor(const std::vector<Eigen::Vector3d>& targets,
+               bool attributes_parts = true,
+               int reported_parts = -1)
+        : dbot::RbSensor<State>(1.0),
+          targets_(targets),
+          attributes_parts_(attributes_parts),
+          reported_parts_(reported_parts < 0 ? targets.size() : reported_parts)
+    {
+        default_poses_ = PoseArray(targets.size());
+        default_poses_.setZero();
+    }
+
+    using dbot::RbSensor<State>::loglikes;
+
+    RealArray loglikes(const StateArray& states,
+                       IntArray& indices,
+                       const bool& update = false)
+    {
+        evaluations.push_back(states);
+
+        RealArray log_likes = RealArray::Zero(states.size());
+        for (int i = 0; i < states.size(); ++i)
+        {
+            for (size_t part = 0; part < targets_.size(); ++part)
+            {
+                log_likes[i] += part_loglike(states[i], part);
+            }
+        }
+        return log_likes;
+    }
+
+    bool has_part_loglikes() const { return attributes_parts_; }
+
+    void part_loglikes(const StateArray& states,
+                       IntArray& indices,
+                       int part,
+                       RealPartArray& part_log_likes,
+                       const bool& update)
+    {
+        evaluations.push_back(states);
+
+        part_log_likes.conservativeResize(states.size(), reported_parts_);
+        for (int i = 0; i < states.size(); ++i)
+        {
+            part_log_likes(i, part) = part_loglike(states[i], part);
+        }
+    }
+
+    fl::Real part_loglike(const State& state, int part) const
+    {
+        const double sigma = 0.01;
+        return -(state.component(part).position() - targets_[part])
+                    .squaredNorm() /
+               (2 * sigma * sigma);
+    }
+
+    void set_observation(const Observation&) {}
+    void reset() {}
+
+    // particles of each evaluation in call order
+    std::vector<StateArray> evaluations;
+
+private:
+    std::vector<Eigen::Vector3d> targets_;
+    bool attributes_parts_;
+    int reported_parts_;
+};
+
+typedef dbot::RaoBlackwellCoordinateParticleFilter<StubTransition, StubSensor>
+    Filter;
+
+const std::vector<std::vector<int>> two_part_blocks = {{0, 1, 2}, {3, 4, 5}};
+
+/// particles scattered around the targets with a deviation per part
+std::vector<State> scatter(const std::vector<Eigen::Vector3d>& targets,
+                           const std::vector<double>& deviations,
+                           int count,
+                           std::mt19937& generator)
+{
+    std::normal_distribution<double> noise(0.0, 1.0);
+    std::vector<State> particles(count, State(targets.size()));
+    for (auto& particle : particles)
+    {
+        particle.setZero();
+        for (size_t part = 0; part < targets.size(); ++part)
+        {
+            particle.component(part).position() =
+                targets[part] + deviations[part] * Eigen::Vector3d(
+                                                       noise(generator),
+                                                       noise(generator),
+                                                       noise(generator));
+        }
+    }
+    return particles;
+}
+
+bool contains(const std::vector<Eigen::Vector3d>& positions,
+              const Eigen::Vector3d& position)
+{
+    for (const auto& p : positions)
+    {
+        if (p == position) return true;
+    }
+    return false;
+}
+}
+
+TEST(RaoBlackwellCoordinateParticleFilterTests,
+     factorized_weights_resample_parts_independently)
+{
+    const std::vector<Eigen::Vector3d> targets = {
+        Eigen::Vector3d(0, 0, 1), Eigen::Vector3d(0.1, 0, 1)};
+
+    // the first part is scattered widely and resampled, the second part
+    // neither moves nor degenerates, hence it stays with its particle
+    auto sensor = std::make_shared<StubSensor>(targets);
+    Filter filter(std::make_shared<StubTransition>(
+                      std::vector<double>{0.005, 0.0}),
+                  sensor,
+                  two_part_blocks,
+                  0.5);
+    filter.set_factorized_weights(true);
+
+    const int count = 30;
+    std::mt19937 generator(1);
+    const std::vector<State> particles =
+        scatter(targets, {0.02, 0.002}, count, generator);
+    filter.set_particles(particles);
+    filter.filter(StubSensor::Observation(), Eigen::VectorXd::Zero(6));
+
+    ASSERT_EQ(2u, sensor->evaluations.size());
+    const auto& first_block = sensor->evaluations[0];
+    const auto& second_block = sensor->evaluations[1];
+
+    std::vector<Eigen::Vector3d> first_parts, second_parts;
+    for (int i = 0; i < count; ++i)
+    {
+        first_parts.push_back(first_block[i].component(0).position());
+        second_parts.push_back(particles[i].component(1).position());
+    }
+
+    // the first part was drawn among the evaluated ones, the second part
+    // of each particle remained in place
+    std::set<std::vector<double>> distinct;
+    for (int i = 0; i < count; ++i)
+    {
+        const Eigen::Vector3d first = second_block[i].component(0).position();
+        EXPECT_TRUE(contains(first_parts, first));
+        distinct.insert({first(0), first(1), first(2)});
+
+        EXPECT_EQ(particles[i].component(1).position(),
+                  second_block[i].component(1).position());
+    }
+    EXPECT_LT(distinct.size(), size_t(count));
+
+    // the weight of a particle is the sum of its part weights, and the
+    // part loglikelihoods belong to the resampled parts
+    auto snapshot = filter.snapshot();
+    Filter::RealArray part_sums = snapshot.part_log_weights.rowwise().sum();
+    EXPECT_GT(part_sums.maxCoeff() - part_sums.minCoeff(), 1e-3);
+    for (int i = 0; i < count; ++i)
+    {
+        EXPECT_EQ(second_block[i], snapshot.particles[i]);
+        EXPECT_NEAR(snapshot.log_weights(i) - snapshot.log_weights(0),
+                    part_sums(i) - part_sums(0),
+                    1e-9);
+        for (int part = 0; part < 2; ++part)
+        {
+            EXPECT_NEAR(snapshot.part_loglikes(i, part),
+                        sensor->part_loglike(snapshot.particles[i], part),
+                        1e-9);
+        }
+        EXPECT_NEAR(snapshot.loglikes(i),
+                    snapshot.part_loglikes.row(i).sum(),
+                    1e-9);
+    }
+}
+
+TEST(RaoBlackwellCoordinateParticleFilterTests,
+     factorized_weights_require_part_attribution)
+{
+    const std::vector<Eigen::Vector3d> targets = {
+        Eigen::Vector3d(0, 0, 1), Eigen::Vector3d(0.1, 0, 1)};
+    auto transition =
+        std::make_shared<StubTransition>(std::vector<double>{0.005, 0.005});
+    std::mt19937 generator(1);
+
+    Filter unattributed(transition,
+                        std::make_shared<StubSensor>(targets, false),
+                        two_part_blocks);
+    EXPECT_THROW(unattributed.set_factorized_weights(true),
+                 dbot::FactorizedWeightsException);
+
+    // the sensor reports a part more than there are sampling blocks
+    Filter mismatched(transition,
+                      std::make_shared<StubSensor>(targets, true, 3),
+                      two_part_blocks);
+    mismatched.set_factorized_weights(true);
+    mismatched.set_particles(scatter(targets, {0.01, 0.01}, 10, generator));
+    EXPECT_THROW(mismatched.filter(StubSensor::Observation(),
+                                   Eigen::VectorXd::Zero(6)),
+                 dbot::FactorizedWeightsException);
+}
+
+TEST(RaoBlackwellCoordinateParticleFilterTests, annealing_validates_schedule)
+{
+    const std::vector<Eigen::Vector3d> targets = {
+        Eigen::Vector3d(0, 0, 1), Eigen::Vector3d(0.1, 0, 1)};
+    Filter filter(
+        std::make_shared<StubTransition>(std::vector<double>{0.005, 0.005}),
+        std::make_shared<StubSensor>(targets),
+        two_part_blocks);
+
+    EXPECT_THROW(filter.set_annealing({0.5, 0.3}, 0.5),
+                 dbot::AnnealingException);
+    EXPECT_THROW(filter.set_annealing({0.5, 0.5}, 0.5),
+                 dbot::AnnealingException);
+    EXPECT_THROW(filter.set_annealing({0.0}, 0.5), dbot::AnnealingException);
+    EXPECT_THROW(filter.set_annealing({1.0}, 0.5), dbot::AnnealingException);
+    EXPECT_THROW(filter.set_annealing({0.5}, -0.1), dbot::AnnealingException);
+    EXPECT_NO_THROW(filter.set_annealing({0.2, 0.5}, 0.5));
+    EXPECT_NO_THROW(filter.set_annealing({}, 0.0));
+
+    // annealed layers are weighted as whole particles
+    filter.set_factorized_weights(true);
+    EXPECT_THROW(filter.set_annealing({0.5}, 0.5), dbot::AnnealingException);
+    filter.set_factorized_weights(false);
+    filter.set_annealing({0.5}, 0.5);
+    EXPECT_THROW(filter.set_factorized_weights(true),
+                 dbot::FactorizedWeightsException);
+}
+
+TEST(RaoBlackwellCoordinateParticleFilterTests, seed_is_restored)
+{
+    const std::vector<Eigen::Vector3d> targets = {
+        Eigen::Vector3d(0, 0, 1), Eigen::Vector3d(0.1, 0, 1)};
+    auto transition =
+        std::make_shared<StubTransition>(std::vector<double>{0.005, 0.005});
+
+    Filter seeded(transition, std::make_shared<StubSensor>(targets),
+                  two_part_blocks, 1.0);
+    Filter restored(transition, std::make_shared<StubSensor>(targets),
+                    two_part_blocks, 1.0);
+    seeded.set_seed(7);
+
+    std::mt19937 generator(3);
+    seeded.set_particles(scatter(targets, {0.02, 0.02}, 20, generator));
+    seeded.filter(StubSensor::Observation(), Eigen::VectorXd::Zero(6));
+
+    restored.restore(seeded.snapshot());
+    EXPECT_EQ(7u, restored.seed());
+
+    seeded.filter(StubSensor::Observation(), Eigen::VectorXd::Zero(6));
+    restored.filter(StubSensor::Observation(), Eigen::VectorXd::Zero(6));
+    auto expected = seeded.snapshot();
+    auto actual = restored.snapshot();
+    EXPECT_TRUE((expected.log_weights == actual.log_weights).all());
+    for (size_t i = 0; i < expected.particles.size(); ++i)
+    {
+        EXPECT_EQ(expected.particles[i], actual.particles[i]);
+    }
+
+    // a different seed draws different samples
+    Filter other(transition, std::make_shared<StubSensor>(targets),
+                 two_part_blocks, 1.0);
+    other.restore(seeded.snapshot());
+    other.set_seed(8);
+    seeded.filter(StubSensor::Observation(), Eigen::VectorXd::Zero(6));
+    other.filter(StubSensor::Observation(), Eigen::VectorXd::Zero(6));
+    EXPECT_FALSE(seeded.snapshot().particles == other.snapshot().particles);
+}
+
+TEST(RaoBlackwellCoordinateParticleFilterTests,
+     empty_annealing_schedule_reproduces_plain_weights)
+{
+    const std::vector<Eigen::Vector3d> targets = {
+        Eigen::Vector3d(0, 0, 1), Eigen::Vector3d(0.1, 0, 1)};
+    auto transition =
+        std::make_shared<StubTransition>(std::vector<double>{0.005, 0.005});
+
+    Filter plain(transition, std::make_shared<StubSensor>(targets),
+                 two_part_blocks, 1.0);
+    Filter disabled(transition, std::make_shared<StubSensor>(targets),
+                    two_part_blocks, 1.0);
+    disabled.set_annealing({0.3, 0.6}, 0.5);
+    disabled.set_annealing({}, 0.5);
+
+    std::mt19937 generator(3);
+    const std::vector<State> particles =
+        scatter(targets, {0.02, 0.02}, 20, generator);
+    plain.set_particles(particles);
+    disabled.set_particles(particles);
+
+    for (int frame = 0; frame < 3; ++frame)
+    {
+        plain.filter(StubSensor::Observation(), Eigen::VectorXd::Zero(6));
+        disabled.filter(StubSensor::Observation(), Eigen::VectorXd::Zero(6));
+
+        auto expected = plain.snapshot();
+        auto actual = disabled.snapshot();
+        EXPECT_TRUE((expected.log_weights == actual.log_weights).all());
+        EXPECT_TRUE((expected.loglikes == actual.loglikes).all());
+        for (size_t i = 0; i < particles.size(); ++i)
+        {
+            EXPECT_EQ(expected.particles[i], actual.particles[i]);
+        }
+        EXPECT_EQ(plain.evaluations(), disabled.evaluations());
+    }
+}
+
+TEST(RaoBlackwellCoordinateParticleFilterTests,
+     annealing_evaluates_only_moved_copies)
+{
+    const std::vector<Eigen::Vector3d> targets = {
+        Eigen::Vector3d(0, 0, 1), Eigen::Vector3d(0.1, 0, 1)};
+
+    // the second part does not move, hence the loglikelihoods of the first
+    // block are those seen again by the second
+    auto sensor = std::make_shared<StubSensor>(targets);
+    Filter filter(std::make_shared<StubTransition>(
+                      std::vector<double>{0.005, 0.0}),
+                  sensor,
+                  two_part_blocks,
+                  1e10);
+    filter.set_annealing({0.5}, 1.0);
+
+    const int count = 30;
+    std::mt19937 generator(1);
+    filter.set_particles(scatter(targets, {0.02, 0.002}, count, generator));
+    filter.filter(StubSensor::Observation(), Eigen::VectorXd::Zero(6));
+
+    // the first block evaluates all particles, then the diffused copies of
+    // its layer. The second block evaluates all particles for its layer and
+    // for the update.
+    ASSERT_EQ(4u, sensor->evaluations.size());
+    const auto& layer = sensor->evaluations[0];
+    const auto& copies = sensor->evaluations[1];
+    const auto& first_block = sensor->evaluations[2];
+    EXPECT_EQ(count, layer.size());
+    EXPECT_GT(copies.size(), 0);
+    EXPECT_LT(copies.size(), count);
+    EXPECT_EQ(count, first_block.size());
+    EXPECT_EQ(count, sensor->evaluations[3].size());
+    EXPECT_EQ(size_t(3 * count + copies.size()), filter.evaluations());
+
+    // a particle of the first block is either a kept copy of the layer or
+    // a diffused copy which was evaluated again
+    auto contains_state = [](const StubSensor::StateArray& states,
+                             const State& state) {
+        for (int i = 0; i < states.size(); ++i)
+        {
+            if (states[i] == state) return true;
+        }
+        return false;
+    };
+    int moved = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        if (contains_state(layer, first_block[i])) continue;
+        EXPECT_TRUE(contains_state(copies, first_block[i]));
+        moved++;
+    }
+    EXPECT_EQ(copies.size(), moved);
+
+    // the kept copies carried their loglikelihoods, hence the loglikelihoods
+    // of the first block match those of the second and leave all weights
+    // uniform after the layer of the second block
+    auto snapshot = filter.snapshot();
+    EXPECT_EQ(snapshot.log_weights.maxCoeff(), snapshot.log_weights.minCoeff());
+}
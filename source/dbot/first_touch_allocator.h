@@ -0,0 +1,66 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file first_touch_allocator.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace dbot
+{
+/**
+ * \brief std::allocator which default-initializes instead of
+ *        value-initializing elements.
+ *
+ * Resizing a std::vector of arithmetic types with this allocator leaves the
+ * new elements uninitialized. Large buffers are therefore not written by the
+ * allocating thread and their pages are placed on the NUMA node of the thread
+ * which writes them first.
+ */
+template <typename T>
+class FirstTouchAllocator : public std::allocator<T>
+{
+public:
+    template <typename U>
+    struct rebind
+    {
+        typedef FirstTouchAllocator<U> other;
+    };
+
+    FirstTouchAllocator() = default;
+
+    template <typename U>
+    FirstTouchAllocator(const FirstTouchAllocator<U>& other)
+        : std::allocator<T>(other)
+    {
+    }
+
+    template <typename U>
+    void construct(U* p)
+    {
+        ::new (static_cast<void*>(p)) U;
+    }
+
+    template <typename U, typename... Args>
+    void construct(U* p, Args&&... args)
+    {
+        ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+};
+}
@@ -0,0 +1,140 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file frame_arena.cpp
+ * \date October 2016
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <dbot/frame_arena.h>
+
+namespace dbot
+{
+FrameArena::FrameArena(std::size_t block_size)
+    : current_(0), offset_(0), block_size_(std::max<std::size_t>(block_size, 1))
+{
+}
+
+void* FrameArena::allocate(std::size_t bytes)
+{
+    if (bytes == 0) bytes = 1;
+
+    // try the current block and then any block left over from a rewind
+    while (current_ < blocks_.size())
+    {
+        void* memory = allocate_in(blocks_[current_], offset_, bytes);
+        if (memory) return memory;
+
+        ++current_;
+        offset_ = 0;
+    }
+
+    add_block(bytes);
+    current_ = blocks_.size() - 1;
+    offset_ = 0;
+
+    return allocate_in(blocks_[current_], offset_, bytes);
+}
+
+void* FrameArena::allocate_in(Block& block,
+                              std::size_t& offset,
+                              std::size_t bytes)
+{
+    auto address = reinterpret_cast<std::uintptr_t>(block.data.get()) + offset;
+    std::size_t padding = (Alignment - address % Alignment) % Alignment;
+
+    if (offset + padding + bytes > block.size) return nullptr;
+
+    void* memory = block.data.get() + offset + padding;
+    offset += padding + bytes;
+
+    return memory;
+}
+
+void FrameArena::add_block(std::size_t min_bytes)
+{
+    std::size_t size = std::max(block_size_, capacity());
+    size = std::max(size, min_bytes + Alignment);
+
+    Block block;
+    block.data.reset(new char[size]);
+    block.size = size;
+    blocks_.push_back(std::move(block));
+}
+
+auto FrameArena::mark() const -> Marker
+{
+    Marker marker;
+    marker.block = current_;
+    marker.offset = offset_;
+    return marker;
+}
+
+void FrameArena::rewind(const Marker& marker)
+{
+    if (marker.block == 0 && marker.offset == 0)
+    {
+        reset();
+        return;
+    }
+
+    current_ = marker.block;
+    offset_ = marker.offset;
+}
+
+void FrameArena::reset()
+{
+    if (blocks_.size() > 1)
+    {
+        std::size_t total = capacity();
+        blocks_.clear();
+        add_block(total);
+    }
+
+    current_ = 0;
+    offset_ = 0;
+}
+
+std::size_t FrameArena::used() const
+{
+    std::size_t bytes = offset_;
+    for (std::size_t i = 0; i < current_ && i < blocks_.size(); ++i)
+    {
+        bytes += blocks_[i].size;
+    }
+    return bytes;
+}
+
+std::size_t FrameArena::capacity() const
+{
+    std::size_t bytes = 0;
+    for (const auto& block : blocks_)
+    {
+        bytes += block.size;
+    }
+    return bytes;
+}
+
+std::size_t FrameArena::count_blocks() const
+{
+    return blocks_.size();
+}
+
+FrameArena& FrameArena::local()
+{
+    static thread_local FrameArena arena;
+    return arena;
+}
+}
@@ -0,0 +1,173 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file frame_arena.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace dbot
+{
+/**
+ * \brief Monotonic allocator for temporaries which live at most one frame.
+ *
+ * Memory is handed out by advancing an offset within a list of blocks and is
+ * never released individually. Rewinding to a previously taken marker and
+ * resetting the arena are O(1). If a frame overflows the first block, the
+ * blocks are coalesced into a single larger one on reset such that the steady
+ * state is served from one block without calling the system allocator.
+ */
+class FrameArena
+{
+public:
+    /**
+     * \brief Position within the arena as returned by mark()
+     */
+    struct Marker
+    {
+        std::size_t block;
+        std::size_t offset;
+    };
+
+    /**
+     * \brief Rewinds the arena to the position it had on construction of
+     *        the scope. Scopes may be nested.
+     */
+    class Scope
+    {
+    public:
+        explicit Scope(FrameArena& arena)
+            : arena_(arena), marker_(arena.mark())
+        {
+        }
+
+        ~Scope() { arena_.rewind(marker_); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        FrameArena& arena_;
+        Marker marker_;
+    };
+
+    enum
+    {
+        Alignment = 32
+    };
+
+public:
+    /**
+     * \brief Creates an arena with an initial block of the given size in
+     *        bytes. The block is allocated on first use.
+     */
+    explicit FrameArena(std::size_t block_size = 1 << 20);
+
+    /**
+     * \brief Returns uninitialized memory of the given size in bytes aligned
+     *        to \c Alignment bytes
+     */
+    void* allocate(std::size_t bytes);
+
+    /**
+     * \brief Returns uninitialized storage for count elements of type T
+     */
+    template <typename T>
+    T* allocate(std::size_t count)
+    {
+        static_assert(std::alignment_of<T>::value <= Alignment,
+                      "Type alignment exceeds arena alignment");
+
+        return static_cast<T*>(allocate(count * sizeof(T)));
+    }
+
+    /**
+     * \brief Returns count default constructed elements of type T. Elements
+     *        are never destructed, hence T must be trivially destructible.
+     */
+    template <typename T>
+    T* create(std::size_t count)
+    {
+        static_assert(std::is_trivially_destructible<T>::value,
+                      "Arena objects are never destructed");
+
+        T* objects = allocate<T>(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            new (objects + i) T();
+        }
+        return objects;
+    }
+
+    /**
+     * \brief Returns the current position of the arena
+     */
+    Marker mark() const;
+
+    /**
+     * \brief Releases everything allocated after the given marker. Rewinding
+     *        to the very beginning is equivalent to reset().
+     */
+    void rewind(const Marker& marker);
+
+    /**
+     * \brief Releases all allocations. If the previous frames required more
+     *        than one block, the blocks are merged into one.
+     */
+    void reset();
+
+    /**
+     * \brief Number of bytes currently handed out (including padding)
+     */
+    std::size_t used() const;
+
+    /**
+     * \brief Total number of bytes owned by the arena
+     */
+    std::size_t capacity() const;
+
+    /**
+     * \brief Number of blocks currently owned by the arena
+     */
+    std::size_t count_blocks() const;
+
+    /**
+     * \brief Returns the arena of the calling thread
+     */
+    static FrameArena& local();
+
+private:
+    struct Block
+    {
+        std::unique_ptr<char[]> data;
+        std::size_t size;
+    };
+
+    void* allocate_in(Block& block, std::size_t& offset, std::size_t bytes);
+    void add_block(std::size_t min_bytes);
+
+private:
+    std::vector<Block> blocks_;
+    std::size_t current_;
+    std::size_t offset_;
+    std::size_t block_size_;
+};
+}
@@ -0,0 +1,105 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file frame_arena_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <thread>
+
+#include <dbot/frame_arena.h>
+
+TEST(FrameArenaTests, allocations_are_aligned)
+{
+    dbot::FrameArena arena(1024);
+
+    arena.allocate(3);
+    auto address = reinterpret_cast<std::uintptr_t>(arena.allocate<double>(5));
+
+    EXPECT_EQ(address % dbot::FrameArena::Alignment, 0);
+}
+
+TEST(FrameArenaTests, rewind_reuses_memory)
+{
+    dbot::FrameArena arena(1024);
+    arena.allocate<float>(10);
+
+    auto marker = arena.mark();
+    float* first = arena.allocate<float>(100);
+    arena.rewind(marker);
+    float* second = arena.allocate<float>(100);
+
+    EXPECT_EQ(first, second);
+}
+
+TEST(FrameArenaTests, scopes_release_on_exit)
+{
+    dbot::FrameArena arena(1024);
+    arena.allocate<float>(10);
+    std::size_t used = arena.used();
+
+    {
+        dbot::FrameArena::Scope outer(arena);
+        arena.allocate<float>(20);
+        {
+            dbot::FrameArena::Scope inner(arena);
+            arena.allocate<float>(30);
+        }
+        arena.allocate<float>(20);
+    }
+
+    EXPECT_EQ(arena.used(), used);
+}
+
+TEST(FrameArenaTests, reset_coalesces_blocks)
+{
+    dbot::FrameArena arena(64);
+
+    for (int i = 0; i < 10; ++i) arena.allocate<double>(16);
+    EXPECT_GT(arena.count_blocks(), 1);
+
+    std::size_t capacity = arena.capacity();
+    arena.reset();
+
+    EXPECT_EQ(arena.count_blocks(), 1);
+    EXPECT_GE(arena.capacity(), capacity);
+    EXPECT_EQ(arena.used(), 0);
+
+    // the same frame now fits into the single block
+    for (int i = 0; i < 10; ++i) arena.allocate<double>(16);
+    EXPECT_EQ(arena.count_blocks(), 1);
+}
+
+TEST(FrameArenaTests, create_default_constructs)
+{
+    dbot::FrameArena arena(1024);
+    int* values = arena.create<int>(8);
+
+    for (int i = 0; i < 8; ++i) EXPECT_EQ(values[i], 0);
+}
+
+TEST(FrameArenaTests, local_arena_is_per_thread)
+{
+    dbot::FrameArena* main_arena = &dbot::FrameArena::local();
+    dbot::FrameArena* worker_arena = nullptr;
+
+    std::thread worker([&]() { worker_arena = &dbot::FrameArena::local(); });
+    worker.join();
+
+    EXPECT_EQ(main_arena, &dbot::FrameArena::local());
+    EXPECT_NE(main_arena, worker_arena);
+}
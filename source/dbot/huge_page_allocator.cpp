@@ -0,0 +1,165 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file huge_page_allocator.cpp
+ * \date October 2016
+ */
+
+#include <dbot/huge_page_allocator.h>
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <new>
+#include <string>
+
+#include <sys/mman.h>
+
+namespace dbot
+{
+namespace
+{
+std::atomic<std::size_t> explicit_bytes(0);
+std::atomic<std::size_t> transparent_bytes(0);
+std::atomic<std::size_t> regular_bytes(0);
+
+std::size_t read_huge_page_size()
+{
+    std::ifstream meminfo("/proc/meminfo");
+    std::string key;
+    while (meminfo >> key)
+    {
+        if (key == "Hugepagesize:")
+        {
+            std::size_t kib;
+            if (meminfo >> kib && kib > 0) return kib * 1024;
+            break;
+        }
+        meminfo.ignore(1024, '\n');
+    }
+
+    return std::size_t(2) << 20;
+}
+
+bool mapped(std::size_t bytes, HugePagePolicy policy)
+{
+    return policy != HugePagePolicy::Disabled && bytes >= huge_page_size();
+}
+
+std::size_t mapping_size(std::size_t bytes)
+{
+    const std::size_t page = huge_page_size();
+    return (bytes + page - 1) / page * page;
+}
+
+void* map_explicit(std::size_t size)
+{
+#ifdef MAP_HUGETLB
+    void* memory = mmap(nullptr,
+                        size,
+                        PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                        -1,
+                        0);
+    if (memory != MAP_FAILED) return memory;
+#endif
+    return nullptr;
+}
+
+void* map_transparent(std::size_t size, bool& advised)
+{
+    // over-allocate by one huge page such that the mapping can be trimmed
+    // to a huge page aligned range, otherwise the kernel cannot back the
+    // first and last pages with huge pages
+    const std::size_t page = huge_page_size();
+    void* memory = mmap(nullptr,
+                        size + page,
+                        PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS,
+                        -1,
+                        0);
+    if (memory == MAP_FAILED) return nullptr;
+
+    auto address = reinterpret_cast<std::uintptr_t>(memory);
+    std::size_t head = (page - address % page) % page;
+    if (head > 0) munmap(memory, head);
+    munmap(reinterpret_cast<char*>(memory) + head + size, page - head);
+    memory = reinterpret_cast<char*>(memory) + head;
+
+    advised = false;
+#ifdef MADV_HUGEPAGE
+    advised = madvise(memory, size, MADV_HUGEPAGE) == 0;
+#endif
+    return memory;
+}
+}
+
+std::size_t huge_page_size()
+{
+    static const std::size_t size = read_huge_page_size();
+    return size;
+}
+
+void* allocate_huge_pages(std::size_t bytes, HugePagePolicy policy)
+{
+    if (!mapped(bytes, policy))
+    {
+        regular_bytes += bytes;
+        return ::operator new(bytes);
+    }
+
+    const std::size_t size = mapping_size(bytes);
+
+    if (policy == HugePagePolicy::Explicit)
+    {
+        void* memory = map_explicit(size);
+        if (memory)
+        {
+            explicit_bytes += size;
+            return memory;
+        }
+    }
+
+    bool advised;
+    void* memory = map_transparent(size, advised);
+    if (!memory) throw std::bad_alloc();
+
+    (advised ? transparent_bytes : regular_bytes) += size;
+    return memory;
+}
+
+void deallocate_huge_pages(void* memory,
+                           std::size_t bytes,
+                           HugePagePolicy policy)
+{
+    if (!memory) return;
+
+    if (!mapped(bytes, policy))
+    {
+        ::operator delete(memory);
+        return;
+    }
+
+    munmap(memory, mapping_size(bytes));
+}
+
+HugePageUsage huge_page_usage()
+{
+    HugePageUsage usage;
+    usage.explicit_bytes = explicit_bytes;
+    usage.transparent_bytes = transparent_bytes;
+    usage.regular_bytes = regular_bytes;
+    return usage;
+}
+}
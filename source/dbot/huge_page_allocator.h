@@ -0,0 +1,142 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file huge_page_allocator.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+#include <dbot/first_touch_allocator.h>
+
+namespace dbot
+{
+/**
+ * \brief Page backing requested for large buffers
+ */
+enum class HugePagePolicy
+{
+    /// regular heap allocation
+    Disabled,
+    /// anonymous mapping advised for transparent huge pages (MADV_HUGEPAGE)
+    Transparent,
+    /// explicit huge pages (MAP_HUGETLB) falling back to Transparent if no
+    /// huge pages are reserved
+    Explicit
+};
+
+/**
+ * \brief Number of bytes allocated so far per obtained backing
+ */
+struct HugePageUsage
+{
+    std::size_t explicit_bytes;
+    std::size_t transparent_bytes;
+    std::size_t regular_bytes;
+};
+
+/**
+ * \brief Returns the default huge page size of the host in bytes
+ */
+std::size_t huge_page_size();
+
+/**
+ * \brief Allocates at least the given number of bytes according to the
+ *        policy. Allocations smaller than a huge page and the Disabled policy
+ *        are served from the heap. The memory is not touched, hence its pages
+ *        are placed on the NUMA node of the first writer.
+ *
+ * \throws std::bad_alloc
+ */
+void* allocate_huge_pages(std::size_t bytes, HugePagePolicy policy);
+
+/**
+ * \brief Releases memory obtained from allocate_huge_pages() with the same
+ *        size and policy
+ */
+void deallocate_huge_pages(void* memory,
+                           std::size_t bytes,
+                           HugePagePolicy policy);
+
+/**
+ * \brief Returns the bytes allocated so far per backing actually obtained
+ */
+HugePageUsage huge_page_usage();
+
+/**
+ * \brief Allocator for large buffers backed by huge pages.
+ *
+ * Large per-particle buffers are accessed at random rows, which causes many
+ * TLB misses on 4 KiB pages. Elements are default-initialized like with
+ * FirstTouchAllocator. The policy is part of the allocator state and moves
+ * along with the memory on container move and swap.
+ */
+template <typename T>
+class HugePageAllocator : public FirstTouchAllocator<T>
+{
+public:
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    template <typename U>
+    struct rebind
+    {
+        typedef HugePageAllocator<U> other;
+    };
+
+    explicit HugePageAllocator(
+        HugePagePolicy policy = HugePagePolicy::Disabled)
+        : policy_(policy)
+    {
+    }
+
+    template <typename U>
+    HugePageAllocator(const HugePageAllocator<U>& other)
+        : policy_(other.policy())
+    {
+    }
+
+    T* allocate(std::size_t count, const void* = nullptr)
+    {
+        return static_cast<T*>(
+            allocate_huge_pages(count * sizeof(T), policy_));
+    }
+
+    void deallocate(T* memory, std::size_t count)
+    {
+        deallocate_huge_pages(memory, count * sizeof(T), policy_);
+    }
+
+    HugePagePolicy policy() const { return policy_; }
+
+private:
+    HugePagePolicy policy_;
+};
+
+template <typename T, typename U>
+bool operator==(const HugePageAllocator<T>& a, const HugePageAllocator<U>& b)
+{
+    return a.policy() == b.policy();
+}
+
+template <typename T, typename U>
+bool operator!=(const HugePageAllocator<T>& a, const HugePageAllocator<U>& b)
+{
+    return !(a == b);
+}
+}
@@ -0,0 +1,80 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file huge_page_allocator_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include <dbot/huge_page_allocator.h>
+
+typedef std::vector<float, dbot::HugePageAllocator<float>> Buffer;
+
+TEST(HugePageAllocatorTests, large_buffers_are_huge_page_aligned)
+{
+    const std::size_t count = 3 * dbot::huge_page_size() / sizeof(float);
+
+    for (auto policy : {dbot::HugePagePolicy::Transparent,
+                        dbot::HugePagePolicy::Explicit})
+    {
+        auto before = dbot::huge_page_usage();
+
+        Buffer buffer{Buffer::allocator_type(policy)};
+        buffer.resize(count);
+        for (std::size_t i = 0; i < count; ++i) buffer[i] = i;
+
+        auto address = reinterpret_cast<std::uintptr_t>(buffer.data());
+        EXPECT_EQ(address % dbot::huge_page_size(), 0u);
+        EXPECT_EQ(buffer[count - 1], float(count - 1));
+
+        auto after = dbot::huge_page_usage();
+        EXPECT_GE(after.explicit_bytes + after.transparent_bytes +
+                      after.regular_bytes,
+                  before.explicit_bytes + before.transparent_bytes +
+                      before.regular_bytes + count * sizeof(float));
+    }
+}
+
+TEST(HugePageAllocatorTests, small_buffers_use_heap)
+{
+    auto before = dbot::huge_page_usage();
+
+    Buffer buffer{Buffer::allocator_type(dbot::HugePagePolicy::Transparent)};
+    buffer.resize(16, 1.f);
+
+    auto after = dbot::huge_page_usage();
+    EXPECT_EQ(after.transparent_bytes, before.transparent_bytes);
+    EXPECT_EQ(after.regular_bytes, before.regular_bytes + 16 * sizeof(float));
+}
+
+TEST(HugePageAllocatorTests, swap_exchanges_policies)
+{
+    const std::size_t count = dbot::huge_page_size() / sizeof(float);
+
+    Buffer a{Buffer::allocator_type(dbot::HugePagePolicy::Transparent)};
+    Buffer b{Buffer::allocator_type(dbot::HugePagePolicy::Disabled)};
+    a.assign(count, 1.f);
+    b.assign(count, 2.f);
+
+    a.swap(b);
+
+    EXPECT_EQ(a.get_allocator().policy(), dbot::HugePagePolicy::Disabled);
+    EXPECT_EQ(b.get_allocator().policy(), dbot::HugePagePolicy::Transparent);
+    EXPECT_EQ(a[0], 2.f);
+    EXPECT_EQ(b[count - 1], 1.f);
+}
@@ -0,0 +1,208 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file impostor_atlas.cpp
+ * \date October 2016
+ */
+
+#include <dbot/impostor_atlas.h>
+#include <dbot/rigid_body_renderer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace dbot
+{
+namespace
+{
+const std::uint32_t impostor_magic = 0x64626931;  // "dbi1"
+}
+
+ImpostorAtlas::ImpostorAtlas(
+    const std::vector<std::vector<Eigen::Vector3d>>& vertices,
+    const std::vector<std::vector<std::vector<int>>>& indices,
+    int subdivisions,
+    int resolution)
+    : ImpostorAtlas(subdivisions, resolution)
+{
+    const int pixels = resolution_ * resolution_;
+    const double principal_point = (resolution_ - 1) / 2.;
+
+    depths_.resize(vertices.size() * count_views() * pixels);
+    std::vector<float> depth_image(pixels);
+
+    for (size_t part = 0; part < vertices.size(); ++part)
+    {
+        Eigen::Vector3d center = Eigen::Vector3d::Zero();
+        for (auto& vertex : vertices[part]) center += vertex;
+        center /= vertices[part].size();
+
+        double radius = 0;
+        for (auto& vertex : vertices[part])
+        {
+            radius = std::max(radius, (vertex - center).norm());
+        }
+
+        centers_.push_back(center);
+        radii_.push_back(radius);
+
+        // instances of one mesh share the views of its first part
+        const int source =
+            RigidBodyRenderer::identical_part(vertices, indices, part);
+        if (source != int(part))
+        {
+            const int stride = count_views() * pixels;
+            std::copy(depths_.begin() + source * stride,
+                      depths_.begin() + (source + 1) * stride,
+                      depths_.begin() + part * stride);
+            continue;
+        }
+
+        Eigen::Matrix3d camera_matrix = Eigen::Matrix3d::Identity();
+        camera_matrix(0, 0) = camera_matrix(1, 1) = reference_focal(part);
+        camera_matrix(0, 2) = camera_matrix(1, 2) = principal_point;
+
+        RigidBodyRenderer renderer(
+            std::vector<std::vector<Eigen::Vector3d>>(1, vertices[part]),
+            std::vector<std::vector<std::vector<int>>>(1, indices[part]));
+
+        for (int view = 0; view < count_views(); ++view)
+        {
+            RigidBodyRenderer::Affine pose;
+            pose.linear() = view_rotations_[view];
+            pose.translation() =
+                -view_rotations_[view] * center +
+                Eigen::Vector3d(0, 0, reference_distance(part));
+            renderer.set_poses(&pose, 1);
+            renderer.Render(
+                camera_matrix, resolution_, resolution_, depth_image.data());
+
+            std::uint16_t* depths =
+                &depths_[(part * count_views() + view) * pixels];
+            for (int i = 0; i < pixels; ++i)
+            {
+                double offset = depth_image[i] - reference_distance(part);
+                if (std::isinf(depth_image[i]) || radius == 0)
+                {
+                    depths[i] = Empty;
+                    continue;
+                }
+
+                double q =
+                    std::round((offset / radius + 1.) / 2. * (Empty - 1));
+                depths[i] = std::min<double>(std::max(q, 0.), Empty - 1);
+            }
+        }
+    }
+}
+
+ImpostorAtlas::ImpostorAtlas(int subdivisions, int resolution)
+    : views_(subdivisions), resolution_(resolution)
+{
+    // the reference camera looks at the part center along the inverse view
+    // direction
+    for (int view = 0; view < count_views(); ++view)
+    {
+        view_rotations_.push_back(look_at(-views_.direction(view)));
+    }
+}
+
+ImpostorAtlas ImpostorAtlas::load(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw ImpostorException(path + ": cannot open file");
+    }
+
+    std::uint32_t header[4];
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (!file || header[0] != impostor_magic)
+    {
+        throw ImpostorException(path + ": not an impostor atlas");
+    }
+
+    ImpostorAtlas atlas(header[1], header[2]);
+
+    const std::uint32_t parts = header[3];
+    atlas.centers_.resize(parts);
+    atlas.radii_.resize(parts);
+    for (std::uint32_t part = 0; part < parts; ++part)
+    {
+        file.read(reinterpret_cast<char*>(atlas.centers_[part].data()),
+                  3 * sizeof(double));
+        file.read(reinterpret_cast<char*>(&atlas.radii_[part]),
+                  sizeof(double));
+    }
+
+    atlas.depths_.resize(parts * atlas.count_views() * atlas.resolution_ *
+                         atlas.resolution_);
+    file.read(reinterpret_cast<char*>(atlas.depths_.data()),
+              atlas.depths_.size() * sizeof(std::uint16_t));
+    if (!file)
+    {
+        throw ImpostorException(path + ": truncated file");
+    }
+
+    return atlas;
+}
+
+void ImpostorAtlas::save(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::binary);
+
+    std::uint32_t header[4] = {impostor_magic,
+                               std::uint32_t(views_.subdivisions()),
+                               std::uint32_t(resolution_),
+                               std::uint32_t(count_parts())};
+    file.write(reinterpret_cast<const char*>(header), sizeof(header));
+    for (int part = 0; part < count_parts(); ++part)
+    {
+        file.write(reinterpret_cast<const char*>(centers_[part].data()),
+                   3 * sizeof(double));
+        file.write(reinterpret_cast<const char*>(&radii_[part]),
+                   sizeof(double));
+    }
+    file.write(reinterpret_cast<const char*>(depths_.data()),
+               depths_.size() * sizeof(std::uint16_t));
+
+    if (!file)
+    {
+        throw ImpostorException(path + ": cannot write file");
+    }
+}
+
+double ImpostorAtlas::reference_focal(int part) const
+{
+    // the part's bounding sphere, seen from the reference distance, fits
+    // into the view with a margin of one pixel
+    const double distance = reference_distance(part);
+    return ((resolution_ - 1) / 2. - 1.) * (distance - radii_[part]) /
+           radii_[part];
+}
+
+Eigen::Matrix3d ImpostorAtlas::look_at(const Eigen::Vector3d& axis)
+{
+    Eigen::Vector3d x = Eigen::Vector3d::UnitY().cross(axis);
+    if (x.norm() < 1e-6) x = Eigen::Vector3d::UnitX().cross(axis);
+    x.normalize();
+
+    Eigen::Matrix3d rotation;
+    rotation.row(0) = x;
+    rotation.row(1) = axis.cross(x);
+    rotation.row(2) = axis;
+    return rotation;
+}
+}
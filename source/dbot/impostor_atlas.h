@@ -0,0 +1,154 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file impostor_atlas.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <Eigen/Dense>
+#include <cstdint>
+#include <dbot/view_sphere.h>
+#include <exception>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace dbot
+{
+/**
+ * \brief The ImpostorException class
+ */
+class ImpostorException : public std::exception
+{
+public:
+    explicit ImpostorException(const std::string& message)
+        : message_("Impostor atlas: " + message)
+    {
+    }
+
+    const char* what() const noexcept { return message_.c_str(); }
+
+private:
+    std::string message_;
+};
+
+/**
+ * \brief Depth images of each part of a rigid object pre-rendered from the
+ *        directions of a geodesic view sphere.
+ *
+ * Every part is rendered from each view direction by a square reference
+ * camera looking at the part's center from a reference distance of several
+ * part radii. A view stores the depth relative to the reference distance,
+ * quantized to 16 bits over the part's depth range. The atlas is built once
+ * at load time or loaded from a file written by save().
+ */
+class ImpostorAtlas
+{
+public:
+    /**
+     * \param vertices      Vertices per part, as for RigidBodyRenderer
+     * \param indices       Triangles per part, as for RigidBodyRenderer
+     * \param subdivisions  Subdivisions of the icosahedron, 3 yields 642
+     *                      view directions about 8 degrees apart
+     * \param resolution    Width and height of a view in pixels
+     */
+    ImpostorAtlas(const std::vector<std::vector<Eigen::Vector3d>>& vertices,
+                  const std::vector<std::vector<std::vector<int>>>& indices,
+                  int subdivisions = 3,
+                  int resolution = 64);
+
+    /**
+     * \throws ImpostorException
+     */
+    static ImpostorAtlas load(const std::string& path);
+
+    /**
+     * \throws ImpostorException
+     */
+    void save(const std::string& path) const;
+
+    int count_parts() const { return centers_.size(); }
+    int count_views() const { return views_.count_directions(); }
+    int resolution() const { return resolution_; }
+
+    /**
+     * \brief Returns the view whose direction is closest to the given unit
+     *        direction from the part center towards the camera, expressed
+     *        in the part frame
+     */
+    int nearest_view(const Eigen::Vector3d& direction) const
+    {
+        return views_.nearest(direction);
+    }
+
+    /**
+     * \brief Rotation from the part frame into the reference camera frame of
+     *        the given view
+     */
+    const Eigen::Matrix3d& view_rotation(int view) const
+    {
+        return view_rotations_[view];
+    }
+
+    const Eigen::Vector3d& center(int part) const { return centers_[part]; }
+    double radius(int part) const { return radii_[part]; }
+    double reference_distance(int part) const { return 10. * radii_[part]; }
+
+    /**
+     * \brief Focal length of the reference camera of the given part in
+     *        pixels. The principal point is at the view center.
+     */
+    double reference_focal(int part) const;
+
+    /**
+     * \brief Returns the depth at the given view pixel relative to the
+     *        reference distance, or NaN if the part does not cover the pixel
+     */
+    float depth(int part, int view, int row, int col) const
+    {
+        std::uint16_t q = depths_[((part * count_views() + view) *
+                                   resolution_ + row) * resolution_ + col];
+        if (q == Empty) return std::numeric_limits<float>::quiet_NaN();
+
+        return (q * (2. / (Empty - 1)) - 1.) * radii_[part];
+    }
+
+    /**
+     * \brief Rotation whose third row is the given unit axis. Used for the
+     *        reference cameras and to align a camera with a viewing ray.
+     */
+    static Eigen::Matrix3d look_at(const Eigen::Vector3d& axis);
+
+private:
+    enum : std::uint16_t
+    {
+        Empty = 0xffff
+    };
+
+    ImpostorAtlas(int subdivisions, int resolution);
+
+private:
+    ViewSphere views_;
+    int resolution_;
+    std::vector<Eigen::Matrix3d> view_rotations_;
+
+    std::vector<Eigen::Vector3d> centers_;
+    std::vector<double> radii_;
+
+    // parts x views x resolution x resolution quantized depths
+    std::vector<std::uint16_t> depths_;
+};
+}
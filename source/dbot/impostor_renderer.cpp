@@ -0,0 +1,152 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file impostor_renderer.cpp
+ * \date October 2016
+ */
+
+#include <dbot/frame_arena.h>
+#include <dbot/impostor_renderer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace dbot
+{
+ImpostorRenderer::ImpostorRenderer(
+    const std::shared_ptr<const ImpostorAtlas>& atlas)
+    : atlas_(atlas)
+{
+}
+
+void ImpostorRenderer::set_poses(const Affine* poses, int count)
+{
+    R_.resize(count);
+    t_.resize(count);
+    for (int i = 0; i < count; i++)
+    {
+        R_[i] = poses[i].rotation();
+        t_[i] = poses[i].translation();
+    }
+}
+
+void ImpostorRenderer::Render(const Eigen::Matrix3d& camera_matrix,
+                              int n_rows,
+                              int n_cols,
+                              float* depth_image) const
+{
+    std::fill(depth_image,
+              depth_image + n_rows * n_cols,
+              std::numeric_limits<float>::infinity());
+
+    const double fx = camera_matrix(0, 0);
+    const double fy = camera_matrix(1, 1);
+    const double cx = camera_matrix(0, 2);
+    const double cy = camera_matrix(1, 2);
+    const int resolution = atlas_->resolution();
+    const double principal_point = (resolution - 1) / 2.;
+
+    for (int part = 0; part < int(R_.size()); ++part)
+    {
+        const Eigen::Vector3d center =
+            R_[part] * atlas_->center(part) + t_[part];
+        if (center(2) < 0.001) continue;
+
+        // pick the view closest to the ray from the part to the camera
+        const double distance = center.norm();
+        const Eigen::Vector3d ray = center / distance;
+        const int view = atlas_->nearest_view(R_[part].transpose() * -ray);
+
+        // in a camera frame aligned with the ray the part appears as the
+        // reference view rotated around the ray
+        const Eigen::Matrix3d roll = ImpostorAtlas::look_at(ray) * R_[part] *
+                                     atlas_->view_rotation(view).transpose();
+        const double angle = std::atan2(roll(1, 0), roll(0, 0));
+        const double cos_angle = std::cos(angle);
+        const double sin_angle = std::sin(angle);
+
+        // metric offsets at the part center to reference view pixels
+        const double view_scale =
+            atlas_->reference_focal(part) / atlas_->reference_distance(part);
+
+        const double center_col = fx * center(0) / center(2) + cx;
+        const double center_row = fy * center(1) / center(2) + cy;
+        const double radius = atlas_->radius(part);
+        const int min_col = std::max(
+            0, int(std::floor(center_col - fx * radius / center(2))));
+        const int max_col = std::min(
+            n_cols - 1, int(std::ceil(center_col + fx * radius / center(2))));
+        const int min_row = std::max(
+            0, int(std::floor(center_row - fy * radius / center(2))));
+        const int max_row = std::min(
+            n_rows - 1, int(std::ceil(center_row + fy * radius / center(2))));
+
+        for (int row = min_row; row <= max_row; ++row)
+        {
+            const double y = (row - center_row) * center(2) / fy;
+            for (int col = min_col; col <= max_col; ++col)
+            {
+                const double x = (col - center_col) * center(2) / fx;
+
+                const int view_col = std::lround(
+                    principal_point +
+                    (cos_angle * x + sin_angle * y) * view_scale);
+                const int view_row = std::lround(
+                    principal_point +
+                    (-sin_angle * x + cos_angle * y) * view_scale);
+                if (view_col < 0 || view_col >= resolution || view_row < 0 ||
+                    view_row >= resolution)
+                {
+                    continue;
+                }
+
+                const float offset =
+                    atlas_->depth(part, view, view_row, view_col);
+                if (std::isnan(offset)) continue;
+
+                float& depth = depth_image[row * n_cols + col];
+                depth = std::min(depth, float(center(2) + offset));
+            }
+        }
+    }
+}
+
+int ImpostorRenderer::Render(const Eigen::Matrix3d& camera_matrix,
+                             int n_rows,
+                             int n_cols,
+                             int* intersect_indices,
+                             float* depth) const
+{
+    FrameArena& arena = FrameArena::local();
+    FrameArena::Scope scope(arena);
+
+    float* depth_image = arena.allocate<float>(n_rows * n_cols);
+
+    Render(camera_matrix, n_rows, n_cols, depth_image);
+
+    int count = 0;
+    for (int i = 0; i < n_rows * n_cols; i++)
+    {
+        if (depth_image[i] != std::numeric_limits<float>::infinity())
+        {
+            intersect_indices[count] = i;
+            depth[count] = depth_image[i];
+            count++;
+        }
+    }
+
+    return count;
+}
+}
@@ -0,0 +1,76 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file impostor_renderer.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <Eigen/Dense>
+#include <dbot/impostor_atlas.h>
+#include <dbot/rigid_body_renderer.h>
+#include <memory>
+#include <vector>
+
+namespace dbot
+{
+/**
+ * \brief Approximate depth renderer drawing parts from an ImpostorAtlas.
+ *
+ * For each part the view nearest to the direction towards the camera is
+ * picked and warped into the image under a weak perspective: it is scaled
+ * by the distance of the part center, rotated in the image plane by the
+ * roll of the part around the viewing ray and offset in depth by the
+ * distance of the part center. The silhouette error is bounded by the
+ * angular spacing of the views. The interface mirrors RigidBodyRenderer.
+ */
+class ImpostorRenderer
+{
+public:
+    typedef RigidBodyRenderer::Affine Affine;
+
+    explicit ImpostorRenderer(
+        const std::shared_ptr<const ImpostorAtlas>& atlas);
+
+    void set_poses(const Affine* poses, int count);
+
+    /**
+     * \brief Renders the full depth image into a caller provided buffer of
+     *        n_rows * n_cols elements. Uncovered pixels are set to infinity.
+     */
+    void Render(const Eigen::Matrix3d& camera_matrix,
+                int n_rows,
+                int n_cols,
+                float* depth_image) const;
+
+    /**
+     * \brief Renders into caller provided buffers which must hold at least
+     *        n_rows * n_cols elements. Returns the number of pixels covered
+     *        by the object.
+     */
+    int Render(const Eigen::Matrix3d& camera_matrix,
+               int n_rows,
+               int n_cols,
+               int* intersect_indices,
+               float* depth) const;
+
+private:
+    std::shared_ptr<const ImpostorAtlas> atlas_;
+
+    // state
+    std::vector<Eigen::Matrix3d> R_;
+    std::vector<Eigen::Vector3d> t_;
+};
+}
@@ -0,0 +1,122 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file impostor_renderer_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include <dbot/impostor_renderer.h>
+#include <dbot/rigid_body_renderer.h>
+#include <dbot/test_meshes.h>
+
+class ImpostorRendererTests : public ::testing::Test
+{
+protected:
+    // box of 10 x 5 x 20 cm
+    ImpostorRendererTests()
+        : vertices_(1, dbot::box_vertices(0.05, 0.025, 0.1)),
+          indices_(1, dbot::box_indices())
+    {
+        camera_matrix_ << 300, 0, 80, 0, 300, 60, 0, 0, 1;
+    }
+
+    std::vector<std::vector<Eigen::Vector3d>> vertices_;
+    std::vector<std::vector<std::vector<int>>> indices_;
+    Eigen::Matrix3d camera_matrix_;
+};
+
+TEST_F(ImpostorRendererTests, geodesic_view_sphere)
+{
+    dbot::ImpostorAtlas atlas(vertices_, indices_, 2, 16);
+
+    EXPECT_EQ(atlas.count_parts(), 1);
+    EXPECT_EQ(atlas.count_views(), 162);
+    EXPECT_NEAR(atlas.radius(0), std::sqrt(0.013125), 1e-9);
+}
+
+TEST_F(ImpostorRendererTests, approximates_exact_rendering)
+{
+    auto atlas = std::make_shared<dbot::ImpostorAtlas>(vertices_, indices_);
+    dbot::RigidBodyRenderer exact(vertices_, indices_);
+    dbot::ImpostorRenderer approximate(atlas);
+
+    const int rows = 120, cols = 160;
+    std::vector<float> exact_depth(rows * cols), approximate_depth(rows * cols);
+
+    for (int k = 0; k < 5; ++k)
+    {
+        dbot::RigidBodyRenderer::Affine pose;
+        pose.linear() =
+            Eigen::AngleAxisd(
+                0.7 * k, Eigen::Vector3d(1, 2 * k - 3, 0.5 * k).normalized())
+                .toRotationMatrix();
+        pose.translation() =
+            Eigen::Vector3d(0.02 * k - 0.04, 0.01 * k, 0.8 + 0.1 * k);
+
+        exact.set_poses(&pose, 1);
+        approximate.set_poses(&pose, 1);
+        exact.Render(camera_matrix_, rows, cols, exact_depth.data());
+        approximate.Render(
+            camera_matrix_, rows, cols, approximate_depth.data());
+
+        int intersection = 0, in_union = 0;
+        double error = 0;
+        for (int i = 0; i < rows * cols; ++i)
+        {
+            bool a = !std::isinf(exact_depth[i]);
+            bool b = !std::isinf(approximate_depth[i]);
+            if (a || b) in_union++;
+            if (a && b)
+            {
+                intersection++;
+                error += std::fabs(exact_depth[i] - approximate_depth[i]);
+            }
+        }
+
+        EXPECT_GT(double(intersection) / in_union, 0.85);
+        EXPECT_LT(error / intersection, 0.01);
+    }
+}
+
+TEST_F(ImpostorRendererTests, save_and_load)
+{
+    dbot::ImpostorAtlas atlas(vertices_, indices_, 1, 16);
+
+    const std::string path = "impostor_renderer_test.bin";
+    atlas.save(path);
+    auto loaded = dbot::ImpostorAtlas::load(path);
+    std::remove(path.c_str());
+
+    ASSERT_EQ(loaded.count_views(), atlas.count_views());
+    EXPECT_DOUBLE_EQ(loaded.radius(0), atlas.radius(0));
+    for (int view = 0; view < atlas.count_views(); ++view)
+    {
+        for (int i = 0; i < 16; ++i)
+        {
+            float a = atlas.depth(0, view, i, 8);
+            float b = loaded.depth(0, view, i, 8);
+            EXPECT_TRUE(a == b || (std::isnan(a) && std::isnan(b)));
+        }
+    }
+
+    EXPECT_THROW(dbot::ImpostorAtlas::load("missing_impostors.bin"),
+                 dbot::ImpostorException);
+}
@@ -0,0 +1,201 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file background_model.cpp
+ * \date October 2016
+ */
+
+#include <dbot/model/background_model.h>
+
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+namespace dbot
+{
+namespace
+{
+const std::uint32_t background_magic = 0x64626731;  // "dbg1"
+}
+
+BackgroundModel::BackgroundModel(int pixel_count,
+                                 int learning_frames,
+                                 double match_sigmas,
+                                 double update_rate,
+                                 double min_sigma)
+    : learning_frames_(learning_frames),
+      frames_(0),
+      match_sigmas_(match_sigmas),
+      update_rate_(update_rate),
+      min_variance_(min_sigma * min_sigma),
+      mean_(pixel_count, 0.f),
+      variance_(pixel_count, 0.f),
+      counts_(pixel_count, 0)
+{
+    if (learning_frames_ <= 0) finish_learning();
+}
+
+BackgroundModel BackgroundModel::load(const std::string& path,
+                                      double match_sigmas,
+                                      double update_rate,
+                                      double min_sigma)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw BackgroundModelException(path + ": cannot open file");
+    }
+
+    std::uint32_t magic = 0, pixel_count = 0;
+    file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    file.read(reinterpret_cast<char*>(&pixel_count), sizeof(pixel_count));
+    if (!file || magic != background_magic)
+    {
+        throw BackgroundModelException(path + ": not a background model");
+    }
+
+    BackgroundModel model(
+        pixel_count, 0, match_sigmas, update_rate, min_sigma);
+    file.read(reinterpret_cast<char*>(model.mean_.data()),
+              pixel_count * sizeof(float));
+    file.read(reinterpret_cast<char*>(model.variance_.data()),
+              pixel_count * sizeof(float));
+    if (!file)
+    {
+        throw BackgroundModelException(path + ": truncated file");
+    }
+
+    return model;
+}
+
+void BackgroundModel::save(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::binary);
+    std::uint32_t pixel_count = count_pixels();
+
+    file.write(reinterpret_cast<const char*>(&background_magic),
+               sizeof(background_magic));
+    file.write(reinterpret_cast<const char*>(&pixel_count),
+               sizeof(pixel_count));
+    file.write(reinterpret_cast<const char*>(mean_.data()),
+               pixel_count * sizeof(float));
+    file.write(reinterpret_cast<const char*>(variance_.data()),
+               pixel_count * sizeof(float));
+
+    if (!file)
+    {
+        throw BackgroundModelException(path + ": cannot write file");
+    }
+}
+
+void BackgroundModel::update(const float* depth)
+{
+    const int pixel_count = count_pixels();
+
+    if (!learned())
+    {
+        // Welford's algorithm, variance_ holds the sum of squared deviations
+        for (int i = 0; i < pixel_count; ++i)
+        {
+            if (std::isnan(depth[i])) continue;
+
+            float delta = depth[i] - mean_[i];
+            mean_[i] += delta / ++counts_[i];
+            variance_[i] += delta * (depth[i] - mean_[i]);
+        }
+
+        if (++frames_ == learning_frames_) finish_learning();
+        return;
+    }
+
+    if (update_rate_ <= 0) return;
+
+    for (int i = 0; i < pixel_count; ++i)
+    {
+        if (!matches(i, depth[i])) continue;
+
+        float delta = depth[i] - mean_[i];
+        mean_[i] += update_rate_ * delta;
+        variance_[i] = std::max<float>(
+            (1 - update_rate_) * (variance_[i] + update_rate_ * delta * delta),
+            min_variance_);
+    }
+}
+
+void BackgroundModel::finish_learning()
+{
+    // pixels without at least two valid depths never match
+    for (int i = 0; i < count_pixels(); ++i)
+    {
+        if (counts_[i] < 2)
+        {
+            mean_[i] = std::numeric_limits<float>::quiet_NaN();
+            variance_[i] = std::numeric_limits<float>::infinity();
+        }
+        else
+        {
+            variance_[i] = std::max<float>(variance_[i] / (counts_[i] - 1),
+                                           min_variance_);
+        }
+    }
+
+    frames_ = learning_frames_;
+    counts_.clear();
+    counts_.shrink_to_fit();
+}
+
+bool BackgroundModel::learned() const
+{
+    return frames_ >= learning_frames_;
+}
+
+bool BackgroundModel::matches(int pixel, float depth) const
+{
+    if (!learned() || std::isnan(depth) || std::isnan(mean_[pixel]))
+    {
+        return false;
+    }
+
+    float delta = depth - mean_[pixel];
+    return delta * delta <=
+           match_sigmas_ * match_sigmas_ * variance_[pixel];
+}
+
+void BackgroundModel::front_limits(const float* depth, float* limits) const
+{
+    const float none = -std::numeric_limits<float>::infinity();
+
+    for (int i = 0; i < count_pixels(); ++i)
+    {
+        limits[i] = matches(i, depth[i])
+                        ? mean_[i] - match_sigmas_ * std::sqrt(variance_[i])
+                        : none;
+    }
+}
+
+int BackgroundModel::count_pixels() const
+{
+    return mean_.size();
+}
+
+float BackgroundModel::depth(int pixel) const
+{
+    return mean_[pixel];
+}
+
+float BackgroundModel::variance(int pixel) const
+{
+    return variance_[pixel];
+}
+}
@@ -0,0 +1,133 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file background_model.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <vector>
+
+namespace dbot
+{
+/**
+ * \brief The BackgroundModelException class
+ */
+class BackgroundModelException : public std::exception
+{
+public:
+    explicit BackgroundModelException(const std::string& message)
+        : message_("Background model: " + message)
+    {
+    }
+
+    const char* what() const noexcept { return message_.c_str(); }
+
+private:
+    std::string message_;
+};
+
+/**
+ * \brief Per pixel depth and variance of the static background of a fixed
+ *        camera.
+ *
+ * The model is either learned from the first frames, accumulating mean and
+ * variance of every pixel, or loaded from disk. Once learned, pixels which
+ * match the background keep adapting with an exponential moving average
+ * while pixels showing anything else are left untouched.
+ */
+class BackgroundModel
+{
+public:
+    /**
+     * \param pixel_count      Number of pixels of a frame
+     * \param learning_frames  Number of frames to learn from
+     * \param match_sigmas     A depth within this many standard deviations of
+     *                         the background depth matches the background
+     * \param update_rate      Weight of a new matching depth once learned,
+     *                         zero keeps the model fixed
+     * \param min_sigma        Lower bound of the standard deviation
+     */
+    BackgroundModel(int pixel_count,
+                    int learning_frames,
+                    double match_sigmas = 3.0,
+                    double update_rate = 0.0,
+                    double min_sigma = 0.005);
+
+    /**
+     * \brief Loads a model stored with save()
+     *
+     * \throws BackgroundModelException
+     */
+    static BackgroundModel load(const std::string& path,
+                                double match_sigmas = 3.0,
+                                double update_rate = 0.0,
+                                double min_sigma = 0.005);
+
+    /**
+     * \brief Stores depth and variance of a learned model
+     *
+     * \throws BackgroundModelException
+     */
+    void save(const std::string& path) const;
+
+    /**
+     * \brief Adds a frame of depth values, NaN for missing measurements.
+     *        While learning all valid depths are accumulated, afterwards only
+     *        those matching the background.
+     */
+    void update(const float* depth);
+
+    /**
+     * \brief Whether the learning frames have been seen
+     */
+    bool learned() const;
+
+    /**
+     * \brief Whether the depth of the given pixel matches the background
+     */
+    bool matches(int pixel, float depth) const;
+
+    /**
+     * \brief For every pixel matching the background, writes the smallest
+     *        depth still explained by the background, and -infinity for all
+     *        other pixels. A prediction in front of this depth contradicts
+     *        the observed background.
+     */
+    void front_limits(const float* depth, float* limits) const;
+
+    int count_pixels() const;
+    float depth(int pixel) const;
+    float variance(int pixel) const;
+
+private:
+    void finish_learning();
+
+private:
+    int learning_frames_;
+    int frames_;
+    double match_sigmas_;
+    double update_rate_;
+    double min_variance_;
+
+    std::vector<float> mean_;
+    std::vector<float> variance_;
+    // number of valid depths per pixel while learning
+    std::vector<std::uint32_t> counts_;
+};
+}
@@ -0,0 +1,109 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file background_model_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+#include <dbot/model/background_model.h>
+
+namespace
+{
+const float missing = std::numeric_limits<float>::quiet_NaN();
+}
+
+TEST(BackgroundModelTests, learns_mean_and_variance)
+{
+    dbot::BackgroundModel model(3, 4);
+
+    float frames[4][3] = {{1.00f, 2.f, missing},
+                          {1.02f, 2.f, missing},
+                          {0.98f, 2.f, 3.f},
+                          {1.00f, 2.f, missing}};
+    for (int i = 0; i < 4; ++i)
+    {
+        EXPECT_FALSE(model.learned());
+        model.update(frames[i]);
+    }
+    EXPECT_TRUE(model.learned());
+
+    EXPECT_NEAR(model.depth(0), 1.0f, 1e-6);
+    EXPECT_NEAR(model.variance(0), 0.0008f / 3, 1e-7);
+
+    // clamped to the minimum standard deviation
+    EXPECT_NEAR(model.variance(1), 0.005f * 0.005f, 1e-9);
+
+    // a single valid depth is not enough to learn a pixel
+    EXPECT_TRUE(std::isnan(model.depth(2)));
+    EXPECT_FALSE(model.matches(2, 3.f));
+}
+
+TEST(BackgroundModelTests, front_limits_mark_matching_pixels)
+{
+    dbot::BackgroundModel model(3, 2, 3.0, 0.0, 0.01);
+    float frame[3] = {1.f, 2.f, 3.f};
+    model.update(frame);
+    model.update(frame);
+
+    float observation[3] = {1.01f, 1.5f, missing};
+    float limits[3];
+    model.front_limits(observation, limits);
+
+    EXPECT_NEAR(limits[0], 0.97f, 1e-6);
+    EXPECT_TRUE(std::isinf(limits[1]) && limits[1] < 0);
+    EXPECT_TRUE(std::isinf(limits[2]) && limits[2] < 0);
+}
+
+TEST(BackgroundModelTests, updates_matching_pixels_only)
+{
+    dbot::BackgroundModel model(2, 2, 3.0, 0.5, 0.01);
+    float frame[2] = {1.f, 2.f};
+    model.update(frame);
+    model.update(frame);
+
+    float observation[2] = {1.01f, 1.f};
+    model.update(observation);
+
+    EXPECT_NEAR(model.depth(0), 1.005f, 1e-6);
+    EXPECT_FLOAT_EQ(model.depth(1), 2.f);
+}
+
+TEST(BackgroundModelTests, save_and_load)
+{
+    dbot::BackgroundModel model(2, 2, 3.0, 0.0, 0.01);
+    float frames[2][2] = {{1.f, 2.f}, {1.1f, missing}};
+    model.update(frames[0]);
+    model.update(frames[1]);
+
+    const std::string path = "background_model_test.bin";
+    model.save(path);
+    auto loaded = dbot::BackgroundModel::load(path);
+    std::remove(path.c_str());
+
+    EXPECT_TRUE(loaded.learned());
+    EXPECT_EQ(loaded.count_pixels(), 2);
+    EXPECT_FLOAT_EQ(loaded.depth(0), model.depth(0));
+    EXPECT_FLOAT_EQ(loaded.variance(0), model.variance(0));
+    EXPECT_TRUE(std::isnan(loaded.depth(1)));
+
+    EXPECT_THROW(dbot::BackgroundModel::load("missing_background.bin"),
+                 dbot::BackgroundModelException);
+}
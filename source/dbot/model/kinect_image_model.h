@@ -29,15 +29,28 @@
 #pragma once
 
 #include <Eigen/Core>
+#include <algorithm>
+#include <cmath>
+#include <dbot/cpu_kernels.h>
+#include <dbot/executor.h>
+#include <dbot/frame_arena.h>
+#include <dbot/huge_page_allocator.h>
+#include <dbot/impostor_renderer.h>
+#include <dbot/observation_context.h>
+#include <dbot/model/background_model.h>
 #include <dbot/model/kinect_pixel_model.h>
 #include <dbot/model/occlusion_model.h>
 #include <dbot/model/rao_blackwell_sensor.h>
+#include <dbot/model/scene_change_detector.h>
 #include <dbot/pose/free_floating_rigid_bodies_state.h>
 #include <dbot/pose/pose_vector.h>
 #include <dbot/rigid_body_renderer.h>
 #include <dbot/traits.h>
 #include <fl/util/assertions.hpp>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <type_traits>
 #include <vector>
 
 namespace dbot
@@ -69,6 +82,10 @@ struct Traits<KinectImageModel<Scalar, State, OBJECTS>>
  *
  * \ingroup distributions
  * \ingroup sensors
+ *
+ * \tparam Scalar  Precision of the pixel model evaluation, float or double.
+ *                 Depths and occlusions are single precision either way, the
+ *                 scores of the pixels of a particle are summed in fl::Real.
  */
 template <typename Scalar, typename State, int OBJECTS = -1>
 class KinectImageModel
@@ -86,9 +103,48 @@ public:
     typedef typename Base::StateArray StateArray;
     typedef typename Base::RealArray RealArray;
     typedef typename Base::IntArray IntArray;
+    typedef typename Base::RealPartArray RealPartArray;
+    typedef typename Base::Snapshot Snapshot;
 
     typedef typename Eigen::Transform<fl::Real, 3, Eigen::Affine> Affine;
 
+    /**
+     * \brief Observation and occlusion rows a range of particles is evaluated
+     *        against. Rows of the current buffers are addressed by the
+     *        particle's parent index, rows of the new buffers by the particle
+     *        index. The new buffers are only written on update. The
+     *        occluder depths and the background limits and scores are
+     *        optional and may be null. The probabilities of the
+     *        observations given an infinitely distant object are computed
+     *        from the observations if null.
+     */
+    struct ParticleBuffers
+    {
+        const float* observations;
+        double observation_time;
+        const float* occlusions;
+        const double* occlusion_times;
+        float* new_occlusions;
+        double* new_occlusion_times;
+        const float* occluder_depths = nullptr;
+        const float* background_limits = nullptr;
+        const float* background_scores = nullptr;
+        const float* infinities = nullptr;
+    };
+
+    /**
+     * \brief Pixels scored by the last evaluation, over all particles
+     */
+    struct PixelStatistics
+    {
+        // pixels covered by the object
+        long pixels = 0;
+        // pixels without a valid observation
+        long invalid = 0;
+        // pixels pruned as confidently occluded
+        long occluded = 0;
+    };
+
     // TODO: DO WE NEED ALL OF THIS IN THE CONSTRUCTOR??
     KinectImageModel(const Eigen::Matrix3d& camera_matrix,
                      const size_t& n_rows,
@@ -105,162 +161,1390 @@ public:
           object_model_(object_renderer),
           sensor_(sensor),
           occlusion_transition_(occlusion_transition),
+          rows_pending_(false),
+          context_infinities_(nullptr),
           observation_time_(0),
+          huge_pages_(HugePagePolicy::Disabled),
+          occluded_threshold_(std::numeric_limits<double>::infinity()),
+          tile_rows_(0),
+          keep_fraction_(1.0),
+          observation_changed_(true),
           Base(delta_time)
     {
         static_assert_base(State, dbot::RigidBodiesState<OBJECTS>);
+        static_assert(std::is_same<Scalar, float>::value ||
+                          std::is_same<Scalar, double>::value,
+                      "The pixel model is evaluated in float or double");
 
         this->default_poses_.recount(object_model_->vertices().size());
         this->default_poses_.setZero();
 
+        Workspace workspace;
+        workspace.renderer = object_model_;
+        workspace.pixel_model = sensor_;
+        workspace.occlusion_model = occlusion_transition_;
+        workspace.node = 0;
+        workspaces_.push_back(workspace);
+
         reset();
     }
 
     virtual ~KinectImageModel() noexcept {}
+
+    using Base::loglikes;
+
     RealArray loglikes(const StateArray& deltas,
                        IntArray& indices,
                        const bool& update = false)
     {
-        std::vector<std::vector<float>> new_occlusions(deltas.size());
-        std::vector<std::vector<double>> new_occlusion_times(deltas.size());
+        RealArray log_likes(deltas.size());
+        loglikes(deltas, indices, log_likes, update);
+        return log_likes;
+    }
 
-        RealArray log_likes = RealArray::Zero(deltas.size());
-        for (size_t i_state = 0; i_state < size_t(deltas.size()); i_state++)
+    void loglikes(const StateArray& deltas,
+                  IntArray& indices,
+                  Eigen::Ref<RealArray> log_likes,
+                  const bool& update)
+    {
+        compute_loglikes(deltas, indices, log_likes, nullptr, update);
+    }
+
+    bool has_part_loglikes() const { return true; }
+
+    /**
+     * \brief Evaluates the particles as above and attributes every pixel to
+     *        the part rendered closest to the camera. The impostor prefilter
+     *        is not applied since the impostors do not resolve the parts.
+     */
+    void loglikes(const StateArray& deltas,
+                  IntArray& indices,
+                  Eigen::Ref<RealArray> log_likes,
+                  RealPartArray& part_log_likes,
+                  const bool& update)
+    {
+        part_log_likes.setZero(deltas.size(), this->default_poses_.count());
+        compute_loglikes(deltas, indices, log_likes, &part_log_likes, update);
+    }
+
+    /**
+     * \brief Re-scores one part of the particles after only this part moved
+     *        since the previous evaluation, as in the sampling blocks of the
+     *        coordinate particle filter. All parts are rendered, such that
+     *        they occlude each other, but only the pixels of the given part
+     *        are scored. Its column of part_log_likes is overwritten, the
+     *        other columns keep the pixels of their last evaluation.
+     *
+     * Pixels of other parts change their part if the moved part covers or
+     * uncovers them. All columns of a particle are therefore overwritten if
+     * the extent of the moved part in the image meets that of another part
+     * before or after the move, or if other parts moved since the last
+     * evaluation of the particle, see attribution_changed().
+     *
+     * The occlusions of the scored pixels are updated in pending rows, which
+     * are copied from the particles' rows by the first call after
+     * set_observation() and replace the occlusion state with update. The
+     * occlusion rows thereby follow the particles and not their parts.
+     */
+    void part_loglikes(const StateArray& deltas,
+                       IntArray& indices,
+                       int part,
+                       RealPartArray& part_log_likes,
+                       const bool& update)
+    {
+        part_log_likes.col(part).setZero();
+        RealArray log_likes(deltas.size());
+        compute_loglikes(
+            deltas, indices, log_likes, &part_log_likes, update, part);
+    }
+
+    /**
+     * \brief Evaluates the particles against buffers owned by the caller
+     *        instead of the model's own occlusion state, which is left
+     *        untouched. The particles are evaluated on the calling thread.
+     */
+    void loglikes(const StateArray& deltas,
+                  const IntArray& indices,
+                  const ParticleBuffers& buffers,
+                  bool update,
+                  Eigen::Ref<RealArray> log_likes)
+    {
+        loglikes(deltas,
+                 indices,
+                 0,
+                 deltas.size(),
+                 update,
+                 buffers,
+                 workspaces_[0],
+                 log_likes);
+    }
+
+    /**
+     * \brief Evaluates the particles in parallel on the workers of the given
+     *        executor. Each worker processes a contiguous range of particles
+     *        and owns the occlusion rows of these particles. If the workers
+     *        are spread over several NUMA nodes, every node receives its own
+     *        copy of the observation.
+     */
+    void set_executor(const std::shared_ptr<Executor>& executor)
+    {
+        executor_ = executor;
+
+        // the models keep conditioning state, hence each worker needs its
+        // own instances
+        workspaces_.clear();
+        for (int worker = 0; worker < executor_->count_workers(); ++worker)
+        {
+            Workspace workspace;
+            workspace.renderer =
+                std::make_shared<RigidBodyRenderer>(*object_model_);
+            workspace.pixel_model = std::make_shared<KinectPixelModel>(*sensor_);
+            workspace.occlusion_model =
+                std::make_shared<OcclusionModel>(*occlusion_transition_);
+            workspace.node = executor_->node(worker);
+            if (impostors_)
+            {
+                workspace.impostor_renderer =
+                    std::make_shared<ImpostorRenderer>(impostors_);
+            }
+            workspaces_.push_back(workspace);
+        }
+
+        node_observations_.clear();
+        if (executor_->count_nodes() > 1)
+        {
+            node_observations_.assign(
+                executor_->count_nodes(),
+                ObservationBuffer(
+                    typename ObservationBuffer::allocator_type(huge_pages_)));
+            distribute_observation();
+        }
+    }
+
+    /**
+     * \brief Prunes covered pixels whose predicted occlusion probability is
+     *        at least the given threshold. Their object is hidden for all
+     *        practical purposes, hence they receive the cheap approximation
+     *        KinectPixelModel::occluded_loglike() instead of the full pixel
+     *        model. Their occlusion is not updated but left to decay by the
+     *        occlusion transition until they are evaluated again. A
+     *        threshold above one disables the pruning, the default.
+     */
+    void set_occlusion_pruning(double occluded_threshold)
+    {
+        occluded_threshold_ = occluded_threshold;
+    }
+
+    /**
+     * \brief Returns the pixel counts of the last evaluation, from which the
+     *        pruned fraction follows
+     */
+    PixelStatistics pixel_statistics() const
+    {
+        PixelStatistics statistics;
+        for (const auto& workspace : workspaces_)
+        {
+            statistics.pixels += workspace.statistics.pixels;
+            statistics.invalid += workspace.statistics.invalid;
+            statistics.occluded += workspace.statistics.occluded;
+        }
+        return statistics;
+    }
+
+    /**
+     * \brief Splits the exact evaluation of each particle into tiles of the
+     *        given number of image rows, which the workers of the executor
+     *        render and score in parallel. This lowers the latency of few
+     *        particles on large images, where distributing the particles
+     *        leaves workers idle. Zero distributes the particles.
+     */
+    void set_tile_rows(int tile_rows) { tile_rows_ = tile_rows; }
+
+    /**
+     * \brief Enables a prefilter which scores all particles with depth
+     *        impostors first. Only the given fraction of particles with the
+     *        highest approximate scores is rendered exactly. The others keep
+     *        their approximate score, offset by the mean difference between
+     *        the exact and approximate scores of the kept particles and
+     *        capped at the lowest exact score, such that impostor error
+     *        cannot rank a rejected particle above a kept one.
+     */
+    void set_impostor_prefilter(
+        const std::shared_ptr<const ImpostorAtlas>& impostors,
+        double keep_fraction)
+    {
+        impostors_ = impostors;
+        keep_fraction_ = keep_fraction;
+
+        for (auto& workspace : workspaces_)
+        {
+            workspace.impostor_renderer =
+                std::make_shared<ImpostorRenderer>(impostors_);
+        }
+    }
+
+    /**
+     * \brief Sets the page backing of the occlusion and observation buffers.
+     *        Existing contents are preserved.
+     */
+    void set_huge_page_policy(HugePagePolicy policy)
+    {
+        huge_pages_ = policy;
+
+        OcclusionBuffer occlusions(
+            occlusions_.begin(),
+            occlusions_.end(),
+            typename OcclusionBuffer::allocator_type(policy));
+        occlusions_.swap(occlusions);
+
+        OcclusionTimeBuffer occlusion_times(
+            occlusion_times_.begin(),
+            occlusion_times_.end(),
+            typename OcclusionTimeBuffer::allocator_type(policy));
+        occlusion_times_.swap(occlusion_times);
+
+        new_occlusions_ =
+            OcclusionBuffer(typename OcclusionBuffer::allocator_type(policy));
+        new_occlusion_times_ = OcclusionTimeBuffer(
+            typename OcclusionTimeBuffer::allocator_type(policy));
+
+        ObservationBuffer observations(
+            observations_.begin(),
+            observations_.end(),
+            typename ObservationBuffer::allocator_type(policy));
+        observations_.swap(observations);
+
+        for (auto& node_observations : node_observations_)
         {
-            if (update)
+            node_observations = ObservationBuffer(
+                typename ObservationBuffer::allocator_type(policy));
+        }
+        distribute_observation();
+    }
+
+    /**
+     * \brief Sets a model of the static scene background. A pixel observing
+     *        the background is not explained by a particle rendering the
+     *        object in front of it. Such a pixel receives a per frame
+     *        constant score and keeps its occlusion state instead of being
+     *        evaluated by the pixel and occlusion models. The background
+     *        model is updated with every observation.
+     */
+    void set_background_model(const std::shared_ptr<BackgroundModel>& model)
+    {
+        assert(model->count_pixels() == int(n_rows_ * n_cols_));
+
+        background_ = model;
+        background_limits_.clear();
+        background_scores_.clear();
+    }
+
+    /**
+     * \brief Sets the meshes of occluders whose poses are known, e.g. from
+     *        the kinematics of a robot arm, one body per occluder. A pixel
+     *        where the object is rendered behind an occluder is occluded
+     *        with certainty. It is skipped in the evaluation and in the
+     *        occlusion update.
+     */
+    void set_occluders(const ObjectRendererPtr& occluders)
+    {
+        occluders_ = occluders;
+        occluder_depths_.clear();
+    }
+
+    /**
+     * \brief Renders the occluders at the given poses into the occluder
+     *        depth layer shared by all particles, which applies from the
+     *        next frame on. Called for every frame in which they move.
+     *        Ignored without occluders.
+     */
+    void set_occluder_poses(const std::vector<RigidBodyRenderer::Affine>& poses)
+    {
+        if (!occluders_) return;
+
+        occluders_->set_poses(poses);
+        occluder_depths_.resize(n_rows_ * n_cols_);
+        occluders_->Render(
+            camera_matrix_, n_rows_, n_cols_, occluder_depths_.data());
+    }
+
+    /**
+     * \brief Sets a detector which compares every observation to the last
+     *        changed one around the object rendered at the integrated poses.
+     *        Without a detector every observation counts as changed.
+     */
+    void set_change_detector(
+        const std::shared_ptr<SceneChangeDetector>& detector)
+    {
+        change_detector_ = detector;
+        observation_changed_ = true;
+    }
+
+    bool observation_changed() const { return observation_changed_; }
+
+    void set_observation(const Observation& image)
+    {
+        assert(image.rows() == image.size());
+        assert(image.cols() == 1);
+
+        context_.reset();
+        observations_.resize(image.size());
+        convert_depth(image.data(), observations_.data(), image.size());
+        infinities_.resize(image.size());
+        sensor_->infinity_probs(
+            observations_.data(), image.size(), infinities_.data());
+
+        observe();
+    }
+
+    /**
+     * \brief Reads the observation and its infinity probabilities from the
+     *        shared context instead of copying and computing them. The
+     *        probabilities are computed here only if the pixel model did not
+     *        subscribe to the source of the context.
+     */
+    void set_observation_context(
+        const std::shared_ptr<const ObservationContext>& context)
+    {
+        assert(size_t(context->size()) == n_rows_ * n_cols_);
+
+        context_ = context;
+        context_infinities_ = context->infinities(sensor_->parameters());
+        if (!context_infinities_)
+        {
+            infinities_.resize(context->size());
+            sensor_->infinity_probs(
+                context->depth(), context->size(), infinities_.data());
+        }
+
+        observe();
+    }
+
+    void subscribe(ObservationSource& source) const
+    {
+        ObservationRequirements requirements;
+        requirements.pixel_models.push_back(sensor_->parameters());
+        source.subscribe(requirements);
+    }
+
+    virtual void reset()
+    {
+        occlusions_.assign(n_rows_ * n_cols_, initial_occlusion_);
+        occlusion_times_.assign(n_rows_ * n_cols_, 0);
+        observation_time_ = 0;
+        rows_pending_ = false;
+
+        if (change_detector_) change_detector_->reset();
+        observation_changed_ = true;
+    }
+
+    Snapshot snapshot() const
+    {
+        Snapshot snapshot;
+        snapshot.occlusions.assign(occlusions_.begin(), occlusions_.end());
+        snapshot.occlusion_times.assign(occlusion_times_.begin(),
+                                        occlusion_times_.end());
+        snapshot.observation_time = observation_time_;
+        return snapshot;
+    }
+
+    void restore(const Snapshot& snapshot)
+    {
+        if (snapshot.occlusions.empty()) return;
+
+        occlusions_.assign(snapshot.occlusions.begin(),
+                           snapshot.occlusions.end());
+        occlusion_times_.assign(snapshot.occlusion_times.begin(),
+                                snapshot.occlusion_times.end());
+        observation_time_ = snapshot.observation_time;
+        rows_pending_ = false;
+    }
+
+    // TODO: TYPES
+    const std::vector<float> Occlusions(size_t index) const
+    {
+        return std::vector<float>(
+            occlusions_.begin() + index * n_rows_ * n_cols_,
+            occlusions_.begin() + (index + 1) * n_rows_ * n_cols_);
+    }
+
+private:
+    typedef std::vector<float, HugePageAllocator<float>> OcclusionBuffer;
+    typedef std::vector<double, HugePageAllocator<double>> OcclusionTimeBuffer;
+    typedef std::vector<float, HugePageAllocator<float>> ObservationBuffer;
+
+    /**
+     * \brief Models and scratch state used by one worker
+     */
+    struct Workspace
+    {
+        ObjectRendererPtr renderer;
+        PixelSensorPtr pixel_model;
+        OcclusionModelPtr occlusion_model;
+        std::shared_ptr<ImpostorRenderer> impostor_renderer;
+        int node;
+        PixelStatistics statistics;
+    };
+
+    /**
+     * \brief Approximate scores of the prefilter pass. Particles scoring
+     *        below the threshold keep their approximate score in the exact
+     *        pass until calibrate_rejected() adjusts it.
+     */
+    struct Prefilter
+    {
+        const fl::Real* scores;
+        fl::Real threshold;
+    };
+
+    /**
+     * \brief Evaluates the particles against the model's own buffers and
+     *        advances the occlusion state on update. The part contributions
+     *        are computed if part_log_likes is given, only those of the
+     *        given part if it is not negative. The evaluation of a part
+     *        writes the occlusions of its pixels to the pending update
+     *        rows, see part_loglikes().
+     */
+    void compute_loglikes(const StateArray& deltas,
+                          IntArray& indices,
+                          Eigen::Ref<RealArray> log_likes,
+                          RealPartArray* part_log_likes,
+                          bool update,
+                          int part = -1)
+    {
+        for (auto& workspace : workspaces_)
+        {
+            workspace.statistics = PixelStatistics();
+        }
+
+        if (update || part >= 0)
+        {
+            // the update buffers are overwritten entirely by the workers
+            // owning the particles. They are not initialized here such that
+            // their pages are first touched by the owning workers
+            const size_t size = deltas.size() * n_rows_ * n_cols_;
+            if (new_occlusions_.size() != size)
+            {
+                new_occlusions_ = OcclusionBuffer(
+                    typename OcclusionBuffer::allocator_type(huge_pages_));
+                new_occlusions_.resize(size);
+                new_occlusion_times_ = OcclusionTimeBuffer(
+                    typename OcclusionTimeBuffer::allocator_type(huge_pages_));
+                new_occlusion_times_.resize(size);
+            }
+        }
+
+        if (part_log_likes) prepare_attribution(deltas.size());
+
+        if (impostors_ && !part_log_likes)
+        {
+            // score all particles approximately, then render only the best
+            // fraction exactly
+            RealArray approximate_log_likes(deltas.size());
+            evaluate(deltas,
+                     indices,
+                     false,
+                     true,
+                     nullptr,
+                     approximate_log_likes);
+
+            Prefilter prefilter;
+            prefilter.scores = approximate_log_likes.data();
+            prefilter.threshold = prefilter_threshold(approximate_log_likes);
+            evaluate(deltas, indices, update, false, &prefilter, log_likes);
+            calibrate_rejected(prefilter, log_likes);
+        }
+        else
+        {
+            evaluate(deltas,
+                     indices,
+                     update,
+                     false,
+                     nullptr,
+                     log_likes,
+                     part_log_likes,
+                     part);
+        }
+
+        rows_pending_ = part >= 0 && !update;
+        if (update)
+        {
+            // the previous occlusion buffers are kept for the next update
+            occlusions_.swap(new_occlusions_);
+            occlusion_times_.swap(new_occlusion_times_);
+            for (size_t i_state = 0; i_state < indices.size(); i_state++)
+                indices[i_state] = i_state;
+        }
+    }
+
+    /**
+     * \brief Evaluates all particles against the model's own buffers, in
+     *        parallel if an executor is set. The exact pass is split into
+     *        tiles if tile rows are set. Only the pixels of the given part
+     *        are scored if it is not negative.
+     */
+    void evaluate(const StateArray& deltas,
+                  const IntArray& indices,
+                  bool update,
+                  bool approximate,
+                  const Prefilter* prefilter,
+                  Eigen::Ref<RealArray> log_likes,
+                  RealPartArray* part_log_likes = nullptr,
+                  int part = -1)
+    {
+        if (executor_ && tile_rows_ > 0 && !approximate)
+        {
+            evaluate_tiled(deltas,
+                           indices,
+                           update,
+                           prefilter,
+                           log_likes,
+                           part_log_likes,
+                           part);
+        }
+        else if (executor_)
+        {
+            executor_->run([&](int worker) {
+                int begin, end;
+                executor_->partition(deltas.size(), worker, begin, end);
+                loglikes(deltas,
+                         indices,
+                         begin,
+                         end,
+                         update,
+                         buffers(workspaces_[worker].node),
+                         workspaces_[worker],
+                         log_likes,
+                         approximate,
+                         prefilter,
+                         part_log_likes,
+                         part);
+            });
+        }
+        else
+        {
+            loglikes(deltas,
+                     indices,
+                     0,
+                     deltas.size(),
+                     update,
+                     buffers(0),
+                     workspaces_[0],
+                     log_likes,
+                     approximate,
+                     prefilter,
+                     part_log_likes,
+                     part);
+        }
+    }
+
+    /**
+     * \brief Moves the approximate scores of the rejected particles onto the
+     *        scale of the exact ones: each is offset by the mean difference
+     *        between the exact and approximate scores of the kept particles
+     *        and capped at the lowest exact score
+     */
+    void calibrate_rejected(const Prefilter& prefilter,
+                            Eigen::Ref<RealArray> log_likes) const
+    {
+        fl::Real gap = 0;
+        fl::Real lowest = std::numeric_limits<fl::Real>::infinity();
+        int kept = 0;
+        for (int i = 0; i < log_likes.size(); ++i)
+        {
+            if (prefilter.scores[i] < prefilter.threshold) continue;
+
+            gap += log_likes[i] - prefilter.scores[i];
+            lowest = std::min(lowest, log_likes[i]);
+            kept++;
+        }
+        gap /= kept;
+
+        for (int i = 0; i < log_likes.size(); ++i)
+        {
+            if (prefilter.scores[i] >= prefilter.threshold) continue;
+
+            log_likes[i] = std::min(prefilter.scores[i] + gap, lowest);
+        }
+    }
+
+    /**
+     * \brief Returns the lowest approximate score among the kept fraction
+     */
+    fl::Real prefilter_threshold(const RealArray& scores) const
+    {
+        const int count = scores.size();
+        const int kept = std::min(
+            count, std::max(1, int(std::ceil(keep_fraction_ * count))));
+
+        std::vector<fl::Real> sorted(scores.data(), scores.data() + count);
+        std::nth_element(sorted.begin(),
+                         sorted.begin() + (kept - 1),
+                         sorted.end(),
+                         std::greater<fl::Real>());
+        return sorted[kept - 1];
+    }
+
+    /**
+     * \brief Returns the model's own buffers as seen from the given node
+     */
+    ParticleBuffers buffers(int node)
+    {
+        ParticleBuffers buffers;
+        buffers.observations = node_observations_.empty()
+                                   ? observed()
+                                   : node_observations_[node].data();
+        buffers.observation_time = observation_time_;
+        buffers.occlusions = occlusions_.data();
+        buffers.occlusion_times = occlusion_times_.data();
+        buffers.new_occlusions = new_occlusions_.data();
+        buffers.new_occlusion_times = new_occlusion_times_.data();
+        buffers.infinities = observed_infinities();
+        if (!occluder_depths_.empty())
+        {
+            buffers.occluder_depths = occluder_depths_.data();
+        }
+        if (!background_limits_.empty())
+        {
+            buffers.background_limits = background_limits_.data();
+            buffers.background_scores = background_scores_.data();
+        }
+        return buffers;
+    }
+
+    /**
+     * \brief Evaluates the particles [begin, end) against the given buffers
+     *        using the given workspace. The approximate pass renders with
+     *        the impostors of the workspace. If part_log_likes is given, each
+     *        pixel's score is also added to the row of the particle in the
+     *        column of the part rendered at the pixel. If the given part is
+     *        not negative, only its pixels are scored.
+     */
+    void loglikes(const StateArray& deltas,
+                  const IntArray& indices,
+                  int begin,
+                  int end,
+                  bool update,
+                  const ParticleBuffers& buffers,
+                  Workspace& workspace,
+                  Eigen::Ref<RealArray> log_likes,
+                  bool approximate = false,
+                  const Prefilter* prefilter = nullptr,
+                  RealPartArray* part_log_likes = nullptr,
+                  int part = -1)
+    {
+        // all temporaries of this call are drawn from the frame arena of the
+        // calling thread and released on return
+        FrameArena& arena = FrameArena::local();
+        FrameArena::Scope scope(arena);
+
+        const size_t n_pixels = n_rows_ * n_cols_;
+        int* intersect_indices = arena.allocate<int>(n_pixels);
+        float* predictions = arena.allocate<float>(n_pixels);
+        int* parts =
+            part_log_likes ? arena.allocate<int>(n_pixels) : nullptr;
+
+        RigidBodyRenderer& renderer = *workspace.renderer;
+
+        for (size_t i_state = begin; i_state < size_t(end); i_state++)
+        {
+            FrameArena::Scope particle_scope(arena);
+
+            const float* occlusions =
+                buffers.occlusions + indices[i_state] * n_pixels;
+            const double* occlusion_times =
+                buffers.occlusion_times + indices[i_state] * n_pixels;
+            float* new_occlusions = nullptr;
+            double* new_occlusion_times = nullptr;
+
+            if (update || part >= 0)
+            {
+                new_occlusions = buffers.new_occlusions + i_state * n_pixels;
+                new_occlusion_times =
+                    buffers.new_occlusion_times + i_state * n_pixels;
+                if (part < 0 || !rows_pending_)
+                {
+                    std::copy(
+                        occlusions, occlusions + n_pixels, new_occlusions);
+                    std::copy(occlusion_times,
+                              occlusion_times + n_pixels,
+                              new_occlusion_times);
+                }
+            }
+
+            if (prefilter &&
+                prefilter->scores[i_state] < prefilter->threshold)
             {
-                new_occlusions[i_state] = occlusions_[indices[i_state]];
-                new_occlusion_times[i_state] =
-                    occlusion_times_[indices[i_state]];
+                log_likes[i_state] = prefilter->scores[i_state];
+                continue;
             }
 
             // render the object model -----------------------------------------
             int body_count = deltas[i_state].count();
-            std::vector<Affine> poses(body_count);
-            for (size_t i_obj = 0; i_obj < body_count; i_obj++)
+            Affine* poses = arena.create<Affine>(body_count);
+            particle_poses(deltas[i_state], poses);
+            int intersect_count;
+            if (approximate)
+            {
+                ImpostorRenderer& impostors = *workspace.impostor_renderer;
+                impostors.set_poses(poses, body_count);
+                intersect_count = impostors.Render(camera_matrix_,
+                                                   n_rows_,
+                                                   n_cols_,
+                                                   intersect_indices,
+                                                   predictions);
+            }
+            else
+            {
+                renderer.set_poses(poses, body_count);
+                intersect_count = renderer.Render(camera_matrix_,
+                                                  n_rows_,
+                                                  n_cols_,
+                                                  intersect_indices,
+                                                  predictions,
+                                                  parts);
+            }
+            if (parts)
             {
-                auto pose_0 = this->default_poses_.component(i_obj);
-                auto delta = deltas[i_state].component(i_obj);
+                int* extents = arena.allocate<int>(4 * body_count);
+                part_extents(intersect_count,
+                             intersect_indices,
+                             parts,
+                             body_count,
+                             extents);
+                if (!attribution_changed(
+                        i_state, deltas[i_state], part, extents))
+                {
+                    intersect_count = select_part(part,
+                                                  intersect_count,
+                                                  intersect_indices,
+                                                  predictions,
+                                                  parts);
+                }
+                else if (part >= 0)
+                {
+                    part_log_likes->row(i_state).setZero();
+                }
+            }
 
-                dbot::PoseVector pose;
+            log_likes[i_state] = score(intersect_count,
+                                       intersect_indices,
+                                       predictions,
+                                       parts,
+                                       buffers,
+                                       occlusions,
+                                       occlusion_times,
+                                       new_occlusions,
+                                       new_occlusion_times,
+                                       workspace,
+                                       part_log_likes,
+                                       i_state);
+        }
+    }
+
+    /**
+     * \brief Evaluates the particles one after another. Each particle is
+     *        split into tiles of tile_rows_ image rows which the workers
+     *        render and score. The tile scores are summed in tile order,
+     *        hence the result does not depend on the number of workers.
+     */
+    void evaluate_tiled(const StateArray& deltas,
+                        const IntArray& indices,
+                        bool update,
+                        const Prefilter* prefilter,
+                        Eigen::Ref<RealArray> log_likes,
+                        RealPartArray* part_log_likes,
+                        int part)
+    {
+        FrameArena& arena = FrameArena::local();
+        FrameArena::Scope scope(arena);
+
+        const size_t n_pixels = n_rows_ * n_cols_;
+        float* predictions = arena.allocate<float>(n_pixels);
+        int* parts = part_log_likes ? arena.allocate<int>(n_pixels) : nullptr;
 
-                /// \todo: this should be done through the the apply_delta
-                /// function
-                pose.position() =
-                    pose_0.orientation().rotation_matrix() * delta.position() +
-                    pose_0.position();
-                pose.orientation() = pose_0.orientation() * delta.orientation();
+        const int body_count = this->default_poses_.count();
+        RigidBodyRenderer& renderer = *object_model_;
 
-                poses[i_obj] = pose.affine();
+        for (size_t i_state = 0; i_state < size_t(deltas.size()); i_state++)
+        {
+            FrameArena::Scope particle_scope(arena);
+
+            const bool skipped =
+                prefilter &&
+                prefilter->scores[i_state] < prefilter->threshold;
+            if (!skipped)
+            {
+                Affine* poses = arena.create<Affine>(body_count);
+                particle_poses(deltas[i_state], poses);
+                renderer.set_poses(poses, body_count);
+                renderer.bin(
+                    camera_matrix_, n_rows_, n_cols_, tile_rows_, tiles_);
             }
-            object_model_->set_poses(poses);
-            std::vector<int> intersect_indices;
-            std::vector<float> predictions;
-            object_model_->Render(camera_matrix_,
-                                  n_rows_,
-                                  n_cols_,
-                                  intersect_indices,
-                                  predictions);
-
-            // compute likelihoods ---------------------------------------------
-            for (size_t i = 0; i < size_t(predictions.size()); i++)
+
+            const int tile_count = (n_rows_ + tile_rows_ - 1) / tile_rows_;
+            tile_log_likes_.assign(tile_count, 0);
+            if (part_log_likes)
             {
-                if (std::isnan(observations_[intersect_indices[i]]))
+                tile_part_log_likes_.setZero(tile_count, body_count);
+            }
+
+            // the parts are attributed once all tiles are rendered, then
+            // only the pixels of the selected part are scored
+            int selected = -1;
+            if (parts && !skipped)
+            {
+                executor_->run([&](int worker) {
+                    for (int tile = worker; tile < tile_count;
+                         tile += executor_->count_workers())
+                    {
+                        renderer.render_tile(tiles_, tile, predictions, parts);
+                    }
+                });
+
+                int* extents = arena.allocate<int>(4 * body_count);
+                image_part_extents(predictions, parts, body_count, extents);
+                if (!attribution_changed(
+                        i_state, deltas[i_state], part, extents))
                 {
-                    log_likes[i_state] += log(1.);
+                    selected = part;
                 }
-                else
+                else if (part >= 0)
                 {
-                    double delta_time = observation_time_ -
-                                        occlusion_times_[indices[i_state]]
-                                                        [intersect_indices[i]];
-
-                    occlusion_transition_->Condition(
-                        delta_time,
-                        occlusions_[indices[i_state]][intersect_indices[i]]);
-
-                    float occlusion =
-                        occlusion_transition_->MapStandardGaussian();
-
-                    sensor_->Condition(predictions[i], false);
-                    float p_obsIpred_vis =
-                        sensor_->Probability(
-                            observations_[intersect_indices[i]]) *
-                        (1.0 - occlusion);
-
-                    sensor_->Condition(predictions[i], true);
-                    float p_obsIpred_occl =
-                        sensor_->Probability(
-                            observations_[intersect_indices[i]]) *
-                        occlusion;
-
-                    sensor_->Condition(std::numeric_limits<float>::infinity(),
-                                       true);
-                    float p_obsIinf = sensor_->Probability(
-                        observations_[intersect_indices[i]]);
-
-                    log_likes[i_state] +=
-                        log((p_obsIpred_vis + p_obsIpred_occl) / p_obsIinf);
-
-                    // we update the occlusion with the observations
-                    if (update)
+                    part_log_likes->row(i_state).setZero();
+                }
+            }
+
+            executor_->run([&](int worker) {
+                const ParticleBuffers buffers =
+                    this->buffers(workspaces_[worker].node);
+                FrameArena& worker_arena = FrameArena::local();
+
+                for (int tile = worker; tile < tile_count;
+                     tile += executor_->count_workers())
+                {
+                    FrameArena::Scope tile_scope(worker_arena);
+
+                    const size_t begin = tile * tile_rows_ * n_cols_;
+                    const size_t end =
+                        std::min(n_rows_, size_t(tile + 1) * tile_rows_) *
+                        n_cols_;
+
+                    const float* occlusions =
+                        buffers.occlusions + indices[i_state] * n_pixels;
+                    const double* occlusion_times =
+                        buffers.occlusion_times + indices[i_state] * n_pixels;
+                    float* new_occlusions = nullptr;
+                    double* new_occlusion_times = nullptr;
+
+                    if (update || part >= 0)
+                    {
+                        new_occlusions =
+                            buffers.new_occlusions + i_state * n_pixels;
+                        new_occlusion_times =
+                            buffers.new_occlusion_times + i_state * n_pixels;
+                        if (part < 0 || !rows_pending_)
+                        {
+                            std::copy(occlusions + begin,
+                                      occlusions + end,
+                                      new_occlusions + begin);
+                            std::copy(occlusion_times + begin,
+                                      occlusion_times + end,
+                                      new_occlusion_times + begin);
+                        }
+                    }
+
+                    if (skipped) continue;
+
+                    if (!parts)
                     {
-                        new_occlusions[i_state][intersect_indices[i]] =
-                            p_obsIpred_occl /
-                            (p_obsIpred_vis + p_obsIpred_occl);
-                        new_occlusion_times[i_state][intersect_indices[i]] =
-                            observation_time_;
+                        renderer.render_tile(tiles_, tile, predictions, parts);
                     }
+
+                    // gather the covered pixels of the tile
+                    int* tile_indices = worker_arena.allocate<int>(end - begin);
+                    float* tile_predictions =
+                        worker_arena.allocate<float>(end - begin);
+                    int* tile_parts =
+                        parts ? worker_arena.allocate<int>(end - begin)
+                              : nullptr;
+                    int count = 0;
+                    for (size_t pixel = begin; pixel < end; pixel++)
+                    {
+                        if (std::isinf(predictions[pixel])) continue;
+                        if (selected >= 0 && parts[pixel] != selected)
+                            continue;
+                        tile_indices[count] = pixel;
+                        tile_predictions[count] = predictions[pixel];
+                        if (parts) tile_parts[count] = parts[pixel];
+                        count++;
+                    }
+
+                    tile_log_likes_[tile] = score(count,
+                                                  tile_indices,
+                                                  tile_predictions,
+                                                  tile_parts,
+                                                  buffers,
+                                                  occlusions,
+                                                  occlusion_times,
+                                                  new_occlusions,
+                                                  new_occlusion_times,
+                                                  workspaces_[worker],
+                                                  &tile_part_log_likes_,
+                                                  tile);
+                }
+            });
+
+            if (skipped)
+            {
+                log_likes[i_state] = prefilter->scores[i_state];
+                continue;
+            }
+
+            log_likes[i_state] = 0;
+            for (int tile = 0; tile < tile_count; tile++)
+            {
+                log_likes[i_state] += tile_log_likes_[tile];
+                if (part_log_likes)
+                {
+                    part_log_likes->row(i_state) +=
+                        tile_part_log_likes_.row(tile);
                 }
             }
         }
-        if (update)
+    }
+
+    /**
+     * \brief Keeps the first count covered pixels which are rendered to the
+     *        given part, in order, and returns their number
+     */
+    static int select_part(int part,
+                           int count,
+                           int* intersect_indices,
+                           float* predictions,
+                           int* parts)
+    {
+        int selected = 0;
+        for (int i = 0; i < count; i++)
         {
-            occlusions_ = new_occlusions;
-            occlusion_times_ = new_occlusion_times;
-            for (size_t i_state = 0; i_state < indices.size(); i_state++)
-                indices[i_state] = i_state;
+            if (parts[i] != part) continue;
+            intersect_indices[selected] = intersect_indices[i];
+            predictions[selected] = predictions[i];
+            parts[selected] = part;
+            selected++;
         }
-        return log_likes;
+        return selected;
     }
 
-    void set_observation(const Observation& image)
+    /**
+     * \brief Computes the extent of each part in the image from the count
+     *        covered pixels, given their indices and parts. The extent of a
+     *        part is its inclusive row and column range, stored as {first
+     *        row, last row, first column, last column}, and empty if the
+     *        part covers no pixel.
+     */
+    void part_extents(int count,
+                      const int* intersect_indices,
+                      const int* parts,
+                      int body_count,
+                      int* extents) const
     {
-        assert(image.rows() == image.size());
-        assert(image.cols() == 1);
+        for (int body = 0; body < body_count; body++)
+        {
+            int* extent = extents + 4 * body;
+            extent[0] = extent[2] = std::numeric_limits<int>::max();
+            extent[1] = extent[3] = -1;
+        }
 
-        std::vector<float> std_measurement(image.size());
+        for (int i = 0; i < count; i++)
+        {
+            const int row = intersect_indices[i] / n_cols_;
+            const int col = intersect_indices[i] % n_cols_;
+            int* extent = extents + 4 * parts[i];
+            extent[0] = std::min(extent[0], row);
+            extent[1] = std::max(extent[1], row);
+            extent[2] = std::min(extent[2], col);
+            extent[3] = std::max(extent[3], col);
+        }
+    }
+
+    /**
+     * \brief Computes the extents as above from rendered images, in which
+     *        uncovered pixels are infinitely distant
+     */
+    void image_part_extents(const float* predictions,
+                            const int* parts,
+                            int body_count,
+                            int* extents) const
+    {
+        FrameArena& arena = FrameArena::local();
+        FrameArena::Scope scope(arena);
 
-        for (int i = 0; i < image.size(); ++i)
+        const size_t n_pixels = n_rows_ * n_cols_;
+        int* indices = arena.allocate<int>(n_pixels);
+        int* covered_parts = arena.allocate<int>(n_pixels);
+        int count = 0;
+        for (size_t pixel = 0; pixel < n_pixels; pixel++)
         {
-            std_measurement[i] = image(i, 0);
+            if (std::isinf(predictions[pixel])) continue;
+            indices[count] = pixel;
+            covered_parts[count] = parts[pixel];
+            count++;
+        }
+        part_extents(count, indices, covered_parts, body_count, extents);
+    }
+
+    /**
+     * \brief Resets the attribution of the particles if their number or the
+     *        default poses changed, see attribution_changed()
+     */
+    void prepare_attribution(size_t count)
+    {
+        if (attributed_states_.size() == count &&
+            attributed_poses_.size() == this->default_poses_.size() &&
+            attributed_poses_ == this->default_poses_)
+        {
+            return;
         }
 
-        set_observation(std_measurement, this->delta_time_);
+        attributed_states_.assign(count, State());
+        attributed_extents_.assign(count * 4 * this->default_poses_.count(),
+                                   0);
+        attributed_poses_ = this->default_poses_;
     }
 
-    virtual void reset()
+    /**
+     * \brief Returns whether pixels may have changed their part since the
+     *        last evaluation of the particle, such that the pixels of all
+     *        parts have to be scored and not only those of the given moved
+     *        part. This is the case if a part other than the given one
+     *        moved, or if the extent of the given part before or after the
+     *        move meets the extent of another part after or before it. Always
+     *        true if the part is negative. Records the particle and the
+     *        extents of its parts for the next evaluation.
+     */
+    bool attribution_changed(size_t i_state,
+                             const State& delta,
+                             int part,
+                             const int* extents)
     {
-        occlusions_.resize(1);
-        occlusions_[0] =
-            std::vector<float>(n_rows_ * n_cols_, initial_occlusion_);
-        occlusion_times_.resize(1);
-        occlusion_times_[0] = std::vector<double>(n_rows_ * n_cols_, 0);
-        observation_time_ = 0;
+        const int body_count = delta.count();
+        State& attributed = attributed_states_[i_state];
+        int* attributed_extents =
+            attributed_extents_.data() + i_state * 4 * body_count;
+
+        bool changed = part < 0 || attributed.size() != delta.size();
+        if (!changed)
+        {
+            const int body_size = delta.size() / body_count;
+            for (int body = 0; body < body_count && !changed; body++)
+            {
+                if (body == part) continue;
+
+                changed =
+                    attributed.segment(body * body_size, body_size) !=
+                        delta.segment(body * body_size, body_size) ||
+                    meet(attributed_extents + 4 * part, extents + 4 * body) ||
+                    meet(extents + 4 * part, attributed_extents + 4 * body);
+            }
+        }
+
+        attributed = delta;
+        std::copy(extents, extents + 4 * body_count, attributed_extents);
+        return changed;
     }
 
-    // TODO: TYPES
-    const std::vector<float> Occlusions(size_t index) const
+    /**
+     * \brief Returns whether two extents share a pixel
+     */
+    static bool meet(const int* a, const int* b)
     {
-        return occlusions_[index];
+        return a[0] <= b[1] && b[0] <= a[1] && a[2] <= b[3] && b[2] <= a[3];
     }
 
-private:
-    void set_observation(const std::vector<float>& observations,
-                         const Scalar& delta_time)
+    /**
+     * \brief Computes the poses of the parts of a particle from its delta to
+     *        the default poses
+     */
+    void particle_poses(const State& delta_state, Affine* poses) const
     {
-        observations_ = observations;
-        observation_time_ += delta_time;
+        for (size_t i_obj = 0; i_obj < delta_state.count(); i_obj++)
+        {
+            auto pose_0 = this->default_poses_.component(i_obj);
+            auto delta = delta_state.component(i_obj);
+
+            dbot::PoseVector pose;
+
+            /// \todo: this should be done through the the apply_delta
+            /// function
+            pose.position() =
+                pose_0.orientation().rotation_matrix() * delta.position() +
+                pose_0.position();
+            pose.orientation() = pose_0.orientation() * delta.orientation();
+
+            poses[i_obj] = pose.affine();
+        }
+    }
+
+    /**
+     * \brief Scores the count pixels covered by a particle, given their
+     *        indices, predicted depths and, if not null, parts. Returns the
+     *        sum of the pixel scores. If part_log_likes is given, each score
+     *        is also added to the given row in the column of the pixel's
+     *        part. The occlusions of the pixels are updated if the new
+     *        occlusion rows are not null.
+     */
+    fl::Real score(int count,
+                   const int* intersect_indices,
+                   const float* predictions,
+                   const int* parts,
+                   const ParticleBuffers& buffers,
+                   const float* occlusions,
+                   const double* occlusion_times,
+                   float* new_occlusions,
+                   double* new_occlusion_times,
+                   Workspace& workspace,
+                   RealPartArray* part_log_likes,
+                   int row)
+    {
+        FrameArena& arena = FrameArena::local();
+        FrameArena::Scope scope(arena);
+
+        float* prior_occlusions = arena.allocate<float>(count);
+        double* delta_times = arena.allocate<double>(count);
+        float* observed = arena.allocate<float>(count);
+        float* infinities = arena.allocate<float>(count);
+        bool* pruned = arena.allocate<bool>(count);
+        Scalar* scores = arena.allocate<Scalar>(count);
+        float* posterior_occlusions = arena.allocate<float>(count);
+
+        const float* observations = buffers.observations;
+        const double observation_time = buffers.observation_time;
+        const float* occluder_depths = buffers.occluder_depths;
+        const float* background_limits = buffers.background_limits;
+        const float* background_scores = buffers.background_scores;
+
+        // predict the occlusions of the covered pixels -----------------------
+        for (size_t i = 0; i < size_t(count); i++)
+        {
+            delta_times[i] =
+                observation_time - occlusion_times[intersect_indices[i]];
+            prior_occlusions[i] = occlusions[intersect_indices[i]];
+        }
+        workspace.occlusion_model->predict(
+            delta_times, prior_occlusions, prior_occlusions, count);
+
+        // evaluate the pixel model on the covered pixels. The pixels
+        // explained by known occluders or the background, and the pixels
+        // pruned as confidently occluded, are passed as NaN observations,
+        // which the kernel skips ------------------------------------------
+        for (size_t i = 0; i < size_t(count); i++)
+        {
+            const int pixel = intersect_indices[i];
+            const bool explained =
+                (occluder_depths &&
+                 predictions[i] > occluder_depths[pixel]) ||
+                (background_limits &&
+                 predictions[i] < background_limits[pixel]);
+            observed[i] = explained ? std::numeric_limits<float>::quiet_NaN()
+                                    : observations[pixel];
+        }
+        if (buffers.infinities)
+        {
+            for (size_t i = 0; i < size_t(count); i++)
+            {
+                infinities[i] = buffers.infinities[intersect_indices[i]];
+            }
+        }
+        else
+        {
+            workspace.pixel_model->infinity_probs(observed, count, infinities);
+        }
+        for (size_t i = 0; i < size_t(count); i++)
+        {
+            pruned[i] = !std::isnan(observed[i]) &&
+                        prior_occlusions[i] >= occluded_threshold_;
+            if (pruned[i])
+            {
+                observed[i] = std::numeric_limits<float>::quiet_NaN();
+            }
+        }
+        workspace.pixel_model->loglikes(observed,
+                                        predictions,
+                                        prior_occlusions,
+                                        infinities,
+                                        count,
+                                        scores,
+                                        posterior_occlusions);
+
+        // compute likelihoods -------------------------------------------------
+        workspace.statistics.pixels += count;
+        fl::Real log_like = 0;
+        for (size_t i = 0; i < size_t(count); i++)
+        {
+            // the object is hidden by a known occluder, hence the pixel
+            // carries no information about it
+            if (occluder_depths &&
+                predictions[i] > occluder_depths[intersect_indices[i]])
+            {
+                continue;
+            }
+
+            // the object is rendered in front of the observed background,
+            // hence it would be visible and the observation is explained
+            // by the tail of the pixel model only
+            if (background_limits &&
+                predictions[i] < background_limits[intersect_indices[i]])
+            {
+                fl::Real score = background_scores[intersect_indices[i]];
+                log_like += score;
+                if (parts) (*part_log_likes)(row, parts[i]) += score;
+                continue;
+            }
+
+            // the pixel is confidently occluded, its score is approximated
+            // and its occlusion is left to the transition, such that the
+            // pixel is evaluated again once the occlusion has decayed
+            if (pruned[i])
+            {
+                fl::Real score = workspace.pixel_model->occluded_loglike(
+                    predictions[i], prior_occlusions[i], infinities[i]);
+                log_like += score;
+                if (parts) (*part_log_likes)(row, parts[i]) += score;
+                workspace.statistics.occluded++;
+                continue;
+            }
+
+            if (std::isnan(observations[intersect_indices[i]]))
+            {
+                log_like += log(1.);
+                workspace.statistics.invalid++;
+            }
+            else
+            {
+                fl::Real score = scores[i];
+                log_like += score;
+                if (parts) (*part_log_likes)(row, parts[i]) += score;
+
+                // we update the occlusion with the observations
+                if (new_occlusions)
+                {
+                    new_occlusions[intersect_indices[i]] =
+                        posterior_occlusions[i];
+                    new_occlusion_times[intersect_indices[i]] =
+                        observation_time;
+                }
+            }
+        }
+
+        return log_like;
+    }
+
+    /// observed depth of the current frame, from the context if set
+    const float* observed() const
+    {
+        return context_ ? context_->depth() : observations_.data();
+    }
+
+    /// probabilities of the observed depth given an infinitely distant
+    /// object
+    const float* observed_infinities() const
+    {
+        return context_ && context_infinities_ ? context_infinities_
+                                               : infinities_.data();
+    }
+
+    /// advances to the observation of the current frame
+    void observe()
+    {
+        observation_time_ += this->delta_time_;
+        rows_pending_ = false;
+
+        if (background_) observe_background();
+        if (change_detector_) detect_change();
+
+        distribute_observation();
+    }
+
+    /**
+     * \brief Computes the background limits and scores of the current
+     *        observation, then updates the background model with it. Until
+     *        the model is learned no pixel is treated as background.
+     */
+    void observe_background()
+    {
+        const size_t n_pixels = n_rows_ * n_cols_;
+
+        if (!background_->learned())
+        {
+            background_limits_.clear();
+            background_scores_.clear();
+            background_->update(observed());
+            return;
+        }
+
+        background_limits_.resize(n_pixels);
+        background_scores_.resize(n_pixels);
+        background_->front_limits(observed(), background_limits_.data());
+
+        for (size_t i = 0; i < n_pixels; ++i)
+        {
+            if (!std::isfinite(background_limits_[i])) continue;
+
+            // a visible prediction far in front of the observation only
+            // contributes the tail mass
+            sensor_->Condition(std::numeric_limits<float>::infinity(), false);
+            float p_obsIvis = sensor_->Probability(observed()[i]);
+            sensor_->Condition(std::numeric_limits<float>::infinity(), true);
+            float p_obsIinf = sensor_->Probability(observed()[i]);
+
+            background_scores_[i] = log(p_obsIvis / p_obsIinf);
+        }
+
+        background_->update(observed());
+    }
+
+    /**
+     * \brief Renders the object at the integrated poses and compares the
+     *        current observation to the last changed one around it
+     */
+    void detect_change()
+    {
+        FrameArena& arena = FrameArena::local();
+        FrameArena::Scope scope(arena);
+
+        const int body_count = this->default_poses_.count();
+        Affine* poses = arena.create<Affine>(body_count);
+        for (int i_obj = 0; i_obj < body_count; i_obj++)
+        {
+            poses[i_obj] = this->default_poses_.component(i_obj).affine();
+        }
+
+        // the workers are idle while the observation is set
+        RigidBodyRenderer& renderer = *workspaces_[0].renderer;
+        float* predictions = arena.allocate<float>(n_rows_ * n_cols_);
+        renderer.set_poses(poses, body_count);
+        renderer.Render(camera_matrix_, n_rows_, n_cols_, predictions);
+
+        observation_changed_ =
+            change_detector_->update(observed(), predictions);
+    }
+
+    /**
+     * \brief Copies the observation to each NUMA node of the executor. The
+     *        copy is made by the first worker of each node.
+     */
+    void distribute_observation()
+    {
+        if (!executor_ || executor_->count_nodes() < 2) return;
+
+        executor_->run([&](int worker) {
+            int node = executor_->node(worker);
+            if (executor_->first_worker(node) != worker) return;
+
+            node_observations_[node].assign(observed(),
+                                            observed() + n_rows_ * n_cols_);
+        });
     }
 
     // TODO: WE PROBABLY DONT NEED ALL OF THIS
@@ -275,12 +1559,70 @@ private:
     PixelSensorPtr sensor_;
     OcclusionModelPtr occlusion_transition_;
 
-    // occlusion parameters
-    std::vector<std::vector<float>> occlusions_;
-    std::vector<std::vector<double>> occlusion_times_;
+    // occlusion parameters, one row of n_rows_ * n_cols_ pixels per particle
+    OcclusionBuffer occlusions_;
+    OcclusionTimeBuffer occlusion_times_;
 
-    // observed data
-    std::vector<float> observations_;
+    // update buffers, swapped with the above after each update. They hold
+    // the occlusions of the parts evaluated since the last observation if
+    // rows are pending
+    OcclusionBuffer new_occlusions_;
+    OcclusionTimeBuffer new_occlusion_times_;
+    bool rows_pending_;
+
+    // observed data and its probabilities given an infinitely distant
+    // object, computed once per observation. A shared context replaces the
+    // own buffers, and its probabilities replace infinities_ if they were
+    // requested for the pixel model
+    ObservationBuffer observations_;
+    std::vector<float> infinities_;
+    std::shared_ptr<const ObservationContext> context_;
+    const float* context_infinities_;
     double observation_time_;
+
+    // page backing of the above buffers
+    HugePagePolicy huge_pages_;
+
+    // parallel evaluation, one workspace per worker
+    std::shared_ptr<Executor> executor_;
+    std::vector<Workspace> workspaces_;
+
+    // pixels with a predicted occlusion of at least the threshold are
+    // pruned, disabled if above one
+    double occluded_threshold_;
+
+    // tiled evaluation of single particles, disabled if zero rows
+    int tile_rows_;
+    RigidBodyRenderer::Tiles tiles_;
+    std::vector<fl::Real> tile_log_likes_;
+    RealPartArray tile_part_log_likes_;
+
+    // particles and extents of their parts at their last evaluation with
+    // part attribution, and the default poses they are relative to
+    std::vector<State> attributed_states_;
+    std::vector<int> attributed_extents_;
+    State attributed_poses_;
+
+    // impostor prefilter, disabled if null
+    std::shared_ptr<const ImpostorAtlas> impostors_;
+    double keep_fraction_;
+
+    // observation copies per NUMA node, empty if not running on several nodes
+    std::vector<ObservationBuffer> node_observations_;
+
+    // known occluders and their depth layer of the current frame, empty if
+    // no occluder poses are set
+    ObjectRendererPtr occluders_;
+    std::vector<float> occluder_depths_;
+
+    // static background, the limits and scores of the current observation
+    // are empty while the background is not learned
+    std::shared_ptr<BackgroundModel> background_;
+    std::vector<float> background_limits_;
+    std::vector<float> background_scores_;
+
+    // change of the current observation, always true without a detector
+    std::shared_ptr<SceneChangeDetector> change_detector_;
+    bool observation_changed_;
 };
 }
@@ -0,0 +1,467 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file kinect_image_model_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <memory>
+#include <random>
+
+#include <dbot/executor.h>
+#include <dbot/impostor_atlas.h>
+#include <dbot/model/kinect_image_model.h>
+#include <dbot/pose/free_floating_rigid_bodies_state.h>
+#include <dbot/test_meshes.h>
+
+typedef dbot::FreeFloatingRigidBodiesState<> State;
+typedef dbot::KinectImageModel<double, State> Model;
+
+class KinectImageModelTests : public ::testing::Test
+{
+protected:
+    // two instances of a cube of 4 cm
+    KinectImageModelTests()
+        : vertices_(2, dbot::cube_vertices(0.02)),
+          indices_(2, dbot::box_indices())
+    {
+        camera_matrix_ << 320, 0, 80, 0, 320, 60, 0, 0, 1;
+    }
+
+    template <typename Scalar = double>
+    std::shared_ptr<dbot::KinectImageModel<Scalar, State>> create_model(
+        int workers,
+        int tile_rows,
+        bool overlapping = false) const
+    {
+        auto model = std::make_shared<dbot::KinectImageModel<Scalar, State>>(
+            camera_matrix_,
+            rows_,
+            cols_,
+            std::make_shared<dbot::RigidBodyRenderer>(vertices_, indices_),
+            std::make_shared<dbot::KinectPixelModel>(0.01, 0.003, 0.00142478),
+            std::make_shared<dbot::OcclusionModel>(0.1, 0.7),
+            0.1,
+            1.0 / 30.0);
+        if (workers > 0)
+        {
+            model->set_executor(std::make_shared<dbot::Executor>(workers));
+            model->set_tile_rows(tile_rows);
+        }
+
+        // side by side without overlap, or the second in front of the first
+        State poses(2);
+        poses.setZero();
+        poses.component(0).position() = Eigen::Vector3d(-0.05, 0, 0.6);
+        poses.component(1).position() = Eigen::Vector3d(0.05, 0, 0.58);
+        if (overlapping)
+        {
+            poses.component(0).position() = Eigen::Vector3d(-0.01, 0, 0.6);
+            poses.component(1).position() = Eigen::Vector3d(0.01, 0, 0.55);
+        }
+        model->integrated_poses() = poses;
+
+        return model;
+    }
+
+    /// random deltas of the two parts
+    Model::StateArray random_deltas(int particles,
+                                    std::mt19937& generator) const
+    {
+        std::normal_distribution<double> noise(0.0, 0.003);
+        Model::StateArray deltas(particles);
+        for (auto& delta : deltas)
+        {
+            delta = State(2);
+            delta.setZero();
+            for (int part = 0; part < 2; ++part)
+            {
+                delta.component(part).position() = Eigen::Vector3d(
+                    noise(generator), noise(generator), noise(generator));
+            }
+        }
+        return deltas;
+    }
+
+    /// the true poses behind a slightly displaced observation
+    Eigen::MatrixXd observe(std::mt19937& generator) const
+    {
+        std::normal_distribution<double> noise(0.0, 0.003);
+        dbot::RigidBodyRenderer renderer(vertices_, indices_);
+        std::vector<dbot::RigidBodyRenderer::Affine> poses(
+            2, dbot::RigidBodyRenderer::Affine::Identity());
+        poses[0].translation() = Eigen::Vector3d(-0.048, 0, 0.6);
+        poses[1].translation() = Eigen::Vector3d(0.05, 0.003, 0.58);
+        renderer.set_poses(poses);
+        std::vector<float> depth;
+        renderer.Render(camera_matrix_, rows_, cols_, depth);
+        Eigen::MatrixXd image(depth.size(), 1);
+        for (size_t i = 0; i < depth.size(); ++i)
+        {
+            image(i) = std::isinf(depth[i]) ? 2.0 : depth[i];
+            image(i) += noise(generator);
+        }
+        return image;
+    }
+
+    /**
+     * \brief Evaluates random frames once with all parts and once part by
+     *        part and compares the part contributions and occlusions
+     */
+    void expect_part_evaluation_matches(int workers, int tile_rows)
+    {
+        auto full = create_model(workers, tile_rows);
+        auto partial = create_model(workers, tile_rows);
+
+        const int particles = 8;
+        std::mt19937 generator(1);
+        Model::IntArray full_indices = Model::IntArray::Zero(particles);
+        Model::IntArray partial_indices = full_indices;
+
+        for (int frame = 0; frame < 3; ++frame)
+        {
+            Model::StateArray deltas = random_deltas(particles, generator);
+            Eigen::MatrixXd image = observe(generator);
+
+            full->set_observation(image);
+            partial->set_observation(image);
+
+            Model::RealArray log_likes(particles);
+            Model::RealPartArray full_parts;
+            full->loglikes(deltas, full_indices, log_likes, full_parts, true);
+
+            Model::RealPartArray partial_parts =
+                Model::RealPartArray::Zero(particles, 2);
+            partial->part_loglikes(
+                deltas, partial_indices, 0, partial_parts, false);
+            partial->part_loglikes(
+                deltas, partial_indices, 1, partial_parts, true);
+
+            for (int i = 0; i < particles; ++i)
+            {
+                for (int part = 0; part < 2; ++part)
+                {
+                    EXPECT_NEAR(full_parts(i, part),
+                                partial_parts(i, part),
+                                1e-9 * std::fabs(full_parts(i, part)));
+                }
+            }
+        }
+
+        for (int i = 0; i < particles; ++i)
+        {
+            EXPECT_EQ(full->Occlusions(i), partial->Occlusions(i));
+        }
+    }
+
+    /**
+     * \brief Moves the parts of overlapping instances in turns, as the
+     *        sampling blocks of the filter do, and compares the part
+     *        evaluations to full evaluations of the same particles
+     */
+    void expect_overlapping_parts_match(int workers, int tile_rows)
+    {
+        auto full = create_model(workers, tile_rows, true);
+        auto partial = create_model(workers, tile_rows, true);
+
+        const int particles = 8;
+        std::mt19937 generator(2);
+        std::normal_distribution<double> noise(0.0, 0.01);
+        Model::IntArray indices = Model::IntArray::Zero(particles);
+
+        Eigen::MatrixXd image = observe(generator);
+        full->set_observation(image);
+        partial->set_observation(image);
+
+        Model::StateArray deltas = random_deltas(particles, generator);
+        Model::RealArray log_likes(particles);
+        Model::RealPartArray partial_parts;
+        partial->loglikes(deltas, indices, log_likes, partial_parts, false);
+
+        for (int block = 0; block < 6; ++block)
+        {
+            const int part = block % 2;
+            for (auto& delta : deltas)
+            {
+                delta.component(part).position() += Eigen::Vector3d(
+                    noise(generator), noise(generator), noise(generator));
+            }
+            partial->part_loglikes(
+                deltas, indices, part, partial_parts, false);
+
+            Model::RealPartArray full_parts;
+            full->loglikes(deltas, indices, log_likes, full_parts, false);
+
+            for (int i = 0; i < particles; ++i)
+            {
+                EXPECT_NEAR(log_likes(i),
+                            partial_parts.row(i).sum(),
+                            1e-9 * std::fabs(log_likes(i)));
+                for (int part = 0; part < 2; ++part)
+                {
+                    EXPECT_NEAR(full_parts(i, part),
+                                partial_parts(i, part),
+                                1e-9 * std::fabs(full_parts(i, part)));
+                }
+            }
+        }
+    }
+
+    const int rows_ = 120;
+    const int cols_ = 160;
+    std::vector<std::vector<Eigen::Vector3d>> vertices_;
+    std::vector<std::vector<std::vector<int>>> indices_;
+    Eigen::Matrix3d camera_matrix_;
+};
+
+TEST_F(KinectImageModelTests, known_occluders_skip_hidden_pixels)
+{
+    typedef dbot::RigidBodyRenderer::Affine Affine;
+
+    // a cube in front of the first instance, hiding part of it
+    auto occluders = std::make_shared<dbot::RigidBodyRenderer>(
+        std::vector<std::vector<Eigen::Vector3d>>(1, vertices_[0]),
+        std::vector<std::vector<std::vector<int>>>(1, indices_[0]));
+    std::vector<Affine> occluder_poses(1, Affine::Identity());
+    occluder_poses[0].translation() = Eigen::Vector3d(-0.07, 0, 0.5);
+
+    std::vector<float> occluder_depth;
+    occluders->set_poses(occluder_poses);
+    occluders->Render(camera_matrix_, rows_, cols_, occluder_depth);
+
+    dbot::RigidBodyRenderer renderer(vertices_, indices_);
+    std::vector<Affine> poses(2, Affine::Identity());
+    poses[0].translation() = Eigen::Vector3d(-0.05, 0, 0.6);
+    poses[1].translation() = Eigen::Vector3d(0.05, 0, 0.58);
+    renderer.set_poses(poses);
+    std::vector<float> object_depth;
+    renderer.Render(camera_matrix_, rows_, cols_, object_depth);
+
+    std::vector<int> hidden;
+    for (int i = 0; i < rows_ * cols_; ++i)
+    {
+        if (!std::isinf(object_depth[i]) && object_depth[i] > occluder_depth[i])
+        {
+            hidden.push_back(i);
+        }
+    }
+    ASSERT_GT(hidden.size(), 20u);
+
+    // the observations differ only behind the occluder
+    std::mt19937 generator(1);
+    Eigen::MatrixXd image = observe(generator);
+    Eigen::MatrixXd changed = image;
+    for (int i : hidden) changed(i) = 0.3;
+
+    auto evaluate = [&](bool with_occluders, const Eigen::MatrixXd& frame) {
+        auto model = create_model(0, 0);
+        if (with_occluders)
+        {
+            model->set_occluders(occluders);
+            model->set_occluder_poses(occluder_poses);
+        }
+        model->set_observation(frame);
+
+        Model::StateArray deltas(1);
+        deltas[0] = State(2);
+        deltas[0].setZero();
+        Model::IntArray indices = Model::IntArray::Zero(1);
+        Model::RealArray log_likes(1);
+        model->loglikes(deltas, indices, log_likes, true);
+        return std::make_pair(log_likes(0), model->Occlusions(0));
+    };
+
+    auto occluded = evaluate(true, image);
+    auto occluded_changed = evaluate(true, changed);
+    EXPECT_DOUBLE_EQ(occluded.first, occluded_changed.first);
+    EXPECT_EQ(occluded.second, occluded_changed.second);
+
+    // hidden pixels keep their initial occlusion, unlike without occluders
+    auto plain_changed = evaluate(false, changed);
+    EXPECT_NE(evaluate(false, image).first, plain_changed.first);
+    int updated = 0;
+    for (int i : hidden)
+    {
+        EXPECT_FLOAT_EQ(0.1f, occluded_changed.second[i]);
+        updated += plain_changed.second[i] != 0.1f;
+    }
+    EXPECT_GT(updated, 0);
+}
+
+TEST_F(KinectImageModelTests, impostor_prefilter_ranks_rejected_below_kept)
+{
+    auto atlas =
+        std::make_shared<dbot::ImpostorAtlas>(vertices_, indices_, 2, 64);
+
+    const int particles = 12;
+    std::mt19937 generator(2);
+
+    // a rejected particle keeps its occlusion rows, hence each trial starts
+    // from the initial occlusions of both models
+    for (int trial = 0; trial < 3; ++trial)
+    {
+        auto exact = create_model(0, 0);
+        auto filtered = create_model(0, 0);
+        filtered->set_impostor_prefilter(atlas, 0.5);
+
+        Model::StateArray deltas = random_deltas(particles, generator);
+        Eigen::MatrixXd image = observe(generator);
+        exact->set_observation(image);
+        filtered->set_observation(image);
+
+        Model::IntArray indices = Model::IntArray::Zero(particles);
+        Model::RealArray exact_log_likes(particles);
+        Model::RealArray filtered_log_likes(particles);
+        exact->loglikes(deltas, indices, exact_log_likes, false);
+        filtered->loglikes(deltas, indices, filtered_log_likes, false);
+
+        // the kept particles are scored exactly, the rejected ones below
+        // all of them
+        std::vector<bool> kept(particles);
+        fl::Real lowest_kept = std::numeric_limits<fl::Real>::infinity();
+        int kept_count = 0;
+        for (int i = 0; i < particles; ++i)
+        {
+            kept[i] = filtered_log_likes(i) == exact_log_likes(i);
+            if (!kept[i]) continue;
+            lowest_kept = std::min(lowest_kept, filtered_log_likes(i));
+            kept_count++;
+        }
+        EXPECT_EQ(particles / 2, kept_count);
+
+        for (int i = 0; i < particles; ++i)
+        {
+            if (kept[i]) continue;
+            EXPECT_LE(filtered_log_likes(i), lowest_kept);
+        }
+    }
+}
+
+TEST_F(KinectImageModelTests, part_evaluation_matches_full_evaluation)
+{
+    expect_part_evaluation_matches(0, 0);
+}
+
+TEST_F(KinectImageModelTests, tiled_part_evaluation_matches_full_evaluation)
+{
+    expect_part_evaluation_matches(2, 16);
+}
+
+TEST_F(KinectImageModelTests, overlapping_part_evaluation_matches_full)
+{
+    expect_overlapping_parts_match(0, 0);
+}
+
+TEST_F(KinectImageModelTests, tiled_overlapping_part_evaluation_matches_full)
+{
+    expect_overlapping_parts_match(2, 16);
+}
+
+TEST_F(KinectImageModelTests, single_precision_matches_double_precision)
+{
+    auto wide = create_model<double>(0, 0);
+    auto narrow = create_model<float>(0, 0);
+
+    const int particles = 8;
+    std::mt19937 generator(1);
+    Model::IntArray wide_indices = Model::IntArray::Zero(particles);
+    Model::IntArray narrow_indices = wide_indices;
+
+    for (int frame = 0; frame < 3; ++frame)
+    {
+        Model::StateArray deltas = random_deltas(particles, generator);
+        Eigen::MatrixXd image = observe(generator);
+        wide->set_observation(image);
+        narrow->set_observation(image);
+
+        Model::RealArray wide_log_likes(particles);
+        Model::RealArray narrow_log_likes(particles);
+        wide->loglikes(deltas, wide_indices, wide_log_likes, true);
+        narrow->loglikes(deltas, narrow_indices, narrow_log_likes, true);
+
+        for (int i = 0; i < particles; ++i)
+        {
+            EXPECT_NEAR(wide_log_likes(i),
+                        narrow_log_likes(i),
+                        1e-4 * std::fabs(wide_log_likes(i)));
+        }
+    }
+
+    for (int i = 0; i < particles; ++i)
+    {
+        const std::vector<float> wide_occlusions = wide->Occlusions(i);
+        const std::vector<float> narrow_occlusions = narrow->Occlusions(i);
+        for (size_t pixel = 0; pixel < wide_occlusions.size(); ++pixel)
+        {
+            EXPECT_NEAR(wide_occlusions[pixel], narrow_occlusions[pixel], 1e-4);
+        }
+    }
+}
+
+TEST_F(KinectImageModelTests, shared_context_matches_own_observation)
+{
+    auto own = create_model(0, 0);
+    auto subscribed = create_model(0, 0);
+    auto unsubscribed = create_model(0, 0);
+
+    dbot::ObservationSource source(camera_matrix_, rows_, cols_);
+    subscribed->subscribe(source);
+    EXPECT_EQ(1u, source.requirements().pixel_models.size());
+
+    const int particles = 8;
+    std::mt19937 generator(1);
+    Model::IntArray own_indices = Model::IntArray::Zero(particles);
+    Model::IntArray subscribed_indices = own_indices;
+    Model::IntArray unsubscribed_indices = own_indices;
+
+    for (int frame = 0; frame < 3; ++frame)
+    {
+        Model::StateArray deltas = random_deltas(particles, generator);
+        Eigen::MatrixXd image = observe(generator);
+        auto context = source.publish(image.data());
+
+        own->set_observation(image);
+        subscribed->set_observation_context(context);
+        unsubscribed->set_observation_context(
+            std::make_shared<dbot::ObservationContext>(
+                frame,
+                image.data(),
+                rows_,
+                cols_,
+                dbot::ObservationRequirements()));
+
+        Model::RealArray own_log_likes(particles);
+        Model::RealArray subscribed_log_likes(particles);
+        Model::RealArray unsubscribed_log_likes(particles);
+        own->loglikes(deltas, own_indices, own_log_likes, true);
+        subscribed->loglikes(
+            deltas, subscribed_indices, subscribed_log_likes, true);
+        unsubscribed->loglikes(
+            deltas, unsubscribed_indices, unsubscribed_log_likes, true);
+
+        for (int i = 0; i < particles; ++i)
+        {
+            EXPECT_EQ(own_log_likes(i), subscribed_log_likes(i));
+            EXPECT_EQ(own_log_likes(i), unsubscribed_log_likes(i));
+        }
+    }
+
+    for (int i = 0; i < particles; ++i)
+    {
+        EXPECT_EQ(own->Occlusions(i), subscribed->Occlusions(i));
+    }
+}
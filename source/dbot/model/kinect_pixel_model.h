@@ -30,6 +30,7 @@
 
 #include <Eigen/Dense>
 #include <cmath>
+#include <dbot/cpu_kernels.h>
 #include <dbot/traits.h>
 #include <iostream>
 
@@ -137,6 +138,101 @@ public:
         occlusion_ = occlusion;
     }
 
+    /**
+     * \brief Evaluates count pixels at once with the kernel of the active
+     *        CPU variant, see CpuKernels::pixel_loglikes. The kernel
+     *        implements this model, overrides of Probability() are not
+     *        taken into account.
+     */
+    void loglikes(const float* observations,
+                  const float* predictions,
+                  const float* occlusions,
+                  const float* infinities,
+                  int count,
+                  double* scores,
+                  float* posterior_occlusions) const
+    {
+        cpu_kernels().pixel_loglikes(parameters(),
+                                     observations,
+                                     predictions,
+                                     occlusions,
+                                     infinities,
+                                     count,
+                                     scores,
+                                     posterior_occlusions);
+    }
+
+    /**
+     * \brief Single precision loglikes(), see
+     *        CpuKernels::pixel_loglikes_single
+     */
+    void loglikes(const float* observations,
+                  const float* predictions,
+                  const float* occlusions,
+                  const float* infinities,
+                  int count,
+                  float* scores,
+                  float* posterior_occlusions) const
+    {
+        cpu_kernels().pixel_loglikes_single(parameters(),
+                                            observations,
+                                            predictions,
+                                            occlusions,
+                                            infinities,
+                                            count,
+                                            scores,
+                                            posterior_occlusions);
+    }
+
+    /**
+     * \brief Computes the probabilities of count observations given an
+     *        occluded object at infinite distance, the reference of the
+     *        log likelihood ratios, see CpuKernels::infinity_probs
+     */
+    void infinity_probs(const float* observations,
+                        int count,
+                        float* probabilities) const
+    {
+        cpu_kernels().infinity_probs(
+            parameters(), observations, count, probabilities);
+    }
+
+    /**
+     * \brief Approximates the log likelihood ratio of a pixel whose object
+     *        is confidently occluded by a surface well in front of it. The
+     *        visible term is dropped and the error function of the occluded
+     *        term saturates, which leaves a single exponential.
+     *
+     * \param infinity  Probability of the observation given an infinitely
+     *                  distant object, see infinity_probs()
+     */
+    Scalar occluded_loglike(Scalar prediction,
+                            Scalar occlusion,
+                            Scalar infinity) const
+    {
+        // the occluded term then is the one at infinity scaled by
+        // 1 / (1 - exp(-lambda * prediction)) above the tail
+        const Scalar tail = tail_weight_ / max_depth_;
+        const Scalar p_occluded =
+            tail +
+            (infinity - tail) / (1 - std::exp(-lambda_ * prediction));
+
+        return std::log(occlusion * p_occluded / infinity);
+    }
+
+    /// parameters of the kernels, which identify the model in a shared
+    /// ObservationContext
+    PixelModelParameters parameters() const
+    {
+        PixelModelParameters parameters;
+        parameters.lambda = lambda_;
+        parameters.tail_weight = tail_weight_;
+        parameters.model_sigma = model_sigma_;
+        parameters.sigma_factor = sigma_factor_;
+        parameters.max_depth = max_depth_;
+        return parameters;
+    }
+
 private:
     const Scalar lambda_, tail_weight_, model_sigma_, sigma_factor_, max_depth_;
 
@@ -0,0 +1,70 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file kinect_pixel_model_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+
+#include <dbot/model/kinect_pixel_model.h>
+
+TEST(KinectPixelModelTests, infinity_probs_match_single_pixel)
+{
+    dbot::KinectPixelModel model(0.01, 0.003, 0.00142478);
+
+    const float observations[3] = {0.5f, 1.0f, 2.5f};
+    float probabilities[3];
+    model.infinity_probs(observations, 3, probabilities);
+
+    for (int i = 0; i < 3; ++i)
+    {
+        dbot::KinectPixelModel single(0.01, 0.003, 0.00142478);
+        single.Condition(std::numeric_limits<double>::infinity(), true);
+        EXPECT_FLOAT_EQ(single.Probability(observations[i]), probabilities[i]);
+    }
+}
+
+TEST(KinectPixelModelTests, occluded_loglike_approximates_occluded_pixel)
+{
+    dbot::KinectPixelModel model(0.01, 0.003, 0.00142478);
+
+    // an occluder 10 cm in front of the predicted object
+    const float predictions[2] = {1.0f, 2.0f};
+    const float observations[2] = {0.9f, 1.9f};
+    const float occlusions[2] = {0.99f, 0.99f};
+
+    float infinities[2];
+    double scores[2];
+    float posterior_occlusions[2];
+    model.infinity_probs(observations, 2, infinities);
+    model.loglikes(observations,
+                   predictions,
+                   occlusions,
+                   infinities,
+                   2,
+                   scores,
+                   posterior_occlusions);
+
+    for (int i = 0; i < 2; ++i)
+    {
+        EXPECT_NEAR(
+            scores[i],
+            model.occluded_loglike(predictions[i], occlusions[i], infinities[i]),
+            1e-3);
+    }
+}
@@ -29,6 +29,11 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <dbot/cpu_kernels.h>
+#include <limits>
+
 // TODO: THIS IS JUST A LINEAR GAUSSIAN PROCESS WITH NO NOISE, SHOULD DISAPPEAR
 namespace dbot
 {
@@ -42,6 +47,16 @@ namespace dbot
 class OcclusionModel
 {
 public:
+    /**
+     * \brief Coefficients of the transition over one time step, which maps an
+     *        occlusion probability o to offset + scale * o
+     */
+    struct Transition
+    {
+        double scale;
+        double offset;
+    };
+
     // the prob of source being object given source was object one sec ago,
     // and prob of source being object given one sec ago source was not object
     OcclusionModel(double p_occluded_visible,
@@ -49,13 +64,19 @@ public:
                                       p_occluded_visible_(p_occluded_visible),
                                       p_occluded_occluded_(p_occluded_occluded),
                                       c_(p_occluded_occluded_ - p_occluded_visible_),
-                                      log_c_(std::log(c_)) { }
+                                      log_c_(std::log(c_)),
+                                      cache_next_(0)
+    {
+        std::fill(cached_times_,
+                  cached_times_ + CacheSize,
+                  std::numeric_limits<double>::quiet_NaN());
+    }
 
     virtual ~OcclusionModel() noexcept {}
 
     virtual void Condition(const double& delta_time,
                            const double& occlusion_probability,
-                           const double& input = 0)
+                           const double& = 0)
     {
         delta_time_ = delta_time;
         occlusion_probability_ = occlusion_probability;
@@ -63,33 +84,116 @@ public:
 
     virtual double MapStandardGaussian() const
     {
-        double pow_c_time = std::exp(delta_time_*log_c_);
+        const Transition& t = transition(delta_time_);
 
-        double new_occlusion_probability =
-                1. - (pow_c_time*(1.-occlusion_probability_) +
-                    (1 - p_occluded_occluded_)*(pow_c_time-1.)/(c_-1.));
+        return clamp(t.offset + t.scale * occlusion_probability_);
+    }
 
-        if(new_occlusion_probability < 0.0 || new_occlusion_probability > 1.0)
+    /**
+     * \brief Returns the transition over the given time step. The
+     *        coefficients of the last few distinct time steps are cached.
+     *
+     * If c = p_occluded_occluded - p_occluded_visible is one, the occlusion
+     * never changes. If c is not positive, c^delta_time is undefined for
+     * fractional time steps and the occlusion is forgotten after any
+     * positive time step, i.e. it jumps to the stationary probability.
+     */
+    const Transition& transition(double delta_time) const
+    {
+        for (int i = 0; i < CacheSize; ++i)
         {
-            if(std::fabs(c_ - 1.0) < 0.000000001)
-            {
-                new_occlusion_probability = occlusion_probability_;
-            }
-            else
-            {
-                std::cout << "unhandeled case in occlusion process mdoel " << std::endl;
-                exit(-1);
-            }
+            if (cached_times_[i] == delta_time) return cached_[i];
         }
 
-        return new_occlusion_probability;
+        const int i = cache_next_;
+        cache_next_ = (cache_next_ + 1) % CacheSize;
+        cached_times_[i] = delta_time;
+
+        Transition& t = cached_[i];
+        if (std::fabs(c_ - 1.0) < 0.000000001 || delta_time == 0)
+        {
+            t.scale = 1;
+            t.offset = 0;
+        }
+        else if (c_ <= 0)
+        {
+            t.scale = 0;
+            t.offset = p_occluded_visible_ / (1. - c_);
+        }
+        else
+        {
+            double pow_c_time = std::exp(delta_time * log_c_);
+
+            t.scale = pow_c_time;
+            t.offset = 1. - pow_c_time - (1 - p_occluded_occluded_) *
+                                             (pow_c_time - 1.) / (c_ - 1.);
+        }
+
+        return t;
     }
 
+    /**
+     * \brief Predicts count occlusion probabilities, each over its own time
+     *        step. Runs of equal time steps share one transition and are
+     *        mapped by the vectorized kernel of the CPU variant. The output
+     *        may alias the input. Results are clamped to [0, 1], which
+     *        matters for negative time steps only.
+     */
+    void predict(const double* delta_times,
+                 const float* occlusions,
+                 float* new_occlusions,
+                 int count) const
+    {
+        int begin = 0;
+        while (begin < count)
+        {
+            int end = begin + 1;
+            while (end < count && delta_times[end] == delta_times[begin]) ++end;
+
+            predict(delta_times[begin],
+                    occlusions + begin,
+                    new_occlusions + begin,
+                    end - begin);
+            begin = end;
+        }
+    }
+
+    /**
+     * \brief Predicts count occlusion probabilities over the same time step
+     */
+    void predict(double delta_time,
+                 const float* occlusions,
+                 float* new_occlusions,
+                 int count) const
+    {
+        const Transition& t = transition(delta_time);
+
+        cpu_kernels().predict_occlusions(
+            t.scale, t.offset, occlusions, new_occlusions, count);
+    }
+
+private:
+    static double clamp(double occlusion_probability)
+    {
+        return std::min(std::max(occlusion_probability, 0.), 1.);
+    }
+
+    enum
+    {
+        /// number of cached transitions
+        CacheSize = 8
+    };
+
 private:
     // conditionals
     double occlusion_probability_, delta_time_;
     // parameters
     double p_occluded_visible_, p_occluded_occluded_, c_, log_c_;
+
+    // transitions of the last distinct time steps
+    mutable double cached_times_[CacheSize];
+    mutable Transition cached_[CacheSize];
+    mutable int cache_next_;
 };
 
 }
@@ -0,0 +1,81 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file occlusion_model_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include <dbot/model/occlusion_model.h>
+
+TEST(OcclusionModelTests, batch_matches_single_transition)
+{
+    dbot::OcclusionModel model(0.1, 0.7);
+
+    double delta_times[6] = {0.03, 0.03, 0.03, 0.06, 0.0, 0.03};
+    float occlusions[6] = {0.1f, 0.5f, 0.9f, 0.1f, 0.3f, 1.0f};
+    float predicted[6];
+    model.predict(delta_times, occlusions, predicted, 6);
+
+    for (int i = 0; i < 6; ++i)
+    {
+        dbot::OcclusionModel single(0.1, 0.7);
+        single.Condition(delta_times[i], occlusions[i]);
+        EXPECT_FLOAT_EQ(predicted[i], single.MapStandardGaussian());
+    }
+    EXPECT_FLOAT_EQ(predicted[4], 0.3f);
+}
+
+TEST(OcclusionModelTests, converges_to_stationary_probability)
+{
+    dbot::OcclusionModel model(0.1, 0.7);
+
+    // p_occluded_visible / (1 - p_occluded_occluded + p_occluded_visible)
+    model.Condition(1000., 0.9);
+    EXPECT_NEAR(model.MapStandardGaussian(), 0.25, 1e-9);
+}
+
+TEST(OcclusionModelTests, constant_occlusion_if_c_is_one)
+{
+    dbot::OcclusionModel model(0.0, 1.0);
+
+    model.Condition(0.5, 0.3);
+    EXPECT_DOUBLE_EQ(model.MapStandardGaussian(), 0.3);
+}
+
+TEST(OcclusionModelTests, memoryless_if_c_is_not_positive)
+{
+    dbot::OcclusionModel model(0.6, 0.2);
+
+    model.Condition(0.5, 0.9);
+    double occlusion = model.MapStandardGaussian();
+    EXPECT_FALSE(std::isnan(occlusion));
+    EXPECT_NEAR(occlusion, 0.6 / 1.4, 1e-12);
+
+    model.Condition(0.0, 0.9);
+    EXPECT_DOUBLE_EQ(model.MapStandardGaussian(), 0.9);
+}
+
+TEST(OcclusionModelTests, negative_time_step_is_clamped)
+{
+    dbot::OcclusionModel model(0.1, 0.7);
+
+    model.Condition(-10., 1.0);
+    double occlusion = model.MapStandardGaussian();
+    EXPECT_GE(occlusion, 0.0);
+    EXPECT_LE(occlusion, 1.0);
+}
@@ -28,9 +28,15 @@
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include <Eigen/Core>
+#include <Eigen/Geometry>
 
 #include <fl/util/types.hpp>
+#include <dbot/cpu_kernels.h>
+#include <dbot/observation_context.h>
 #include <dbot/pose/pose_vector.h>
 #include <dbot/pose/pose_velocity_vector.h>
 #include <dbot/pose/free_floating_rigid_bodies_state.h>
@@ -50,11 +56,22 @@ public:
     typedef Eigen::Array<fl::Real, -1, 1> RealArray;
     typedef Eigen::Array<int, -1, 1> IntArray;
     typedef Eigen::Matrix<fl::Real, -1, 1> RealVector;
+    // one row per particle and one column per object part
+    typedef Eigen::Array<fl::Real, -1, -1> RealPartArray;
 //    typedef State PoseArray;
 
     /// \todo: this should be a different type, only containing poses
     typedef dbot::FreeFloatingRigidBodiesState<> PoseArray;
 
+    // per particle occlusions and the time of the last observation, one row
+    // of pixels per particle
+    struct Snapshot
+    {
+        std::vector<float> occlusions;
+        std::vector<double> occlusion_times;
+        double observation_time = 0;
+    };
+
 public:
     /// constructor and destructor *********************************************
     RbSensor(const fl::Real& delta_time) : delta_time_(delta_time) {}
@@ -64,6 +81,48 @@ public:
                                IntArray& indices,
                                const bool& update = false) = 0;
 
+    // compute the loglikelihoods into caller provided storage of
+    // deviations.size() elements. Sensors which are able to evaluate without
+    // temporaries should override this
+    virtual void loglikes(const StateArray& deviations,
+                          IntArray& indices,
+                          Eigen::Ref<RealArray> log_likes,
+                          const bool& update)
+    {
+        log_likes = loglikes(deviations, indices, update);
+    }
+
+    // whether the sensor attributes the loglikelihoods to the object parts
+    virtual bool has_part_loglikes() const { return false; }
+
+    // compute the loglikelihoods along with the contribution of each part
+    // into part_log_likes, which sums to log_likes. A pixel is attributed to
+    // the part rendered closest to the camera. Sensors which do not attribute
+    // pixels to parts leave part_log_likes zero
+    virtual void loglikes(const StateArray& deviations,
+                          IntArray& indices,
+                          Eigen::Ref<RealArray> log_likes,
+                          RealPartArray& part_log_likes,
+                          const bool& update)
+    {
+        loglikes(deviations, indices, log_likes, update);
+        part_log_likes.setZero(deviations.size(), default_poses_.count());
+    }
+
+    // recompute the contribution of the given part into its column of
+    // part_log_likes after only this part moved since the last evaluation,
+    // keeping the other columns. Sensors which cannot restrict the
+    // evaluation to one part recompute all columns
+    virtual void part_loglikes(const StateArray& deviations,
+                               IntArray& indices,
+                               int,
+                               RealPartArray& part_log_likes,
+                               const bool& update)
+    {
+        RealArray log_likes(deviations.size());
+        loglikes(deviations, indices, log_likes, part_log_likes, update);
+    }
+
     // compute the loglikelihoods without keeping track of the occulsions
     virtual RealArray loglikes(const StateArray& deviations)
     {
@@ -74,9 +133,43 @@ public:
 
     /// accessors **************************************************************
     virtual void set_observation(const Observation& image) = 0;
+
+    // sets the observation from a context shared with the other sensors of
+    // the camera. Sensors which do not read the context directly receive a
+    // copy of its depth
+    virtual void set_observation_context(
+        const std::shared_ptr<const ObservationContext>& context)
+    {
+        Observation image(context->size(), 1);
+        convert_depth(context->depth(), image.data(), context->size());
+        set_observation(image);
+    }
+
+    // adds the frame data the sensor reads from a context to the
+    // requirements of the source
+    virtual void subscribe(ObservationSource&) const {}
+
+    // whether the last observation differs significantly from the previous
+    // ones around the object. Sensors without change detection always
+    // report a change
+    virtual bool observation_changed() const { return true; }
+
     virtual PoseArray& integrated_poses() { return default_poses_; }
     virtual void reset() = 0;
 
+    // moves the occluders of known pose to their poses of the next frame.
+    // Sensors without known occluders ignore them
+    virtual void set_occluder_poses(const std::vector<Eigen::Affine3d>&) {}
+
+    // captures the state the sensor carries from frame to frame, such that
+    // restore() continues from it. Sensors without such state return an
+    // empty snapshot
+    virtual Snapshot snapshot() const { return Snapshot(); }
+
+    // continues from the snapshot of a sensor of the same configuration,
+    // an empty snapshot leaves the sensor as it is
+    virtual void restore(const Snapshot&) {}
+
 protected:
     fl::Real delta_time_;
     PoseArray default_poses_;
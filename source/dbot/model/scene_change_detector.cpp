@@ -0,0 +1,108 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file scene_change_detector.cpp
+ * \date October 2016
+ */
+
+#include <dbot/model/scene_change_detector.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace dbot
+{
+SceneChangeDetector::SceneChangeDetector(int rows,
+                                         int cols,
+                                         double sigma_factor,
+                                         double threshold_sigmas,
+                                         double max_changed_fraction,
+                                         int margin)
+    : rows_(rows),
+      cols_(cols),
+      sigma_factor_(sigma_factor),
+      threshold_sigmas_(threshold_sigmas),
+      max_changed_fraction_(max_changed_fraction),
+      margin_(margin),
+      changed_fraction_(1.0)
+{
+}
+
+bool SceneChangeDetector::update(const float* depth,
+                                 const float* predicted_depth)
+{
+    // bounding box of the rendered object
+    int min_row = rows_, max_row = -1, min_col = cols_, max_col = -1;
+    for (int row = 0; row < rows_; ++row)
+    {
+        for (int col = 0; col < cols_; ++col)
+        {
+            if (std::isinf(predicted_depth[row * cols_ + col])) continue;
+
+            min_row = std::min(min_row, row);
+            max_row = std::max(max_row, row);
+            min_col = std::min(min_col, col);
+            max_col = std::max(max_col, col);
+        }
+    }
+
+    const bool first = reference_.empty();
+    changed_fraction_ = 1.0;
+
+    if (!first && max_row >= 0)
+    {
+        min_row = std::max(0, min_row - margin_);
+        max_row = std::min(rows_ - 1, max_row + margin_);
+        min_col = std::max(0, min_col - margin_);
+        max_col = std::min(cols_ - 1, max_col + margin_);
+
+        // the difference of two frames has sqrt(2) times the noise of one
+        const double factor =
+            threshold_sigmas_ * std::sqrt(2.) * sigma_factor_;
+
+        int changed_pixels = 0;
+        for (int row = min_row; row <= max_row; ++row)
+        {
+            for (int col = min_col; col <= max_col; ++col)
+            {
+                const float current = depth[row * cols_ + col];
+                const float reference = reference_[row * cols_ + col];
+
+                const bool valid = std::isfinite(current);
+                if (valid != std::isfinite(reference))
+                {
+                    changed_pixels++;
+                }
+                else if (valid && std::fabs(current - reference) >
+                                      factor * current * current)
+                {
+                    changed_pixels++;
+                }
+            }
+        }
+
+        const int area = (max_row - min_row + 1) * (max_col - min_col + 1);
+        changed_fraction_ = double(changed_pixels) / area;
+    }
+
+    const bool changed =
+        first || max_row < 0 || changed_fraction_ > max_changed_fraction_;
+
+    // a static frame keeps the reference, such that slow motion accumulates
+    // until it is detected
+    if (changed) reference_.assign(depth, depth + rows_ * cols_);
+
+    return changed;
+}
+}
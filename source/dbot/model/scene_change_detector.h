@@ -0,0 +1,87 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file scene_change_detector.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <vector>
+
+namespace dbot
+{
+/**
+ * \brief Detects whether a depth frame differs significantly from the last
+ *        changed frame around the predicted object.
+ *
+ * The region of interest is the bounding box of the pixels covered by the
+ * object rendered at its predicted pose, grown by a margin. A pixel inside
+ * the region changed if its depth moved by more than a number of standard
+ * deviations of the depth noise of two frames, or if it turned valid or
+ * invalid. The frame changed if the fraction of changed pixels in the region
+ * exceeds a limit.
+ */
+class SceneChangeDetector
+{
+public:
+    /**
+     * \param rows, cols            Frame size in pixels
+     * \param sigma_factor          Depth noise standard deviation per squared
+     *                              meter of depth, as in KinectPixelModel
+     * \param threshold_sigmas      Significant depth change in standard
+     *                              deviations
+     * \param max_changed_fraction  Fraction of changed region pixels below
+     *                              which the frame is static
+     * \param margin                Margin of the region around the object
+     *                              in pixels
+     */
+    SceneChangeDetector(int rows,
+                        int cols,
+                        double sigma_factor = 0.00142478,
+                        double threshold_sigmas = 4.0,
+                        double max_changed_fraction = 0.01,
+                        int margin = 8);
+
+    /**
+     * \brief Compares the frame to the reference frame within the region of
+     *        the given predicted depth image, infinite where the object is
+     *        not rendered, and returns whether the frame changed. A changed
+     *        frame becomes the reference. The first frame and a frame in
+     *        which the object is not rendered always count as changed.
+     */
+    bool update(const float* depth, const float* predicted_depth);
+
+    /**
+     * \brief Fraction of changed region pixels of the last update
+     */
+    double changed_fraction() const { return changed_fraction_; }
+
+    /**
+     * \brief Clears the reference frame, such that the next frame changes
+     */
+    void reset() { reference_.clear(); }
+
+private:
+    int rows_;
+    int cols_;
+    double sigma_factor_;
+    double threshold_sigmas_;
+    double max_changed_fraction_;
+    int margin_;
+
+    std::vector<float> reference_;
+    double changed_fraction_;
+};
+}
@@ -0,0 +1,148 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file scene_change_detector_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <dbot/model/scene_change_detector.h>
+
+class SceneChangeDetectorTests : public ::testing::Test
+{
+protected:
+    static const int rows = 60;
+    static const int cols = 80;
+
+    SceneChangeDetectorTests()
+        : detector_(rows, cols),
+          prediction_(rows * cols, std::numeric_limits<float>::infinity()),
+          generator_(1)
+    {
+        // object predicted in a 20 x 20 pixel square at 0.6 m
+        for (int row = 20; row < 40; ++row)
+        {
+            for (int col = 30; col < 50; ++col)
+            {
+                prediction_[row * cols + col] = 0.6f;
+            }
+        }
+    }
+
+    /**
+     * \brief Background at 1 m with the object square at the given depth
+     *        and column offset, plus depth noise
+     */
+    std::vector<float> frame(float object_depth, int offset = 0)
+    {
+        std::normal_distribution<float> noise(0, 0.00142478f);
+
+        std::vector<float> depth(rows * cols, 1.0f);
+        for (int row = 20; row < 40; ++row)
+        {
+            for (int col = 30 + offset; col < 50 + offset; ++col)
+            {
+                depth[row * cols + col] = object_depth;
+            }
+        }
+        for (auto& d : depth) d += d * d * noise(generator_);
+
+        return depth;
+    }
+
+    dbot::SceneChangeDetector detector_;
+    std::vector<float> prediction_;
+    std::mt19937 generator_;
+};
+
+TEST_F(SceneChangeDetectorTests, first_frame_changes)
+{
+    EXPECT_TRUE(detector_.update(frame(0.6f).data(), prediction_.data()));
+}
+
+TEST_F(SceneChangeDetectorTests, noise_is_static)
+{
+    detector_.update(frame(0.6f).data(), prediction_.data());
+
+    for (int i = 0; i < 20; ++i)
+    {
+        EXPECT_FALSE(detector_.update(frame(0.6f).data(), prediction_.data()));
+        EXPECT_LT(detector_.changed_fraction(), 0.01);
+    }
+}
+
+TEST_F(SceneChangeDetectorTests, motion_changes)
+{
+    detector_.update(frame(0.6f).data(), prediction_.data());
+
+    EXPECT_TRUE(detector_.update(frame(0.6f, 3).data(), prediction_.data()));
+    EXPECT_TRUE(detector_.update(frame(0.58f, 3).data(), prediction_.data()));
+}
+
+TEST_F(SceneChangeDetectorTests, slow_motion_accumulates)
+{
+    detector_.update(frame(0.6f).data(), prediction_.data());
+
+    // 1 mm per frame is within the noise of a single frame pair
+    EXPECT_FALSE(detector_.update(frame(0.599f).data(), prediction_.data()));
+
+    bool changed = false;
+    for (int i = 2; i < 20 && !changed; ++i)
+    {
+        auto depth = frame(0.6f - 0.001f * i);
+        changed = detector_.update(depth.data(), prediction_.data());
+    }
+    EXPECT_TRUE(changed);
+}
+
+TEST_F(SceneChangeDetectorTests, changes_away_from_the_object_are_ignored)
+{
+    detector_.update(frame(0.6f).data(), prediction_.data());
+
+    auto depth = frame(0.6f);
+    for (int row = 0; row < 5; ++row)
+    {
+        for (int col = 0; col < cols; ++col) depth[row * cols + col] = 0.4f;
+    }
+    EXPECT_FALSE(detector_.update(depth.data(), prediction_.data()));
+}
+
+TEST_F(SceneChangeDetectorTests, missing_measurements_change)
+{
+    detector_.update(frame(0.6f).data(), prediction_.data());
+
+    auto depth = frame(0.6f);
+    for (int row = 20; row < 30; ++row)
+    {
+        for (int col = 30; col < 50; ++col)
+        {
+            depth[row * cols + col] = std::numeric_limits<float>::quiet_NaN();
+        }
+    }
+    EXPECT_TRUE(detector_.update(depth.data(), prediction_.data()));
+}
+
+TEST_F(SceneChangeDetectorTests, object_out_of_view_changes)
+{
+    detector_.update(frame(0.6f).data(), prediction_.data());
+
+    std::vector<float> nothing(rows * cols,
+                               std::numeric_limits<float>::infinity());
+    EXPECT_TRUE(detector_.update(frame(0.6f).data(), nothing.data()));
+}
@@ -0,0 +1,359 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file sharded_image_model.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <dbot/model/kinect_image_model.h>
+#include <dbot/model/rao_blackwell_sensor.h>
+#include <dbot/process_pool.h>
+#include <dbot/shared_memory.h>
+#include <exception>
+#include <memory>
+#include <string>
+
+namespace dbot
+{
+/**
+ * \brief The ShardCapacityException class
+ */
+class ShardCapacityException : public std::exception
+{
+public:
+    explicit ShardCapacityException(int particle_count, int capacity)
+        : message_("Sharded image model: " + std::to_string(particle_count) +
+                   " particles exceed the capacity of " +
+                   std::to_string(capacity))
+    {
+    }
+
+    const char* what() const noexcept { return message_.c_str(); }
+
+private:
+    std::string message_;
+};
+
+/**
+ * \brief Evaluates a KinectImageModel in several worker processes.
+ *
+ * The particles are split into contiguous slices, one per worker process,
+ * and each worker writes the occlusion rows of its slice. The occlusion rows
+ * are double buffered in memory shared by all workers, such that a particle
+ * may be resampled from a parent held by any other worker. Observation frames
+ * are published through a ring of shared slots, and per call only the
+ * particle deltas and parent indices are sent to and the log likelihoods
+ * returned from the workers.
+ *
+ * The shared occlusion state is sized for a fixed maximum number of
+ * particles. A worker which dies is restarted and repeats its slice.
+ *
+ * \tparam Scalar  Precision of the pixel model, see KinectImageModel
+ */
+template <typename State, typename Scalar = fl::Real>
+class ShardedImageModel : public RbSensor<State>
+{
+public:
+    typedef RbSensor<State> Base;
+    typedef KinectImageModel<Scalar, State> Model;
+
+    typedef typename Base::Observation Observation;
+    typedef typename Base::StateArray StateArray;
+    typedef typename Base::RealArray RealArray;
+    typedef typename Base::IntArray IntArray;
+    typedef typename Base::Snapshot Snapshot;
+
+    enum
+    {
+        /// number of observation slots
+        RingSize = 2
+    };
+
+public:
+    /**
+     * \brief Forks the worker processes, each holding a copy of the given
+     *        model. The model must not have an executor since threads do not
+     *        survive the fork, and the process must not run other threads
+     *        yet, see ProcessPool.
+     *
+     * \param model         Model evaluated by the workers
+     * \param process_count Number of worker processes
+     * \param capacity      Maximum number of particles
+     *
+     * \throws ProcessPoolException if the process runs other threads
+     */
+    ShardedImageModel(const std::shared_ptr<Model>& model,
+                      int process_count,
+                      int capacity,
+                      size_t n_rows,
+                      size_t n_cols,
+                      float initial_occlusion,
+                      double delta_time)
+        : Base(delta_time),
+          model_(model),
+          capacity_(capacity),
+          n_pixels_(n_rows * n_cols),
+          initial_occlusion_(initial_occlusion),
+          body_count_(model->integrated_poses().count()),
+          state_dimension_(State(body_count_).size()),
+          observation_time_(0),
+          frame_(0),
+          current_(0),
+          particle_count_(1),
+          memory_(layout()),
+          pool_(process_count, [this](int worker) { evaluate(worker); })
+    {
+        this->default_poses_ = model_->integrated_poses();
+
+        reset();
+    }
+
+    virtual ~ShardedImageModel() noexcept {}
+
+    using Base::loglikes;
+
+    RealArray loglikes(const StateArray& deltas,
+                       IntArray& indices,
+                       const bool& update = false)
+    {
+        RealArray log_likes(deltas.size());
+        loglikes(deltas, indices, log_likes, update);
+        return log_likes;
+    }
+
+    void loglikes(const StateArray& deltas,
+                  IntArray& indices,
+                  Eigen::Ref<RealArray> log_likes,
+                  const bool& update)
+    {
+        const int count = deltas.size();
+        if (count > capacity_) throw ShardCapacityException(count, capacity_);
+
+        Header& header = *memory_.at<Header>(header_);
+        header.particle_count = count;
+        header.update = update;
+        header.frame_slot = (frame_ + RingSize - 1) % RingSize;
+        header.observation_time = observation_time_;
+        header.current = current_;
+
+        Eigen::Map<Eigen::VectorXd>(memory_.at<double>(poses_),
+                                    this->default_poses_.size()) =
+            this->default_poses_;
+
+        double* deltas_data = memory_.at<double>(deltas_);
+        for (int i = 0; i < count; ++i)
+        {
+            Eigen::Map<Eigen::VectorXd>(deltas_data + i * state_dimension_,
+                                        state_dimension_) = deltas[i];
+        }
+        std::copy(indices.data(),
+                  indices.data() + count,
+                  memory_.at<int>(indices_));
+
+        pool_.run();
+
+        log_likes = Eigen::Map<RealArray>(memory_.at<fl::Real>(log_likes_),
+                                          count);
+
+        if (update)
+        {
+            current_ = 1 - current_;
+            particle_count_ = count;
+            for (int i_state = 0; i_state < count; i_state++)
+                indices[i_state] = i_state;
+        }
+    }
+
+    void set_observation(const Observation& image)
+    {
+        assert(image.size() == n_pixels_);
+
+        float* slot =
+            memory_.at<float>(observations_) + (frame_ % RingSize) * n_pixels_;
+        for (int i = 0; i < image.size(); ++i)
+        {
+            slot[i] = image(i, 0);
+        }
+        ++frame_;
+
+        observation_time_ += this->delta_time_;
+    }
+
+    virtual void reset()
+    {
+        float* occlusions =
+            memory_.at<float>(occlusions_) + current_ * capacity_ * n_pixels_;
+        double* occlusion_times = memory_.at<double>(occlusion_times_) +
+                                  current_ * capacity_ * n_pixels_;
+
+        std::fill(occlusions, occlusions + n_pixels_, initial_occlusion_);
+        std::fill(occlusion_times, occlusion_times + n_pixels_, 0.0);
+        observation_time_ = 0;
+        particle_count_ = 1;
+    }
+
+    Snapshot snapshot() const
+    {
+        const size_t size = particle_count_ * n_pixels_;
+        const float* occlusions =
+            memory_.at<float>(occlusions_) + current_ * capacity_ * n_pixels_;
+        const double* occlusion_times = memory_.at<double>(occlusion_times_) +
+                                        current_ * capacity_ * n_pixels_;
+
+        Snapshot snapshot;
+        snapshot.occlusions.assign(occlusions, occlusions + size);
+        snapshot.occlusion_times.assign(occlusion_times,
+                                        occlusion_times + size);
+        snapshot.observation_time = observation_time_;
+        return snapshot;
+    }
+
+    /**
+     * \throws ShardCapacityException if the snapshot holds more particles
+     *         than the shared occlusion state
+     */
+    void restore(const Snapshot& snapshot)
+    {
+        if (snapshot.occlusions.empty()) return;
+
+        const int count = snapshot.occlusions.size() / n_pixels_;
+        if (count > capacity_) throw ShardCapacityException(count, capacity_);
+
+        std::copy(snapshot.occlusions.begin(),
+                  snapshot.occlusions.end(),
+                  memory_.at<float>(occlusions_) +
+                      current_ * capacity_ * n_pixels_);
+        std::copy(snapshot.occlusion_times.begin(),
+                  snapshot.occlusion_times.end(),
+                  memory_.at<double>(occlusion_times_) +
+                      current_ * capacity_ * n_pixels_);
+        observation_time_ = snapshot.observation_time;
+        particle_count_ = count;
+    }
+
+    /**
+     * \brief Returns the number of times worker processes were restarted
+     */
+    int count_restarts() const { return pool_.count_restarts(); }
+
+private:
+    /**
+     * \brief Parameters of a call shared with the workers
+     */
+    struct Header
+    {
+        int particle_count;
+        int update;
+        int frame_slot;
+        int current;
+        double observation_time;
+    };
+
+    /**
+     * \brief Computes the offsets of the shared sections and returns the
+     *        total size
+     */
+    size_t layout()
+    {
+        SharedMemoryLayout layout;
+        header_ = layout.add<Header>(1);
+        poses_ = layout.add<double>(model_->integrated_poses().size());
+        deltas_ = layout.add<double>(capacity_ * state_dimension_);
+        indices_ = layout.add<int>(capacity_);
+        log_likes_ = layout.add<fl::Real>(capacity_);
+        observations_ = layout.add<float>(RingSize * n_pixels_);
+        occlusions_ = layout.add<float>(2 * capacity_ * n_pixels_);
+        occlusion_times_ = layout.add<double>(2 * capacity_ * n_pixels_);
+        return layout.size();
+    }
+
+    /**
+     * \brief Evaluates the slice of the given worker. Runs in the worker
+     *        process.
+     */
+    void evaluate(int worker)
+    {
+        const Header& header = *memory_.at<Header>(header_);
+
+        int begin, end;
+        pool_.partition(header.particle_count, worker, begin, end);
+        const int count = end - begin;
+        if (count == 0) return;
+
+        auto& poses = model_->integrated_poses();
+        poses = Eigen::Map<const Eigen::VectorXd>(memory_.at<double>(poses_),
+                                                  poses.size());
+
+        StateArray deltas(count);
+        const double* deltas_data = memory_.at<double>(deltas_);
+        for (int i = 0; i < count; ++i)
+        {
+            deltas[i] = State(Eigen::Map<const Eigen::VectorXd>(
+                deltas_data + (begin + i) * state_dimension_,
+                state_dimension_));
+        }
+        IntArray indices =
+            Eigen::Map<IntArray>(memory_.at<int>(indices_) + begin, count);
+
+        const size_t current = header.current * capacity_ * n_pixels_;
+        const size_t next =
+            (1 - header.current) * capacity_ * n_pixels_ + begin * n_pixels_;
+
+        typename Model::ParticleBuffers buffers;
+        buffers.observations = memory_.at<float>(observations_) +
+                               header.frame_slot * n_pixels_;
+        buffers.observation_time = header.observation_time;
+        buffers.occlusions = memory_.at<float>(occlusions_) + current;
+        buffers.occlusion_times = memory_.at<double>(occlusion_times_) + current;
+        buffers.new_occlusions = memory_.at<float>(occlusions_) + next;
+        buffers.new_occlusion_times = memory_.at<double>(occlusion_times_) + next;
+
+        Eigen::Map<RealArray> log_likes(
+            memory_.at<fl::Real>(log_likes_) + begin, count);
+
+        model_->loglikes(deltas, indices, buffers, header.update, log_likes);
+    }
+
+private:
+    std::shared_ptr<Model> model_;
+    const int capacity_;
+    const size_t n_pixels_;
+    const float initial_occlusion_;
+    const int body_count_;
+    const int state_dimension_;
+
+    double observation_time_;
+    size_t frame_;
+    int current_;
+    // occlusion rows of the current half, those of the last update
+    int particle_count_;
+
+    // offsets of the shared sections
+    size_t header_;
+    size_t poses_;
+    size_t deltas_;
+    size_t indices_;
+    size_t log_likes_;
+    size_t observations_;
+    size_t occlusions_;
+    size_t occlusion_times_;
+
+    SharedMemory memory_;
+    ProcessPool pool_;
+};
+}
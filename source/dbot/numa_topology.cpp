@@ -0,0 +1,121 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file numa_topology.cpp
+ * \date October 2016
+ */
+
+#include <dbot/numa_topology.h>
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <sched.h>
+
+namespace dbot
+{
+NumaTopology NumaTopology::detect()
+{
+    std::vector<std::vector<int>> node_cpus;
+
+    // node ids may have gaps, e.g. on systems with memory only nodes
+    int missing = 0;
+    for (int node = 0; missing < 8; ++node)
+    {
+        std::ifstream file("/sys/devices/system/node/node" +
+                           std::to_string(node) + "/cpulist");
+        if (!file.is_open())
+        {
+            ++missing;
+            continue;
+        }
+
+        std::string list;
+        std::getline(file, list);
+        auto cpus = parse_cpu_list(list);
+        if (!cpus.empty()) node_cpus.push_back(cpus);
+    }
+
+    if (node_cpus.empty())
+    {
+        std::vector<int> cpus;
+        int count = std::max(1u, std::thread::hardware_concurrency());
+        for (int cpu = 0; cpu < count; ++cpu) cpus.push_back(cpu);
+        node_cpus.push_back(cpus);
+    }
+
+    return NumaTopology(node_cpus);
+}
+
+NumaTopology::NumaTopology(const std::vector<int>& cpus)
+    : node_cpus_(1, cpus)
+{
+}
+
+NumaTopology::NumaTopology(const std::vector<std::vector<int>>& node_cpus)
+    : node_cpus_(node_cpus)
+{
+}
+
+int NumaTopology::count_nodes() const
+{
+    return node_cpus_.size();
+}
+
+const std::vector<int>& NumaTopology::cpus(int node) const
+{
+    return node_cpus_[node];
+}
+
+bool NumaTopology::bind_current_thread(int node) const
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : node_cpus_[node])
+    {
+        if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+std::vector<int> NumaTopology::parse_cpu_list(const std::string& list)
+{
+    std::vector<int> cpus;
+    std::stringstream stream(list);
+    std::string range;
+
+    while (std::getline(stream, range, ','))
+    {
+        if (range.find_first_of("0123456789") == std::string::npos) continue;
+
+        int first, last;
+        auto dash = range.find('-');
+        if (dash == std::string::npos)
+        {
+            first = last = std::stoi(range);
+        }
+        else
+        {
+            first = std::stoi(range.substr(0, dash));
+            last = std::stoi(range.substr(dash + 1));
+        }
+
+        for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+    }
+
+    return cpus;
+}
+}
@@ -0,0 +1,74 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file numa_topology.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace dbot
+{
+/**
+ * \brief Describes the NUMA nodes of the host and the CPUs attached to each.
+ *
+ * The topology is read from /sys/devices/system/node. On systems without NUMA
+ * information a single node holding all online CPUs is reported.
+ */
+class NumaTopology
+{
+public:
+    /**
+     * \brief Detects the topology of the host
+     */
+    static NumaTopology detect();
+
+    /**
+     * \brief Creates a topology of a single node with the given CPUs
+     */
+    explicit NumaTopology(const std::vector<int>& cpus);
+
+    /**
+     * \brief Creates a topology from per node CPU lists
+     */
+    explicit NumaTopology(const std::vector<std::vector<int>>& node_cpus);
+
+    /**
+     * \brief Returns the number of nodes with at least one CPU
+     */
+    int count_nodes() const;
+
+    /**
+     * \brief Returns the CPUs of the given node
+     */
+    const std::vector<int>& cpus(int node) const;
+
+    /**
+     * \brief Restricts the calling thread to the CPUs of the given node.
+     *        Returns false if the affinity could not be set.
+     */
+    bool bind_current_thread(int node) const;
+
+    /**
+     * \brief Parses a kernel CPU list such as "0-3,8,10-11"
+     */
+    static std::vector<int> parse_cpu_list(const std::string& list);
+
+private:
+    std::vector<std::vector<int>> node_cpus_;
+};
+}
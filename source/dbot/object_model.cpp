@@ -19,21 +19,40 @@
 
 #include <dbot/object_model.h>
 
+#include <cassert>
+
 namespace dbot
 {
 ObjectModel::ObjectModel(const std::shared_ptr<ObjectModelLoader>& loader,
-                         bool center)
+                         bool center,
+                         int instances)
 {
-    load_from(loader, center);
+    load_from(loader, center, instances);
 }
 
 void ObjectModel::load_from(const std::shared_ptr<ObjectModelLoader>& loader,
-                            bool center)
+                            bool center,
+                            int instances)
 {
+    assert(instances > 0);
+
     loader->load(vertices_, triangle_indices_);
+    meshes_ = vertices_.size();
     compute_centers(centers_);
 
     if (center) center_vertices(centers_, vertices_);
+
+    // the instances are copies of the loaded meshes, the renderers detect
+    // identical parts and share their precomputed data
+    for (int instance = 1; instance < instances; ++instance)
+    {
+        for (int mesh = 0; mesh < meshes_; ++mesh)
+        {
+            vertices_.push_back(vertices_[mesh]);
+            triangle_indices_.push_back(triangle_indices_[mesh]);
+            centers_.push_back(centers_[mesh]);
+        }
+    }
 }
 
 auto ObjectModel::vertices() const -> const Vertices &
@@ -56,6 +75,21 @@ int ObjectModel::count_parts() const
     return vertices_.size();
 }
 
+int ObjectModel::count_meshes() const
+{
+    return meshes_;
+}
+
+int ObjectModel::count_instances() const
+{
+    return meshes_ == 0 ? 0 : count_parts() / meshes_;
+}
+
+int ObjectModel::mesh_of(int part) const
+{
+    return part % meshes_;
+}
+
 void ObjectModel::compute_centers(std::vector<Eigen::Vector3d>& centers)
 {
     centers.resize(vertices_.size());
@@ -70,6 +104,27 @@ void ObjectModel::compute_centers(std::vector<Eigen::Vector3d>& centers)
     }
 }
 
+ObjectModelFuture load_object_model(
+    const std::shared_ptr<ObjectModelLoader>& loader,
+    bool center,
+    int instances)
+{
+    return std::async(std::launch::async,
+                      [loader, center, instances]() {
+                          return std::make_shared<ObjectModel>(
+                              loader, center, instances);
+                      })
+        .share();
+}
+
+ObjectModelFuture ready_object_model(
+    const std::shared_ptr<ObjectModel>& object_model)
+{
+    std::promise<std::shared_ptr<ObjectModel>> promise;
+    promise.set_value(object_model);
+    return promise.get_future().share();
+}
+
 void ObjectModel::center_vertices(
     const std::vector<Eigen::Vector3d>& centers,
     std::vector<std::vector<Eigen::Vector3d>>& vertices)
@@ -19,6 +19,7 @@
 
 #pragma once
 
+#include <future>
 #include <vector>
 #include <memory>
 
@@ -30,6 +31,13 @@
 
 namespace dbot
 {
+/**
+ * \brief Meshes of the object parts. An object may consist of several
+ *        instances of the same meshes, e.g. identical parts in a bin, which
+ *        are tracked jointly as further parts of one state. The meshes are
+ *        loaded once and the parts of instance i are the parts
+ *        [i * count_meshes(), (i + 1) * count_meshes()).
+ */
 class ObjectModel
 {
 public:
@@ -39,10 +47,13 @@ public:
 public:
     ObjectModel() = default;
 
-    ObjectModel(const std::shared_ptr<ObjectModelLoader>& loader, bool center);
+    ObjectModel(const std::shared_ptr<ObjectModelLoader>& loader,
+                bool center,
+                int instances = 1);
 
     void load_from(const std::shared_ptr<ObjectModelLoader>& loader,
-                   bool center);
+                   bool center,
+                   int instances = 1);
 
     const Vertices& vertices() const;
 
@@ -52,6 +63,18 @@ public:
 
     int count_parts() const;
 
+    /**
+     * \brief Returns the number of meshes loaded, the parts per instance
+     */
+    int count_meshes() const;
+
+    int count_instances() const;
+
+    /**
+     * \brief Returns the index of the mesh of the given part
+     */
+    int mesh_of(int part) const;
+
 private:
     void compute_centers(std::vector<Eigen::Vector3d>& centers);
 
@@ -59,9 +82,32 @@ private:
                          std::vector<std::vector<Eigen::Vector3d>>& vertices);
 
 private:
+    int meshes_ = 0;
     std::vector<Eigen::Vector3d> centers_;
 
     std::vector<std::vector<Eigen::Vector3d>> vertices_;
     std::vector<std::vector<std::vector<int>>> triangle_indices_;
 };
+
+/**
+ * \brief Object model which may still be loading, see load_object_model()
+ */
+typedef std::shared_future<std::shared_ptr<ObjectModel>> ObjectModelFuture;
+
+/**
+ * \brief Loads an object model on a background thread, such that the caller
+ *        can set up everything which does not depend on the meshes in the
+ *        meantime. The future is ready once the model is loaded, get()
+ *        rethrows the exception of a failed load.
+ */
+ObjectModelFuture load_object_model(
+    const std::shared_ptr<ObjectModelLoader>& loader,
+    bool center,
+    int instances = 1);
+
+/**
+ * \brief Returns a ready future holding the given model
+ */
+ObjectModelFuture ready_object_model(
+    const std::shared_ptr<ObjectModel>& object_model);
 }
@@ -0,0 +1,158 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file object_model_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+
+#include <unistd.h>
+
+#include <dbot/object_model.h>
+#include <dbot/simple_wavefront_object_loader.h>
+
+namespace
+{
+// two meshes, a triangle and a shifted quad
+class TestLoader : public dbot::ObjectModelLoader
+{
+public:
+    void load(
+        std::vector<std::vector<Eigen::Vector3d>>& vertices,
+        std::vector<std::vector<std::vector<int>>>& triangle_indices) const
+    {
+        vertices = {{Eigen::Vector3d(0, 0, 0),
+                     Eigen::Vector3d(3, 0, 0),
+                     Eigen::Vector3d(0, 3, 0)},
+                    {Eigen::Vector3d(1, 1, 1),
+                     Eigen::Vector3d(3, 1, 1),
+                     Eigen::Vector3d(3, 3, 1),
+                     Eigen::Vector3d(1, 3, 1)}};
+        triangle_indices = {{{0, 1, 2}}, {{0, 1, 2}, {0, 2, 3}}};
+    }
+};
+
+class FailingLoader : public dbot::ObjectModelLoader
+{
+public:
+    void load(std::vector<std::vector<Eigen::Vector3d>>&,
+              std::vector<std::vector<std::vector<int>>>&) const
+    {
+        throw std::runtime_error("cannot load");
+    }
+};
+
+std::string working_directory()
+{
+    char path[4096];
+    return getcwd(path, sizeof(path)) ? path : "/";
+}
+}
+
+TEST(ObjectModelTests, single_instance)
+{
+    dbot::ObjectModel model(std::make_shared<TestLoader>(), false);
+
+    EXPECT_EQ(2, model.count_parts());
+    EXPECT_EQ(2, model.count_meshes());
+    EXPECT_EQ(1, model.count_instances());
+    EXPECT_TRUE(model.centers()[1].isApprox(Eigen::Vector3d(2, 2, 1)));
+}
+
+TEST(ObjectModelTests, instances_repeat_the_meshes)
+{
+    dbot::ObjectModel model(std::make_shared<TestLoader>(), true, 3);
+
+    EXPECT_EQ(6, model.count_parts());
+    EXPECT_EQ(2, model.count_meshes());
+    EXPECT_EQ(3, model.count_instances());
+
+    for (int part = 0; part < model.count_parts(); ++part)
+    {
+        const int mesh = model.mesh_of(part);
+        EXPECT_EQ(part % 2, mesh);
+        EXPECT_EQ(model.vertices()[mesh], model.vertices()[part]);
+        EXPECT_EQ(model.triangle_indices()[mesh],
+                  model.triangle_indices()[part]);
+        EXPECT_TRUE(model.centers()[mesh].isApprox(model.centers()[part]));
+    }
+
+    // centered once, not per instance
+    EXPECT_TRUE(model.vertices()[3][0].isApprox(Eigen::Vector3d(-1, -1, 0)));
+}
+
+TEST(ObjectModelTests, loads_in_background)
+{
+    dbot::ObjectModelFuture future =
+        dbot::load_object_model(std::make_shared<TestLoader>(), false, 2);
+    dbot::ObjectModel expected(std::make_shared<TestLoader>(), false, 2);
+
+    EXPECT_EQ(expected.vertices(), future.get()->vertices());
+    EXPECT_EQ(expected.triangle_indices(), future.get()->triangle_indices());
+    EXPECT_EQ(2, future.get()->count_instances());
+}
+
+TEST(ObjectModelTests, background_load_rethrows)
+{
+    auto future = dbot::load_object_model(std::make_shared<FailingLoader>(),
+                                          false);
+    EXPECT_THROW(future.get(), std::runtime_error);
+}
+
+TEST(ObjectModelTests, wavefront_meshes_load_concurrently)
+{
+    std::ofstream("object_model_test_a.obj") << "v 0 0 0\nv 1 0 0\nv 0 1 0\n"
+                                                "f 1 2 3\n";
+    std::ofstream("object_model_test_b.obj") << "v 0 0 0\nv 1 0 0\nv 1 1 0\n"
+                                                "v 0 1 0\nf 1 2 3\nf 1 3 4\n";
+
+    // the first file is listed twice
+    dbot::ObjectResourceIdentifier ori(
+        working_directory(),
+        "",
+        {"object_model_test_a.obj",
+         "object_model_test_b.obj",
+         "object_model_test_a.obj"});
+    auto model =
+        dbot::load_object_model(
+            std::make_shared<dbot::SimpleWavefrontObjectModelLoader>(ori),
+            false)
+            .get();
+
+    std::remove("object_model_test_a.obj");
+    std::remove("object_model_test_b.obj");
+
+    ASSERT_EQ(3, model->count_parts());
+    EXPECT_EQ(3u, model->vertices()[0].size());
+    EXPECT_EQ(4u, model->vertices()[1].size());
+    EXPECT_EQ(2u, model->triangle_indices()[1].size());
+    EXPECT_EQ(model->vertices()[0], model->vertices()[2]);
+    EXPECT_EQ(model->triangle_indices()[0], model->triangle_indices()[2]);
+}
+
+TEST(ObjectModelTests, missing_wavefront_mesh_throws)
+{
+    dbot::ObjectResourceIdentifier ori(
+        working_directory(), "", {"object_model_test_missing.obj"});
+    auto future = dbot::load_object_model(
+        std::make_shared<dbot::SimpleWavefrontObjectModelLoader>(ori), false);
+
+    EXPECT_THROW(future.get(), dbot::CannotOpenWavefrontFileException);
+}
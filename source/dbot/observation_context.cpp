@@ -0,0 +1,270 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file observation_context.cpp
+ * \date October 2016
+ */
+
+#include <dbot/observation_context.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace dbot
+{
+namespace
+{
+bool valid_depth(float depth)
+{
+    return std::isfinite(depth) && depth > 0;
+}
+
+bool same_model(const PixelModelParameters& a, const PixelModelParameters& b)
+{
+    return a.lambda == b.lambda && a.tail_weight == b.tail_weight &&
+           a.model_sigma == b.model_sigma &&
+           a.sigma_factor == b.sigma_factor && a.max_depth == b.max_depth;
+}
+
+/// halves the rows and columns of the depth, rounding up
+void downsample(const float* depth,
+                int rows,
+                int cols,
+                std::vector<float>& level)
+{
+    const int level_rows = (rows + 1) / 2;
+    const int level_cols = (cols + 1) / 2;
+    level.resize(level_rows * level_cols);
+
+    for (int row = 0; row < level_rows; ++row)
+    {
+        for (int col = 0; col < level_cols; ++col)
+        {
+            float sum = 0;
+            int count = 0;
+            for (int r = 2 * row; r < std::min(2 * row + 2, rows); ++r)
+            {
+                for (int c = 2 * col; c < std::min(2 * col + 2, cols); ++c)
+                {
+                    const float value = depth[r * cols + c];
+                    if (!valid_depth(value)) continue;
+                    sum += value;
+                    count++;
+                }
+            }
+            level[row * level_cols + col] =
+                count > 0 ? sum / count
+                          : std::numeric_limits<float>::quiet_NaN();
+        }
+    }
+}
+}
+
+ObservationContext::ObservationContext(
+    std::uint64_t frame,
+    const float* depth,
+    int rows,
+    int cols,
+    const ObservationRequirements& requirements,
+    const PointCloudConverter* converter)
+    : frame_(frame),
+      rows_(rows),
+      cols_(cols),
+      depth_(depth, depth + rows * cols)
+{
+    derive(requirements, converter);
+}
+
+ObservationContext::ObservationContext(
+    std::uint64_t frame,
+    const double* depth,
+    int rows,
+    int cols,
+    const ObservationRequirements& requirements,
+    const PointCloudConverter* converter)
+    : frame_(frame), rows_(rows), cols_(cols), depth_(rows * cols)
+{
+    convert_depth(depth, depth_.data(), size());
+    derive(requirements, converter);
+}
+
+void ObservationContext::derive(const ObservationRequirements& requirements,
+                                const PointCloudConverter* converter)
+{
+    const CpuKernels& kernels = cpu_kernels();
+
+    valid_.resize(size());
+    valid_count_ = 0;
+    for (int i = 0; i < size(); ++i)
+    {
+        valid_[i] = valid_depth(depth_[i]);
+        valid_count_ += valid_[i];
+    }
+
+    for (const auto& model : requirements.pixel_models)
+    {
+        if (infinities(model)) continue;
+
+        pixel_models_.push_back(model);
+        infinities_.emplace_back(size());
+        kernels.infinity_probs(
+            model, depth_.data(), size(), infinities_.back().data());
+    }
+
+    levels_.resize(std::max(requirements.levels, 0));
+    for (int i = 1; i < count_levels(); ++i)
+    {
+        downsample(
+            level(i - 1), level_rows(i - 1), level_cols(i - 1), levels_[i - 1]);
+    }
+
+    point_cloud_ = PointCloud{nullptr, nullptr, nullptr, nullptr};
+    if (requirements.point_cloud)
+    {
+        if (!converter || converter->rows() != rows_ ||
+            converter->cols() != cols_)
+        {
+            throw ObservationContextException(
+                "the point cloud needs a converter of the image size");
+        }
+
+        points_.resize(3 * size());
+        point_valid_.resize(size());
+        point_cloud_.x = points_.data();
+        point_cloud_.y = points_.data() + size();
+        point_cloud_.z = points_.data() + 2 * size();
+        point_cloud_.valid = point_valid_.data();
+        converter->to_points(depth_.data(), point_cloud_);
+    }
+}
+
+const float* ObservationContext::infinities(
+    const PixelModelParameters& model) const
+{
+    for (size_t i = 0; i < pixel_models_.size(); ++i)
+    {
+        if (same_model(pixel_models_[i], model)) return infinities_[i].data();
+    }
+    return nullptr;
+}
+
+const float* ObservationContext::level(int level) const
+{
+    if (level < 0 || level >= count_levels())
+    {
+        throw ObservationContextException("level " + std::to_string(level) +
+                                          " was not requested");
+    }
+    return level == 0 ? depth_.data() : levels_[level - 1].data();
+}
+
+int ObservationContext::level_rows(int level) const
+{
+    int rows = rows_;
+    for (int i = 0; i < level; ++i) rows = (rows + 1) / 2;
+    return rows;
+}
+
+int ObservationContext::level_cols(int level) const
+{
+    int cols = cols_;
+    for (int i = 0; i < level; ++i) cols = (cols + 1) / 2;
+    return cols;
+}
+
+const PointCloud& ObservationContext::point_cloud() const
+{
+    if (!point_cloud_.x)
+    {
+        throw ObservationContextException("the point cloud was not requested");
+    }
+    return point_cloud_;
+}
+
+ObservationSource::ObservationSource(const Eigen::Matrix3d& camera_matrix,
+                                     int rows,
+                                     int cols)
+    : rows_(rows),
+      cols_(cols),
+      converter_(camera_matrix, rows, cols),
+      frames_(0)
+{
+}
+
+void ObservationSource::subscribe(const ObservationRequirements& requirements)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (const auto& model : requirements.pixel_models)
+    {
+        bool known = false;
+        for (const auto& other : requirements_.pixel_models)
+        {
+            known = known || same_model(model, other);
+        }
+        if (!known) requirements_.pixel_models.push_back(model);
+    }
+    requirements_.levels = std::max(requirements_.levels, requirements.levels);
+    requirements_.point_cloud =
+        requirements_.point_cloud || requirements.point_cloud;
+}
+
+ObservationRequirements ObservationSource::requirements() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return requirements_;
+}
+
+auto ObservationSource::publish(const double* depth)
+    -> std::shared_ptr<const ObservationContext>
+{
+    return build(depth);
+}
+
+auto ObservationSource::publish(const float* depth)
+    -> std::shared_ptr<const ObservationContext>
+{
+    return build(depth);
+}
+
+auto ObservationSource::latest() const
+    -> std::shared_ptr<const ObservationContext>
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return latest_;
+}
+
+template <typename Real>
+auto ObservationSource::build(const Real* depth)
+    -> std::shared_ptr<const ObservationContext>
+{
+    ObservationRequirements requirements;
+    std::uint64_t frame;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        requirements = requirements_;
+        frame = frames_++;
+    }
+
+    // the context is built outside of the lock, subscribers are not held up
+    std::shared_ptr<const ObservationContext> context =
+        std::make_shared<ObservationContext>(
+            frame, depth, rows_, cols_, requirements, &converter_);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!latest_ || latest_->frame() < frame) latest_ = context;
+    return context;
+}
+}
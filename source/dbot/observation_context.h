@@ -0,0 +1,219 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file observation_context.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <dbot/cpu_kernels.h>
+#include <dbot/point_cloud.h>
+
+namespace dbot
+{
+class ObservationContextException : public std::exception
+{
+public:
+    explicit ObservationContextException(const std::string& message)
+        : message_("Observation context: " + message)
+    {
+    }
+
+    const char* what() const noexcept { return message_.c_str(); }
+
+private:
+    std::string message_;
+};
+
+/**
+ * \brief Derived data of a frame which the consumers of a camera request,
+ *        see ObservationSource
+ */
+struct ObservationRequirements
+{
+    /// pixel models whose infinity probabilities are precomputed
+    std::vector<PixelModelParameters> pixel_models;
+
+    /// downsampled levels in addition to the full resolution
+    int levels = 0;
+
+    /// back projection of the depth into the camera frame
+    bool point_cloud = false;
+};
+
+/**
+ * \brief Immutable data of one depth frame, shared by all sensors and
+ *        trackers observing the same camera.
+ *
+ * The context holds the depth in single precision, its validity mask and
+ * the derived data requested by the consumers: the infinity probabilities
+ * of each pixel model, see CpuKernels::infinity_probs, downsampled levels
+ * and the point cloud. It is computed once per frame by
+ * ObservationSource::publish() and handed out by reference count, such that
+ * a consumer neither copies the frame nor recomputes its derived data.
+ */
+class ObservationContext
+{
+public:
+    /**
+     * \brief Builds the context of a row major depth image in meters. A
+     *        depth which is NaN, infinite or not positive is invalid.
+     *
+     * \param converter  Back projection of the camera, required if the
+     *                   point cloud is requested
+     *
+     * \throws ObservationContextException if the point cloud is requested
+     *         without a converter of the image size
+     */
+    ObservationContext(std::uint64_t frame,
+                       const float* depth,
+                       int rows,
+                       int cols,
+                       const ObservationRequirements& requirements,
+                       const PointCloudConverter* converter = nullptr);
+    ObservationContext(std::uint64_t frame,
+                       const double* depth,
+                       int rows,
+                       int cols,
+                       const ObservationRequirements& requirements,
+                       const PointCloudConverter* converter = nullptr);
+
+    ObservationContext(const ObservationContext&) = delete;
+    ObservationContext& operator=(const ObservationContext&) = delete;
+
+    /// number of the frame at its source
+    std::uint64_t frame() const { return frame_; }
+
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+    int size() const { return rows_ * cols_; }
+
+    /// depth of each pixel in meters as published
+    const float* depth() const { return depth_.data(); }
+
+    /// one for each pixel of a valid depth, zero otherwise
+    const unsigned char* valid() const { return valid_.data(); }
+    int valid_count() const { return valid_count_; }
+
+    /**
+     * \brief Returns the probabilities of the observations given an
+     *        infinitely distant object of the pixel model, or null if they
+     *        were not requested
+     */
+    const float* infinities(const PixelModelParameters& model) const;
+
+    /**
+     * \brief Returns the given level of the depth, level 0 is the full
+     *        resolution and each further level halves the rows and columns.
+     *        A pixel of a level is the mean of the valid pixels of its 2 x 2
+     *        block in the level above, NaN if there is none.
+     *
+     * \throws ObservationContextException if the level was not requested
+     */
+    const float* level(int level) const;
+    int level_rows(int level) const;
+    int level_cols(int level) const;
+    int count_levels() const { return int(levels_.size()) + 1; }
+
+    /**
+     * \brief Returns the point cloud of the full resolution depth. Its
+     *        buffers belong to the context and must not be written.
+     *
+     * \throws ObservationContextException if it was not requested
+     */
+    const PointCloud& point_cloud() const;
+    bool has_point_cloud() const { return point_cloud_.x != nullptr; }
+
+private:
+    /// computes the mask and the requested data from the depth
+    void derive(const ObservationRequirements& requirements,
+                const PointCloudConverter* converter);
+
+private:
+    std::uint64_t frame_;
+    int rows_;
+    int cols_;
+
+    std::vector<float> depth_;
+    std::vector<unsigned char> valid_;
+    int valid_count_;
+
+    std::vector<PixelModelParameters> pixel_models_;
+    std::vector<std::vector<float>> infinities_;
+
+    std::vector<std::vector<float>> levels_;
+
+    std::vector<float> points_;
+    std::vector<unsigned char> point_valid_;
+    PointCloud point_cloud_;
+};
+
+/**
+ * \brief Publishes the frames of one camera as shared contexts.
+ *
+ * Consumers subscribe with the derived data they need before the frames
+ * arrive, e.g. a sensor its pixel model. Each publish() then builds a
+ * single context with the union of the requirements, however many
+ * consumers read it. Subscribing and publishing may happen on different
+ * threads.
+ */
+class ObservationSource
+{
+public:
+    ObservationSource(const Eigen::Matrix3d& camera_matrix, int rows, int cols);
+
+    /// adds the requirements of a consumer to those of the next frames
+    void subscribe(const ObservationRequirements& requirements);
+
+    /// requirements of the next frames
+    ObservationRequirements requirements() const;
+
+    /**
+     * \brief Builds the context of the next frame from a row major depth
+     *        image of rows * cols values in meters
+     */
+    std::shared_ptr<const ObservationContext> publish(const double* depth);
+    std::shared_ptr<const ObservationContext> publish(const float* depth);
+
+    /// the last published context, null before the first frame
+    std::shared_ptr<const ObservationContext> latest() const;
+
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+
+private:
+    template <typename Real>
+    std::shared_ptr<const ObservationContext> build(const Real* depth);
+
+private:
+    int rows_;
+    int cols_;
+    PointCloudConverter converter_;
+
+    mutable std::mutex mutex_;
+    ObservationRequirements requirements_;
+    std::uint64_t frames_;
+    std::shared_ptr<const ObservationContext> latest_;
+};
+}
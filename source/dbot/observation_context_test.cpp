@@ -0,0 +1,177 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file observation_context_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <dbot/observation_context.h>
+
+using namespace dbot;
+
+namespace
+{
+const float missing_depth = std::numeric_limits<float>::quiet_NaN();
+
+Eigen::Matrix3d camera_matrix()
+{
+    Eigen::Matrix3d matrix;
+    matrix << 100, 0, 2, 0, 100, 1.5, 0, 0, 1;
+    return matrix;
+}
+
+// 3 x 4 pixels with missing and invalid measurements
+const float depth[12] = {1.0f, 2.0f, missing_depth, 4.0f,
+                         3.0f, 0.0f, 1.0f, 1.0f,
+                         -1.0f, 5.0f, std::numeric_limits<float>::infinity(),
+                         2.0f};
+
+const PixelModelParameters model = {
+    -std::log(0.5), 0.01, 0.003, 0.00142478, 6.0};
+}
+
+TEST(ObservationContextTests, mask_and_levels)
+{
+    ObservationRequirements requirements;
+    requirements.levels = 2;
+    ObservationContext context(7, depth, 3, 4, requirements);
+
+    EXPECT_EQ(7u, context.frame());
+    EXPECT_EQ(12, context.size());
+    EXPECT_EQ(8, context.valid_count());
+    EXPECT_EQ(0, context.valid()[2]);
+    EXPECT_EQ(0, context.valid()[5]);
+    EXPECT_EQ(0, context.valid()[8]);
+    EXPECT_EQ(0, context.valid()[10]);
+    EXPECT_EQ(1, context.valid()[11]);
+
+    ASSERT_EQ(3, context.count_levels());
+    EXPECT_EQ(context.depth(), context.level(0));
+
+    // the invalid pixels are left out of the means
+    EXPECT_EQ(2, context.level_rows(1));
+    EXPECT_EQ(2, context.level_cols(1));
+    const float* half = context.level(1);
+    EXPECT_FLOAT_EQ(2.0f, half[0]);
+    EXPECT_FLOAT_EQ(2.0f, half[1]);
+    EXPECT_FLOAT_EQ(5.0f, half[2]);
+    EXPECT_FLOAT_EQ(2.0f, half[3]);
+
+    EXPECT_EQ(1, context.level_rows(2));
+    EXPECT_EQ(1, context.level_cols(2));
+    EXPECT_FLOAT_EQ(2.75f, context.level(2)[0]);
+
+    EXPECT_THROW(context.level(3), ObservationContextException);
+    EXPECT_THROW(context.point_cloud(), ObservationContextException);
+    EXPECT_EQ(nullptr, context.infinities(model));
+}
+
+TEST(ObservationContextTests, empty_blocks_are_nan)
+{
+    const float missing[4] = {missing_depth, missing_depth, 0.0f, 1.0f};
+    ObservationRequirements requirements;
+    requirements.levels = 1;
+    ObservationContext context(0, missing, 2, 2, requirements);
+    EXPECT_FLOAT_EQ(1.0f, context.level(1)[0]);
+
+    ObservationContext left(0, missing, 1, 4, requirements);
+    EXPECT_TRUE(std::isnan(left.level(1)[0]));
+    EXPECT_FLOAT_EQ(1.0f, left.level(1)[1]);
+}
+
+TEST(ObservationContextTests, derived_data_matches_direct_computation)
+{
+    ObservationRequirements requirements;
+    requirements.pixel_models.push_back(model);
+    requirements.pixel_models.push_back(model);
+    requirements.point_cloud = true;
+
+    PointCloudConverter converter(camera_matrix(), 3, 4);
+    ObservationContext context(0, depth, 3, 4, requirements, &converter);
+
+    std::vector<float> infinities(12);
+    cpu_kernels().infinity_probs(model, depth, 12, infinities.data());
+    ASSERT_NE(nullptr, context.infinities(model));
+    for (int i = 0; i < 12; ++i)
+    {
+        if (context.valid()[i])
+        {
+            EXPECT_EQ(infinities[i], context.infinities(model)[i]);
+        }
+    }
+
+    PixelModelParameters other = model;
+    other.model_sigma = 0.004;
+    EXPECT_EQ(nullptr, context.infinities(other));
+
+    std::vector<float> x(12), y(12), z(12);
+    std::vector<unsigned char> valid(12);
+    PointCloud expected = {x.data(), y.data(), z.data(), valid.data()};
+    EXPECT_EQ(8, converter.to_points(depth, expected));
+    ASSERT_TRUE(context.has_point_cloud());
+    const PointCloud& points = context.point_cloud();
+    for (int i = 0; i < 12; ++i)
+    {
+        EXPECT_EQ(valid[i], points.valid[i]);
+        if (!valid[i]) continue;
+        EXPECT_EQ(x[i], points.x[i]);
+        EXPECT_EQ(y[i], points.y[i]);
+        EXPECT_EQ(z[i], points.z[i]);
+    }
+
+    EXPECT_THROW(ObservationContext(0, depth, 3, 4, requirements),
+                 ObservationContextException);
+}
+
+TEST(ObservationContextTests, source_merges_requirements)
+{
+    ObservationSource source(camera_matrix(), 3, 4);
+    EXPECT_EQ(nullptr, source.latest());
+
+    ObservationRequirements sensor;
+    sensor.pixel_models.push_back(model);
+    source.subscribe(sensor);
+    source.subscribe(sensor);
+
+    ObservationRequirements refiner;
+    refiner.point_cloud = true;
+    refiner.levels = 1;
+    source.subscribe(refiner);
+
+    EXPECT_EQ(1u, source.requirements().pixel_models.size());
+    EXPECT_TRUE(source.requirements().point_cloud);
+    EXPECT_EQ(1, source.requirements().levels);
+
+    std::vector<double> wide(depth, depth + 12);
+    auto first = source.publish(wide.data());
+    auto second = source.publish(depth);
+    EXPECT_EQ(0u, first->frame());
+    EXPECT_EQ(1u, second->frame());
+    EXPECT_EQ(second, source.latest());
+
+    for (int i = 0; i < 12; ++i)
+    {
+        if (!second->valid()[i]) continue;
+        EXPECT_EQ(depth[i], first->depth()[i]);
+        EXPECT_EQ(second->infinities(model)[i], first->infinities(model)[i]);
+    }
+    EXPECT_TRUE(first->has_point_cloud());
+    EXPECT_EQ(2, first->count_levels());
+}
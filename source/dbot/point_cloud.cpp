@@ -0,0 +1,145 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file point_cloud.cpp
+ * \date October 2016
+ */
+
+#include <dbot/point_cloud.h>
+
+#include <cmath>
+
+#include <dbot/cpu_kernels.h>
+
+namespace dbot
+{
+PointCloudConverter::PointCloudConverter(const Eigen::Matrix3d& camera_matrix,
+                                         int rows,
+                                         int cols)
+    : camera_matrix_(camera_matrix),
+      rows_(rows),
+      cols_(cols),
+      ray_x_(rows * cols),
+      ray_y_(rows * cols),
+      ray_z_(rows * cols)
+{
+    const Eigen::Matrix3d inverse = camera_matrix.inverse();
+
+    for (int row = 0; row < rows_; ++row)
+    {
+        for (int col = 0; col < cols_; ++col)
+        {
+            const Eigen::Vector3d ray = inverse * Eigen::Vector3d(col, row, 1);
+            const int pixel = row * cols_ + col;
+            ray_x_[pixel] = ray(0);
+            ray_y_[pixel] = ray(1);
+            ray_z_[pixel] = ray(2);
+        }
+    }
+}
+
+auto PointCloudConverter::image(int step) const -> Region
+{
+    Region region;
+    region.row_begin = 0;
+    region.row_end = rows_;
+    region.col_begin = 0;
+    region.col_end = cols_;
+    region.step = step;
+    return region;
+}
+
+int PointCloudConverter::to_points(const float* depth,
+                                   const Region& region,
+                                   const PointCloud& points) const
+{
+    if (region.step < 1)
+    {
+        throw PointCloudException("step must be positive");
+    }
+    if (region.row_begin < 0 || region.row_end > rows_ ||
+        region.col_begin < 0 || region.col_end > cols_ ||
+        region.row_begin > region.row_end || region.col_begin > region.col_end)
+    {
+        throw PointCloudException("region exceeds the image");
+    }
+
+    const CpuKernels& kernels = cpu_kernels();
+    const int cols = region.cols();
+
+    int valid = 0;
+    for (int i = 0; i < region.rows(); ++i)
+    {
+        const int pixel =
+            (region.row_begin + i * region.step) * cols_ + region.col_begin;
+        const int point = i * cols;
+
+        valid += kernels.backproject_depth(&ray_x_[pixel],
+                                           &ray_y_[pixel],
+                                           &ray_z_[pixel],
+                                           depth + pixel,
+                                           cols,
+                                           region.step,
+                                           points.x + point,
+                                           points.y + point,
+                                           points.z + point,
+                                           points.valid + point);
+    }
+
+    return valid;
+}
+
+int PointCloudConverter::to_points(const float* depth,
+                                   const PointCloud& points) const
+{
+    return to_points(depth, image(), points);
+}
+
+int PointCloudConverter::to_depth(const float* x,
+                                  const float* y,
+                                  const float* z,
+                                  int count,
+                                  float* depth) const
+{
+    const Eigen::Matrix3d& k = camera_matrix_;
+
+    int outside = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        if (std::isnan(x[i]) || std::isnan(y[i]) || std::isnan(z[i]))
+        {
+            continue;
+        }
+
+        const double u = (k(0, 0) * x[i] + k(0, 1) * y[i] + k(0, 2) * z[i]) /
+                         z[i];
+        const double v = (k(1, 0) * x[i] + k(1, 1) * y[i] + k(1, 2) * z[i]) /
+                         z[i];
+        if (!(z[i] > 0) || !(u + 0.5 >= 0 && u + 0.5 < cols_) ||
+            !(v + 0.5 >= 0 && v + 0.5 < rows_))
+        {
+            outside++;
+            continue;
+        }
+
+        const int col = std::floor(u + 0.5);
+        const int row = std::floor(v + 0.5);
+
+        float& pixel = depth[row * cols_ + col];
+        if (!(pixel <= z[i])) pixel = z[i];
+    }
+
+    return outside;
+}
+}
@@ -0,0 +1,148 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file point_cloud.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <exception>
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+
+namespace dbot
+{
+class PointCloudException : public std::exception
+{
+public:
+    explicit PointCloudException(const std::string& message)
+        : message_("Point cloud: " + message)
+    {
+    }
+
+    const char* what() const noexcept { return message_.c_str(); }
+
+private:
+    std::string message_;
+};
+
+/**
+ * \brief Organized point cloud in caller provided structure of arrays
+ *        buffers. Point i of a region of r x c points is the pixel
+ *        (i / c, i % c) of the region. Invalid points are NaN and have a
+ *        zero mask.
+ */
+struct PointCloud
+{
+    float* x;
+    float* y;
+    float* z;
+    unsigned char* valid;
+};
+
+/**
+ * \brief Converts between row major depth images and organized point clouds
+ *        in the camera frame.
+ *
+ * The ray through each pixel, i.e. the inverse camera matrix times
+ * (col, row, 1), is computed once on construction, such that a conversion
+ * is one multiplication per coordinate. The conversions run on the kernels
+ * of the active CPU variant and allocate nothing.
+ */
+class PointCloudConverter
+{
+public:
+    /**
+     * \brief Pixels [row_begin, row_end) x [col_begin, col_end) of an image,
+     *        every step-th pixel of every step-th row
+     */
+    struct Region
+    {
+        int row_begin;
+        int row_end;
+        int col_begin;
+        int col_end;
+        int step;
+
+        /// rows and columns of the point cloud of the region
+        int rows() const { return (row_end - row_begin + step - 1) / step; }
+        int cols() const { return (col_end - col_begin + step - 1) / step; }
+        int size() const { return rows() * cols(); }
+    };
+
+public:
+    PointCloudConverter(const Eigen::Matrix3d& camera_matrix,
+                        int rows,
+                        int cols);
+
+    /**
+     * \brief Returns the whole image, downsampled by the given step
+     */
+    Region image(int step = 1) const;
+
+    /**
+     * \brief Back projects the pixels of the region of the depth image in
+     *        meters into the point cloud of region.size() points. Depths
+     *        which are NaN, infinite or not positive are invalid. Returns
+     *        the number of valid points.
+     *
+     * \throws PointCloudException if the region exceeds the image or the
+     *         step is not positive
+     */
+    int to_points(const float* depth,
+                  const Region& region,
+                  const PointCloud& points) const;
+
+    /**
+     * \brief Back projects the whole depth image
+     */
+    int to_points(const float* depth, const PointCloud& points) const;
+
+    /**
+     * \brief Projects count points into the depth image, keeping the
+     *        closest depth of each pixel. Pixels without a point keep
+     *        their depth. NaN points are skipped. Returns the number of
+     *        points which lie behind the camera or outside of the image,
+     *        which are skipped as well.
+     */
+    int to_depth(const float* x,
+                 const float* y,
+                 const float* z,
+                 int count,
+                 float* depth) const;
+
+    /**
+     * \brief Ray through the given pixel, its depth component is one for a
+     *        pinhole camera matrix
+     */
+    Eigen::Vector3d ray(int pixel) const
+    {
+        return Eigen::Vector3d(ray_x_[pixel], ray_y_[pixel], ray_z_[pixel]);
+    }
+
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+
+private:
+    Eigen::Matrix3d camera_matrix_;
+    int rows_;
+    int cols_;
+    std::vector<float> ray_x_;
+    std::vector<float> ray_y_;
+    std::vector<float> ray_z_;
+};
+}
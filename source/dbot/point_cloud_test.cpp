@@ -0,0 +1,204 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file point_cloud_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <dbot/point_cloud.h>
+
+using namespace dbot;
+
+namespace
+{
+/// structure of arrays buffers of a point cloud
+struct PointBuffers
+{
+    explicit PointBuffers(int count) : x(count), y(count), z(count), valid(count)
+    {
+    }
+
+    PointCloud cloud()
+    {
+        PointCloud points = {x.data(), y.data(), z.data(), valid.data()};
+        return points;
+    }
+
+    std::vector<float> x, y, z;
+    std::vector<unsigned char> valid;
+};
+}
+
+class PointCloudTests : public ::testing::Test
+{
+protected:
+    PointCloudTests() : converter_(camera_matrix(), rows_, cols_)
+    {
+        // a plane tilted about the vertical axis
+        for (int row = 0; row < rows_; ++row)
+        {
+            for (int col = 0; col < cols_; ++col)
+            {
+                depth_.push_back(1.0f + 0.01f * col);
+            }
+        }
+    }
+
+    static Eigen::Matrix3d camera_matrix()
+    {
+        Eigen::Matrix3d camera_matrix;
+        camera_matrix << 50, 0, 9.5, 0, 50, 7.5, 0, 0, 1;
+        return camera_matrix;
+    }
+
+    /// back projection of a pixel as by the camera matrix inverse
+    Eigen::Vector3d expected_point(int row, int col) const
+    {
+        return depth_[row * cols_ + col] *
+               (camera_matrix().inverse() * Eigen::Vector3d(col, row, 1));
+    }
+
+    const int rows_ = 16;
+    const int cols_ = 20;
+    PointCloudConverter converter_;
+    std::vector<float> depth_;
+};
+
+TEST_F(PointCloudTests, back_projects_along_pixel_rays)
+{
+    PointBuffers buffers(rows_ * cols_);
+    EXPECT_EQ(rows_ * cols_, converter_.to_points(depth_.data(),
+                                                  buffers.cloud()));
+
+    for (int row = 0; row < rows_; ++row)
+    {
+        for (int col = 0; col < cols_; ++col)
+        {
+            const int i = row * cols_ + col;
+            const Eigen::Vector3d expected = expected_point(row, col);
+            EXPECT_NEAR(expected(0), buffers.x[i], 1e-6);
+            EXPECT_NEAR(expected(1), buffers.y[i], 1e-6);
+            EXPECT_NEAR(expected(2), buffers.z[i], 1e-6);
+            EXPECT_EQ(1, buffers.valid[i]);
+        }
+    }
+}
+
+TEST_F(PointCloudTests, masks_invalid_depths)
+{
+    depth_[3] = std::numeric_limits<float>::quiet_NaN();
+    depth_[4] = std::numeric_limits<float>::infinity();
+    depth_[5] = 0.0f;
+    depth_[6] = -1.0f;
+
+    PointBuffers buffers(rows_ * cols_);
+    EXPECT_EQ(rows_ * cols_ - 4,
+              converter_.to_points(depth_.data(), buffers.cloud()));
+
+    for (int i = 3; i < 7; ++i)
+    {
+        EXPECT_EQ(0, buffers.valid[i]);
+        EXPECT_TRUE(std::isnan(buffers.x[i]));
+        EXPECT_TRUE(std::isnan(buffers.y[i]));
+        EXPECT_TRUE(std::isnan(buffers.z[i]));
+    }
+    EXPECT_EQ(1, buffers.valid[7]);
+}
+
+TEST_F(PointCloudTests, region_is_downsampled)
+{
+    PointCloudConverter::Region region = {3, 12, 2, 17, 4};
+    ASSERT_EQ(3, region.rows());
+    ASSERT_EQ(4, region.cols());
+
+    PointBuffers buffers(region.size());
+    EXPECT_EQ(region.size(),
+              converter_.to_points(depth_.data(), region, buffers.cloud()));
+
+    for (int i = 0; i < region.rows(); ++i)
+    {
+        for (int j = 0; j < region.cols(); ++j)
+        {
+            const Eigen::Vector3d expected =
+                expected_point(3 + 4 * i, 2 + 4 * j);
+            const int point = i * region.cols() + j;
+            EXPECT_NEAR(expected(0), buffers.x[point], 1e-6);
+            EXPECT_NEAR(expected(1), buffers.y[point], 1e-6);
+            EXPECT_NEAR(expected(2), buffers.z[point], 1e-6);
+        }
+    }
+}
+
+TEST_F(PointCloudTests, invalid_region_throws)
+{
+    PointBuffers buffers(rows_ * cols_);
+
+    PointCloudConverter::Region region = converter_.image();
+    region.row_end = rows_ + 1;
+    EXPECT_THROW(converter_.to_points(depth_.data(), region, buffers.cloud()),
+                 PointCloudException);
+
+    region = converter_.image(0);
+    EXPECT_THROW(converter_.to_points(depth_.data(), region, buffers.cloud()),
+                 PointCloudException);
+}
+
+TEST_F(PointCloudTests, projection_restores_depth)
+{
+    depth_[7] = std::numeric_limits<float>::quiet_NaN();
+
+    PointBuffers buffers(rows_ * cols_);
+    converter_.to_points(depth_.data(), buffers.cloud());
+
+    std::vector<float> depth(rows_ * cols_,
+                             std::numeric_limits<float>::quiet_NaN());
+    EXPECT_EQ(0,
+              converter_.to_depth(buffers.x.data(),
+                                  buffers.y.data(),
+                                  buffers.z.data(),
+                                  rows_ * cols_,
+                                  depth.data()));
+
+    for (int i = 0; i < rows_ * cols_; ++i)
+    {
+        if (i == 7)
+        {
+            EXPECT_TRUE(std::isnan(depth[i]));
+        }
+        else
+        {
+            EXPECT_NEAR(depth_[i], depth[i], 1e-6);
+        }
+    }
+}
+
+TEST_F(PointCloudTests, projection_keeps_closest_point)
+{
+    const float x[4] = {0.0f, 0.0f, 10.0f, 0.0f};
+    const float y[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    const float z[4] = {2.0f, 1.5f, 1.0f, -1.0f};
+
+    std::vector<float> depth(rows_ * cols_, 3.0f);
+    EXPECT_EQ(2, converter_.to_depth(x, y, z, 4, depth.data()));
+
+    // the principal point (9.5, 7.5) rounds to the pixel (8, 10)
+    EXPECT_EQ(1.5f, depth[8 * cols_ + 10]);
+    EXPECT_EQ(3.0f, depth[0]);
+}
@@ -0,0 +1,407 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file process_pool.cpp
+ * \date October 2016
+ */
+
+#include <dbot/process_pool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+
+#include <dirent.h>
+#include <semaphore.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace dbot
+{
+namespace
+{
+/// number of threads of this process, see proc(5)
+int count_threads()
+{
+    DIR* tasks = opendir("/proc/self/task");
+    if (!tasks) return 1;
+
+    int count = 0;
+    while (const dirent* entry = readdir(tasks))
+    {
+        if (entry->d_name[0] != '.') count++;
+    }
+    closedir(tasks);
+    return count;
+}
+
+/// absolute time 50 ms from now for sem_timedwait()
+timespec poll_deadline()
+{
+    timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += 50 * 1000 * 1000;
+    if (deadline.tv_nsec >= 1000 * 1000 * 1000)
+    {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000 * 1000 * 1000;
+    }
+    return deadline;
+}
+}
+
+/**
+ * \brief Per worker state in shared memory
+ */
+struct ProcessPool::Channel
+{
+    sem_t request;
+    sem_t done;
+    int stop;
+    int failed;
+    char error[256];
+    pid_t pid;
+    // set by the spawner once it reaped the worker
+    std::atomic<int> exited;
+};
+
+/**
+ * \brief Requests of the owner to the spawner in shared memory
+ */
+struct ProcessPool::Spawner
+{
+    sem_t request;
+    sem_t done;
+    int stop;
+    int worker;
+    pid_t pid;
+    int error;
+};
+
+ProcessPool::ProcessPool(int worker_count, const Task& task, int max_restarts)
+    : task_(task),
+      max_restarts_(max_restarts),
+      restarts_(0),
+      pids_(std::max(worker_count, 1), -1),
+      spawner_pid_(-1),
+      memory_(layout())
+{
+    // threads joined just before may take a moment to disappear
+    for (int attempt = 0; count_threads() > 1; ++attempt)
+    {
+        if (attempt == 100)
+        {
+            throw ProcessPoolException(
+                "cannot fork from a process running other threads, create "
+                "the pool before starting any");
+        }
+        usleep(1000);
+    }
+
+    sem_init(&spawner().request, 1, 0);
+    sem_init(&spawner().done, 1, 0);
+    for (int worker = 0; worker < count_workers(); ++worker)
+    {
+        sem_init(&channel(worker).request, 1, 0);
+        sem_init(&channel(worker).done, 1, 0);
+    }
+
+    start_spawner();
+    for (int worker = 0; worker < count_workers(); ++worker)
+    {
+        spawn(worker);
+    }
+}
+
+ProcessPool::~ProcessPool()
+{
+    for (int worker = 0; worker < count_workers(); ++worker)
+    {
+        if (pids_[worker] <= 0) continue;
+
+        channel(worker).stop = 1;
+        sem_post(&channel(worker).request);
+    }
+
+    // the spawner reaps the workers before it exits
+    if (spawner_pid_ > 0)
+    {
+        spawner().stop = 1;
+        sem_post(&spawner().request);
+        waitpid(spawner_pid_, nullptr, 0);
+    }
+
+    for (int worker = 0; worker < count_workers(); ++worker)
+    {
+        sem_destroy(&channel(worker).request);
+        sem_destroy(&channel(worker).done);
+    }
+    sem_destroy(&spawner().request);
+    sem_destroy(&spawner().done);
+}
+
+std::size_t ProcessPool::layout()
+{
+    SharedMemoryLayout layout;
+    spawner_ = layout.add<Spawner>(1);
+    channels_ = layout.add<Channel>(pids_.size());
+    return layout.size();
+}
+
+void ProcessPool::start_spawner()
+{
+    const pid_t owner = getpid();
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        throw ProcessPoolException(std::string("fork failed: ") +
+                                   std::strerror(errno));
+    }
+
+    if (pid == 0)
+    {
+        prctl(PR_SET_PDEATHSIG, SIGKILL);
+        if (getppid() != owner) _exit(1);
+
+        serve_spawner();
+        _exit(0);
+    }
+
+    spawner_pid_ = pid;
+}
+
+void ProcessPool::serve_spawner()
+{
+    Spawner& s = spawner();
+
+    while (true)
+    {
+        const timespec deadline = poll_deadline();
+        const bool requested = sem_timedwait(&s.request, &deadline) == 0;
+
+        int status;
+        pid_t pid;
+        while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
+        {
+            for (int worker = 0; worker < count_workers(); ++worker)
+            {
+                if (channel(worker).pid == pid) channel(worker).exited = 1;
+            }
+        }
+
+        if (!requested) continue;
+
+        if (s.stop)
+        {
+            while ((pid = wait(nullptr)) > 0 || errno == EINTR)
+            {
+            }
+            return;
+        }
+
+        s.pid = fork_worker(s.worker);
+        s.error = s.pid < 0 ? errno : 0;
+        sem_post(&s.done);
+    }
+}
+
+pid_t ProcessPool::fork_worker(int worker)
+{
+    const pid_t parent = getpid();
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        prctl(PR_SET_PDEATHSIG, SIGKILL);
+        if (getppid() != parent) _exit(1);
+
+        serve(worker);
+        _exit(0);
+    }
+
+    if (pid > 0) channel(worker).pid = pid;
+    return pid;
+}
+
+void ProcessPool::wait_spawner()
+{
+    while (true)
+    {
+        const timespec deadline = poll_deadline();
+        if (sem_timedwait(&spawner().done, &deadline) == 0) return;
+
+        if (waitpid(spawner_pid_, nullptr, WNOHANG) == spawner_pid_)
+        {
+            spawner_pid_ = -1;
+            throw ProcessPoolException("the spawner terminated");
+        }
+    }
+}
+
+void ProcessPool::spawn(int worker)
+{
+    if (spawner_pid_ < 0)
+    {
+        throw ProcessPoolException("the spawner terminated");
+    }
+
+    // a restarted worker starts from a clean channel such that stale
+    // requests or replies of its predecessor are dropped
+    Channel& c = channel(worker);
+    sem_destroy(&c.request);
+    sem_destroy(&c.done);
+    sem_init(&c.request, 1, 0);
+    sem_init(&c.done, 1, 0);
+    c.stop = 0;
+    c.failed = 0;
+    c.pid = -1;
+    c.exited = 0;
+
+    spawner().worker = worker;
+    sem_post(&spawner().request);
+    wait_spawner();
+
+    if (spawner().pid < 0)
+    {
+        throw ProcessPoolException(std::string("fork failed: ") +
+                                   std::strerror(spawner().error));
+    }
+
+    pids_[worker] = spawner().pid;
+}
+
+void ProcessPool::serve(int worker)
+{
+    Channel& c = channel(worker);
+
+    while (true)
+    {
+        while (sem_wait(&c.request) != 0 && errno == EINTR)
+        {
+        }
+
+        if (c.stop) return;
+
+        c.failed = 0;
+        try
+        {
+            task_(worker);
+        }
+        catch (const std::exception& e)
+        {
+            c.failed = 1;
+            std::strncpy(c.error, e.what(), sizeof(c.error) - 1);
+            c.error[sizeof(c.error) - 1] = 0;
+        }
+        catch (...)
+        {
+            c.failed = 1;
+            std::strncpy(c.error, "unknown exception", sizeof(c.error));
+        }
+
+        sem_post(&c.done);
+    }
+}
+
+bool ProcessPool::exited(int worker)
+{
+    // the workers die with the spawner without being reaped
+    if (waitpid(spawner_pid_, nullptr, WNOHANG) == spawner_pid_)
+    {
+        spawner_pid_ = -1;
+        throw ProcessPoolException("the spawner terminated");
+    }
+
+    return channel(worker).exited;
+}
+
+void ProcessPool::run()
+{
+    for (int worker = 0; worker < count_workers(); ++worker)
+    {
+        // workers given up on in a previous run get another chance
+        if (pids_[worker] < 0) spawn(worker);
+
+        sem_post(&channel(worker).request);
+    }
+
+    int restarts = 0;
+    std::string error;
+    for (int worker = 0; worker < count_workers(); ++worker)
+    {
+        Channel& c = channel(worker);
+
+        while (pids_[worker] > 0)
+        {
+            const timespec deadline = poll_deadline();
+            if (sem_timedwait(&c.done, &deadline) == 0) break;
+            if (!exited(worker)) continue;
+
+            // the worker died, restart it and repeat its part of the run.
+            // The remaining workers are still waited for such that no reply
+            // is left over for the next run
+            if (++restarts > max_restarts_)
+            {
+                pids_[worker] = -1;
+                if (error.empty())
+                {
+                    error = "worker " + std::to_string(worker) +
+                            " keeps terminating";
+                }
+                break;
+            }
+            ++restarts_;
+            spawn(worker);
+            sem_post(&c.request);
+        }
+
+        if (pids_[worker] > 0 && c.failed && error.empty())
+        {
+            error = "worker " + std::to_string(worker) + " failed: " + c.error;
+        }
+    }
+
+    if (!error.empty()) throw ProcessPoolException(error);
+}
+
+int ProcessPool::count_workers() const
+{
+    return pids_.size();
+}
+
+int ProcessPool::count_restarts() const
+{
+    return restarts_;
+}
+
+void ProcessPool::partition(int count, int worker, int& begin, int& end) const
+{
+    int workers = count_workers();
+    begin = int((long(count) * worker) / workers);
+    end = int((long(count) * (worker + 1)) / workers);
+}
+
+auto ProcessPool::channel(int worker) const -> Channel&
+{
+    return memory_.at<Channel>(channels_)[worker];
+}
+
+auto ProcessPool::spawner() const -> Spawner&
+{
+    return *memory_.at<Spawner>(spawner_);
+}
+}
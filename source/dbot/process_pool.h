@@ -0,0 +1,154 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file process_pool.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <exception>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+#include <dbot/shared_memory.h>
+
+namespace dbot
+{
+/**
+ * \brief The ProcessPoolException class
+ */
+class ProcessPoolException : public std::exception
+{
+public:
+    explicit ProcessPoolException(const std::string& message)
+        : message_("Process pool: " + message)
+    {
+    }
+
+    const char* what() const noexcept { return message_.c_str(); }
+
+private:
+    std::string message_;
+};
+
+/**
+ * \brief Fixed set of forked worker processes.
+ *
+ * Like Executor, run() invokes the task once per worker index, but each
+ * worker runs in its own process. The task sees a copy of the owner's
+ * address space as of the construction of the pool and exchanges data
+ * through SharedMemory created before the pool.
+ *
+ * A child forked from a process running several threads may inherit locks
+ * held by the other threads, e.g. of the allocator, and deadlock on them.
+ * The pool is therefore created while the owner runs a single thread: the
+ * constructor forks a spawner process, which forks the workers and never
+ * starts a thread itself. The owner may start threads once the pool exists.
+ *
+ * A worker which dies is forked again by the spawner and its part of the run
+ * is repeated, hence tasks must only depend on shared input and write their
+ * own output. The spawner and the workers terminate if the owning process
+ * dies.
+ */
+class ProcessPool
+{
+public:
+    typedef std::function<void(int worker)> Task;
+
+public:
+    /**
+     * \brief Forks the given number of workers which run the task on every
+     *        call of run()
+     *
+     * \param max_restarts
+     *          Number of times the workers may be restarted within a single
+     *          run before it fails
+     *
+     * \throws ProcessPoolException if the process runs other threads or a
+     *         worker cannot be forked
+     */
+    ProcessPool(int worker_count, const Task& task, int max_restarts = 3);
+
+    /**
+     * \brief Terminates the workers and the spawner
+     */
+    virtual ~ProcessPool();
+
+    ProcessPool(const ProcessPool&) = delete;
+    ProcessPool& operator=(const ProcessPool&) = delete;
+
+    /**
+     * \brief Runs the task on all workers and returns when all are done
+     *
+     * \throws ProcessPoolException if a task throws, the workers keep
+     *         dying or the spawner died
+     */
+    void run();
+
+    /**
+     * \brief Returns the number of workers
+     */
+    int count_workers() const;
+
+    /**
+     * \brief Returns the number of times workers have been restarted
+     */
+    int count_restarts() const;
+
+    /**
+     * \brief Returns the half-open range [begin, end) of items assigned to
+     *        the given worker if count items are split evenly
+     */
+    void partition(int count, int worker, int& begin, int& end) const;
+
+private:
+    struct Channel;
+    struct Spawner;
+
+    /**
+     * \brief Computes the offsets of the shared sections and returns the
+     *        total size
+     */
+    std::size_t layout();
+
+    void start_spawner();
+    void serve_spawner();
+    pid_t fork_worker(int worker);
+    void wait_spawner();
+
+    void spawn(int worker);
+    void serve(int worker);
+    bool exited(int worker);
+    Channel& channel(int worker) const;
+    Spawner& spawner() const;
+
+private:
+    Task task_;
+    int max_restarts_;
+    int restarts_;
+    std::vector<pid_t> pids_;
+    pid_t spawner_pid_;
+
+    // offsets of the shared sections
+    std::size_t spawner_;
+    std::size_t channels_;
+
+    SharedMemory memory_;
+};
+}
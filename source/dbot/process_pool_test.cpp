@@ -0,0 +1,163 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file process_pool_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <csignal>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include <unistd.h>
+
+#include <dbot/process_pool.h>
+#include <dbot/shared_memory.h>
+
+TEST(ProcessPoolTests, workers_write_shared_memory)
+{
+    dbot::SharedMemory memory(3 * sizeof(int));
+    int* items = memory.at<int>(0);
+
+    dbot::ProcessPool pool(3, [items](int worker) { items[worker] += worker; });
+    pool.run();
+    pool.run();
+
+    EXPECT_EQ(items[0], 0);
+    EXPECT_EQ(items[1], 2);
+    EXPECT_EQ(items[2], 4);
+}
+
+TEST(ProcessPoolTests, each_worker_runs_in_its_own_process)
+{
+    dbot::SharedMemory memory(4 * sizeof(pid_t));
+    pid_t* pids = memory.at<pid_t>(0);
+
+    dbot::ProcessPool pool(4, [pids](int worker) { pids[worker] = getpid(); });
+    pool.run();
+
+    for (int worker = 0; worker < 4; ++worker)
+    {
+        EXPECT_NE(pids[worker], getpid());
+        for (int other = 0; other < worker; ++other)
+        {
+            EXPECT_NE(pids[worker], pids[other]);
+        }
+    }
+}
+
+TEST(ProcessPoolTests, dead_worker_is_restarted)
+{
+    dbot::SharedMemory memory(2 * sizeof(int));
+    int* killed = memory.at<int>(0);
+    int* runs = memory.at<int>(sizeof(int));
+
+    dbot::ProcessPool pool(2, [killed, runs](int worker) {
+        if (worker == 1 && !*killed)
+        {
+            *killed = 1;
+            raise(SIGKILL);
+        }
+        if (worker == 1) ++*runs;
+    });
+
+    pool.run();
+    pool.run();
+
+    EXPECT_EQ(pool.count_restarts(), 1);
+    EXPECT_EQ(*runs, 2);
+}
+
+TEST(ProcessPoolTests, worker_exception_is_reported)
+{
+    dbot::ProcessPool pool(2, [](int worker) {
+        if (worker == 0) throw std::runtime_error("failure");
+    });
+
+    EXPECT_THROW(pool.run(), dbot::ProcessPoolException);
+}
+
+TEST(ProcessPoolTests, restarts_are_limited)
+{
+    dbot::ProcessPool pool(2,
+                           [](int worker) {
+                               if (worker == 1) raise(SIGKILL);
+                           },
+                           2);
+
+    EXPECT_THROW(pool.run(), dbot::ProcessPoolException);
+    EXPECT_EQ(pool.count_restarts(), 2);
+}
+
+TEST(ProcessPoolTests, refuses_to_fork_from_threads)
+{
+    std::mutex mutex;
+    std::condition_variable released;
+    bool release = false;
+    std::thread thread([&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        released.wait(lock, [&]() { return release; });
+    });
+
+    EXPECT_THROW(dbot::ProcessPool(2, [](int) {}),
+                 dbot::ProcessPoolException);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        release = true;
+    }
+    released.notify_one();
+    thread.join();
+
+    // the thread is gone
+    dbot::ProcessPool pool(2, [](int) {});
+    pool.run();
+}
+
+TEST(ProcessPoolTests, restarts_after_threads_started)
+{
+    dbot::SharedMemory memory(3 * sizeof(int));
+    int* killed = memory.at<int>(0);
+    pid_t* parents = memory.at<pid_t>(sizeof(int));
+
+    dbot::ProcessPool pool(2, [killed, parents](int worker) {
+        if (worker == 1 && !*killed)
+        {
+            *killed = 1;
+            raise(SIGKILL);
+        }
+        parents[worker] = getppid();
+    });
+
+    // a thread holding the allocator is not inherited by the restarted
+    // worker, which is forked by the spawner
+    std::atomic<bool> stop(false);
+    std::thread thread([&stop]() {
+        while (!stop) delete[] new char[64];
+    });
+
+    pool.run();
+
+    stop = true;
+    thread.join();
+
+    EXPECT_EQ(pool.count_restarts(), 1);
+    EXPECT_NE(parents[1], getpid());
+    EXPECT_EQ(parents[0], parents[1]);
+}
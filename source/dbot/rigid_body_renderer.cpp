@@ -16,9 +16,15 @@
  * \author Manuel Wuthrich (manuel.wuthrich@gmail.com)
  */
 
+#include <algorithm>
+#include <dbot/cpu_kernels.h>
+#include <dbot/executor.h>
+#include <dbot/frame_arena.h>
 #include <dbot/rigid_body_renderer.h>
 #include <iostream>
 #include <limits>
+#include <map>
+#include <utility>
 
 using namespace std;
 using namespace Eigen;
@@ -109,207 +115,431 @@ RigidBodyRenderer::~RigidBodyRenderer()
 {
 }
 
+void RigidBodyRenderer::Render(Matrix camera_matrix,
+                               int n_rows,
+                               int n_cols,
+                               std::vector<float>& depth_image) const
+{
+    depth_image.resize(n_rows * n_cols);
+
+    Render(camera_matrix, n_rows, n_cols, depth_image.data());
+}
+
+void RigidBodyRenderer::Render(Matrix camera_matrix,
+                               int n_rows,
+                               int n_cols,
+                               float* depth_image) const
+{
+    Render(camera_matrix, n_rows, n_cols, depth_image, nullptr);
+}
+
 // todo: does not handle the case properly when the depth is around zero or
 // negative
 void RigidBodyRenderer::Render(Matrix camera_matrix,
                                int n_rows,
                                int n_cols,
-                               std::vector<float>& depth_image) const
+                               float* depth_image,
+                               int* part_image) const
 {
+    FrameArena& arena = FrameArena::local();
+    FrameArena::Scope scope(arena);
+
+    const CpuKernels& kernels = cpu_kernels();
     Matrix3d inv_camera_matrix = camera_matrix.inverse();
 
+    std::fill(depth_image,
+              depth_image + n_rows * n_cols,
+              numeric_limits<float>::infinity());
+
     // we project all the points into image space
     // --------------------------------------------------------
-    vector<vector<Vector3d>> trans_vertices(vertices_.size());
-    vector<vector<Vector2d>> image_vertices(vertices_.size());
+    static_assert(sizeof(Vector3d) == 3 * sizeof(double) &&
+                      sizeof(Vector2d) == 2 * sizeof(double),
+                  "the kernels expect densely packed points");
+    Vector3d** trans_vertices = arena.allocate<Vector3d*>(vertices_.size());
+    Vector2d** image_vertices = arena.allocate<Vector2d*>(vertices_.size());
 
     for (int part_index = 0; part_index < int(vertices_.size()); part_index++)
     {
-        image_vertices[part_index].resize(vertices_[part_index].size());
-        trans_vertices[part_index].resize(vertices_[part_index].size());
-        for (int point_index = 0;
-             point_index < int(vertices_[part_index].size());
-             point_index++)
-        {
-            trans_vertices[part_index][point_index] =
-                R_[part_index] * vertices_[part_index][point_index] +
-                t_[part_index];
-            image_vertices[part_index][point_index] =
-                (camera_matrix * trans_vertices[part_index][point_index] /
-                 trans_vertices[part_index][point_index](2))
-                    .topRows(2);
-        }
+        image_vertices[part_index] =
+            arena.allocate<Vector2d>(vertices_[part_index].size());
+        trans_vertices[part_index] =
+            arena.allocate<Vector3d>(vertices_[part_index].size());
+        kernels.transform_points(R_[part_index].data(),
+                                 t_[part_index].data(),
+                                 camera_matrix.data(),
+                                 vertices_[part_index].data()->data(),
+                                 vertices_[part_index].size(),
+                                 trans_vertices[part_index]->data(),
+                                 image_vertices[part_index]->data());
     }
 
     // we find the intersections with the triangles and the depths
     // ---------------------------------------------------
-    depth_image =
-        vector<float>(n_rows * n_cols, numeric_limits<float>::infinity());
+    for (int part_index = 0; part_index < int(indices_.size()); part_index++)
+    {
+        const std::vector<int>* visible = visible_triangles(part_index);
+        const int triangle_count =
+            visible ? visible->size() : indices_[part_index].size();
+
+        for (int k = 0; k < triangle_count; k++)
+        {
+            rasterize(kernels,
+                      inv_camera_matrix,
+                      part_index,
+                      visible ? (*visible)[k] : k,
+                      trans_vertices[part_index],
+                      image_vertices[part_index],
+                      0,
+                      n_rows,
+                      n_cols,
+                      depth_image,
+                      part_image);
+        }
+    }
+}
+
+void RigidBodyRenderer::Render(Matrix camera_matrix,
+                               int n_rows,
+                               int n_cols,
+                               float* depth_image,
+                               int* part_image,
+                               Executor& executor,
+                               int tile_rows) const
+{
+    Tiles tiles;
+    bin(camera_matrix, n_rows, n_cols, tile_rows, tiles);
+
+    // tiles are dealt round robin, as the objects tend to cover the center
+    // rows of the image
+    executor.run([&](int worker) {
+        for (int tile = worker; tile < tiles.count();
+             tile += executor.count_workers())
+        {
+            render_tile(tiles, tile, depth_image, part_image);
+        }
+    });
+}
+
+void RigidBodyRenderer::bin(Matrix camera_matrix,
+                            int n_rows,
+                            int n_cols,
+                            int tile_rows,
+                            Tiles& tiles) const
+{
+    assert(tile_rows > 0);
+
+    const CpuKernels& kernels = cpu_kernels();
+
+    tiles.camera_matrix = camera_matrix;
+    tiles.inverse_camera_matrix = camera_matrix.inverse();
+    tiles.n_rows = n_rows;
+    tiles.n_cols = n_cols;
+    tiles.tile_rows = tile_rows;
 
+    // the buffers of a reused tiling keep their capacity
+    tiles.bins.resize((n_rows + tile_rows - 1) / tile_rows);
+    for (auto& bin : tiles.bins) bin.clear();
+    tiles.trans_vertices.resize(vertices_.size());
+    tiles.image_vertices.resize(vertices_.size());
+
+    for (int part_index = 0; part_index < int(vertices_.size()); part_index++)
+    {
+        auto& trans_vertices = tiles.trans_vertices[part_index];
+        auto& image_vertices = tiles.image_vertices[part_index];
+        trans_vertices.resize(vertices_[part_index].size());
+        image_vertices.resize(vertices_[part_index].size());
+        kernels.transform_points(R_[part_index].data(),
+                                 t_[part_index].data(),
+                                 camera_matrix.data(),
+                                 vertices_[part_index].data()->data(),
+                                 vertices_[part_index].size(),
+                                 trans_vertices.data()->data(),
+                                 image_vertices.data()->data());
+    }
+
+    // the bins keep the order in which Render() rasterizes the triangles,
+    // which makes the result independent of the tiling
     for (int part_index = 0; part_index < int(indices_.size()); part_index++)
     {
-        for (int triangle_index = 0;
-             triangle_index < int(indices_[part_index].size());
-             triangle_index++)
+        const std::vector<int>* visible = visible_triangles(part_index);
+        const int triangle_count =
+            visible ? visible->size() : indices_[part_index].size();
+
+        for (int k = 0; k < triangle_count; k++)
         {
-            vector<Vector2d> vertices(3);
-            Vector2d center(Vector2d::Zero());
-
-            // find the min and max indices to be checked
-            // ------------------------------------------------------------
-            int min_row = numeric_limits<int>::max();
-            int max_row = -numeric_limits<int>::max();
-            int min_col = numeric_limits<int>::max();
-            int max_col = -numeric_limits<int>::max();
-            bool behind_camera = false;
-            for (int i = 0; i < 3; i++)
+            const int triangle_index = visible ? (*visible)[k] : k;
+
+            int min_row, max_row, min_col, max_col;
+            if (!bounds(part_index,
+                        triangle_index,
+                        tiles.trans_vertices[part_index].data(),
+                        tiles.image_vertices[part_index].data(),
+                        0,
+                        n_rows,
+                        n_cols,
+                        min_row,
+                        max_row,
+                        min_col,
+                        max_col))
             {
-                vertices[i] =
-                    image_vertices[part_index]
-                                  [indices_[part_index][triangle_index][i]];
-                center += vertices[i] / 3.;
-                min_row = ceil(float(vertices[i](1))) < min_row
-                              ? ceil(float(vertices[i](1)))
-                              : min_row;
-                max_row = floor(float(vertices[i](1))) > max_row
-                              ? floor(float(vertices[i](1)))
-                              : max_row;
-                min_col = ceil(float(vertices[i](0))) < min_col
-                              ? ceil(float(vertices[i](0)))
-                              : min_col;
-                max_col = floor(float(vertices[i](0))) > max_col
-                              ? floor(float(vertices[i](0)))
-                              : max_col;
-
-                // how should this be handled properly? for now if some vertex
-                // in a triangle comes to lie behind camera
-                // we just discard that triangle.
-                if (trans_vertices[part_index]
-                                  [indices_[part_index][triangle_index][i]](2) <
-                    0.001)
-                    behind_camera = true;
-            }
-            if (behind_camera) continue;
-
-            // make sure all of them are inside of image
-            // -----------------------------------------------------------------
-            min_row = min_row >= 0 ? min_row : 0;
-            max_row = max_row < n_rows ? max_row : (n_rows - 1);
-            min_col = min_col >= 0 ? min_col : 0;
-            max_col = max_col < n_cols ? max_col : (n_cols - 1);
-
-            // check whether triangle is inside image
-            // ----------------------------------------------------------------------
-            if (max_row < 0 || min_row >= n_rows || max_col < 0 ||
-                min_col >= n_cols || max_row < min_row || max_col < min_col)
                 continue;
+            }
 
-            // we find the line params of the triangle sides
-            // ---------------------------------------------------------------
-            vector<float> slopes(3);
-            vector<bool> boundary_type(3);
-            const bool upper = true;
-            const bool lower = false;
-
-            for (int i = 0; i < 3; i++)
+            for (int tile = min_row / tile_rows; tile <= max_row / tile_rows;
+                 tile++)
             {
-                Vector2d side = vertices[(i + 1) % 3] - vertices[i];
-                slopes[i] = side(1) / side(0);
-
-                // we determine whether the line limits the triangle on top or
-                // on the bottom
-                if (vertices[i](1) + slopes[i] * (center(0) - vertices[i](0)) >
-                    center(1))
-                    boundary_type[i] = upper;
-                else
-                    boundary_type[i] = lower;
+                tiles.bins[tile].push_back(
+                    std::make_pair(part_index, triangle_index));
             }
+        }
+    }
+}
 
-            if (boundary_type[0] == boundary_type[1] &&
-                boundary_type[0] ==
-                    boundary_type[2])  // if triangle is degenerate we continue
-                continue;
+void RigidBodyRenderer::render_tile(const Tiles& tiles,
+                                    int tile,
+                                    float* depth_image,
+                                    int* part_image) const
+{
+    const CpuKernels& kernels = cpu_kernels();
 
-            for (int col = min_col; col <= max_col; col++)
-            {
-                float min_row_given_col = -numeric_limits<float>::max();
-                float max_row_given_col = numeric_limits<float>::max();
+    const int row_begin = tiles.row_begin(tile);
+    const int row_end = tiles.row_end(tile);
+    const int n_cols = tiles.n_cols;
 
-                // the min_row is the max lower boundary at that column, and the
-                // max_row is the min upper boundary at that column
-                for (int i = 0; i < 3; i++)
-                {
-                    if (boundary_type[i] == lower)
-                    {
-                        float lowe_Rboundary = ceil(
-                            float(vertices[i](1) +
-                                  slopes[i] * (float(col) - vertices[i](0))));
-                        min_row_given_col = lowe_Rboundary > min_row_given_col
-                                                ? lowe_Rboundary
-                                                : min_row_given_col;
-                    }
-                    else
-                    {
-                        float upper_boundary = floor(
-                            float(vertices[i](1) +
-                                  slopes[i] * (float(col) - vertices[i](0))));
-                        max_row_given_col = upper_boundary < max_row_given_col
-                                                ? upper_boundary
-                                                : max_row_given_col;
-                    }
-                }
+    std::fill(depth_image + row_begin * n_cols,
+              depth_image + row_end * n_cols,
+              numeric_limits<float>::infinity());
+
+    for (const auto& triangle : tiles.bins[tile])
+    {
+        rasterize(kernels,
+                  tiles.inverse_camera_matrix,
+                  triangle.first,
+                  triangle.second,
+                  tiles.trans_vertices[triangle.first].data(),
+                  tiles.image_vertices[triangle.first].data(),
+                  row_begin,
+                  row_end,
+                  n_cols,
+                  depth_image,
+                  part_image);
+    }
+}
+
+bool RigidBodyRenderer::bounds(int part_index,
+                               int triangle_index,
+                               const Vector3d* trans_vertices,
+                               const Vector2d* image_vertices,
+                               int row_begin,
+                               int row_end,
+                               int n_cols,
+                               int& min_row,
+                               int& max_row,
+                               int& min_col,
+                               int& max_col) const
+{
+    // find the min and max indices to be checked
+    // ------------------------------------------------------------
+    min_row = numeric_limits<int>::max();
+    max_row = -numeric_limits<int>::max();
+    min_col = numeric_limits<int>::max();
+    max_col = -numeric_limits<int>::max();
+    for (int i = 0; i < 3; i++)
+    {
+        const int vertex = indices_[part_index][triangle_index][i];
+        const Vector2d& image_vertex = image_vertices[vertex];
+        min_row = ceil(float(image_vertex(1))) < min_row
+                      ? ceil(float(image_vertex(1)))
+                      : min_row;
+        max_row = floor(float(image_vertex(1))) > max_row
+                      ? floor(float(image_vertex(1)))
+                      : max_row;
+        min_col = ceil(float(image_vertex(0))) < min_col
+                      ? ceil(float(image_vertex(0)))
+                      : min_col;
+        max_col = floor(float(image_vertex(0))) > max_col
+                      ? floor(float(image_vertex(0)))
+                      : max_col;
+
+        // how should this be handled properly? for now if some vertex
+        // in a triangle comes to lie behind camera
+        // we just discard that triangle.
+        if (trans_vertices[vertex](2) < 0.001) return false;
+    }
+
+    // make sure all of them are inside of the rows and the image
+    // -----------------------------------------------------------------
+    min_row = min_row >= row_begin ? min_row : row_begin;
+    max_row = max_row < row_end ? max_row : (row_end - 1);
+    min_col = min_col >= 0 ? min_col : 0;
+    max_col = max_col < n_cols ? max_col : (n_cols - 1);
+
+    // check whether triangle is inside the rows
+    // ----------------------------------------------------------------------
+    return !(max_row < row_begin || min_row >= row_end || max_col < 0 ||
+             min_col >= n_cols || max_row < min_row || max_col < min_col);
+}
+
+void RigidBodyRenderer::rasterize(const CpuKernels& kernels,
+                                  const Matrix& inv_camera_matrix,
+                                  int part_index,
+                                  int triangle_index,
+                                  const Vector3d* trans_vertices,
+                                  const Vector2d* image_vertices,
+                                  int row_begin,
+                                  int row_end,
+                                  int n_cols,
+                                  float* depth_image,
+                                  int* part_image) const
+{
+    int min_row, max_row, min_col, max_col;
+    if (!bounds(part_index,
+                triangle_index,
+                trans_vertices,
+                image_vertices,
+                row_begin,
+                row_end,
+                n_cols,
+                min_row,
+                max_row,
+                min_col,
+                max_col))
+    {
+        return;
+    }
+
+    Vector2d vertices[3];
+    Vector2d center(Vector2d::Zero());
+    for (int i = 0; i < 3; i++)
+    {
+        vertices[i] = image_vertices[indices_[part_index][triangle_index][i]];
+        center += vertices[i] / 3.;
+    }
+
+    // we find the line params of the triangle sides
+    // ---------------------------------------------------------------
+    float slopes[3];
+    bool boundary_type[3];
+    const bool upper = true;
+    const bool lower = false;
+
+    for (int i = 0; i < 3; i++)
+    {
+        Vector2d side = vertices[(i + 1) % 3] - vertices[i];
+        slopes[i] = side(1) / side(0);
+
+        // we determine whether the line limits the triangle on top or
+        // on the bottom
+        if (vertices[i](1) + slopes[i] * (center(0) - vertices[i](0)) >
+            center(1))
+            boundary_type[i] = upper;
+        else
+            boundary_type[i] = lower;
+    }
+
+    if (boundary_type[0] == boundary_type[1] &&
+        boundary_type[0] ==
+            boundary_type[2])  // if triangle is degenerate we continue
+        return;
+
+    for (int col = min_col; col <= max_col; col++)
+    {
+        float min_row_given_col = -numeric_limits<float>::max();
+        float max_row_given_col = numeric_limits<float>::max();
 
-                // we push back the indices of the intersections and the
-                // corresponding depths ------------------------------------
-                Vector3d normal =
-                    R_[part_index] * normals_[part_index][triangle_index];
-                float offset = normal.dot(
-                    trans_vertices[part_index]
-                                  [indices_[part_index][triangle_index][0]]);
-                for (int row = int(min_row_given_col);
-                     row <= int(max_row_given_col);
-                     row++)
-                    if (row >= 0 && row < n_rows && col >= 0 && col < n_cols)
-                    {
-                        //						intersec_tindices.push_back(row*n_cols
-                        //+
-                        // col);
-                        // we find the intersection between the ray and the
-                        // triangle --------------------------------------------
-                        Vector3d line_vector =
-                            inv_camera_matrix *
-                            Vector3d(
-                                col, row, 1);  // the depth is the z component
-                        float depth =
-                            std::fabs(offset / normal.dot(line_vector));
-                        // if(depth > 0.5)
-                        depth_image[row * n_cols + col] =
-                            depth < depth_image[row * n_cols + col]
-                                ? depth
-                                : depth_image[row * n_cols + col];
-                    }
+        // the min_row is the max lower boundary at that column, and the
+        // max_row is the min upper boundary at that column
+        for (int i = 0; i < 3; i++)
+        {
+            if (boundary_type[i] == lower)
+            {
+                float lowe_Rboundary =
+                    ceil(float(vertices[i](1) +
+                               slopes[i] * (float(col) - vertices[i](0))));
+                min_row_given_col = lowe_Rboundary > min_row_given_col
+                                        ? lowe_Rboundary
+                                        : min_row_given_col;
+            }
+            else
+            {
+                float upper_boundary =
+                    floor(float(vertices[i](1) +
+                                slopes[i] * (float(col) - vertices[i](0))));
+                max_row_given_col = upper_boundary < max_row_given_col
+                                        ? upper_boundary
+                                        : max_row_given_col;
             }
         }
+
+        // we find the intersections between the rays of the rows
+        // and the triangle, and keep the closest depths ------------
+        Vector3d normal =
+            R_[part_index] * normals_[part_index][triangle_index];
+        float offset = normal.dot(
+            trans_vertices[indices_[part_index][triangle_index][0]]);
+        int begin = std::max(int(min_row_given_col), row_begin);
+        int end = std::min(int(max_row_given_col), row_end - 1) + 1;
+        kernels.rasterize_column(inv_camera_matrix.data(),
+                                 normal.data(),
+                                 offset,
+                                 col,
+                                 begin,
+                                 end,
+                                 n_cols,
+                                 part_index,
+                                 depth_image,
+                                 part_image);
     }
 }
 
-// todo: does not handle the case properly when the depth is around zero or
-// negative
 void RigidBodyRenderer::Render(Matrix camera_matrix,
                                int n_rows,
                                int n_cols,
                                std::vector<int>& intersect_indices,
                                std::vector<float>& depth) const
 {
-    vector<float> depth_image;
+    intersect_indices.resize(n_rows * n_cols);
+    depth.resize(n_rows * n_cols);
+
+    int count = Render(camera_matrix,
+                       n_rows,
+                       n_cols,
+                       intersect_indices.data(),
+                       depth.data());
 
-    Render(camera_matrix, n_rows, n_cols, depth_image);
+    intersect_indices.resize(count);
+    depth.resize(count);
+}
+
+int RigidBodyRenderer::Render(Matrix camera_matrix,
+                              int n_rows,
+                              int n_cols,
+                              int* intersect_indices,
+                              float* depth) const
+{
+    return Render(
+        camera_matrix, n_rows, n_cols, intersect_indices, depth, nullptr);
+}
+
+// todo: does not handle the case properly when the depth is around zero or
+// negative
+int RigidBodyRenderer::Render(Matrix camera_matrix,
+                              int n_rows,
+                              int n_cols,
+                              int* intersect_indices,
+                              float* depth,
+                              int* parts) const
+{
+    FrameArena& arena = FrameArena::local();
+    FrameArena::Scope scope(arena);
+
+    float* depth_image = arena.allocate<float>(n_rows * n_cols);
+    int* part_image = parts ? arena.allocate<int>(n_rows * n_cols) : nullptr;
+
+    Render(camera_matrix, n_rows, n_cols, depth_image, part_image);
 
     // fill the depths into the depth vector -------------------------------
-    intersect_indices.clear();
-    depth.clear();
-    intersect_indices.resize(n_rows * n_cols);
-    depth.resize(n_rows * n_cols);
     int count = 0;
     for (int row = 0; row < n_rows; row++)
     {
@@ -320,12 +550,13 @@ void RigidBodyRenderer::Render(Matrix camera_matrix,
             {
                 intersect_indices[count] = row * n_cols + col;
                 depth[count] = depth_image[row * n_cols + col];
+                if (parts) parts[count] = part_image[row * n_cols + col];
                 count++;
             }
         }
     }
-    intersect_indices.resize(count);
-    depth.resize(count);
+
+    return count;
 }
 
 void RigidBodyRenderer::Render(std::vector<float>& depth_image) const
@@ -362,9 +593,14 @@ void RigidBodyRenderer::set_poses(const std::vector<Matrix>& rotations,
 
 void RigidBodyRenderer::set_poses(const std::vector<Affine>& poses)
 {
-    R_.resize(poses.size());
-    t_.resize(poses.size());
-    for (size_t i = 0; i < poses.size(); i++)
+    set_poses(poses.data(), poses.size());
+}
+
+void RigidBodyRenderer::set_poses(const Affine* poses, int count)
+{
+    R_.resize(count);
+    t_.resize(count);
+    for (int i = 0; i < count; i++)
     {
         R_[i] = poses[i].rotation();
         t_[i] = poses[i].translation();
@@ -435,3 +671,131 @@ void RigidBodyRenderer::parameters(Matrix camera_matrix, int n_rows, int n_cols)
 //
 //	objec_tmodel_enchilada.set_state(R, t, alpha);
 //}
+
+void RigidBodyRenderer::compute_visible_sets(int subdivisions,
+                                             double min_distance)
+{
+    auto sets = std::make_shared<VisibleSets>(subdivisions);
+    sets->min_distance = min_distance;
+
+    const ViewSphere& views = sets->views;
+    for (size_t part = 0; part < vertices_.size(); part++)
+    {
+        Vector3d center = Vector3d::Zero();
+        for (auto& vertex : vertices_[part]) center += vertex;
+        center /= vertices_[part].size();
+        sets->centers.push_back(center);
+
+        sets->triangles.push_back(vector<vector<int>>());
+        sets->sources.push_back(identical_part(vertices_, indices_, part));
+        if (sets->sources.back() != int(part)) continue;
+        if (!consistently_wound(part)) continue;
+
+        double radius = 0;
+        double volume = 0;
+        for (auto& vertex : vertices_[part])
+        {
+            radius = std::max(radius, (vertex - center).norm());
+        }
+        for (auto& triangle : indices_[part])
+        {
+            volume += vertices_[part][triangle[0]].dot(
+                vertices_[part][triangle[1]].cross(
+                    vertices_[part][triangle[2]]));
+        }
+        // the normals point outwards if the enclosed volume is positive
+        const double orientation = volume < 0 ? -1 : 1;
+
+        // a triangle with outward normal n faces a camera at c + d * v, with
+        // |v| = 1 and d >= min_distance, only if n.v > -radius / d. Within
+        // the cone of a view direction, n.v is at most the cosine of the
+        // angle between n and the direction reduced by the cone's angle.
+        const double limit = -radius / min_distance;
+        const double cone = views.covering_angle();
+
+        auto& part_sets = sets->triangles.back();
+        part_sets.resize(views.count_directions());
+        for (int view = 0; view < views.count_directions(); view++)
+        {
+            for (size_t triangle = 0; triangle < indices_[part].size();
+                 triangle++)
+            {
+                double cosine = orientation *
+                                normals_[part][triangle].dot(
+                                    views.direction(view));
+                double angle = std::acos(std::max(-1., std::min(1., cosine)));
+                if (std::cos(std::max(0., angle - cone)) > limit)
+                {
+                    part_sets[view].push_back(triangle);
+                }
+            }
+        }
+    }
+
+    visible_sets_ = sets;
+}
+
+int RigidBodyRenderer::count_rasterized_triangles(int part) const
+{
+    const std::vector<int>* visible = visible_triangles(part);
+
+    return visible ? visible->size() : indices_[part].size();
+}
+
+const std::vector<int>* RigidBodyRenderer::visible_triangles(int part) const
+{
+    if (!visible_sets_) return nullptr;
+
+    const auto& sets = visible_sets_->triangles[visible_sets_->sources[part]];
+    if (sets.empty()) return nullptr;
+
+    // direction from the part center towards the camera in the part frame
+    Vector3d camera =
+        -R_[part].transpose() * t_[part] - visible_sets_->centers[part];
+    double distance = camera.norm();
+    if (distance < visible_sets_->min_distance) return nullptr;
+
+    int view = visible_sets_->views.nearest(camera / distance);
+    return &sets[view];
+}
+
+int RigidBodyRenderer::identical_part(
+    const std::vector<std::vector<Eigen::Vector3d>>& vertices,
+    const std::vector<std::vector<std::vector<int>>>& indices,
+    int part)
+{
+    for (int other = 0; other < part; other++)
+    {
+        if (vertices[other] == vertices[part] &&
+            indices[other] == indices[part])
+        {
+            return other;
+        }
+    }
+
+    return part;
+}
+
+bool RigidBodyRenderer::consistently_wound(int part) const
+{
+    std::map<std::pair<int, int>, int> edges;
+    for (auto& triangle : indices_[part])
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            if (++edges[std::make_pair(triangle[i], triangle[(i + 1) % 3])] >
+                1)
+            {
+                return false;
+            }
+        }
+    }
+
+    for (auto& edge : edges)
+    {
+        auto reverse = std::make_pair(edge.first.second, edge.first.first);
+        if (edges.find(reverse) == edges.end()) return false;
+    }
+
+    return true;
+}
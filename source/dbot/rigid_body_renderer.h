@@ -14,12 +14,18 @@
 #pragma once
 
 #include <Eigen/Dense>
+#include <algorithm>
 #include <dbot/pose/rigid_bodies_state.h>
+#include <dbot/view_sphere.h>
 #include <memory>
+#include <utility>
 #include <vector>
 
 namespace dbot
 {
+class Executor;
+struct CpuKernels;
+
 class RigidBodyRenderer
 {
 public:
@@ -47,11 +53,65 @@ public:
                 std::vector<int>& intersect_indices,
                 std::vector<float>& depth) const;
 
+    /**
+     * \brief Renders into caller provided buffers which must hold at least
+     *        n_rows * n_cols elements. Returns the number of pixels covered
+     *        by the object.
+     */
+    int Render(Matrix camera_matrix,
+               int n_rows,
+               int n_cols,
+               int* intersect_indices,
+               float* depth) const;
+
+    /**
+     * \brief As above, additionally writes the index of the part producing
+     *        the depth of each covered pixel into parts
+     */
+    int Render(Matrix camera_matrix,
+               int n_rows,
+               int n_cols,
+               int* intersect_indices,
+               float* depth,
+               int* parts) const;
+
     void Render(Matrix camera_matrix,
                 int n_rows,
                 int n_cols,
                 std::vector<float>& depth_image) const;
 
+    /**
+     * \brief Renders the full depth image into a caller provided buffer of
+     *        n_rows * n_cols elements. Uncovered pixels are set to infinity.
+     */
+    void Render(Matrix camera_matrix,
+                int n_rows,
+                int n_cols,
+                float* depth_image) const;
+
+    /**
+     * \brief As above, additionally writes the index of the part producing
+     *        the depth of each covered pixel into part_image
+     */
+    void Render(Matrix camera_matrix,
+                int n_rows,
+                int n_cols,
+                float* depth_image,
+                int* part_image) const;
+
+    /**
+     * \brief As above, with the image split into tiles of tile_rows rows
+     *        which are rasterized by the workers of the executor. The result
+     *        equals the single threaded one.
+     */
+    void Render(Matrix camera_matrix,
+                int n_rows,
+                int n_cols,
+                float* depth_image,
+                int* part_image,
+                Executor& executor,
+                int tile_rows) const;
+
     void Render(std::vector<float>& depth_image) const;
 
     template <typename RigidbodyState>
@@ -124,9 +184,153 @@ public:
 
     virtual void set_poses(const std::vector<Affine>& poses);
 
+    void set_poses(const Affine* poses, int count);
+
     void parameters(Matrix camera_matrix, int n_rows, int n_cols);
 
+    /**
+     * \brief Precomputes for each part and each direction of a view sphere
+     *        the triangles which can face a camera within the direction's
+     *        cone. Render() then rasterizes only the set matching the
+     *        direction from each part towards the camera.
+     *
+     * The sets are conservative for cameras at least min_distance away from
+     * the part center, closer cameras rasterize all triangles. Parts which
+     * are not closed, consistently wound meshes are not culled. The sets are
+     * shared by copies of the renderer and computed once for identical
+     * parts, such as instances of one mesh.
+     */
+    void compute_visible_sets(int subdivisions = 3, double min_distance = 0.3);
+
+    /**
+     * \brief Returns the first part with the same vertices and triangles as
+     *        the given part, the part itself if there is no earlier one
+     */
+    static int identical_part(
+        const std::vector<std::vector<Eigen::Vector3d>>& vertices,
+        const std::vector<std::vector<std::vector<int>>>& indices,
+        int part);
+
+    /**
+     * \brief Returns the number of triangles rasterized for the given part
+     *        at its current pose
+     */
+    int count_rasterized_triangles(int part) const;
+
+    /**
+     * \brief The parts transformed to their current poses and their
+     *        triangles binned to horizontal tiles of the image
+     */
+    struct Tiles
+    {
+        Matrix camera_matrix;
+        Matrix inverse_camera_matrix;
+        int n_rows;
+        int n_cols;
+        int tile_rows;
+
+        std::vector<std::vector<Eigen::Vector3d>> trans_vertices;
+        std::vector<
+            std::vector<Eigen::Vector2d,
+                        Eigen::aligned_allocator<Eigen::Vector2d>>>
+            image_vertices;
+
+        // tile x (part, triangle) overlapping the rows of the tile
+        std::vector<std::vector<std::pair<int, int>>> bins;
+
+        int count() const { return bins.size(); }
+        int row_begin(int tile) const { return tile * tile_rows; }
+        int row_end(int tile) const
+        {
+            return std::min(n_rows, (tile + 1) * tile_rows);
+        }
+    };
+
+    /**
+     * \brief Transforms the parts to their current poses and bins their
+     *        triangles to tiles of tile_rows rows. The tiles may then be
+     *        rendered by different threads. A reused tiling keeps its
+     *        buffers.
+     */
+    void bin(Matrix camera_matrix,
+             int n_rows,
+             int n_cols,
+             int tile_rows,
+             Tiles& tiles) const;
+
+    /**
+     * \brief Renders the rows of one tile into image buffers of n_rows *
+     *        n_cols elements, the other rows are left untouched. The part
+     *        image may be null.
+     */
+    void render_tile(const Tiles& tiles,
+                     int tile,
+                     float* depth_image,
+                     int* part_image) const;
+
 private:
+    /**
+     * \brief Triangles per part and view direction which may face the camera
+     */
+    struct VisibleSets
+    {
+        explicit VisibleSets(int subdivisions) : views(subdivisions) {}
+
+        ViewSphere views;
+        double min_distance;
+        std::vector<Vector> centers;
+        // part x view x triangle indices, no views for parts not culled and
+        // for parts identical to an earlier one
+        std::vector<std::vector<std::vector<int>>> triangles;
+        // part whose triangle sets are used for each part
+        std::vector<int> sources;
+    };
+
+    /**
+     * \brief Returns the triangles to rasterize for the given part at its
+     *        current pose, or null for all triangles
+     */
+    const std::vector<int>* visible_triangles(int part) const;
+
+    /**
+     * \brief Computes the pixel bounds of a triangle clipped to the rows
+     *        [row_begin, row_end) and the image columns. Returns false if
+     *        nothing remains or the triangle reaches behind the camera.
+     */
+    bool bounds(int part_index,
+                int triangle_index,
+                const Eigen::Vector3d* trans_vertices,
+                const Eigen::Vector2d* image_vertices,
+                int row_begin,
+                int row_end,
+                int n_cols,
+                int& min_row,
+                int& max_row,
+                int& min_col,
+                int& max_col) const;
+
+    /**
+     * \brief Rasterizes a triangle of a part, given its transformed and
+     *        projected vertices, into the rows [row_begin, row_end)
+     */
+    void rasterize(const CpuKernels& kernels,
+                   const Matrix& inv_camera_matrix,
+                   int part_index,
+                   int triangle_index,
+                   const Eigen::Vector3d* trans_vertices,
+                   const Eigen::Vector2d* image_vertices,
+                   int row_begin,
+                   int row_end,
+                   int n_cols,
+                   float* depth_image,
+                   int* part_image) const;
+
+    /**
+     * \brief Returns whether every edge of the part is shared by exactly two
+     *        triangles traversing it in opposite directions
+     */
+    bool consistently_wound(int part) const;
+
     /**
      * Because c++0x on gcc.4.6 does not implement delegating constructors
      */
@@ -150,5 +354,8 @@ public:
     // cached center of mass
     std::vector<Vector> coms_;
     std::vector<float> com_weights_;
+
+    // potentially visible triangles, null if not computed
+    std::shared_ptr<const VisibleSets> visible_sets_;
 };
 }
@@ -0,0 +1,266 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file rigid_body_renderer_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include <dbot/executor.h>
+#include <dbot/rigid_body_renderer.h>
+
+class RigidBodyRendererTests : public ::testing::Test
+{
+protected:
+    RigidBodyRendererTests() : vertices_(1), indices_(1)
+    {
+        // sphere of 5 cm radius with outward winding
+        const int slices = 24, stacks = 12;
+        vertices_[0].push_back(Eigen::Vector3d(0, 0, 0.05));
+        for (int i = 1; i < stacks; ++i)
+        {
+            for (int j = 0; j < slices; ++j)
+            {
+                double theta = M_PI * i / stacks;
+                double phi = 2 * M_PI * j / slices;
+                vertices_[0].push_back(
+                    0.05 * Eigen::Vector3d(std::sin(theta) * std::cos(phi),
+                                           std::sin(theta) * std::sin(phi),
+                                           std::cos(theta)));
+            }
+        }
+        vertices_[0].push_back(Eigen::Vector3d(0, 0, -0.05));
+
+        const int bottom = vertices_[0].size() - 1;
+        auto ring = [&](int i, int j) {
+            return 1 + (i - 1) * slices + j % slices;
+        };
+        for (int j = 0; j < slices; ++j)
+        {
+            indices_[0].push_back({0, ring(1, j), ring(1, j + 1)});
+            indices_[0].push_back(
+                {ring(stacks - 1, j), bottom, ring(stacks - 1, j + 1)});
+        }
+        for (int i = 1; i < stacks - 1; ++i)
+        {
+            for (int j = 0; j < slices; ++j)
+            {
+                indices_[0].push_back(
+                    {ring(i, j), ring(i + 1, j), ring(i + 1, j + 1)});
+                indices_[0].push_back(
+                    {ring(i, j), ring(i + 1, j + 1), ring(i, j + 1)});
+            }
+        }
+
+        camera_matrix_ << 300, 0, 80, 0, 300, 60, 0, 0, 1;
+    }
+
+    std::vector<std::vector<Eigen::Vector3d>> vertices_;
+    std::vector<std::vector<std::vector<int>>> indices_;
+    Eigen::Matrix3d camera_matrix_;
+};
+
+TEST_F(RigidBodyRendererTests, visible_sets_render_identically)
+{
+    dbot::RigidBodyRenderer all(vertices_, indices_);
+    dbot::RigidBodyRenderer culled(vertices_, indices_);
+    culled.compute_visible_sets();
+
+    const int rows = 120, cols = 160;
+    std::vector<float> expected(rows * cols), actual(rows * cols);
+
+    for (int k = 0; k < 5; ++k)
+    {
+        dbot::RigidBodyRenderer::Affine pose;
+        pose.linear() =
+            Eigen::AngleAxisd(
+                0.9 * k, Eigen::Vector3d(1, k - 2, 0.5 * k).normalized())
+                .toRotationMatrix();
+        pose.translation() =
+            Eigen::Vector3d(0.03 * k - 0.06, 0.01 * k, 0.5 + 0.1 * k);
+
+        all.set_poses(&pose, 1);
+        culled.set_poses(&pose, 1);
+        all.Render(camera_matrix_, rows, cols, expected.data());
+        culled.Render(camera_matrix_, rows, cols, actual.data());
+
+        EXPECT_EQ(expected, actual);
+        EXPECT_LT(culled.count_rasterized_triangles(0),
+                  0.7 * indices_[0].size());
+    }
+}
+
+TEST_F(RigidBodyRendererTests, instances_share_visible_sets)
+{
+    // two instances of the sphere and a larger sphere
+    vertices_.push_back(vertices_[0]);
+    indices_.push_back(indices_[0]);
+    vertices_.push_back(vertices_[0]);
+    indices_.push_back(indices_[0]);
+    for (auto& vertex : vertices_[2]) vertex *= 1.5;
+
+    EXPECT_EQ(0, dbot::RigidBodyRenderer::identical_part(vertices_, indices_, 0));
+    EXPECT_EQ(0, dbot::RigidBodyRenderer::identical_part(vertices_, indices_, 1));
+    EXPECT_EQ(2, dbot::RigidBodyRenderer::identical_part(vertices_, indices_, 2));
+
+    dbot::RigidBodyRenderer all(vertices_, indices_);
+    dbot::RigidBodyRenderer culled(vertices_, indices_);
+    culled.compute_visible_sets();
+
+    std::vector<dbot::RigidBodyRenderer::Affine> poses(3);
+    for (int part = 0; part < 3; ++part)
+    {
+        poses[part].linear() =
+            Eigen::AngleAxisd(1.1 * part,
+                              Eigen::Vector3d(1, part - 1, 0.5).normalized())
+                .toRotationMatrix();
+        poses[part].translation() =
+            Eigen::Vector3d(0.06 * part - 0.06, 0.01 * part, 0.5 + 0.05 * part);
+    }
+    all.set_poses(poses);
+    culled.set_poses(poses);
+
+    const int rows = 120, cols = 160;
+    std::vector<float> expected(rows * cols), actual(rows * cols);
+    all.Render(camera_matrix_, rows, cols, expected.data());
+    culled.Render(camera_matrix_, rows, cols, actual.data());
+
+    EXPECT_EQ(expected, actual);
+    for (int part = 0; part < 3; ++part)
+    {
+        EXPECT_LT(culled.count_rasterized_triangles(part),
+                  0.7 * indices_[part].size());
+    }
+}
+
+TEST_F(RigidBodyRendererTests, open_meshes_are_not_culled)
+{
+    indices_[0].pop_back();
+
+    dbot::RigidBodyRenderer renderer(vertices_, indices_);
+    renderer.compute_visible_sets();
+
+    dbot::RigidBodyRenderer::Affine pose;
+    pose.setIdentity();
+    pose.translation() = Eigen::Vector3d(0, 0, 0.6);
+    renderer.set_poses(&pose, 1);
+
+    EXPECT_EQ(renderer.count_rasterized_triangles(0), indices_[0].size());
+}
+
+TEST_F(RigidBodyRendererTests, parts_of_closest_depth)
+{
+    // a second sphere partially in front of the first
+    vertices_.push_back(vertices_[0]);
+    indices_.push_back(indices_[0]);
+
+    dbot::RigidBodyRenderer renderer(vertices_, indices_);
+
+    std::vector<dbot::RigidBodyRenderer::Affine> poses(
+        2, dbot::RigidBodyRenderer::Affine::Identity());
+    poses[0].translation() = Eigen::Vector3d(0, 0, 0.6);
+    poses[1].translation() = Eigen::Vector3d(0.05, 0, 0.5);
+    renderer.set_poses(poses);
+
+    const int rows = 120, cols = 160;
+    std::vector<float> depth_image(rows * cols);
+    std::vector<int> part_image(rows * cols);
+    renderer.Render(
+        camera_matrix_, rows, cols, depth_image.data(), part_image.data());
+
+    std::vector<int> indices(rows * cols), parts(rows * cols);
+    std::vector<float> depths(rows * cols);
+    int count = renderer.Render(camera_matrix_,
+                                rows,
+                                cols,
+                                indices.data(),
+                                depths.data(),
+                                parts.data());
+
+    // each part rendered on its own
+    std::vector<std::vector<float>> single_images(2);
+    for (int part = 0; part < 2; ++part)
+    {
+        std::vector<dbot::RigidBodyRenderer::Affine> single(1, poses[part]);
+        dbot::RigidBodyRenderer single_renderer(
+            std::vector<std::vector<Eigen::Vector3d>>(1, vertices_[part]),
+            std::vector<std::vector<std::vector<int>>>(1, indices_[part]));
+        single_renderer.set_poses(single);
+        single_renderer.Render(camera_matrix_, rows, cols, single_images[part]);
+    }
+
+    int counts[2] = {0, 0};
+    for (int i = 0; i < count; ++i)
+    {
+        const int pixel = indices[i];
+        ASSERT_TRUE(parts[i] == 0 || parts[i] == 1);
+        EXPECT_EQ(parts[i], part_image[pixel]);
+        EXPECT_EQ(depths[i], single_images[parts[i]][pixel]);
+        EXPECT_LE(single_images[parts[i]][pixel],
+                  single_images[1 - parts[i]][pixel]);
+        counts[parts[i]]++;
+    }
+    EXPECT_GT(counts[0], 0);
+    EXPECT_GT(counts[1], 0);
+}
+
+TEST_F(RigidBodyRendererTests, tiles_render_identically)
+{
+    vertices_.push_back(vertices_[0]);
+    indices_.push_back(indices_[0]);
+
+    dbot::RigidBodyRenderer renderer(vertices_, indices_);
+
+    std::vector<dbot::RigidBodyRenderer::Affine> poses(
+        2, dbot::RigidBodyRenderer::Affine::Identity());
+    poses[0].translation() = Eigen::Vector3d(0, 0.02, 0.6);
+    poses[1].translation() = Eigen::Vector3d(0.05, 0, 0.5);
+    renderer.set_poses(poses);
+
+    const int rows = 120, cols = 160;
+    std::vector<float> expected_depth(rows * cols);
+    std::vector<int> expected_parts(rows * cols);
+    renderer.Render(camera_matrix_,
+                    rows,
+                    cols,
+                    expected_depth.data(),
+                    expected_parts.data());
+
+    dbot::Executor executor(3);
+
+    // the last tile is partial
+    for (int tile_rows : {1, 7, 32, rows})
+    {
+        std::vector<float> depth(rows * cols, 0.0f);
+        std::vector<int> parts(rows * cols, -1);
+        renderer.Render(camera_matrix_,
+                        rows,
+                        cols,
+                        depth.data(),
+                        parts.data(),
+                        executor,
+                        tile_rows);
+
+        EXPECT_EQ(expected_depth, depth);
+        for (int i = 0; i < rows * cols; ++i)
+        {
+            if (std::isinf(depth[i])) continue;
+            EXPECT_EQ(expected_parts[i], parts[i]);
+        }
+    }
+}
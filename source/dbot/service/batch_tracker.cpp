@@ -0,0 +1,312 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file batch_tracker.cpp
+ * \date October 2016
+ */
+
+#include <dbot/service/batch_tracker.h>
+
+#include <chrono>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#include <boost/filesystem.hpp>
+
+#include <dbot/observation_context.h>
+#include <dbot/service/depth_recording.h>
+#include <dbot/service/pose_table.h>
+#include <dbot/service/tracker_factory.h>
+
+namespace dbot
+{
+namespace
+{
+typedef std::chrono::steady_clock Clock;
+
+std::string resolve(const std::string& path, const std::string& directory)
+{
+    boost::filesystem::path p(path);
+    if (p.is_absolute() || directory.empty()) return path;
+    return (boost::filesystem::path(directory) / p).string();
+}
+
+std::string join(const std::vector<double>& values)
+{
+    std::ostringstream text;
+    text.precision(17);
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        text << (i ? " " : "") << values[i];
+    }
+    return text.str();
+}
+
+std::vector<std::string> column_names(int object_count)
+{
+    std::vector<std::string> names = {"frame", "timestamp", "track_ms"};
+    for (int i = 0; i < object_count; ++i)
+    {
+        for (auto value : {"x", "y", "z", "qw", "qx", "qy", "qz"})
+        {
+            names.push_back("object" + std::to_string(i) + "." + value);
+        }
+    }
+    return names;
+}
+}
+
+std::vector<BatchJob> parse_batch_manifest(const std::string& text,
+                                           const std::string& directory,
+                                           const std::string& origin)
+{
+    std::vector<BatchJob> jobs;
+    std::set<std::string> ids;
+
+    std::istringstream stream(text);
+    std::string line;
+    for (int number = 1; std::getline(stream, line); ++number)
+    {
+        std::istringstream fields(line.substr(0, line.find('#')));
+        BatchJob job;
+        if (!(fields >> job.id)) continue;
+
+        const std::string where = origin + ":" + std::to_string(number);
+        if (!(fields >> job.recording >> job.config >> job.mesh))
+        {
+            throw ConfigException(where +
+                                  ": expected '<id> <recording> <config> "
+                                  "<mesh> <initial poses>'");
+        }
+
+        double value;
+        while (fields >> value) job.initial_poses.push_back(value);
+        if (!fields.eof() || job.initial_poses.empty() ||
+            job.initial_poses.size() % 7 != 0)
+        {
+            throw ConfigException(where +
+                                  ": initial poses require 7 values per "
+                                  "object");
+        }
+
+        if (!ids.insert(job.id).second)
+        {
+            throw ConfigException(where + ": repeated job " + job.id);
+        }
+
+        job.recording = resolve(job.recording, directory);
+        job.config = resolve(job.config, directory);
+        job.mesh = job.mesh == "-" ? "" : resolve(job.mesh, directory);
+        jobs.push_back(job);
+    }
+
+    return jobs;
+}
+
+std::vector<BatchJob> load_batch_manifest(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        throw ConfigException(path + ": cannot open manifest");
+    }
+
+    std::stringstream text;
+    text << file.rdbuf();
+    return parse_batch_manifest(
+        text.str(),
+        boost::filesystem::path(path).parent_path().string(),
+        path);
+}
+
+BatchTracker::BatchTracker(const Parameters& params)
+    : params_(params), stop_(false)
+{
+}
+
+std::string BatchTracker::output_path(const BatchJob& job) const
+{
+    return (boost::filesystem::path(params_.output_directory) /
+            (job.id + ".poses"))
+        .string();
+}
+
+auto BatchTracker::run(const std::vector<BatchJob>& jobs) -> Summary
+{
+    boost::filesystem::create_directories(params_.output_directory);
+
+    int concurrency = params_.concurrency;
+    if (concurrency <= 0)
+    {
+        concurrency = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    Summary summary;
+    const auto start = Clock::now();
+
+    // the threads claim the jobs in manifest order
+    std::atomic<size_t> next(0);
+    std::mutex summary_mutex;
+    auto work = [&]() {
+        for (size_t i = next++; i < jobs.size() && !stop_; i = next++)
+        {
+            const BatchJob& job = jobs[i];
+            if (boost::filesystem::exists(output_path(job)))
+            {
+                std::lock_guard<std::mutex> lock(summary_mutex);
+                summary.skipped++;
+                continue;
+            }
+
+            try
+            {
+                const long frames = track(job);
+                std::lock_guard<std::mutex> lock(summary_mutex);
+                if (frames < 0) continue;
+                summary.completed++;
+                summary.frames += frames;
+            }
+            catch (const std::exception& e)
+            {
+                std::lock_guard<std::mutex> lock(summary_mutex);
+                summary.failures.push_back(std::make_pair(job.id, e.what()));
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < std::min<int>(concurrency, jobs.size()); ++i)
+    {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto& thread : threads) thread.join();
+
+    summary.seconds =
+        std::chrono::duration<double>(Clock::now() - start).count();
+    return summary;
+}
+
+void BatchTracker::stop()
+{
+    stop_ = true;
+}
+
+long BatchTracker::track(const BatchJob& job)
+{
+    ConfigFile config = ConfigFile::load(job.config);
+    if (!job.mesh.empty())
+    {
+        const boost::filesystem::path mesh(job.mesh);
+        config.set("object.package_path", mesh.parent_path().string());
+        config.set("object.directory", "");
+        config.set("object.meshes", mesh.filename().string());
+    }
+    config.set("tracker.initial_poses", join(job.initial_poses));
+
+    // the jobs are built on the threads of the batch, worker processes
+    // forked from them could inherit locks held by the other jobs
+    if (config.get<int>("sensor.process_count", 0) > 0)
+    {
+        throw ConfigException(job.config +
+                              ": sensor.process_count is not supported in "
+                              "batch jobs");
+    }
+    if (params_.job_workers > 0)
+    {
+        config.set("sensor.worker_count",
+                   std::to_string(params_.job_workers));
+    }
+
+    DepthRecording recording(job.recording);
+    const int rows = recording.rows();
+    const int cols = recording.cols();
+    if (rows != config.get<int>("camera.rows") ||
+        cols != config.get<int>("camera.cols"))
+    {
+        throw RecordingException(job.recording +
+                                 ": frame size does not match the "
+                                 "configured camera resolution");
+    }
+
+    auto tracker = create_configured_tracker(config, object_model(config));
+    tracker->initialize(
+        std::vector<Tracker::State>(1, configured_initial_state(config)));
+    ObservationSource source(configured_camera_matrix(config), rows, cols);
+    tracker->subscribe(source);
+
+    const int object_count = configured_object_count(config);
+    PoseTable table(column_names(object_count));
+
+    std::vector<float> depth(rows * cols);
+    std::vector<double> row;
+    double timestamp;
+    long frame = 0;
+    while (recording.read(timestamp, depth.data()))
+    {
+        if (stop_) return -1;
+
+        const auto context = source.publish(depth.data());
+
+        const auto before = Clock::now();
+        const Tracker::State state = tracker->track(context);
+        const double track_ms =
+            std::chrono::duration<double, std::milli>(Clock::now() - before)
+                .count();
+
+        row = {double(frame), timestamp, track_ms};
+        for (int i = 0; i < object_count; ++i)
+        {
+            const Eigen::Vector3d position = state.component(i).position();
+            const Eigen::Quaterniond orientation =
+                state.component(i).orientation().quaternion();
+            row.insert(row.end(),
+                       {position(0),
+                        position(1),
+                        position(2),
+                        orientation.w(),
+                        orientation.x(),
+                        orientation.y(),
+                        orientation.z()});
+        }
+        table.append(row);
+        frame++;
+    }
+
+    table.save(output_path(job));
+    return frame;
+}
+
+ObjectModelFuture BatchTracker::object_model(const ConfigFile& config)
+{
+    const std::string key =
+        config.get<std::string>("object.package_path") + "\n" +
+        config.get<std::string>("object.directory") + "\n" +
+        config.get<std::string>("object.meshes") + "\n" +
+        std::to_string(config.get<int>("object.instances", 1));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto entry = object_models_.find(key);
+    if (entry == object_models_.end())
+    {
+        entry = object_models_
+                    .insert(std::make_pair(
+                        key, load_configured_object_model(config)))
+                    .first;
+    }
+    return entry->second;
+}
+}
@@ -0,0 +1,152 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file batch_tracker.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <dbot/object_model.h>
+#include <dbot/service/config_file.h>
+
+namespace dbot
+{
+/**
+ * \brief Recorded sequence to track offline
+ */
+struct BatchJob
+{
+    /// name of the job and of its output table
+    std::string id;
+    /// depth recording, see DepthRecording
+    std::string recording;
+    /// tracker configuration, see doc/tracking_service.conf
+    std::string config;
+    /// Wavefront mesh replacing the configured object meshes, empty to
+    /// keep them
+    std::string mesh;
+    /// position and quaternion (x y z qw qx qy qz) per object, replacing
+    /// tracker.initial_poses
+    std::vector<double> initial_poses;
+};
+
+/**
+ * \brief Parses a batch manifest, one job per line of the form
+ *
+ *     <id> <recording> <config> <mesh> <x y z qw qx qy qz per object>
+ *
+ * A mesh of '-' keeps the configured meshes. Everything after a '#' is a
+ * comment. Relative paths are taken relative to the given directory.
+ *
+ * \throws ConfigException if a line is malformed or an id repeats
+ */
+std::vector<BatchJob> parse_batch_manifest(const std::string& text,
+                                           const std::string& directory,
+                                           const std::string& origin =
+                                               "manifest");
+
+/**
+ * \brief Reads the manifest at the given path, relative paths are taken
+ *        relative to the directory of the manifest
+ *
+ * \throws ConfigException if the file cannot be read or is malformed
+ */
+std::vector<BatchJob> load_batch_manifest(const std::string& path);
+
+/**
+ * \brief Tracks recorded sequences offline, several at a time.
+ *
+ * Each job builds a particle tracker from its configuration, initializes it
+ * at the job's initial poses and tracks every frame of the recording. The
+ * estimated poses and the tracking time of each frame are written to the
+ * PoseTable <output directory>/<id>.poses once the job is complete. Jobs
+ * whose table exists are skipped, hence an interrupted batch resumes with
+ * the jobs that did not complete.
+ *
+ * Jobs run on a fixed number of threads and stream their recording frame by
+ * frame, such that memory is bounded by the number of concurrent trackers.
+ * Their sensors evaluate in the job's thread or its executor; a job
+ * configuring worker processes, i.e. sensor.process_count, fails.
+ * Object models are loaded once and shared by all jobs tracking the same
+ * meshes.
+ */
+class BatchTracker
+{
+public:
+    struct Parameters
+    {
+        // directory of the output tables, created if missing
+        std::string output_directory;
+        // jobs tracked at the same time, 0 for one per hardware thread
+        int concurrency = 0;
+        // workers of the sensor of each job, replacing sensor.worker_count.
+        // The jobs already occupy the threads, 0 keeps the configured count
+        int job_workers = 1;
+    };
+
+    struct Summary
+    {
+        int completed = 0;
+        // jobs whose table existed
+        int skipped = 0;
+        // id and error message of each failed job
+        std::vector<std::pair<std::string, std::string>> failures;
+        long frames = 0;
+        // wall time of the batch in seconds
+        double seconds = 0;
+    };
+
+public:
+    explicit BatchTracker(const Parameters& params);
+
+    /**
+     * \brief Tracks the jobs and returns once all have completed, failed or
+     *        been skipped, or after stop()
+     */
+    Summary run(const std::vector<BatchJob>& jobs);
+
+    /**
+     * \brief Makes run() return once the running jobs have been abandoned.
+     *        Their tables are not written. Async signal safe.
+     */
+    void stop();
+
+    /**
+     * \brief Returns the path of the output table of the job
+     */
+    std::string output_path(const BatchJob& job) const;
+
+private:
+    /// tracks the job and writes its table, returns the number of frames
+    /// tracked or -1 if stopped
+    long track(const BatchJob& job);
+
+    /// returns the shared object model of the configured meshes
+    ObjectModelFuture object_model(const ConfigFile& config);
+
+private:
+    Parameters params_;
+    std::mutex mutex_;
+    std::map<std::string, ObjectModelFuture> object_models_;
+    std::atomic<bool> stop_;
+};
+}
@@ -0,0 +1,233 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file batch_tracker_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#include <unistd.h>
+
+#include <boost/filesystem.hpp>
+
+#include <dbot/service/batch_tracker.h>
+#include <dbot/service/depth_recording.h>
+#include <dbot/service/pose_table.h>
+
+namespace
+{
+std::string working_directory()
+{
+    char path[4096];
+    return getcwd(path, sizeof(path)) ? path : "/";
+}
+
+const char* config_text =
+    "camera.rows: 24\n"
+    "camera.cols: 32\n"
+    "camera.matrix: 30 0 16  0 30 12  0 0 1\n"
+    "object.package_path: /\n"
+    "object.directory: none\n"
+    "object.meshes: none.obj\n"
+    "tracker.evaluation_count: 4\n"
+    "tracker.moving_average_update_rate: 1.0\n"
+    "tracker.max_kl_divergence: 2.0\n"
+    "tracker.initial_poses: 0 0 1  1 0 0 0\n"
+    "transition.linear_sigma_x: 0.002\n"
+    "transition.linear_sigma_y: 0.002\n"
+    "transition.linear_sigma_z: 0.002\n"
+    "transition.angular_sigma_x: 0.01\n"
+    "transition.angular_sigma_y: 0.01\n"
+    "transition.angular_sigma_z: 0.01\n"
+    "transition.velocity_factor: 0.8\n"
+    "sensor.sample_count: 10\n"
+    "sensor.delta_time: 0.033\n"
+    "sensor.occlusion.p_occluded_visible: 0.1\n"
+    "sensor.occlusion.p_occluded_occluded: 0.7\n"
+    "sensor.occlusion.initial_occlusion_prob: 0.1\n"
+    "sensor.kinect.tail_weight: 0.01\n"
+    "sensor.kinect.model_sigma: 0.003\n"
+    "sensor.kinect.sigma_factor: 0.00142478\n";
+
+// a cube of 10 cm in front of a wall at 1.2 m
+void write_job_files(int rows, int cols, int frames)
+{
+    std::ofstream("batch_tracker_test.conf") << config_text;
+
+    std::ofstream("batch_tracker_test.obj")
+        << "v -0.05 -0.05 -0.05\nv 0.05 -0.05 -0.05\nv 0.05 0.05 -0.05\n"
+           "v -0.05 0.05 -0.05\nv -0.05 -0.05 0.05\nv 0.05 -0.05 0.05\n"
+           "v 0.05 0.05 0.05\nv -0.05 0.05 0.05\n"
+           "f 1 3 2\nf 1 4 3\nf 5 6 7\nf 5 7 8\nf 1 2 6\nf 1 6 5\n"
+           "f 4 7 3\nf 4 8 7\nf 1 5 8\nf 1 8 4\nf 2 3 7\nf 2 7 6\n";
+
+    dbot::DepthRecordingWriter writer("batch_tracker_test.depth", rows, cols);
+    std::vector<float> depth(rows * cols, 1.2f);
+    for (int row = rows / 2 - 3; row < rows / 2 + 3; ++row)
+    {
+        for (int col = cols / 2 - 3; col < cols / 2 + 3; ++col)
+        {
+            depth[row * cols + col] = 0.95f;
+        }
+    }
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        writer.write(frame / 30.0, depth.data());
+    }
+}
+
+void remove_job_files()
+{
+    std::remove("batch_tracker_test.conf");
+    std::remove("batch_tracker_test.obj");
+    std::remove("batch_tracker_test.depth");
+    boost::filesystem::remove_all("batch_tracker_test_output");
+}
+}
+
+TEST(BatchTrackerTests, parses_manifest)
+{
+    auto jobs = dbot::parse_batch_manifest(
+        "# id recording config mesh poses\n"
+        "a  a.depth  a.conf  -        0 0 1  1 0 0 0\n"
+        "\n"
+        "b  /data/b.depth  b.conf  m/b.obj  0 0 1  1 0 0 0"
+        "  0 0.1 1  1 0 0 0  # two objects\n",
+        "/jobs");
+
+    ASSERT_EQ(2u, jobs.size());
+    EXPECT_EQ("a", jobs[0].id);
+    EXPECT_EQ("/jobs/a.depth", jobs[0].recording);
+    EXPECT_EQ("/jobs/a.conf", jobs[0].config);
+    EXPECT_EQ("", jobs[0].mesh);
+    EXPECT_EQ(7u, jobs[0].initial_poses.size());
+    EXPECT_EQ("/data/b.depth", jobs[1].recording);
+    EXPECT_EQ("/jobs/m/b.obj", jobs[1].mesh);
+    ASSERT_EQ(14u, jobs[1].initial_poses.size());
+    EXPECT_EQ(0.1, jobs[1].initial_poses[8]);
+}
+
+TEST(BatchTrackerTests, malformed_manifest_throws)
+{
+    EXPECT_THROW(dbot::parse_batch_manifest("a a.depth a.conf\n", ""),
+                 dbot::ConfigException);
+    EXPECT_THROW(dbot::parse_batch_manifest("a a.depth a.conf - 0 0 1\n", ""),
+                 dbot::ConfigException);
+    EXPECT_THROW(
+        dbot::parse_batch_manifest("a a.depth a.conf - 0 0 1 1 0 0 x\n", ""),
+        dbot::ConfigException);
+
+    // repeated id
+    EXPECT_THROW(
+        dbot::parse_batch_manifest("a a.depth a.conf - 0 0 1 1 0 0 0\n"
+                                   "a b.depth b.conf - 0 0 1 1 0 0 0\n",
+                                   ""),
+        dbot::ConfigException);
+}
+
+TEST(BatchTrackerTests, tracks_jobs_and_skips_completed)
+{
+    const int frames = 3;
+    write_job_files(24, 32, frames);
+
+    dbot::BatchJob job;
+    job.id = "cube";
+    job.recording = "batch_tracker_test.depth";
+    job.config = "batch_tracker_test.conf";
+    job.mesh = working_directory() + "/batch_tracker_test.obj";
+    job.initial_poses = {0, 0, 1, 1, 0, 0, 0};
+
+    dbot::BatchTracker::Parameters params;
+    params.output_directory = "batch_tracker_test_output";
+    params.concurrency = 2;
+    dbot::BatchTracker batch(params);
+
+    auto summary = batch.run({job});
+    EXPECT_TRUE(summary.failures.empty());
+    EXPECT_EQ(1, summary.completed);
+    EXPECT_EQ(frames, summary.frames);
+
+    auto table = dbot::PoseTable::load(batch.output_path(job));
+    EXPECT_EQ(3u + 7u, table.names().size());
+    ASSERT_EQ(size_t(frames), table.count_rows());
+    EXPECT_EQ(2, table.column("frame")[2]);
+    EXPECT_DOUBLE_EQ(1 / 30.0, table.column("timestamp")[1]);
+    EXPECT_NEAR(1.0, table.column("object0.z")[0], 0.1);
+
+    // the table exists, a rerun resumes after it
+    summary = batch.run({job});
+    EXPECT_EQ(0, summary.completed);
+    EXPECT_EQ(1, summary.skipped);
+
+    remove_job_files();
+}
+
+TEST(BatchTrackerTests, reports_failed_jobs)
+{
+    write_job_files(12, 16, 1);
+
+    dbot::BatchJob job;
+    job.id = "small";
+    job.recording = "batch_tracker_test.depth";
+    job.config = "batch_tracker_test.conf";
+    job.mesh = working_directory() + "/batch_tracker_test.obj";
+    job.initial_poses = {0, 0, 1, 1, 0, 0, 0};
+
+    dbot::BatchJob missing = job;
+    missing.id = "missing";
+    missing.recording = "batch_tracker_test_missing.depth";
+
+    dbot::BatchTracker::Parameters params;
+    params.output_directory = "batch_tracker_test_output";
+    dbot::BatchTracker batch(params);
+
+    // the recording does not match the camera resolution
+    auto summary = batch.run({job, missing});
+    EXPECT_EQ(0, summary.completed);
+    ASSERT_EQ(2u, summary.failures.size());
+    EXPECT_FALSE(boost::filesystem::exists(batch.output_path(job)));
+
+    remove_job_files();
+}
+
+TEST(BatchTrackerTests, rejects_worker_processes)
+{
+    write_job_files(24, 32, 1);
+    std::ofstream("batch_tracker_test.conf", std::ios::app)
+        << "sensor.process_count: 2\n";
+
+    dbot::BatchJob job;
+    job.id = "sharded";
+    job.recording = "batch_tracker_test.depth";
+    job.config = "batch_tracker_test.conf";
+    job.mesh = working_directory() + "/batch_tracker_test.obj";
+    job.initial_poses = {0, 0, 1, 1, 0, 0, 0};
+
+    dbot::BatchTracker::Parameters params;
+    params.output_directory = "batch_tracker_test_output";
+    dbot::BatchTracker batch(params);
+
+    auto summary = batch.run({job});
+    EXPECT_EQ(0, summary.completed);
+    ASSERT_EQ(1u, summary.failures.size());
+    EXPECT_NE(std::string::npos,
+              summary.failures[0].second.find("sensor.process_count"));
+
+    remove_job_files();
+}
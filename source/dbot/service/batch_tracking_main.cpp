@@ -0,0 +1,103 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file batch_tracking_main.cpp
+ * \date October 2016
+ *
+ * Usage: dbot_batch_tracking <manifest> <output directory> [concurrency]
+ *                            [job workers]
+ *
+ * Tracks the recorded sequences listed in the manifest, see BatchTracker.
+ * Rerunning an interrupted batch skips the jobs whose output exists. The
+ * concurrency defaults to one job per hardware thread, each evaluating its
+ * sensor with one worker.
+ */
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+
+#include <dbot/cpu_kernels.h>
+#include <dbot/service/batch_tracker.h>
+
+namespace
+{
+dbot::BatchTracker* batch = nullptr;
+
+void handle_signal(int)
+{
+    if (batch) batch->stop();
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3 || argc > 5)
+    {
+        std::fprintf(stderr,
+                     "Usage: %s <manifest> <output directory> [concurrency] "
+                     "[job workers]\n",
+                     argv[0]);
+        return 2;
+    }
+
+    try
+    {
+        std::fprintf(stderr,
+                     "dbot_batch_tracking: CPU kernels %s\n",
+                     dbot::cpu_kernels_report().c_str());
+
+        auto jobs = dbot::load_batch_manifest(argv[1]);
+
+        dbot::BatchTracker::Parameters params;
+        params.output_directory = argv[2];
+        if (argc > 3) params.concurrency = std::atoi(argv[3]);
+        if (argc > 4) params.job_workers = std::atoi(argv[4]);
+
+        dbot::BatchTracker batch_tracker(params);
+        batch = &batch_tracker;
+        std::signal(SIGINT, handle_signal);
+        std::signal(SIGTERM, handle_signal);
+
+        auto summary = batch_tracker.run(jobs);
+        batch = nullptr;
+
+        for (const auto& failure : summary.failures)
+        {
+            std::fprintf(stderr,
+                         "dbot_batch_tracking: %s: %s\n",
+                         failure.first.c_str(),
+                         failure.second.c_str());
+        }
+        std::fprintf(stderr,
+                     "dbot_batch_tracking: %d of %zu jobs completed, %d "
+                     "skipped, %zu failed, %ld frames in %.1f s\n",
+                     summary.completed,
+                     jobs.size(),
+                     summary.skipped,
+                     summary.failures.size(),
+                     summary.frames,
+                     summary.seconds);
+
+        if (!summary.failures.empty()) return 1;
+    }
+    catch (const std::exception& e)
+    {
+        std::fprintf(stderr, "dbot_batch_tracking: %s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,127 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file config_file.cpp
+ * \date October 2016
+ */
+
+#include <dbot/service/config_file.h>
+
+#include <fstream>
+
+namespace dbot
+{
+namespace
+{
+std::string trim(const std::string& text)
+{
+    auto begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) return "";
+    auto end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+}
+
+ConfigFile ConfigFile::load(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        throw ConfigException(path + ": cannot open configuration file");
+    }
+
+    std::stringstream text;
+    text << file.rdbuf();
+    return parse(text.str(), path);
+}
+
+ConfigFile ConfigFile::parse(const std::string& text,
+                             const std::string& origin)
+{
+    ConfigFile config;
+    config.origin_ = origin;
+
+    std::istringstream stream(text);
+    std::string line;
+    for (int number = 1; std::getline(stream, line); ++number)
+    {
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) continue;
+
+        auto colon = line.find(':');
+        std::string key = trim(line.substr(0, colon));
+        if (colon == std::string::npos || key.empty() ||
+            key.find_first_of(" \t") != std::string::npos)
+        {
+            throw ConfigException(origin + ":" + std::to_string(number) +
+                                  ": expected 'key: value'");
+        }
+
+        config.values_[key] = trim(line.substr(colon + 1));
+    }
+
+    return config;
+}
+
+bool ConfigFile::has(const std::string& key) const
+{
+    return values_.count(key) > 0;
+}
+
+void ConfigFile::set(const std::string& key, const std::string& value)
+{
+    values_[key] = value;
+}
+
+std::string ConfigFile::text() const
+{
+    std::string text;
+    for (const auto& entry : values_)
+    {
+        text += entry.first + ": " + entry.second + "\n";
+    }
+    return text;
+}
+
+const std::string& ConfigFile::find(const std::string& key) const
+{
+    auto entry = values_.find(key);
+    if (entry == values_.end())
+    {
+        throw ConfigException(origin_ + ": missing " + key);
+    }
+    return entry->second;
+}
+
+bool ConfigFile::convert(const std::string& text, std::string& value)
+{
+    value = text;
+    return true;
+}
+
+bool ConfigFile::convert(const std::string& text, bool& value)
+{
+    if (text == "true" || text == "1")
+    {
+        value = true;
+        return true;
+    }
+    if (text == "false" || text == "0")
+    {
+        value = false;
+        return true;
+    }
+    return false;
+}
+}
@@ -0,0 +1,158 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file config_file.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <exception>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace dbot
+{
+/**
+ * \brief The ConfigException class
+ */
+class ConfigException : public std::exception
+{
+public:
+    explicit ConfigException(const std::string& message) : message_(message)
+    {
+    }
+
+    const char* what() const noexcept { return message_.c_str(); }
+
+private:
+    std::string message_;
+};
+
+/**
+ * \brief Flat key value configuration.
+ *
+ * Each line holds one entry of the form
+ *
+ *     sensor.kinect.tail_weight: 0.01
+ *
+ * Keys are arbitrary strings without whitespace and colons, dots are a mere
+ * naming convention. Everything after a '#' is a comment. Lists are
+ * whitespace separated values.
+ */
+class ConfigFile
+{
+public:
+    /**
+     * \brief Reads the file at the given path
+     *
+     * \throws ConfigException if the file cannot be read or is malformed
+     */
+    static ConfigFile load(const std::string& path);
+
+    /**
+     * \brief Parses the given text. The origin is used in error messages.
+     *
+     * \throws ConfigException if the text is malformed
+     */
+    static ConfigFile parse(const std::string& text,
+                            const std::string& origin = "config");
+
+    bool has(const std::string& key) const;
+
+    /**
+     * \brief Sets the value of the key, replacing a previous value
+     */
+    void set(const std::string& key, const std::string& value);
+
+    /**
+     * \brief Returns the entries as text which parse() reads back
+     */
+    std::string text() const;
+
+    /**
+     * \brief Returns the value of the key converted to T
+     *
+     * \throws ConfigException if the key is missing or not convertible
+     */
+    template <typename T>
+    T get(const std::string& key) const
+    {
+        T value;
+        if (!convert(find(key), value))
+        {
+            throw ConfigException(origin_ + ": invalid value for " + key +
+                                  ": '" + find(key) + "'");
+        }
+        return value;
+    }
+
+    /**
+     * \brief Returns the value of the key converted to T or the default
+     *        value if the key is missing
+     *
+     * \throws ConfigException if the value is not convertible
+     */
+    template <typename T>
+    T get(const std::string& key, const T& default_value) const
+    {
+        return has(key) ? get<T>(key) : default_value;
+    }
+
+    /**
+     * \brief Returns the whitespace separated values of the key
+     *
+     * \throws ConfigException if the key is missing or a value is not
+     *         convertible
+     */
+    template <typename T>
+    std::vector<T> get_list(const std::string& key) const
+    {
+        std::vector<T> values;
+        std::istringstream stream(find(key));
+        std::string item;
+        while (stream >> item)
+        {
+            T value;
+            if (!convert(item, value))
+            {
+                throw ConfigException(origin_ + ": invalid list item for " +
+                                      key + ": '" + item + "'");
+            }
+            values.push_back(value);
+        }
+        return values;
+    }
+
+private:
+    const std::string& find(const std::string& key) const;
+
+    template <typename T>
+    static bool convert(const std::string& text, T& value)
+    {
+        std::istringstream stream(text);
+        stream >> value;
+        return !stream.fail() && (stream >> std::ws).eof();
+    }
+
+    static bool convert(const std::string& text, std::string& value);
+    static bool convert(const std::string& text, bool& value);
+
+private:
+    std::string origin_;
+    std::map<std::string, std::string> values_;
+};
+}
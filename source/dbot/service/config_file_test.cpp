@@ -0,0 +1,86 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file config_file_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <dbot/service/config_file.h>
+
+TEST(ConfigFileTests, parses_values_and_comments)
+{
+    auto config = dbot::ConfigFile::parse(
+        "# comment\n"
+        "sensor.delta_time: 0.033   # seconds\n"
+        "\n"
+        "  sensor.use_gpu :true\n"
+        "object.meshes: a.obj b.obj\n"
+        "camera.matrix: 1 0 2  0 1 3  0 0 1\n");
+
+    EXPECT_DOUBLE_EQ(config.get<double>("sensor.delta_time"), 0.033);
+    EXPECT_TRUE(config.get<bool>("sensor.use_gpu"));
+    EXPECT_EQ(config.get<std::string>("object.meshes"), "a.obj b.obj");
+    EXPECT_EQ(config.get_list<std::string>("object.meshes").size(), 2u);
+    EXPECT_EQ(config.get_list<double>("camera.matrix").size(), 9u);
+    EXPECT_EQ(config.get<int>("sensor.worker_count", 4), 4);
+}
+
+TEST(ConfigFileTests, missing_key_throws)
+{
+    auto config = dbot::ConfigFile::parse("a: 1\n");
+
+    EXPECT_TRUE(config.has("a"));
+    EXPECT_FALSE(config.has("b"));
+    EXPECT_THROW(config.get<int>("b"), dbot::ConfigException);
+}
+
+TEST(ConfigFileTests, invalid_value_throws)
+{
+    auto config = dbot::ConfigFile::parse("a: 1.5x\nb: maybe\nc: 1 x\n");
+
+    EXPECT_THROW(config.get<double>("a"), dbot::ConfigException);
+    EXPECT_THROW(config.get<bool>("b"), dbot::ConfigException);
+    EXPECT_THROW(config.get_list<int>("c"), dbot::ConfigException);
+}
+
+TEST(ConfigFileTests, malformed_line_throws)
+{
+    EXPECT_THROW(dbot::ConfigFile::parse("no colon here\n"),
+                 dbot::ConfigException);
+    EXPECT_THROW(dbot::ConfigFile::parse("two words: 1\n"),
+                 dbot::ConfigException);
+}
+
+TEST(ConfigFileTests, set_replaces_values)
+{
+    auto config = dbot::ConfigFile::parse("object.meshes: a.obj\n");
+    config.set("object.meshes", "b.obj c.obj");
+    config.set("object.instances", "2");
+
+    EXPECT_EQ(config.get_list<std::string>("object.meshes").size(), 2u);
+    EXPECT_EQ(config.get<int>("object.instances"), 2);
+}
+
+TEST(ConfigFileTests, text_parses_back)
+{
+    auto config = dbot::ConfigFile::parse(
+        "a: 1  # comment\nb: x y\nc:\n");
+    auto parsed = dbot::ConfigFile::parse(config.text());
+
+    EXPECT_EQ(parsed.get<int>("a"), 1);
+    EXPECT_EQ(parsed.get<std::string>("b"), "x y");
+    EXPECT_EQ(parsed.get<std::string>("c"), "");
+}
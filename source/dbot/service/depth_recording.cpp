@@ -0,0 +1,109 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file depth_recording.cpp
+ * \date October 2016
+ */
+
+#include <dbot/service/depth_recording.h>
+
+#include <cstring>
+
+namespace dbot
+{
+namespace
+{
+const char magic[8] = {'D', 'B', 'O', 'T', 'D', 'E', 'P', '1'};
+
+struct Header
+{
+    char magic[8];
+    std::int32_t rows;
+    std::int32_t cols;
+};
+
+std::streamoff frame_size(int rows, int cols)
+{
+    return sizeof(double) + std::streamoff(rows) * cols * sizeof(float);
+}
+}
+
+DepthRecording::DepthRecording(const std::string& path)
+    : path_(path), file_(path, std::ios::binary)
+{
+    if (!file_.is_open())
+    {
+        throw RecordingException(path + ": cannot open recording");
+    }
+
+    Header header;
+    if (!file_.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, magic, sizeof(magic)) != 0 ||
+        header.rows <= 0 || header.cols <= 0)
+    {
+        throw RecordingException(path + ": not a depth recording");
+    }
+    rows_ = header.rows;
+    cols_ = header.cols;
+
+    file_.seekg(0, std::ios::end);
+    const std::streamoff size = file_.tellg();
+    file_.seekg(sizeof(header), std::ios::beg);
+    frame_count_ = (size - std::streamoff(sizeof(header))) /
+                   frame_size(rows_, cols_);
+}
+
+bool DepthRecording::read(double& timestamp, float* depth)
+{
+    if (file_.peek() == std::ifstream::traits_type::eof()) return false;
+
+    if (!file_.read(reinterpret_cast<char*>(&timestamp), sizeof(timestamp)) ||
+        !file_.read(reinterpret_cast<char*>(depth),
+                    std::streamsize(rows_) * cols_ * sizeof(float)))
+    {
+        throw RecordingException(path_ + ": truncated frame");
+    }
+    return true;
+}
+
+DepthRecordingWriter::DepthRecordingWriter(const std::string& path,
+                                           int rows,
+                                           int cols)
+    : path_(path),
+      file_(path, std::ios::binary | std::ios::trunc),
+      rows_(rows),
+      cols_(cols)
+{
+    Header header;
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.rows = rows;
+    header.cols = cols;
+
+    if (!file_.write(reinterpret_cast<const char*>(&header), sizeof(header)))
+    {
+        throw RecordingException(path + ": cannot create recording");
+    }
+}
+
+void DepthRecordingWriter::write(double timestamp, const float* depth)
+{
+    if (!file_.write(reinterpret_cast<const char*>(&timestamp),
+                     sizeof(timestamp)) ||
+        !file_.write(reinterpret_cast<const char*>(depth),
+                     std::streamsize(rows_) * cols_ * sizeof(float)))
+    {
+        throw RecordingException(path_ + ": cannot write frame");
+    }
+}
+}
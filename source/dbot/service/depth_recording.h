@@ -0,0 +1,110 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file depth_recording.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <string>
+
+namespace dbot
+{
+class RecordingException : public std::exception
+{
+public:
+    explicit RecordingException(const std::string& message)
+        : message_(message)
+    {
+    }
+
+    const char* what() const noexcept { return message_.c_str(); }
+
+private:
+    std::string message_;
+};
+
+/**
+ * \brief Reads a recorded depth sequence frame by frame.
+ *
+ * A recording holds a header with the image size followed by the frames,
+ * each a timestamp in seconds and a row major image of rows x cols depth
+ * values in meters as in the FrameRing (NaN for missing measurements).
+ * Values are stored in the byte order of the recording machine. Frames are
+ * streamed, only the caller's buffer for one frame is needed.
+ */
+class DepthRecording
+{
+public:
+    /**
+     * \brief Opens the recording at the given path
+     *
+     * \throws RecordingException if the file cannot be opened or is not a
+     *         depth recording
+     */
+    explicit DepthRecording(const std::string& path);
+
+    /**
+     * \brief Reads the next frame into rows() x cols() depth values. Returns
+     *        false at the end of the recording.
+     *
+     * \throws RecordingException if the last frame is truncated
+     */
+    bool read(double& timestamp, float* depth);
+
+    int rows() const { return rows_; }
+    int cols() const { return cols_; }
+
+    /**
+     * \brief Returns the number of frames in the recording
+     */
+    std::uint64_t count_frames() const { return frame_count_; }
+
+private:
+    std::string path_;
+    std::ifstream file_;
+    int rows_;
+    int cols_;
+    std::uint64_t frame_count_;
+};
+
+/**
+ * \brief Writes a depth recording as read by DepthRecording
+ */
+class DepthRecordingWriter
+{
+public:
+    /**
+     * \throws RecordingException if the file cannot be created
+     */
+    DepthRecordingWriter(const std::string& path, int rows, int cols);
+
+    /**
+     * \brief Appends a frame of rows x cols depth values
+     *
+     * \throws RecordingException if the frame cannot be written
+     */
+    void write(double timestamp, const float* depth);
+
+private:
+    std::string path_;
+    std::ofstream file_;
+    int rows_;
+    int cols_;
+};
+}
@@ -0,0 +1,84 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file depth_recording_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#include <dbot/service/depth_recording.h>
+
+TEST(DepthRecordingTests, round_trip)
+{
+    {
+        dbot::DepthRecordingWriter writer("depth_recording_test.depth", 2, 3);
+        const float first[6] = {1, 2, 3, 4, 5, 6};
+        const float second[6] = {6, 5, 4, 3, 2, 1};
+        writer.write(0.5, first);
+        writer.write(0.75, second);
+    }
+
+    dbot::DepthRecording recording("depth_recording_test.depth");
+    EXPECT_EQ(2, recording.rows());
+    EXPECT_EQ(3, recording.cols());
+    EXPECT_EQ(2u, recording.count_frames());
+
+    double timestamp;
+    std::vector<float> depth(6);
+    ASSERT_TRUE(recording.read(timestamp, depth.data()));
+    EXPECT_EQ(0.5, timestamp);
+    EXPECT_EQ(3.0f, depth[2]);
+    ASSERT_TRUE(recording.read(timestamp, depth.data()));
+    EXPECT_EQ(0.75, timestamp);
+    EXPECT_EQ(4.0f, depth[2]);
+    EXPECT_FALSE(recording.read(timestamp, depth.data()));
+
+    std::remove("depth_recording_test.depth");
+}
+
+TEST(DepthRecordingTests, invalid_file_throws)
+{
+    EXPECT_THROW(dbot::DepthRecording("depth_recording_test_missing.depth"),
+                 dbot::RecordingException);
+
+    std::ofstream("depth_recording_test.depth") << "not a recording";
+    EXPECT_THROW(dbot::DepthRecording("depth_recording_test.depth"),
+                 dbot::RecordingException);
+    std::remove("depth_recording_test.depth");
+}
+
+TEST(DepthRecordingTests, truncated_frame_throws)
+{
+    {
+        dbot::DepthRecordingWriter writer("depth_recording_test.depth", 2, 2);
+        const float depth[4] = {1, 1, 1, 1};
+        writer.write(0.0, depth);
+    }
+    std::ofstream("depth_recording_test.depth", std::ios::app) << "partial";
+
+    dbot::DepthRecording recording("depth_recording_test.depth");
+    EXPECT_EQ(1u, recording.count_frames());
+
+    double timestamp;
+    float depth[4];
+    EXPECT_TRUE(recording.read(timestamp, depth));
+    EXPECT_THROW(recording.read(timestamp, depth), dbot::RecordingException);
+
+    std::remove("depth_recording_test.depth");
+}
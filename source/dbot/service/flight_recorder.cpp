@@ -0,0 +1,652 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file flight_recorder.cpp
+ * \date October 2016
+ */
+
+#include <dbot/service/flight_recorder.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+
+#include <dbot/observation_context.h>
+
+namespace dbot
+{
+namespace
+{
+const char magic[8] = {'D', 'B', 'O', 'T', 'F', 'L', 'T', '3'};
+
+typedef ParticleTracker::Filter Filter;
+
+/// binary writer of the dump, values in host byte order
+class Writer
+{
+public:
+    explicit Writer(std::ofstream& file) : file_(file) {}
+
+    template <typename T>
+    void value(const T& value)
+    {
+        file_.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void bytes(const void* data, std::size_t size)
+    {
+        value<std::uint64_t>(size);
+        file_.write(static_cast<const char*>(data), size);
+    }
+
+    void string(const std::string& text) { bytes(text.data(), text.size()); }
+
+    /// vectors and arrays of fl::Real, stored as doubles
+    template <typename Vector>
+    void reals(const Vector& vector)
+    {
+        value<std::uint64_t>(vector.size());
+        for (int i = 0; i < vector.size(); ++i) value<double>(vector(i));
+    }
+
+    void part_array(const Filter::RealPartArray& array)
+    {
+        value<std::uint64_t>(array.rows());
+        value<std::uint64_t>(array.cols());
+        for (int i = 0; i < array.size(); ++i) value<double>(array(i));
+    }
+
+    void ints(const Filter::IntArray& array)
+    {
+        value<std::uint64_t>(array.size());
+        for (int i = 0; i < array.size(); ++i) value<std::int32_t>(array(i));
+    }
+
+private:
+    std::ofstream& file_;
+};
+
+/// reader of the values written by Writer, which throws once the file is
+/// truncated
+class Reader
+{
+public:
+    Reader(std::ifstream& file, const std::string& path)
+        : file_(file), path_(path)
+    {
+    }
+
+    template <typename T>
+    T value()
+    {
+        T value;
+        file_.read(reinterpret_cast<char*>(&value), sizeof(value));
+        check();
+        return value;
+    }
+
+    std::string string()
+    {
+        std::string text(size(), '\0');
+        file_.read(&text[0], text.size());
+        check();
+        return text;
+    }
+
+    void bytes(std::vector<unsigned char>& data)
+    {
+        data.resize(size());
+        file_.read(reinterpret_cast<char*>(data.data()), data.size());
+        check();
+    }
+
+    template <typename Vector>
+    void reals(Vector& vector)
+    {
+        vector.resize(size());
+        for (int i = 0; i < vector.size(); ++i) vector(i) = value<double>();
+    }
+
+    void part_array(Filter::RealPartArray& array)
+    {
+        const std::uint64_t rows = size();
+        const std::uint64_t cols = size();
+        array.resize(rows, cols);
+        for (int i = 0; i < array.size(); ++i) array(i) = value<double>();
+    }
+
+    void ints(Filter::IntArray& array)
+    {
+        array.resize(size());
+        for (int i = 0; i < array.size(); ++i)
+        {
+            array(i) = value<std::int32_t>();
+        }
+    }
+
+private:
+    /// reads a size, bounded by the remaining file to reject corrupt dumps
+    /// before allocating
+    std::uint64_t size()
+    {
+        const std::uint64_t size = value<std::uint64_t>();
+        const std::streamoff position = file_.tellg();
+        file_.seekg(0, std::ios::end);
+        const std::streamoff end = file_.tellg();
+        file_.seekg(position);
+        if (size > std::uint64_t(end - position))
+        {
+            throw FlightRecorderException(path_ + ": corrupt flight dump");
+        }
+        return size;
+    }
+
+    void check()
+    {
+        if (!file_)
+        {
+            throw FlightRecorderException(path_ + ": truncated flight dump");
+        }
+    }
+
+private:
+    std::ifstream& file_;
+    std::string path_;
+};
+
+void write_snapshot(Writer& writer, const ParticleTracker::Snapshot& snapshot)
+{
+    const Filter::Snapshot& filter = snapshot.filter;
+
+    writer.value<std::uint64_t>(filter.particles.size());
+    for (const auto& particle : filter.particles) writer.reals(particle);
+    writer.ints(filter.indices);
+    writer.reals(filter.log_weights);
+    writer.reals(filter.loglikes);
+    writer.part_array(filter.part_loglikes);
+    writer.part_array(filter.part_log_weights);
+    writer.reals(filter.integrated_poses);
+    writer.value<double>(filter.sensor.observation_time);
+    writer.value<std::uint64_t>(filter.dynamic_particle_count);
+    writer.value<std::uint8_t>(filter.static_frame);
+    writer.value<std::uint32_t>(filter.seed);
+    writer.string(filter.random_state);
+
+    writer.reals(snapshot.estimate);
+    writer.reals(snapshot.moving_average);
+}
+
+void read_snapshot(Reader& reader, ParticleTracker::Snapshot& snapshot)
+{
+    Filter::Snapshot& filter = snapshot.filter;
+
+    filter.particles.resize(reader.value<std::uint64_t>());
+    for (auto& particle : filter.particles) reader.reals(particle);
+    reader.ints(filter.indices);
+    reader.reals(filter.log_weights);
+    reader.reals(filter.loglikes);
+    reader.part_array(filter.part_loglikes);
+    reader.part_array(filter.part_log_weights);
+    reader.reals(filter.integrated_poses);
+    filter.sensor.observation_time = reader.value<double>();
+    filter.dynamic_particle_count = reader.value<std::uint64_t>();
+    filter.static_frame = reader.value<std::uint8_t>();
+    filter.seed = reader.value<std::uint32_t>();
+    filter.random_state = reader.string();
+
+    reader.reals(snapshot.estimate);
+    reader.reals(snapshot.moving_average);
+}
+
+void write_sensor_state(Writer& writer, const CompressedSensorState& state)
+{
+    writer.value<std::uint64_t>(state.occlusion_count);
+    writer.bytes(state.occlusions.data(), state.occlusions.size());
+    writer.value<std::uint64_t>(state.time_count);
+    writer.bytes(state.occlusion_times.data(), state.occlusion_times.size());
+}
+
+void read_sensor_state(Reader& reader, CompressedSensorState& state)
+{
+    state.occlusion_count = reader.value<std::uint64_t>();
+    reader.bytes(state.occlusions);
+    state.time_count = reader.value<std::uint64_t>();
+    reader.bytes(state.occlusion_times);
+}
+
+void write_timings(Writer& writer, const ParticleTracker::Timings& timings)
+{
+    writer.value<double>(timings.propagation);
+    writer.value<double>(timings.evaluation);
+    writer.value<double>(timings.resampling);
+    writer.value<double>(timings.refinement);
+}
+
+void read_timings(Reader& reader, ParticleTracker::Timings& timings)
+{
+    timings.propagation = reader.value<double>();
+    timings.evaluation = reader.value<double>();
+    timings.resampling = reader.value<double>();
+    timings.refinement = reader.value<double>();
+}
+}
+
+namespace
+{
+/// codes the differences of the bit patterns of consecutive values, see
+/// compress_depth()
+template <typename Bits, typename Signed, typename T>
+void compress_bits(const T* values,
+                   std::size_t count,
+                   std::vector<unsigned char>& compressed)
+{
+    static_assert(sizeof(Bits) == sizeof(T), "bits must match the value");
+
+    compressed.clear();
+
+    Bits previous = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        Bits bits;
+        std::memcpy(&bits, values + i, sizeof(bits));
+
+        // the signed difference, zigzag mapped such that small differences
+        // of either sign have small codes
+        const Signed delta = Signed(bits - previous);
+        Bits code = (Bits(delta) << 1) ^ Bits(delta >> (8 * sizeof(Bits) - 1));
+        previous = bits;
+
+        // 7 bits per byte, the high bit marks a continuation
+        while (code >= 0x80)
+        {
+            compressed.push_back((code & 0x7f) | 0x80);
+            code >>= 7;
+        }
+        compressed.push_back(code);
+    }
+}
+
+template <typename Bits, typename T>
+void decompress_bits(const std::vector<unsigned char>& compressed,
+                     std::size_t count,
+                     T* values,
+                     const char* what)
+{
+    std::size_t position = 0;
+    Bits previous = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        Bits code = 0;
+        for (int shift = 0;; shift += 7)
+        {
+            if (position == compressed.size() ||
+                shift >= int(8 * sizeof(Bits)))
+            {
+                throw FlightRecorderException(std::string("corrupt ") + what);
+            }
+            const unsigned char byte = compressed[position++];
+            code |= Bits(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) break;
+        }
+
+        const Bits delta = (code >> 1) ^ (0 - (code & 1));
+        previous += delta;
+        std::memcpy(values + i, &previous, sizeof(previous));
+    }
+
+    if (position != compressed.size())
+    {
+        throw FlightRecorderException(std::string("corrupt ") + what);
+    }
+}
+}
+
+void compress_depth(const float* depth,
+                    int count,
+                    std::vector<unsigned char>& compressed)
+{
+    compress_bits<std::uint32_t, std::int32_t>(depth, count, compressed);
+}
+
+void decompress_depth(const std::vector<unsigned char>& compressed,
+                      int count,
+                      float* depth)
+{
+    decompress_bits<std::uint32_t>(compressed, count, depth, "depth image");
+}
+
+void compress_sensor_state(ParticleTracker::Snapshot& snapshot,
+                           CompressedSensorState& compressed)
+{
+    auto& sensor = snapshot.filter.sensor;
+
+    compressed.occlusion_count = sensor.occlusions.size();
+    compress_bits<std::uint32_t, std::int32_t>(sensor.occlusions.data(),
+                                               sensor.occlusions.size(),
+                                               compressed.occlusions);
+    compressed.time_count = sensor.occlusion_times.size();
+    compress_bits<std::uint64_t, std::int64_t>(sensor.occlusion_times.data(),
+                                               sensor.occlusion_times.size(),
+                                               compressed.occlusion_times);
+
+    // the observation time is kept in the snapshot
+    std::vector<float>().swap(sensor.occlusions);
+    std::vector<double>().swap(sensor.occlusion_times);
+}
+
+void decompress_sensor_state(const CompressedSensorState& compressed,
+                             ParticleTracker::Snapshot& snapshot)
+{
+    // each value takes a byte at least
+    if (compressed.occlusion_count > compressed.occlusions.size() ||
+        compressed.time_count > compressed.occlusion_times.size())
+    {
+        throw FlightRecorderException("corrupt sensor state");
+    }
+
+    auto& sensor = snapshot.filter.sensor;
+    sensor.occlusions.resize(compressed.occlusion_count);
+    decompress_bits<std::uint32_t>(compressed.occlusions,
+                                   sensor.occlusions.size(),
+                                   sensor.occlusions.data(),
+                                   "sensor state");
+    sensor.occlusion_times.resize(compressed.time_count);
+    decompress_bits<std::uint64_t>(compressed.occlusion_times,
+                                   sensor.occlusion_times.size(),
+                                   sensor.occlusion_times.data(),
+                                   "sensor state");
+}
+
+void save_flight_dump(const FlightDump& dump, const std::string& path)
+{
+    const std::string partial = path + ".partial";
+    {
+        std::ofstream file(partial, std::ios::binary | std::ios::trunc);
+        Writer writer(file);
+
+        file.write(magic, sizeof(magic));
+        writer.string(dump.reason);
+        writer.string(dump.config);
+        writer.value<std::int32_t>(dump.rows);
+        writer.value<std::int32_t>(dump.cols);
+        writer.value<std::uint64_t>(dump.records.size());
+
+        for (const auto& record : dump.records)
+        {
+            writer.value<std::uint64_t>(record->frame);
+            writer.value<double>(record->timestamp);
+            writer.bytes(record->depth.data(), record->depth.size());
+            write_snapshot(writer, record->snapshot);
+            write_sensor_state(writer, record->sensor_state);
+            writer.value<std::int32_t>(record->particle_count);
+            writer.value<double>(record->effective_sample_size);
+            writer.reals(record->estimate);
+            writer.value<double>(record->convert_ms);
+            write_timings(writer, record->stages);
+            writer.value<double>(record->track_ms);
+            writer.value<double>(record->latency);
+        }
+
+        if (!file.flush())
+        {
+            std::remove(partial.c_str());
+            throw FlightRecorderException(path + ": cannot write flight dump");
+        }
+    }
+
+    if (std::rename(partial.c_str(), path.c_str()) != 0)
+    {
+        std::remove(partial.c_str());
+        throw FlightRecorderException(path + ": cannot write flight dump");
+    }
+}
+
+FlightDump load_flight_dump(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw FlightRecorderException(path + ": cannot open flight dump");
+    }
+
+    char file_magic[8];
+    if (!file.read(file_magic, sizeof(file_magic)) ||
+        std::memcmp(file_magic, magic, sizeof(magic)) != 0)
+    {
+        throw FlightRecorderException(path + ": not a flight dump");
+    }
+
+    Reader reader(file, path);
+    FlightDump dump;
+    dump.reason = reader.string();
+    dump.config = reader.string();
+    dump.rows = reader.value<std::int32_t>();
+    dump.cols = reader.value<std::int32_t>();
+
+    const std::uint64_t count = reader.value<std::uint64_t>();
+    for (std::uint64_t i = 0; i < count; ++i)
+    {
+        auto record = std::make_shared<FlightRecord>();
+        record->frame = reader.value<std::uint64_t>();
+        record->timestamp = reader.value<double>();
+        reader.bytes(record->depth);
+        read_snapshot(reader, record->snapshot);
+        read_sensor_state(reader, record->sensor_state);
+        record->particle_count = reader.value<std::int32_t>();
+        record->effective_sample_size = reader.value<double>();
+        reader.reals(record->estimate);
+        record->convert_ms = reader.value<double>();
+        read_timings(reader, record->stages);
+        record->track_ms = reader.value<double>();
+        record->latency = reader.value<double>();
+        dump.records.push_back(record);
+    }
+
+    return dump;
+}
+
+void summarize_particles(const ParticleTracker& tracker,
+                         const Tracker::State& estimate,
+                         FlightRecord& record)
+{
+    const auto& belief = tracker.belief();
+
+    // the inverse sum of the squared normalized weights
+    double squared_weights = 0;
+    for (int i = 0; i < belief.size(); ++i)
+    {
+        const double weight = std::exp(belief.log_prob_mass(i));
+        squared_weights += weight * weight;
+    }
+
+    record.particle_count = belief.size();
+    record.effective_sample_size =
+        squared_weights > 0 ? 1 / squared_weights : 0;
+    record.estimate = estimate;
+}
+
+std::vector<ReplayedFrame> replay_flight_dump(
+    const FlightDump& dump,
+    ParticleTracker& tracker,
+    const Eigen::Matrix3d& camera_matrix)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    std::vector<ReplayedFrame> frames;
+    if (dump.records.empty()) return frames;
+
+    const FlightRecord& first = *dump.records.front();
+    ParticleTracker::Snapshot snapshot = first.snapshot;
+    decompress_sensor_state(first.sensor_state, snapshot);
+    tracker.restore(snapshot);
+
+    ObservationSource source(camera_matrix, dump.rows, dump.cols);
+    tracker.subscribe(source);
+
+    std::vector<float> depth(dump.rows * dump.cols);
+    for (const auto& record : dump.records)
+    {
+        decompress_depth(record->depth, depth.size(), depth.data());
+        const auto context = source.publish(depth.data());
+
+        const auto start = Clock::now();
+        const Tracker::State estimate = tracker.track(context);
+
+        ReplayedFrame frame;
+        frame.track_ms =
+            std::chrono::duration<double, std::milli>(Clock::now() - start)
+                .count();
+        frame.frame = record->frame;
+        frame.estimate = estimate;
+        frame.stages = tracker.timings();
+
+        FlightRecord summary;
+        summarize_particles(tracker, estimate, summary);
+        frame.effective_sample_size = summary.effective_sample_size;
+        frames.push_back(frame);
+    }
+
+    return frames;
+}
+
+FlightRecorder::FlightRecorder(const Parameters& params,
+                               const std::string& config,
+                               int rows,
+                               int cols)
+    : params_(params),
+      config_(config),
+      rows_(rows),
+      cols_(cols),
+      frames_since_sensor_state_(0),
+      frames_since_dump_(0),
+      dump_requested_(false),
+      writing_(false)
+{
+    if (params_.capacity < 1)
+    {
+        throw FlightRecorderException(
+            "the flight recorder requires a positive capacity");
+    }
+}
+
+FlightRecorder::~FlightRecorder()
+{
+    wait();
+}
+
+bool FlightRecorder::needs_sensor_state() const
+{
+    return records_.empty() || frames_since_sensor_state_ >= params_.capacity;
+}
+
+void FlightRecorder::record(FlightRecord&& record)
+{
+    if (!record.snapshot.filter.sensor.occlusions.empty())
+    {
+        compress_sensor_state(record.snapshot, record.sensor_state);
+    }
+    frames_since_sensor_state_ =
+        record.sensor_state.empty() ? frames_since_sensor_state_ + 1 : 1;
+    records_.push_back(std::make_shared<FlightRecord>(std::move(record)));
+    frames_since_dump_++;
+
+    // a record holding the sensor state stays the oldest one until a newer
+    // such record is followed by capacity frames
+    while (int(records_.size()) > params_.capacity)
+    {
+        if (!records_.front()->sensor_state.empty())
+        {
+            const std::size_t last_start = records_.size() - params_.capacity;
+            std::size_t start = 1;
+            while (start <= last_start && records_[start]->sensor_state.empty())
+            {
+                start++;
+            }
+            if (start > last_start) break;
+        }
+        records_.pop_front();
+    }
+
+    // a request waits while a dump is being written
+    const FlightRecord& last = *records_.back();
+    if (dump_requested_)
+    {
+        if (!dump("requested").empty()) dump_requested_ = false;
+    }
+    else if (frames_since_dump_ > params_.cooldown)
+    {
+        if (params_.latency_threshold > 0 &&
+            last.latency > params_.latency_threshold)
+        {
+            dump("latency");
+        }
+        else if (params_.min_effective_fraction > 0 &&
+                 last.effective_sample_size <
+                     params_.min_effective_fraction * last.particle_count)
+        {
+            dump("degenerate");
+        }
+    }
+}
+
+void FlightRecorder::request_dump()
+{
+    dump_requested_ = true;
+}
+
+std::string FlightRecorder::dump(const std::string& reason)
+{
+    if (records_.empty() || writing_) return "";
+    if (writer_.joinable()) writer_.join();
+
+    auto dump = std::make_shared<FlightDump>();
+    dump->reason = reason;
+    dump->config = config_;
+    dump->rows = rows_;
+    dump->cols = cols_;
+    dump->records.assign(records_.begin(), records_.end());
+
+    const std::string path =
+        (boost::filesystem::path(params_.directory) /
+         ("flight_" + std::to_string(records_.back()->frame) + "_" + reason +
+          ".dump"))
+            .string();
+
+    frames_since_dump_ = 0;
+    writing_ = true;
+    writer_ = std::thread([this, dump, path]() {
+        try
+        {
+            boost::filesystem::create_directories(params_.directory);
+            save_flight_dump(*dump, path);
+        }
+        catch (const std::exception& e)
+        {
+            std::fprintf(stderr, "dbot flight recorder: %s\n", e.what());
+        }
+        writing_ = false;
+    });
+
+    return path;
+}
+
+void FlightRecorder::wait()
+{
+    if (writer_.joinable()) writer_.join();
+}
+}
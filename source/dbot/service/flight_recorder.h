@@ -0,0 +1,297 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file flight_recorder.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dbot/tracker/particle_tracker.h>
+
+namespace dbot
+{
+class FlightRecorderException : public std::exception
+{
+public:
+    explicit FlightRecorderException(const std::string& message)
+        : message_(message)
+    {
+    }
+
+    const char* what() const noexcept { return message_.c_str(); }
+
+private:
+    std::string message_;
+};
+
+/**
+ * \brief Compresses count depth values losslessly. Each value is stored as
+ *        the difference of its bit pattern to the one of the previous
+ *        pixel in a variable length code, such that smooth surfaces and
+ *        runs of missing measurements take one or two bytes per pixel.
+ */
+void compress_depth(const float* depth,
+                    int count,
+                    std::vector<unsigned char>& compressed);
+
+/**
+ * \brief Restores count depth values compressed by compress_depth()
+ *
+ * \throws FlightRecorderException if the data does not hold count values
+ */
+void decompress_depth(const std::vector<unsigned char>& compressed,
+                      int count,
+                      float* depth);
+
+/**
+ * \brief Per particle occlusion state of the sensor, compressed with the
+ *        code of compress_depth()
+ */
+struct CompressedSensorState
+{
+    std::uint64_t occlusion_count = 0;
+    std::vector<unsigned char> occlusions;
+    std::uint64_t time_count = 0;
+    std::vector<unsigned char> occlusion_times;
+
+    bool empty() const { return occlusion_count == 0; }
+};
+
+/**
+ * \brief Moves the occlusions and occlusion times of the sensor out of the
+ *        snapshot into compressed. Neighbouring pixels of a particle mostly
+ *        share their values, which then take a byte each.
+ */
+void compress_sensor_state(ParticleTracker::Snapshot& snapshot,
+                           CompressedSensorState& compressed);
+
+/**
+ * \brief Restores the sensor state compressed by compress_sensor_state()
+ *        into the snapshot
+ *
+ * \throws FlightRecorderException if the data is corrupt
+ */
+void decompress_sensor_state(const CompressedSensorState& compressed,
+                             ParticleTracker::Snapshot& snapshot);
+
+/**
+ * \brief One tracked frame of the flight recorder
+ */
+struct FlightRecord
+{
+    /// ring number and timestamp of the frame
+    std::uint64_t frame = 0;
+    double timestamp = 0;
+
+    /// observation, see compress_depth()
+    std::vector<unsigned char> depth;
+
+    /// tracker state before the frame without the per particle state of
+    /// the sensor, see ParticleTracker::snapshot()
+    ParticleTracker::Snapshot snapshot;
+
+    /// per particle state of the sensor before the frame, held by the
+    /// records from which a replay may start only, see
+    /// FlightRecorder::needs_sensor_state()
+    CompressedSensorState sensor_state;
+
+    /// particle summary after the frame
+    int particle_count = 0;
+    double effective_sample_size = 0;
+    Tracker::State estimate;
+
+    /// stage timings in milliseconds: depth conversion, the filter stages,
+    /// the refinement and the whole track() call
+    double convert_ms = 0;
+    ParticleTracker::Timings stages;
+    double track_ms = 0;
+
+    /// time from frame publication to pose publication in microseconds
+    double latency = 0;
+};
+
+/**
+ * \brief Frames of the flight recorder written to disk
+ */
+struct FlightDump
+{
+    /// why the dump was written, e.g. "latency"
+    std::string reason;
+
+    /// configuration of the tracker, see ConfigFile::text()
+    std::string config;
+
+    int rows = 0;
+    int cols = 0;
+
+    /// frames in tracking order
+    std::vector<std::shared_ptr<const FlightRecord>> records;
+};
+
+/**
+ * \brief Writes the dump to the given path, replacing an existing file
+ *        atomically
+ *
+ * \throws FlightRecorderException if the file cannot be written
+ */
+void save_flight_dump(const FlightDump& dump, const std::string& path);
+
+/**
+ * \brief Reads the dump at the given path
+ *
+ * \throws FlightRecorderException if the file cannot be read or is not a
+ *         dump
+ */
+FlightDump load_flight_dump(const std::string& path);
+
+/**
+ * \brief Fills the particle summary of the record from the tracker after
+ *        the frame
+ */
+void summarize_particles(const ParticleTracker& tracker,
+                         const Tracker::State& estimate,
+                         FlightRecord& record);
+
+/**
+ * \brief Result of a replayed frame
+ */
+struct ReplayedFrame
+{
+    std::uint64_t frame;
+    Tracker::State estimate;
+    double effective_sample_size;
+    ParticleTracker::Timings stages;
+    double track_ms;
+};
+
+/**
+ * \brief Tracks the frames of the dump from the tracker state before its
+ *        first frame. The tracker must be created from the configuration of
+ *        the dump. The frames are published through an ObservationSource of
+ *        the given camera, as the tracking service does.
+ *
+ * The random state of the filter is part of each snapshot and the sensor
+ * state part of the first record of a dump, hence a replay is deterministic
+ * and matches the recorded estimates exactly. A dump starting at a record
+ * without sensor state continues from the sensor prior instead.
+ */
+std::vector<ReplayedFrame> replay_flight_dump(
+    const FlightDump& dump,
+    ParticleTracker& tracker,
+    const Eigen::Matrix3d& camera_matrix);
+
+/**
+ * \brief Keeps the inputs, the random state, a particle summary and the
+ *        stage timings of the last frames in memory, and writes them to
+ *        disk on request or when a frame breaches the latency threshold or
+ *        the particles degenerate.
+ *
+ * Only every capacity-th record holds the per particle state of the sensor,
+ * which is by far its largest part. The records before the oldest such one
+ * are dropped, hence between capacity and twice capacity frames are kept
+ * and every dump starts at a record which a replay can continue from.
+ *
+ * Dumps are written by a background thread, such that the tracking thread
+ * only copies the pointers of the records. While a dump is being written,
+ * further dumps are skipped. A dump which cannot be written is reported on
+ * stderr and does not affect tracking.
+ */
+class FlightRecorder
+{
+public:
+    struct Parameters
+    {
+        // frames kept in memory
+        int capacity = 60;
+        // directory of the dumps, created if missing
+        std::string directory = ".";
+        // latency in microseconds above which a frame triggers a dump, 0
+        // disables the trigger
+        double latency_threshold = 0;
+        // effective sample size relative to the particle count below which
+        // a frame triggers a dump, 0 disables the trigger
+        double min_effective_fraction = 0;
+        // frames after a dump during which the thresholds do not trigger
+        int cooldown = 300;
+    };
+
+public:
+    /**
+     * \param config  Configuration of the tracker, stored with each dump
+     */
+    FlightRecorder(const Parameters& params,
+                   const std::string& config,
+                   int rows,
+                   int cols);
+
+    /**
+     * \brief Waits for a dump being written
+     */
+    ~FlightRecorder();
+
+    /**
+     * \brief Whether the next record should hold the per particle state of
+     *        the sensor, i.e. the snapshot should be taken with it
+     */
+    bool needs_sensor_state() const;
+
+    /**
+     * \brief Adds the frame, dropping the oldest ones beyond capacity, and
+     *        dumps if requested or if the frame breaches a threshold. The
+     *        sensor state of the snapshot is compressed into sensor_state.
+     */
+    void record(FlightRecord&& record);
+
+    /**
+     * \brief Makes the next record() dump. Async signal safe.
+     */
+    void request_dump();
+
+    /**
+     * \brief Starts writing the recorded frames in the background. Returns
+     *        the path of the dump, or an empty string if there is nothing
+     *        to dump or a dump is still being written.
+     */
+    std::string dump(const std::string& reason);
+
+    /**
+     * \brief Waits until the dump being written is complete
+     */
+    void wait();
+
+private:
+    Parameters params_;
+    std::string config_;
+    int rows_;
+    int cols_;
+
+    std::deque<std::shared_ptr<const FlightRecord>> records_;
+    int frames_since_sensor_state_;
+    int frames_since_dump_;
+    std::atomic<bool> dump_requested_;
+
+    std::thread writer_;
+    std::atomic<bool> writing_;
+};
+}
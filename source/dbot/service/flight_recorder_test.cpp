@@ -0,0 +1,324 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file flight_recorder_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+#include <unistd.h>
+
+#include <boost/filesystem.hpp>
+
+#include <dbot/service/flight_recorder.h>
+#include <dbot/service/tracker_factory.h>
+#include <dbot/test_meshes.h>
+
+namespace
+{
+std::string working_directory()
+{
+    char path[4096];
+    return getcwd(path, sizeof(path)) ? path : "/";
+}
+
+const int rows = 24;
+const int cols = 32;
+
+dbot::ConfigFile test_config()
+{
+    std::ofstream("flight_recorder_test.obj") << dbot::cube_wavefront(0.05);
+
+    return dbot::ConfigFile::parse(
+        "camera.rows: 24\n"
+        "camera.cols: 32\n"
+        "camera.matrix: 30 0 16  0 30 12  0 0 1\n"
+        "object.package_path: " + working_directory() + "\n"
+        "object.directory:\n"
+        "object.meshes: flight_recorder_test.obj\n"
+        "tracker.evaluation_count: 20\n"
+        "tracker.moving_average_update_rate: 1.0\n"
+        "tracker.max_kl_divergence: 0.5\n"
+        "tracker.initial_poses: 0 0 1  1 0 0 0\n"
+        "transition.linear_sigma_x: 0.002\n"
+        "transition.linear_sigma_y: 0.002\n"
+        "transition.linear_sigma_z: 0.002\n"
+        "transition.angular_sigma_x: 0.01\n"
+        "transition.angular_sigma_y: 0.01\n"
+        "transition.angular_sigma_z: 0.01\n"
+        "transition.velocity_factor: 0.8\n"
+        "sensor.sample_count: 10\n"
+        "sensor.delta_time: 0.033\n"
+        "sensor.occlusion.p_occluded_visible: 0.1\n"
+        "sensor.occlusion.p_occluded_occluded: 0.7\n"
+        "sensor.occlusion.initial_occlusion_prob: 0.1\n"
+        "sensor.kinect.tail_weight: 0.01\n"
+        "sensor.kinect.model_sigma: 0.003\n"
+        "sensor.kinect.sigma_factor: 0.00142478\n");
+}
+
+// a square in front of a wall, moving to the right
+std::vector<float> observation(int frame)
+{
+    std::vector<float> depth(rows * cols, 1.2f);
+    for (int row = 9; row < 15; ++row)
+    {
+        for (int col = 13 + frame % 4; col < 19 + frame % 4; ++col)
+        {
+            depth[row * cols + col] = 0.95f;
+        }
+    }
+    depth[0] = std::numeric_limits<float>::quiet_NaN();
+    return depth;
+}
+
+std::shared_ptr<dbot::ParticleTracker> create_tracker(
+    const dbot::ConfigFile& config)
+{
+    return dbot::create_configured_tracker(
+        config, dbot::load_configured_object_model(config));
+}
+
+// tracks the frames as the tracking service does while recording, keeping
+// the sensor state every interval frames
+dbot::FlightDump track(const dbot::ConfigFile& config,
+                       int frames,
+                       int interval)
+{
+    auto tracker = create_tracker(config);
+    tracker->initialize(std::vector<dbot::Tracker::State>(
+        1, dbot::configured_initial_state(config)));
+    dbot::ObservationSource source(
+        dbot::configured_camera_matrix(config), rows, cols);
+    tracker->subscribe(source);
+
+    dbot::FlightDump dump;
+    dump.config = config.text();
+    dump.rows = rows;
+    dump.cols = cols;
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        auto record = std::make_shared<dbot::FlightRecord>();
+        record->frame = frame;
+        record->snapshot = tracker->snapshot(frame % interval == 0);
+        if (frame % interval == 0)
+        {
+            dbot::compress_sensor_state(record->snapshot,
+                                        record->sensor_state);
+        }
+
+        const std::vector<float> depth = observation(frame);
+        dbot::compress_depth(depth.data(), depth.size(), record->depth);
+
+        dbot::summarize_particles(
+            *tracker, tracker->track(source.publish(depth.data())), *record);
+        record->stages = tracker->timings();
+        dump.records.push_back(record);
+    }
+    return dump;
+}
+
+dbot::FlightRecord small_record(std::uint64_t frame, double latency)
+{
+    dbot::FlightRecord record;
+    record.frame = frame;
+    record.latency = latency;
+    record.particle_count = 10;
+    record.effective_sample_size = 10;
+    const std::vector<float> depth = observation(0);
+    dbot::compress_depth(depth.data(), depth.size(), record.depth);
+    return record;
+}
+}
+
+TEST(FlightRecorderTests, depth_compression_is_lossless)
+{
+    std::vector<float> depth = observation(1);
+    depth[1] = std::numeric_limits<float>::infinity();
+    depth[2] = -0.5f;
+    depth[3] = 0.0f;
+
+    std::vector<unsigned char> compressed;
+    dbot::compress_depth(depth.data(), depth.size(), compressed);
+    EXPECT_LT(compressed.size(), depth.size() * sizeof(float) / 2);
+
+    std::vector<float> restored(depth.size());
+    dbot::decompress_depth(compressed, restored.size(), restored.data());
+    EXPECT_EQ(0,
+              std::memcmp(depth.data(),
+                          restored.data(),
+                          depth.size() * sizeof(float)));
+
+    compressed.pop_back();
+    EXPECT_THROW(
+        dbot::decompress_depth(compressed, restored.size(), restored.data()),
+        dbot::FlightRecorderException);
+}
+
+TEST(FlightRecorderTests, invalid_dump_throws)
+{
+    EXPECT_THROW(dbot::load_flight_dump("flight_recorder_test_missing.dump"),
+                 dbot::FlightRecorderException);
+
+    std::ofstream("flight_recorder_test.dump") << "DBOTFLT1 truncated";
+    EXPECT_THROW(dbot::load_flight_dump("flight_recorder_test.dump"),
+                 dbot::FlightRecorderException);
+    std::remove("flight_recorder_test.dump");
+}
+
+TEST(FlightRecorderTests, dumps_on_latency_and_request)
+{
+    dbot::FlightRecorder::Parameters params;
+    params.capacity = 3;
+    params.directory = "flight_recorder_test_dumps";
+    params.latency_threshold = 1000;
+    params.cooldown = 2;
+
+    {
+        dbot::FlightRecorder recorder(params, "a: 1\n", rows, cols);
+        for (int frame = 0; frame < 5; ++frame)
+        {
+            recorder.record(small_record(frame, 10));
+        }
+        recorder.record(small_record(5, 2000));
+        recorder.wait();
+
+        // within the cooldown
+        recorder.record(small_record(6, 2000));
+        recorder.request_dump();
+        recorder.record(small_record(7, 10));
+    }
+
+    auto latency = dbot::load_flight_dump(
+        "flight_recorder_test_dumps/flight_5_latency.dump");
+    EXPECT_EQ("latency", latency.reason);
+    EXPECT_EQ("a: 1\n", latency.config);
+    EXPECT_EQ(rows, latency.rows);
+    ASSERT_EQ(3u, latency.records.size());
+    EXPECT_EQ(3u, latency.records.front()->frame);
+    EXPECT_EQ(2000, latency.records.back()->latency);
+
+    EXPECT_FALSE(boost::filesystem::exists(
+        "flight_recorder_test_dumps/flight_6_latency.dump"));
+    auto requested = dbot::load_flight_dump(
+        "flight_recorder_test_dumps/flight_7_requested.dump");
+    EXPECT_EQ(7u, requested.records.back()->frame);
+
+    boost::filesystem::remove_all("flight_recorder_test_dumps");
+}
+
+TEST(FlightRecorderTests, keeps_the_sensor_state_of_the_oldest_frame)
+{
+    dbot::FlightRecorder::Parameters params;
+    params.capacity = 3;
+    params.directory = "flight_recorder_test_dumps";
+
+    const std::vector<float> occlusions = {0.1f, 0.1f, 0.1f, 0.4f, 0.4f};
+    const std::vector<double> times = {2.5, 2.5, 2.5, 2.5, 1.0};
+
+    auto dump_front = [&](dbot::FlightRecorder& recorder) {
+        const std::string path = recorder.dump("requested");
+        recorder.wait();
+        auto dump = dbot::load_flight_dump(path);
+        boost::filesystem::remove_all(params.directory);
+        return dump;
+    };
+
+    dbot::FlightRecorder recorder(params, "", rows, cols);
+    for (int frame = 0; frame < 7; ++frame)
+    {
+        const bool needs_sensor_state = recorder.needs_sensor_state();
+        EXPECT_EQ(frame % 3 == 0, needs_sensor_state);
+
+        auto record = small_record(frame, 10);
+        if (needs_sensor_state)
+        {
+            record.snapshot.filter.sensor.occlusions = occlusions;
+            record.snapshot.filter.sensor.occlusion_times = times;
+        }
+        recorder.record(std::move(record));
+
+        if (frame == 4)
+        {
+            // the oldest frame is kept beyond capacity as the replay start
+            auto dump = dump_front(recorder);
+            ASSERT_EQ(5u, dump.records.size());
+            EXPECT_EQ(0u, dump.records.front()->frame);
+
+            dbot::ParticleTracker::Snapshot snapshot;
+            dbot::decompress_sensor_state(
+                dump.records.front()->sensor_state, snapshot);
+            EXPECT_EQ(occlusions, snapshot.filter.sensor.occlusions);
+            EXPECT_EQ(times, snapshot.filter.sensor.occlusion_times);
+            EXPECT_TRUE(dump.records[1]->sensor_state.empty());
+        }
+    }
+
+    // and dropped once a newer replay start is followed by capacity frames
+    auto dump = dump_front(recorder);
+    ASSERT_EQ(4u, dump.records.size());
+    EXPECT_EQ(3u, dump.records.front()->frame);
+    EXPECT_FALSE(dump.records.front()->sensor_state.empty());
+}
+
+TEST(FlightRecorderTests, replay_reproduces_recorded_frames)
+{
+    const auto config = test_config();
+    const auto recorded = track(config, 6, 3);
+
+    dbot::save_flight_dump(recorded, "flight_recorder_test.dump");
+    const auto dump = dbot::load_flight_dump("flight_recorder_test.dump");
+    std::remove("flight_recorder_test.dump");
+
+    // the dump starts with the first frame, the replay from its snapshot
+    // matches exactly
+    const auto camera_matrix = dbot::configured_camera_matrix(config);
+    auto tracker = create_tracker(dbot::ConfigFile::parse(dump.config));
+    auto frames = dbot::replay_flight_dump(dump, *tracker, camera_matrix);
+    ASSERT_EQ(6u, frames.size());
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+        EXPECT_EQ(recorded.records[i]->estimate, frames[i].estimate);
+        EXPECT_EQ(recorded.records[i]->effective_sample_size,
+                  frames[i].effective_sample_size);
+    }
+
+    // a replay from the middle of the recording continues from the
+    // recorded occlusions and matches exactly as well
+    dbot::FlightDump tail = dump;
+    tail.records.erase(tail.records.begin(), tail.records.begin() + 3);
+    EXPECT_FALSE(tail.records.front()->sensor_state.empty());
+    EXPECT_TRUE(dump.records[1]->sensor_state.empty());
+    EXPECT_GT(tail.records.front()->snapshot.filter.sensor.observation_time,
+              0);
+    auto replayed = dbot::replay_flight_dump(
+        tail, *create_tracker(config), camera_matrix);
+    ASSERT_EQ(3u, replayed.size());
+    for (size_t i = 0; i < replayed.size(); ++i)
+    {
+        EXPECT_EQ(recorded.records[3 + i]->estimate, replayed[i].estimate);
+        EXPECT_EQ(recorded.records[3 + i]->effective_sample_size,
+                  replayed[i].effective_sample_size);
+    }
+
+    std::remove("flight_recorder_test.obj");
+}
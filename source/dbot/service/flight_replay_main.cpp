@@ -0,0 +1,110 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file flight_replay_main.cpp
+ * \date October 2016
+ *
+ * Usage: dbot_flight_replay <flight dump> [config file]
+ *
+ * Replays the frames of a flight recorder dump through a tracker of the
+ * recorded configuration, or of the given one, and prints the recorded and
+ * the replayed stage timings of each frame along with the deviation of the
+ * replayed estimates from the recorded ones.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+
+#include <dbot/cpu_kernels.h>
+#include <dbot/service/flight_recorder.h>
+#include <dbot/service/tracker_factory.h>
+
+int main(int argc, char** argv)
+{
+    if (argc < 2 || argc > 3)
+    {
+        std::fprintf(
+            stderr, "Usage: %s <flight dump> [config file]\n", argv[0]);
+        return 2;
+    }
+
+    try
+    {
+        std::fprintf(stderr,
+                     "dbot_flight_replay: CPU kernels %s\n",
+                     dbot::cpu_kernels_report().c_str());
+
+        auto dump = dbot::load_flight_dump(argv[1]);
+        auto config = argc > 2 ? dbot::ConfigFile::load(argv[2])
+                               : dbot::ConfigFile::parse(dump.config, argv[1]);
+
+        auto tracker = dbot::create_configured_tracker(
+            config, dbot::load_configured_object_model(config));
+        auto frames = dbot::replay_flight_dump(
+            dump, *tracker, dbot::configured_camera_matrix(config));
+
+        std::printf("dump of %zu frames, reason: %s\n",
+                    dump.records.size(),
+                    dump.reason.c_str());
+        std::printf("%-10s %10s %10s %10s %10s %10s %10s %12s\n",
+                    "frame",
+                    "track [ms]",
+                    "replay",
+                    "evaluate",
+                    "replay",
+                    "ess",
+                    "replay",
+                    "offset [mm]");
+
+        double max_offset = 0;
+        for (size_t i = 0; i < frames.size(); ++i)
+        {
+            const auto& record = *dump.records[i];
+            const auto& frame = frames[i];
+
+            double offset = 0;
+            for (int j = 0; j < frame.estimate.count(); ++j)
+            {
+                offset = std::max(
+                    offset,
+                    (frame.estimate.component(j).position() -
+                     record.estimate.component(j).position())
+                        .norm());
+            }
+            max_offset = std::max(max_offset, offset);
+
+            std::printf("%-10llu %10.3f %10.3f %10.3f %10.3f %10.1f %10.1f "
+                        "%12.3f\n",
+                        (unsigned long long)record.frame,
+                        record.track_ms,
+                        frame.track_ms,
+                        record.stages.evaluation,
+                        frame.stages.evaluation,
+                        record.effective_sample_size,
+                        frame.effective_sample_size,
+                        1e3 * offset);
+        }
+
+        std::printf("largest offset from the recorded estimates: %.3f mm\n",
+                    1e3 * max_offset);
+    }
+    catch (const std::exception& e)
+    {
+        std::fprintf(stderr, "dbot_flight_replay: %s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,185 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file frame_ring.cpp
+ * \date October 2016
+ */
+
+#include <dbot/service/frame_ring.h>
+
+namespace dbot
+{
+namespace
+{
+const std::uint32_t frame_ring_magic = 0x64667231;  // "dfr1"
+}
+
+struct FrameRing::Header
+{
+    std::uint32_t magic;
+    std::int32_t rows;
+    std::int32_t cols;
+    std::int32_t slots;
+    std::atomic<std::uint64_t> published;
+};
+
+// the sequence of a slot is odd while frame (sequence - 1) / 2 is written and
+// even once it is published
+struct FrameRing::Slot
+{
+    std::atomic<std::uint64_t> sequence;
+    double timestamp;
+};
+
+static_assert(sizeof(std::atomic<std::uint64_t>) == sizeof(std::uint64_t),
+              "shared counters must be plain lock free integers");
+
+std::size_t FrameRing::header_size()
+{
+    return (sizeof(Header) + 63) / 64 * 64;
+}
+
+std::size_t FrameRing::slot_stride(int rows, int cols)
+{
+    std::size_t bytes = sizeof(Slot) + std::size_t(rows) * cols * sizeof(float);
+    return (bytes + 63) / 64 * 64;
+}
+
+FrameRing FrameRing::create(const std::string& name,
+                            int rows,
+                            int cols,
+                            int slots)
+{
+    if (rows <= 0 || cols <= 0 || slots <= 0)
+    {
+        throw SharedMemoryException(name + ": invalid frame ring dimensions");
+    }
+
+    std::unique_ptr<SharedMemory> memory(new SharedMemory(
+        name, header_size() + slots * slot_stride(rows, cols)));
+
+    Header* header = memory->at<Header>(0);
+    header->rows = rows;
+    header->cols = cols;
+    header->slots = slots;
+    header->published.store(0);
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = frame_ring_magic;
+
+    return FrameRing(std::move(memory));
+}
+
+FrameRing FrameRing::open(const std::string& name)
+{
+    std::unique_ptr<SharedMemory> memory(new SharedMemory(name));
+
+    const Header* header = memory->at<Header>(0);
+    if (memory->size() < sizeof(Header) || header->magic != frame_ring_magic ||
+        memory->size() < header_size() +
+                             header->slots *
+                                 slot_stride(header->rows, header->cols))
+    {
+        throw SharedMemoryException(name + ": not a frame ring");
+    }
+
+    return FrameRing(std::move(memory));
+}
+
+FrameRing::FrameRing(std::unique_ptr<SharedMemory> memory)
+    : memory_(std::move(memory))
+{
+}
+
+float* FrameRing::begin_write()
+{
+    std::uint64_t number = header().published.load(std::memory_order_relaxed);
+
+    slot(number).sequence.store(2 * number + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    return depth(number);
+}
+
+void FrameRing::end_write(double timestamp)
+{
+    std::uint64_t number = header().published.load(std::memory_order_relaxed);
+
+    slot(number).timestamp = timestamp;
+    slot(number).sequence.store(2 * number + 2, std::memory_order_release);
+    header().published.store(number + 1, std::memory_order_release);
+}
+
+std::uint64_t FrameRing::count_published() const
+{
+    return header().published.load(std::memory_order_acquire);
+}
+
+bool FrameRing::latest(Frame& frame) const
+{
+    std::uint64_t published = count_published();
+    if (published == 0) return false;
+
+    std::uint64_t number = published - 1;
+    if (slot(number).sequence.load(std::memory_order_acquire) !=
+        2 * number + 2)
+    {
+        return false;
+    }
+
+    frame.depth = depth(number);
+    frame.number = number;
+    frame.timestamp = slot(number).timestamp;
+
+    return valid(frame);
+}
+
+bool FrameRing::valid(const Frame& frame) const
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot(frame.number).sequence.load(std::memory_order_relaxed) ==
+           2 * frame.number + 2;
+}
+
+int FrameRing::rows() const
+{
+    return header().rows;
+}
+
+int FrameRing::cols() const
+{
+    return header().cols;
+}
+
+int FrameRing::count_slots() const
+{
+    return header().slots;
+}
+
+auto FrameRing::header() const -> Header&
+{
+    return *memory_->at<Header>(0);
+}
+
+auto FrameRing::slot(std::uint64_t number) const -> Slot&
+{
+    std::size_t index = number % header().slots;
+    return *memory_->at<Slot>(header_size() +
+                              index * slot_stride(rows(), cols()));
+}
+
+float* FrameRing::depth(std::uint64_t number) const
+{
+    return reinterpret_cast<float*>(&slot(number) + 1);
+}
+}
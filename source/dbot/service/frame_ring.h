@@ -0,0 +1,125 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file frame_ring.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <dbot/shared_memory.h>
+
+namespace dbot
+{
+/**
+ * \brief Ring of depth frames in named shared memory, written by a single
+ *        camera process and read by any number of consumers.
+ *
+ * Each slot holds a row major image of rows x cols depth values in meters
+ * (NaN for missing measurements). Slots are protected by a sequence counter:
+ * readers access the slot memory in place and check afterwards whether the
+ * writer has started overwriting it in the meantime. The writer never waits
+ * for readers; a reader which is too slow loses frames.
+ */
+class FrameRing
+{
+public:
+    /**
+     * \brief Frame as seen by a reader. The depth values point into the
+     *        shared slot and are valid as long as valid() holds.
+     */
+    struct Frame
+    {
+        const float* depth;
+        std::uint64_t number;
+        double timestamp;
+    };
+
+public:
+    /**
+     * \brief Creates the ring under the given name, e.g. "/dbot_frames"
+     *
+     * \throws SharedMemoryException
+     */
+    static FrameRing create(const std::string& name,
+                            int rows,
+                            int cols,
+                            int slots = 4);
+
+    /**
+     * \brief Opens an existing ring
+     *
+     * \throws SharedMemoryException if the ring does not exist or is not a
+     *         frame ring
+     */
+    static FrameRing open(const std::string& name);
+
+    /* -- writer -- */
+
+    /**
+     * \brief Returns the slot the next frame is written into
+     */
+    float* begin_write();
+
+    /**
+     * \brief Publishes the frame written since begin_write()
+     */
+    void end_write(double timestamp);
+
+    /* -- reader -- */
+
+    /**
+     * \brief Returns the number of frames published so far
+     */
+    std::uint64_t count_published() const;
+
+    /**
+     * \brief Retrieves the most recently published frame. Returns false if no
+     *        frame has been published yet or it is already being
+     *        overwritten.
+     */
+    bool latest(Frame& frame) const;
+
+    /**
+     * \brief Returns whether the frame's slot has not been overwritten since
+     *        the frame was retrieved
+     */
+    bool valid(const Frame& frame) const;
+
+    int rows() const;
+    int cols() const;
+    int count_slots() const;
+
+private:
+    struct Header;
+    struct Slot;
+
+    explicit FrameRing(std::unique_ptr<SharedMemory> memory);
+
+    Header& header() const;
+    Slot& slot(std::uint64_t number) const;
+    float* depth(std::uint64_t number) const;
+
+    static std::size_t header_size();
+    static std::size_t slot_stride(int rows, int cols);
+
+private:
+    std::unique_ptr<SharedMemory> memory_;
+};
+}
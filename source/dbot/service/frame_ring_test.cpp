@@ -0,0 +1,104 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file frame_ring_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <unistd.h>
+
+#include <dbot/service/frame_ring.h>
+#include <dbot/service/tracking_output.h>
+
+static std::string unique_name(const std::string& name)
+{
+    return "/dbot_test_" + name + "_" + std::to_string(getpid());
+}
+
+TEST(FrameRingTests, reader_sees_latest_frame_in_place)
+{
+    auto writer = dbot::FrameRing::create(unique_name("ring"), 2, 3, 2);
+    auto reader = dbot::FrameRing::open(unique_name("ring"));
+
+    dbot::FrameRing::Frame frame;
+    EXPECT_FALSE(reader.latest(frame));
+
+    for (int number = 0; number < 3; ++number)
+    {
+        float* depth = writer.begin_write();
+        for (int i = 0; i < 6; ++i) depth[i] = number + 0.1f * i;
+        writer.end_write(10.0 + number);
+    }
+
+    ASSERT_TRUE(reader.latest(frame));
+    EXPECT_EQ(reader.rows(), 2);
+    EXPECT_EQ(reader.cols(), 3);
+    EXPECT_EQ(frame.number, 2u);
+    EXPECT_DOUBLE_EQ(frame.timestamp, 12.0);
+    EXPECT_FLOAT_EQ(frame.depth[5], 2.5f);
+    EXPECT_TRUE(reader.valid(frame));
+}
+
+TEST(FrameRingTests, overwritten_frame_is_invalid)
+{
+    auto ring = dbot::FrameRing::create(unique_name("overwrite"), 1, 1, 2);
+
+    ring.begin_write();
+    ring.end_write(0.0);
+
+    dbot::FrameRing::Frame frame;
+    ASSERT_TRUE(ring.latest(frame));
+
+    // the third frame reuses the slot of the first one
+    ring.begin_write();
+    ring.end_write(1.0);
+    EXPECT_TRUE(ring.valid(frame));
+    ring.begin_write();
+    EXPECT_FALSE(ring.valid(frame));
+}
+
+TEST(FrameRingTests, open_missing_ring_throws)
+{
+    EXPECT_THROW(dbot::FrameRing::open(unique_name("missing")),
+                 dbot::SharedMemoryException);
+}
+
+TEST(TrackingOutputTests, reader_sees_published_sample)
+{
+    auto writer = dbot::TrackingOutput::create(unique_name("output"), 2);
+    auto reader = dbot::TrackingOutput::open(unique_name("output"));
+
+    dbot::TrackingOutput::Sample sample;
+    EXPECT_FALSE(reader.read(sample));
+
+    sample.frame = 7;
+    sample.timestamp = 1.5;
+    sample.health = dbot::TrackingOutput::Health();
+    sample.health.status = dbot::TrackingOutput::Tracking;
+    sample.health.frames_tracked = 3;
+    sample.state = Eigen::VectorXd::LinSpaced(24, 0, 23);
+    writer.publish(sample);
+
+    dbot::TrackingOutput::Sample read;
+    ASSERT_TRUE(reader.read(read));
+    EXPECT_EQ(reader.count_objects(), 2);
+    EXPECT_EQ(read.frame, 7u);
+    EXPECT_EQ(read.health.status, dbot::TrackingOutput::Tracking);
+    EXPECT_EQ(read.health.frames_tracked, 3u);
+    EXPECT_TRUE(read.state.isApprox(sample.state));
+}
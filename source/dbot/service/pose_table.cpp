@@ -0,0 +1,138 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file pose_table.cpp
+ * \date October 2016
+ */
+
+#include <dbot/service/pose_table.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace dbot
+{
+namespace
+{
+const char magic[8] = {'D', 'B', 'O', 'T', 'C', 'O', 'L', '1'};
+}
+
+PoseTable::PoseTable(const std::vector<std::string>& names)
+    : names_(names), columns_(names.size())
+{
+}
+
+PoseTable PoseTable::load(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw PoseTableException(path + ": cannot open table");
+    }
+
+    char file_magic[8];
+    std::uint32_t column_count = 0;
+    std::uint64_t row_count = 0;
+    file.read(file_magic, sizeof(file_magic));
+    file.read(reinterpret_cast<char*>(&column_count), sizeof(column_count));
+    file.read(reinterpret_cast<char*>(&row_count), sizeof(row_count));
+    if (!file || std::memcmp(file_magic, magic, sizeof(magic)) != 0)
+    {
+        throw PoseTableException(path + ": not a pose table");
+    }
+
+    std::vector<std::string> names(column_count);
+    for (auto& name : names)
+    {
+        std::uint32_t length = 0;
+        file.read(reinterpret_cast<char*>(&length), sizeof(length));
+        name.resize(length);
+        file.read(&name[0], length);
+    }
+
+    PoseTable table(names);
+    for (auto& column : table.columns_)
+    {
+        column.resize(row_count);
+        file.read(reinterpret_cast<char*>(column.data()),
+                  row_count * sizeof(double));
+    }
+    if (!file)
+    {
+        throw PoseTableException(path + ": truncated table");
+    }
+
+    return table;
+}
+
+void PoseTable::append(const std::vector<double>& row)
+{
+    for (std::size_t i = 0; i < columns_.size(); ++i)
+    {
+        columns_[i].push_back(row[i]);
+    }
+}
+
+const std::vector<double>& PoseTable::column(const std::string& name) const
+{
+    for (std::size_t i = 0; i < names_.size(); ++i)
+    {
+        if (names_[i] == name) return columns_[i];
+    }
+    throw PoseTableException("no column " + name);
+}
+
+void PoseTable::save(const std::string& path) const
+{
+    const std::string partial = path + ".partial";
+    {
+        std::ofstream file(partial, std::ios::binary | std::ios::trunc);
+
+        const std::uint32_t column_count = names_.size();
+        const std::uint64_t row_count = count_rows();
+        file.write(magic, sizeof(magic));
+        file.write(reinterpret_cast<const char*>(&column_count),
+                   sizeof(column_count));
+        file.write(reinterpret_cast<const char*>(&row_count),
+                   sizeof(row_count));
+
+        for (const auto& name : names_)
+        {
+            const std::uint32_t length = name.size();
+            file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+            file.write(name.data(), length);
+        }
+
+        for (const auto& column : columns_)
+        {
+            file.write(reinterpret_cast<const char*>(column.data()),
+                       column.size() * sizeof(double));
+        }
+
+        if (!file.flush())
+        {
+            std::remove(partial.c_str());
+            throw PoseTableException(path + ": cannot write table");
+        }
+    }
+
+    if (std::rename(partial.c_str(), path.c_str()) != 0)
+    {
+        std::remove(partial.c_str());
+        throw PoseTableException(path + ": cannot write table");
+    }
+}
+}
@@ -0,0 +1,100 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file pose_table.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <string>
+#include <vector>
+
+namespace dbot
+{
+class PoseTableException : public std::exception
+{
+public:
+    explicit PoseTableException(const std::string& message)
+        : message_(message)
+    {
+    }
+
+    const char* what() const noexcept { return message_.c_str(); }
+
+private:
+    std::string message_;
+};
+
+/**
+ * \brief Table of named double columns, such as the poses and timing of a
+ *        tracked sequence, stored column by column.
+ *
+ * The file holds a header with the column names and the row count followed
+ * by the values of each column in turn, in the byte order of the writing
+ * machine. A column can hence be read or mapped as one contiguous array.
+ * Tables are written to a temporary file which is renamed once complete,
+ * such that a table file is never partially written.
+ */
+class PoseTable
+{
+public:
+    explicit PoseTable(const std::vector<std::string>& names);
+
+    /**
+     * \brief Reads the table at the given path
+     *
+     * \throws PoseTableException if the file cannot be read or is not a
+     *         table
+     */
+    static PoseTable load(const std::string& path);
+
+    /**
+     * \brief Appends a row of one value per column
+     */
+    void append(const std::vector<double>& row);
+
+    /**
+     * \brief Writes the table to the given path, replacing an existing file
+     *        atomically
+     *
+     * \throws PoseTableException if the file cannot be written
+     */
+    void save(const std::string& path) const;
+
+    const std::vector<std::string>& names() const { return names_; }
+    const std::vector<double>& column(std::size_t index) const
+    {
+        return columns_[index];
+    }
+
+    /**
+     * \brief Returns the column of the given name
+     *
+     * \throws PoseTableException if there is no such column
+     */
+    const std::vector<double>& column(const std::string& name) const;
+
+    std::size_t count_rows() const
+    {
+        return columns_.empty() ? 0 : columns_.front().size();
+    }
+
+private:
+    std::vector<std::string> names_;
+    std::vector<std::vector<double>> columns_;
+};
+}
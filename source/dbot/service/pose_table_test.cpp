@@ -0,0 +1,60 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file pose_table_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+
+#include <dbot/service/pose_table.h>
+
+TEST(PoseTableTests, round_trip)
+{
+    dbot::PoseTable table({"frame", "object0.x"});
+    table.append({0, 0.25});
+    table.append({1, -0.5});
+    table.save("pose_table_test.poses");
+
+    auto loaded = dbot::PoseTable::load("pose_table_test.poses");
+    std::remove("pose_table_test.poses");
+
+    ASSERT_EQ(2u, loaded.names().size());
+    EXPECT_EQ("object0.x", loaded.names()[1]);
+    ASSERT_EQ(2u, loaded.count_rows());
+    EXPECT_EQ(1, loaded.column("frame")[1]);
+    EXPECT_EQ(0.25, loaded.column(1)[0]);
+    EXPECT_EQ(-0.5, loaded.column(1)[1]);
+}
+
+TEST(PoseTableTests, missing_column_throws)
+{
+    dbot::PoseTable table({"frame"});
+
+    EXPECT_THROW(table.column("timestamp"), dbot::PoseTableException);
+}
+
+TEST(PoseTableTests, invalid_file_throws)
+{
+    EXPECT_THROW(dbot::PoseTable::load("pose_table_test_missing.poses"),
+                 dbot::PoseTableException);
+
+    std::ofstream("pose_table_test.poses") << "frame timestamp\n";
+    EXPECT_THROW(dbot::PoseTable::load("pose_table_test.poses"),
+                 dbot::PoseTableException);
+    std::remove("pose_table_test.poses");
+}
@@ -0,0 +1,294 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file tracker_factory.cpp
+ * \date October 2016
+ */
+
+#include <dbot/service/tracker_factory.h>
+
+#include <dbot/builder/object_transition_builder.h>
+#include <dbot/builder/particle_tracker_builder.h>
+#include <dbot/camera_data.h>
+#include <dbot/object_resource_identifier.h>
+#include <dbot/simple_camera_data_provider.h>
+#include <dbot/simple_wavefront_object_loader.h>
+
+namespace dbot
+{
+namespace
+{
+/**
+ * \brief Camera description taken from the configuration. Frames are passed
+ *        to the tracker by its user, not read through the provider.
+ */
+class ConfiguredCameraDataProvider : public SimpleCameraDataProvider
+{
+public:
+    ConfiguredCameraDataProvider(const std::string& frame_id,
+                                 const Eigen::Matrix3d& camera_matrix,
+                                 const CameraData::Resolution& resolution)
+        : SimpleCameraDataProvider(frame_id, camera_matrix, resolution)
+    {
+    }
+
+    Eigen::MatrixXd depth_image() const { return Eigen::MatrixXd(); }
+    Eigen::VectorXd depth_image_vector() const { return Eigen::VectorXd(); }
+    int downsampling_factor() const { return 1; }
+};
+}
+
+int configured_instances(const ConfigFile& config)
+{
+    const int instances = config.get<int>("object.instances", 1);
+    if (instances < 1)
+    {
+        throw ConfigException("object.instances must be positive");
+    }
+    return instances;
+}
+
+int configured_object_count(const ConfigFile& config)
+{
+    return config.get_list<std::string>("object.meshes").size() *
+           configured_instances(config);
+}
+
+Eigen::Matrix3d configured_camera_matrix(const ConfigFile& config)
+{
+    auto k = config.get_list<double>("camera.matrix");
+    if (k.size() != 9)
+    {
+        throw ConfigException("camera.matrix requires 9 values");
+    }
+    Eigen::Matrix3d camera_matrix;
+    camera_matrix << k[0], k[1], k[2], k[3], k[4], k[5], k[6], k[7], k[8];
+    return camera_matrix;
+}
+
+ObjectModelFuture load_configured_object_model(const ConfigFile& config)
+{
+    ObjectResourceIdentifier ori(
+        config.get<std::string>("object.package_path"),
+        config.get<std::string>("object.directory"),
+        config.get_list<std::string>("object.meshes"));
+
+    return load_object_model(
+        std::make_shared<SimpleWavefrontObjectModelLoader>(ori),
+        false,
+        configured_instances(config));
+}
+
+std::shared_ptr<ParticleTracker> create_configured_tracker(
+    const ConfigFile& config,
+    const ObjectModelFuture& object_model)
+{
+    typedef ParticleTrackerBuilder<ParticleTracker> Builder;
+    typedef Tracker::State State;
+
+    /* -- camera -- */
+    const Eigen::Matrix3d camera_matrix = configured_camera_matrix(config);
+
+    CameraData::Resolution resolution;
+    resolution.width = config.get<int>("camera.cols");
+    resolution.height = config.get<int>("camera.rows");
+    auto camera_data = std::make_shared<CameraData>(
+        std::make_shared<ConfiguredCameraDataProvider>(
+            config.get<std::string>("camera.frame_id", "camera"),
+            camera_matrix,
+            resolution));
+
+    /* -- transition -- */
+    ObjectTransitionBuilder<State>::Parameters transition;
+    transition.linear_sigma_x = config.get<double>("transition.linear_sigma_x");
+    transition.linear_sigma_y = config.get<double>("transition.linear_sigma_y");
+    transition.linear_sigma_z = config.get<double>("transition.linear_sigma_z");
+    transition.angular_sigma_x =
+        config.get<double>("transition.angular_sigma_x");
+    transition.angular_sigma_y =
+        config.get<double>("transition.angular_sigma_y");
+    transition.angular_sigma_z =
+        config.get<double>("transition.angular_sigma_z");
+    transition.velocity_factor =
+        config.get<double>("transition.velocity_factor");
+    transition.part_count = configured_object_count(config);
+
+    /* -- sensor -- */
+    RbSensorBuilder<State>::Parameters sensor;
+    sensor.use_gpu = config.get<bool>("sensor.use_gpu", false);
+    sensor.occlusion.p_occluded_visible =
+        config.get<double>("sensor.occlusion.p_occluded_visible");
+    sensor.occlusion.p_occluded_occluded =
+        config.get<double>("sensor.occlusion.p_occluded_occluded");
+    sensor.occlusion.initial_occlusion_prob =
+        config.get<double>("sensor.occlusion.initial_occlusion_prob");
+    sensor.occlusion.prune_threshold =
+        config.get<double>("sensor.occlusion.prune_threshold", 2.0);
+    sensor.kinect.tail_weight = config.get<double>("sensor.kinect.tail_weight");
+    sensor.kinect.model_sigma = config.get<double>("sensor.kinect.model_sigma");
+    sensor.kinect.sigma_factor =
+        config.get<double>("sensor.kinect.sigma_factor");
+    sensor.delta_time = config.get<double>("sensor.delta_time");
+    sensor.sample_count = config.get<int>("sensor.sample_count");
+    sensor.use_custom_shaders =
+        config.get<bool>("sensor.use_custom_shaders", false);
+    sensor.vertex_shader_file =
+        config.get<std::string>("sensor.vertex_shader_file", "");
+    sensor.fragment_shader_file =
+        config.get<std::string>("sensor.fragment_shader_file", "");
+    sensor.geometry_shader_file =
+        config.get<std::string>("sensor.geometry_shader_file", "");
+    sensor.single_precision =
+        config.get<bool>("sensor.single_precision", false);
+    sensor.worker_count = config.get<int>("sensor.worker_count", 1);
+    sensor.numa_aware = config.get<bool>("sensor.numa_aware", false);
+    sensor.tile_rows = config.get<int>("sensor.tile_rows", 0);
+    sensor.cull_triangles =
+        config.get<bool>("sensor.cull_triangles", false);
+    sensor.process_count = config.get<int>("sensor.process_count", 0);
+    sensor.background.file =
+        config.get<std::string>("sensor.background.file", "");
+    sensor.background.learning_frames =
+        config.get<int>("sensor.background.learning_frames", 0);
+    sensor.background.match_sigmas =
+        config.get<double>("sensor.background.match_sigmas", 3.0);
+    sensor.background.update_rate =
+        config.get<double>("sensor.background.update_rate", 0.0);
+    sensor.impostors.keep_fraction =
+        config.get<double>("sensor.impostors.keep_fraction", 1.0);
+    sensor.change_detection.enabled =
+        config.get<bool>("sensor.change_detection.enabled", false);
+    sensor.change_detection.threshold_sigmas =
+        config.get<double>("sensor.change_detection.threshold_sigmas", 4.0);
+    sensor.change_detection.max_changed_fraction = config.get<double>(
+        "sensor.change_detection.max_changed_fraction", 0.01);
+    sensor.change_detection.margin =
+        config.get<int>("sensor.change_detection.margin", 8);
+
+    if (config.has("sensor.occluders.meshes"))
+    {
+        ObjectResourceIdentifier ori(
+            config.get<std::string>(
+                "sensor.occluders.package_path",
+                config.get<std::string>("object.package_path")),
+            config.get<std::string>("sensor.occluders.directory", ""),
+            config.get_list<std::string>("sensor.occluders.meshes"));
+        sensor.occluders.model = std::make_shared<ObjectModel>(
+            std::make_shared<SimpleWavefrontObjectModelLoader>(ori), false);
+
+        // position and quaternion (x y z qw qx qy qz) per occluder mesh
+        auto values = config.get_list<double>("sensor.occluders.poses");
+        if (values.size() != 7 * size_t(ori.count_meshes()))
+        {
+            throw ConfigException(
+                "sensor.occluders.poses requires 7 values per occluder mesh");
+        }
+        for (size_t i = 0; i < values.size(); i += 7)
+        {
+            RigidBodyRenderer::Affine pose =
+                RigidBodyRenderer::Affine::Identity();
+            pose.translation() =
+                Eigen::Vector3d(values[i], values[i + 1], values[i + 2]);
+            pose.linear() = Eigen::Quaterniond(values[i + 3],
+                                               values[i + 4],
+                                               values[i + 5],
+                                               values[i + 6])
+                                .normalized()
+                                .toRotationMatrix();
+            sensor.occluders.poses.push_back(pose);
+        }
+    }
+
+    auto huge_pages = config.get<std::string>("sensor.huge_pages", "disabled");
+    if (huge_pages == "disabled")
+        sensor.huge_pages = HugePagePolicy::Disabled;
+    else if (huge_pages == "transparent")
+        sensor.huge_pages = HugePagePolicy::Transparent;
+    else if (huge_pages == "explicit")
+        sensor.huge_pages = HugePagePolicy::Explicit;
+    else
+        throw ConfigException("sensor.huge_pages must be one of disabled, "
+                              "transparent or explicit");
+
+    /* -- tracker -- */
+    Builder::Parameters params;
+    params.evaluation_count = config.get<int>("tracker.evaluation_count");
+    params.moving_average_update_rate =
+        config.get<double>("tracker.moving_average_update_rate");
+    params.max_kl_divergence = config.get<double>("tracker.max_kl_divergence");
+    params.center_object_frame =
+        config.get<bool>("tracker.center_object_frame", true);
+    params.seed = config.get<unsigned>("tracker.seed", 0);
+    params.low_discrepancy_noise =
+        config.get<bool>("tracker.low_discrepancy_noise", false);
+    params.factorized_weights =
+        config.get<bool>("tracker.factorized_weights", false);
+    params.static_evaluation_count =
+        config.get<int>("tracker.static_evaluation_count", 0);
+    params.refinement.enabled =
+        config.get<bool>("tracker.refinement.enabled", false);
+    params.refinement.iterations =
+        config.get<int>("tracker.refinement.iterations", 5);
+    params.refinement.max_distance =
+        config.get<double>("tracker.refinement.max_distance", 0.01);
+    params.refinement.min_pixels =
+        config.get<int>("tracker.refinement.min_pixels", 50);
+    params.refinement.particles =
+        config.get<int>("tracker.refinement.particles", 0);
+    if (config.has("tracker.annealing.betas"))
+    {
+        params.annealing.betas =
+            config.get_list<double>("tracker.annealing.betas");
+    }
+    params.annealing.diffusion =
+        config.get<double>("tracker.annealing.diffusion", 0.5);
+
+    Builder builder(
+        std::make_shared<ObjectTransitionBuilder<State>>(transition),
+        std::make_shared<RbSensorBuilder<State>>(
+            object_model, camera_data, sensor),
+        object_model,
+        params);
+
+    return builder.build();
+}
+
+Tracker::State configured_initial_state(const ConfigFile& config)
+{
+    const int object_count = configured_object_count(config);
+
+    // position and quaternion (x y z qw qx qy qz) per object
+    auto values = config.get_list<double>("tracker.initial_poses");
+    if (values.size() != 7 * size_t(object_count))
+    {
+        throw ConfigException(
+            "tracker.initial_poses requires 7 values per object mesh and "
+            "instance");
+    }
+
+    Tracker::State state(object_count);
+    state.setZero();
+    for (int i = 0; i < object_count; ++i)
+    {
+        const double* pose = &values[7 * i];
+        state.component(i).position() =
+            Eigen::Vector3d(pose[0], pose[1], pose[2]);
+        state.component(i).orientation().quaternion(
+            Eigen::Quaterniond(pose[3], pose[4], pose[5], pose[6])
+                .normalized());
+    }
+
+    return state;
+}
+}
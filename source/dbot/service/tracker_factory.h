@@ -0,0 +1,70 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file tracker_factory.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <memory>
+
+#include <Eigen/Core>
+
+#include <dbot/object_model.h>
+#include <dbot/service/config_file.h>
+#include <dbot/tracker/particle_tracker.h>
+
+namespace dbot
+{
+/**
+ * \brief Returns the number of tracked objects, the configured meshes times
+ *        their instances
+ *
+ * \throws ConfigException on missing or invalid configuration
+ */
+int configured_object_count(const ConfigFile& config);
+
+/**
+ * \brief Returns the configured intrinsic matrix of the camera
+ *
+ * \throws ConfigException on missing or invalid configuration
+ */
+Eigen::Matrix3d configured_camera_matrix(const ConfigFile& config);
+
+/**
+ * \brief Starts loading the configured object model in the background
+ *
+ * \throws ConfigException on missing or invalid configuration
+ */
+ObjectModelFuture load_configured_object_model(const ConfigFile& config);
+
+/**
+ * \brief Builds a particle tracker of the given object model with the
+ *        configured camera, transition, sensor and tracker parameters, see
+ *        doc/tracking_service.conf for the recognized keys
+ *
+ * \throws ConfigException on missing or invalid configuration
+ */
+std::shared_ptr<ParticleTracker> create_configured_tracker(
+    const ConfigFile& config,
+    const ObjectModelFuture& object_model);
+
+/**
+ * \brief Returns the configured initial poses of the objects
+ *
+ * \throws ConfigException on missing or invalid configuration
+ */
+Tracker::State configured_initial_state(const ConfigFile& config);
+}
@@ -0,0 +1,144 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file tracking_output.cpp
+ * \date October 2016
+ */
+
+#include <dbot/service/tracking_output.h>
+
+#include <atomic>
+#include <cassert>
+#include <thread>
+
+namespace dbot
+{
+namespace
+{
+const std::uint32_t tracking_output_magic = 0x64746f31;  // "dto1"
+const int state_size = 12;
+}
+
+// the sequence is odd while an update is in progress
+struct TrackingOutput::Header
+{
+    std::uint32_t magic;
+    std::int32_t object_count;
+    std::atomic<std::uint64_t> sequence;
+    std::uint64_t frame;
+    double timestamp;
+    Health health;
+};
+
+std::size_t TrackingOutput::size(int object_count)
+{
+    return sizeof(Header) + object_count * state_size * sizeof(double);
+}
+
+TrackingOutput TrackingOutput::create(const std::string& name,
+                                      int object_count)
+{
+    std::unique_ptr<SharedMemory> memory(
+        new SharedMemory(name, size(object_count)));
+
+    Header* header = memory->at<Header>(0);
+    header->object_count = object_count;
+    header->sequence.store(0);
+    header->health = Health();
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = tracking_output_magic;
+
+    return TrackingOutput(std::move(memory));
+}
+
+TrackingOutput TrackingOutput::open(const std::string& name)
+{
+    std::unique_ptr<SharedMemory> memory(new SharedMemory(name));
+
+    const Header* header = memory->at<Header>(0);
+    if (memory->size() < sizeof(Header) ||
+        header->magic != tracking_output_magic ||
+        memory->size() < size(header->object_count))
+    {
+        throw SharedMemoryException(name + ": not a tracking output");
+    }
+
+    return TrackingOutput(std::move(memory));
+}
+
+TrackingOutput::TrackingOutput(std::unique_ptr<SharedMemory> memory)
+    : memory_(std::move(memory))
+{
+}
+
+void TrackingOutput::publish(const Sample& sample)
+{
+    assert(sample.state.size() == count_objects() * state_size);
+
+    Header& h = header();
+    std::uint64_t sequence = h.sequence.load(std::memory_order_relaxed);
+
+    h.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    h.frame = sample.frame;
+    h.timestamp = sample.timestamp;
+    h.health = sample.health;
+    Eigen::Map<Eigen::VectorXd>(state(), count_objects() * state_size) =
+        sample.state;
+
+    h.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool TrackingOutput::read(Sample& sample) const
+{
+    const Header& h = header();
+    sample.state.resize(count_objects() * state_size);
+
+    while (true)
+    {
+        std::uint64_t before = h.sequence.load(std::memory_order_acquire);
+        if (before == 0) return false;
+        if (before % 2 == 1)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        sample.frame = h.frame;
+        sample.timestamp = h.timestamp;
+        sample.health = h.health;
+        sample.state = Eigen::Map<const Eigen::VectorXd>(
+            state(), count_objects() * state_size);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (h.sequence.load(std::memory_order_relaxed) == before) return true;
+    }
+}
+
+int TrackingOutput::count_objects() const
+{
+    return header().object_count;
+}
+
+auto TrackingOutput::header() const -> Header&
+{
+    return *memory_->at<Header>(0);
+}
+
+double* TrackingOutput::state() const
+{
+    return reinterpret_cast<double*>(&header() + 1);
+}
+}
@@ -0,0 +1,117 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file tracking_output.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <Eigen/Dense>
+
+#include <dbot/shared_memory.h>
+
+namespace dbot
+{
+/**
+ * \brief Latest tracking result in named shared memory, written by the
+ *        tracking service and read by any number of consumers.
+ *
+ * The state holds 12 values per object in the layout of
+ * FreeFloatingRigidBodiesState: position, orientation as rotation vector,
+ * linear and angular velocity. Updates are guarded by a sequence counter;
+ * readers retry while an update is in progress.
+ */
+class TrackingOutput
+{
+public:
+    enum Status
+    {
+        Starting = 0,
+        Tracking = 1,
+        WaitingForFrames = 2,
+        Stopped = 3,
+        Failed = 4
+    };
+
+    struct Health
+    {
+        Status status;
+        /// frames tracked since start
+        std::uint64_t frames_tracked;
+        /// published frames which were skipped or overwritten while read
+        std::uint64_t frames_dropped;
+        /// time from frame publication to pose publication of the last
+        /// frame in microseconds
+        double latency;
+        /// exponential moving average of the latency in microseconds
+        double mean_latency;
+    };
+
+    struct Sample
+    {
+        /// ring number of the frame the state was estimated from
+        std::uint64_t frame;
+        /// timestamp of that frame as given by the camera process
+        double timestamp;
+        Health health;
+        Eigen::VectorXd state;
+    };
+
+public:
+    /**
+     * \brief Creates the output region for the given number of objects
+     *
+     * \throws SharedMemoryException
+     */
+    static TrackingOutput create(const std::string& name, int object_count);
+
+    /**
+     * \brief Opens an existing output region
+     *
+     * \throws SharedMemoryException
+     */
+    static TrackingOutput open(const std::string& name);
+
+    /**
+     * \brief Publishes the sample. The state must hold 12 values per object.
+     */
+    void publish(const Sample& sample);
+
+    /**
+     * \brief Reads the latest sample. Returns false if nothing has been
+     *        published yet.
+     */
+    bool read(Sample& sample) const;
+
+    int count_objects() const;
+
+private:
+    struct Header;
+
+    explicit TrackingOutput(std::unique_ptr<SharedMemory> memory);
+
+    Header& header() const;
+    double* state() const;
+
+    static std::size_t size(int object_count);
+
+private:
+    std::unique_ptr<SharedMemory> memory_;
+};
+}
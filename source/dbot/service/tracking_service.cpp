@@ -0,0 +1,242 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file tracking_service.cpp
+ * \date October 2016
+ */
+
+#include <dbot/service/tracking_service.h>
+
+#include <chrono>
+#include <thread>
+
+#include <dbot/service/tracker_factory.h>
+
+namespace dbot
+{
+namespace
+{
+typedef std::chrono::steady_clock Clock;
+
+double seconds_now()
+{
+    return std::chrono::duration<double>(Clock::now().time_since_epoch())
+        .count();
+}
+
+double milliseconds(const Clock::time_point& start,
+                    const Clock::time_point& end)
+{
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+}
+
+TrackingService::TrackingService(const ConfigFile& config)
+    : frame_ring_name_(config.get<std::string>("service.frame_ring")),
+      rows_(config.get<int>("camera.rows")),
+      cols_(config.get<int>("camera.cols")),
+      poll_interval_(config.get<int>("service.poll_interval", 100)),
+      object_count_(configured_object_count(config)),
+      tracker_(create_configured_tracker(
+          config, load_configured_object_model(config))),
+      output_(TrackingOutput::create(config.get<std::string>("service.output"),
+                                     object_count_)),
+      source_(configured_camera_matrix(config), rows_, cols_),
+      next_frame_(0),
+      health_(),
+      stop_(false)
+{
+    state_ = configured_initial_state(config);
+    tracker_->initialize(std::vector<Tracker::State>(1, state_));
+    tracker_->subscribe(source_);
+
+    FlightRecorder::Parameters recorder;
+    recorder.capacity = config.get<int>("service.flight_recorder.frames", 0);
+    recorder.directory =
+        config.get<std::string>("service.flight_recorder.directory", ".");
+    recorder.latency_threshold =
+        config.get<double>("service.flight_recorder.latency_threshold", 0.0);
+    recorder.min_effective_fraction = config.get<double>(
+        "service.flight_recorder.min_effective_fraction", 0.0);
+    recorder.cooldown =
+        config.get<int>("service.flight_recorder.cooldown", 300);
+    if (recorder.capacity > 0)
+    {
+        recorder_.reset(
+            new FlightRecorder(recorder, config.text(), rows_, cols_));
+    }
+
+    last_frame_.depth = nullptr;
+    last_frame_.number = 0;
+    last_frame_.timestamp = 0;
+    publish(state_, last_frame_, TrackingOutput::WaitingForFrames);
+}
+
+bool TrackingService::open_frames()
+{
+    if (frames_) return true;
+
+    try
+    {
+        frames_.reset(new FrameRing(FrameRing::open(frame_ring_name_)));
+    }
+    catch (const SharedMemoryException&)
+    {
+        // the camera process has not created the ring yet
+        return false;
+    }
+
+    if (frames_->rows() != rows_ || frames_->cols() != cols_)
+    {
+        frames_.reset();
+        throw SharedMemoryException(frame_ring_name_ +
+                                    ": frame size does not match the "
+                                    "configured camera resolution");
+    }
+
+    next_frame_ = 0;
+    return true;
+}
+
+bool TrackingService::step()
+{
+    if (!open_frames()) return false;
+
+    FrameRing::Frame frame;
+    if (!frames_->latest(frame) || frame.number < next_frame_) return false;
+
+    // the frame is copied once from the ring slot into the observation
+    // context, which the sensor and the refiner read directly
+    const auto start = Clock::now();
+    const auto context = source_.publish(frame.depth);
+
+    if (!frames_->valid(frame))
+    {
+        // overwritten while copying
+        health_.frames_dropped++;
+        return false;
+    }
+
+    health_.frames_dropped += frame.number - next_frame_;
+    next_frame_ = frame.number + 1;
+    last_frame_ = frame;
+
+    ParticleTracker::Snapshot snapshot;
+    if (recorder_)
+    {
+        snapshot = tracker_->snapshot(recorder_->needs_sensor_state());
+    }
+
+    const auto converted = Clock::now();
+    state_ = tracker_->track(context);
+    const auto tracked = Clock::now();
+    health_.frames_tracked++;
+
+    publish(state_, frame, TrackingOutput::Tracking);
+
+    if (recorder_)
+    {
+        record(frame,
+               *context,
+               std::move(snapshot),
+               milliseconds(start, converted),
+               milliseconds(converted, tracked));
+    }
+    return true;
+}
+
+void TrackingService::record(const FrameRing::Frame& frame,
+                             const ObservationContext& context,
+                             ParticleTracker::Snapshot&& snapshot,
+                             double convert_ms,
+                             double track_ms)
+{
+    FlightRecord record;
+    record.frame = frame.number;
+    record.timestamp = frame.timestamp;
+
+    // the observation as tracked, the ring slot may be overwritten by now
+    compress_depth(context.depth(), context.size(), record.depth);
+
+    record.snapshot = std::move(snapshot);
+    summarize_particles(*tracker_, state_, record);
+    record.convert_ms = convert_ms;
+    record.stages = tracker_->timings();
+    record.track_ms = track_ms;
+    record.latency = health_.latency;
+
+    recorder_->record(std::move(record));
+}
+
+void TrackingService::publish(const Tracker::State& state,
+                              const FrameRing::Frame& frame,
+                              TrackingOutput::Status status)
+{
+    if (status == TrackingOutput::Tracking)
+    {
+        health_.latency = (seconds_now() - frame.timestamp) * 1e6;
+        health_.mean_latency =
+            health_.frames_tracked == 1
+                ? health_.latency
+                : 0.9 * health_.mean_latency + 0.1 * health_.latency;
+    }
+    health_.status = status;
+
+    TrackingOutput::Sample sample;
+    sample.frame = frame.number;
+    sample.timestamp = frame.timestamp;
+    sample.health = health_;
+    sample.state = state;
+    output_.publish(sample);
+}
+
+void TrackingService::run()
+{
+    try
+    {
+        while (!stop_)
+        {
+            if (!step())
+            {
+                std::this_thread::sleep_for(
+                    std::chrono::microseconds(poll_interval_));
+            }
+        }
+    }
+    catch (...)
+    {
+        publish(state_, last_frame_, TrackingOutput::Failed);
+        if (recorder_) recorder_->dump("failure");
+        throw;
+    }
+
+    publish(state_, last_frame_, TrackingOutput::Stopped);
+}
+
+void TrackingService::stop()
+{
+    stop_ = true;
+}
+
+void TrackingService::dump_flight_recorder()
+{
+    if (recorder_) recorder_->request_dump();
+}
+
+void TrackingService::set_occluder_poses(
+    const std::vector<Eigen::Affine3d>& poses)
+{
+    tracker_->set_occluder_poses(poses);
+}
+}
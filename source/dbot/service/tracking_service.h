@@ -0,0 +1,129 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file tracking_service.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <dbot/observation_context.h>
+#include <dbot/service/config_file.h>
+#include <dbot/service/flight_recorder.h>
+#include <dbot/service/frame_ring.h>
+#include <dbot/service/tracking_output.h>
+#include <dbot/tracker/particle_tracker.h>
+
+namespace dbot
+{
+/**
+ * \brief Runs a particle tracker on depth frames read from a FrameRing and
+ *        publishes the estimates into a TrackingOutput.
+ *
+ * The tracker, the camera and the shared memory names are read from a
+ * ConfigFile, see doc/tracking_service.conf for the recognized keys. Only
+ * the most recent frame is tracked; frames published while the tracker is
+ * busy are counted as dropped.
+ *
+ * If enabled, a FlightRecorder keeps the last frames and dumps them on
+ * request, when the latency or the particle weights breach their
+ * thresholds, and when tracking fails.
+ */
+class TrackingService
+{
+public:
+    /**
+     * \brief Builds and initializes the tracker and creates the output
+     *        region. The frame ring is opened once the camera process has
+     *        created it.
+     *
+     * \throws ConfigException on missing or invalid configuration
+     * \throws SharedMemoryException if the output cannot be created
+     */
+    explicit TrackingService(const ConfigFile& config);
+
+    /**
+     * \brief Tracks frames until stop() is called
+     */
+    void run();
+
+    /**
+     * \brief Makes run() return after the current frame. Async signal safe.
+     */
+    void stop();
+
+    /**
+     * \brief Makes the flight recorder dump after the next frame, if it is
+     *        enabled. Async signal safe.
+     */
+    void dump_flight_recorder();
+
+    /**
+     * \brief Moves the known occluders of the sensor from the next tracked
+     *        frame on, see ParticleTracker::set_occluder_poses(). May be
+     *        called from another thread than run().
+     */
+    void set_occluder_poses(const std::vector<Eigen::Affine3d>& poses);
+
+    /**
+     * \brief Tracks the latest frame if it has not been tracked yet. Returns
+     *        whether a frame has been tracked.
+     *
+     * \throws SharedMemoryException if the frame ring does not match the
+     *         configured resolution
+     */
+    bool step();
+
+private:
+    bool open_frames();
+    void publish(const Tracker::State& state,
+                 const FrameRing::Frame& frame,
+                 TrackingOutput::Status status);
+    void record(const FrameRing::Frame& frame,
+                const ObservationContext& context,
+                ParticleTracker::Snapshot&& snapshot,
+                double convert_ms,
+                double track_ms);
+
+private:
+    std::string frame_ring_name_;
+    int rows_;
+    int cols_;
+    int poll_interval_;
+    int object_count_;
+
+    std::shared_ptr<ParticleTracker> tracker_;
+    std::unique_ptr<FrameRing> frames_;
+    TrackingOutput output_;
+
+    // builds the observation of each frame once for the sensor and the
+    // refiner
+    ObservationSource source_;
+
+    Tracker::State state_;
+    std::uint64_t next_frame_;
+    FrameRing::Frame last_frame_;
+    TrackingOutput::Health health_;
+    std::atomic<bool> stop_;
+
+    // disabled if null
+    std::unique_ptr<FlightRecorder> recorder_;
+};
+}
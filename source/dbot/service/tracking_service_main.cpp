@@ -0,0 +1,80 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file tracking_service_main.cpp
+ * \date October 2016
+ *
+ * Usage: dbot_tracking_service <config file>
+ *
+ * SIGUSR1 dumps the flight recorder, if it is enabled in the configuration.
+ *
+ * The environment variable DBOT_CPU_VARIANT overrides the instruction set
+ * variant of the kernels, one of baseline, sse4.2, avx2 or avx512.
+ */
+
+#include <csignal>
+#include <cstdio>
+#include <exception>
+
+#include <dbot/cpu_kernels.h>
+#include <dbot/service/tracking_service.h>
+
+namespace
+{
+dbot::TrackingService* service = nullptr;
+
+void handle_signal(int)
+{
+    if (service) service->stop();
+}
+
+void handle_dump_signal(int)
+{
+    if (service) service->dump_flight_recorder();
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::fprintf(stderr, "Usage: %s <config file>\n", argv[0]);
+        return 2;
+    }
+
+    try
+    {
+        std::fprintf(stderr,
+                     "dbot_tracking_service: CPU kernels %s\n",
+                     dbot::cpu_kernels_report().c_str());
+
+        dbot::TrackingService tracking_service(
+            dbot::ConfigFile::load(argv[1]));
+
+        service = &tracking_service;
+        std::signal(SIGINT, handle_signal);
+        std::signal(SIGTERM, handle_signal);
+        std::signal(SIGUSR1, handle_dump_signal);
+
+        tracking_service.run();
+        service = nullptr;
+    }
+    catch (const std::exception& e)
+    {
+        std::fprintf(stderr, "dbot_tracking_service: %s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,113 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file shared_memory.cpp
+ * \date October 2016
+ */
+
+#include <dbot/shared_memory.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace dbot
+{
+SharedMemory::SharedMemory(std::size_t bytes)
+    : data_(nullptr), size_(bytes), owner_(false)
+{
+    if (size_ == 0) size_ = 1;
+
+    map(-1);
+}
+
+SharedMemory::SharedMemory(const std::string& name, std::size_t bytes)
+    : data_(nullptr), size_(bytes), name_(name), owner_(true)
+{
+    if (size_ == 0) size_ = 1;
+
+    shm_unlink(name_.c_str());
+    int fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+    {
+        throw SharedMemoryException(name_ + ": " + std::strerror(errno));
+    }
+
+    if (ftruncate(fd, size_) != 0)
+    {
+        int error = errno;
+        close(fd);
+        shm_unlink(name_.c_str());
+        throw SharedMemoryException(name_ + ": " + std::strerror(error));
+    }
+
+    try
+    {
+        map(fd);
+    }
+    catch (...)
+    {
+        shm_unlink(name_.c_str());
+        throw;
+    }
+}
+
+SharedMemory::SharedMemory(const std::string& name)
+    : data_(nullptr), size_(0), name_(name), owner_(false)
+{
+    int fd = shm_open(name_.c_str(), O_RDWR, 0);
+    if (fd < 0)
+    {
+        throw SharedMemoryException(name_ + ": " + std::strerror(errno));
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) != 0 || status.st_size == 0)
+    {
+        close(fd);
+        throw SharedMemoryException(name_ + ": empty or inaccessible");
+    }
+    size_ = status.st_size;
+
+    map(fd);
+}
+
+void SharedMemory::map(int fd)
+{
+    int flags = fd < 0 ? MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE
+                       : MAP_SHARED;
+
+    data_ = mmap(nullptr, size_, PROT_READ | PROT_WRITE, flags, fd, 0);
+    int error = errno;
+    if (fd >= 0) close(fd);
+
+    if (data_ == MAP_FAILED)
+    {
+        data_ = nullptr;
+        throw SharedMemoryException(
+            name_.empty() ? std::strerror(error)
+                          : name_ + ": " + std::strerror(error));
+    }
+}
+
+SharedMemory::~SharedMemory()
+{
+    if (data_) munmap(data_, size_);
+    if (owner_) shm_unlink(name_.c_str());
+}
+}
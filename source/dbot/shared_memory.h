@@ -0,0 +1,141 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file shared_memory.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <string>
+
+namespace dbot
+{
+/**
+ * \brief The SharedMemoryException class
+ */
+class SharedMemoryException : public std::exception
+{
+public:
+    explicit SharedMemoryException(const std::string& message)
+        : message_("Shared memory: " + message)
+    {
+    }
+
+    const char* what() const noexcept { return message_.c_str(); }
+
+private:
+    std::string message_;
+};
+
+/**
+ * \brief Memory mapping shared with other processes.
+ *
+ * Anonymous mappings are shared with child processes forked after their
+ * creation. Named mappings (POSIX shared memory objects) are shared with any
+ * process opening the same name; the creator removes the name on
+ * destruction.
+ *
+ * Pages are reserved lazily and zero on first access, hence large mappings
+ * only consume memory where they are written.
+ */
+class SharedMemory
+{
+public:
+    /**
+     * \brief Maps the given number of bytes
+     *
+     * \throws SharedMemoryException
+     */
+    explicit SharedMemory(std::size_t bytes);
+
+    /**
+     * \brief Creates the named shared memory object of the given size,
+     *        replacing an existing one, and maps it
+     *
+     * \throws SharedMemoryException
+     */
+    SharedMemory(const std::string& name, std::size_t bytes);
+
+    /**
+     * \brief Maps the existing named shared memory object
+     *
+     * \throws SharedMemoryException
+     */
+    explicit SharedMemory(const std::string& name);
+
+    ~SharedMemory();
+
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+
+    void* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+    /**
+     * \brief Returns a pointer of type T at the given byte offset
+     */
+    template <typename T>
+    T* at(std::size_t offset) const
+    {
+        return reinterpret_cast<T*>(static_cast<char*>(data_) + offset);
+    }
+
+    /**
+     * \brief Returns the name of a named mapping, otherwise empty
+     */
+    const std::string& name() const { return name_; }
+
+private:
+    void map(int fd);
+
+private:
+    void* data_;
+    std::size_t size_;
+    std::string name_;
+    bool owner_;
+};
+
+/**
+ * \brief Assigns consecutive, suitably aligned byte offsets to the sections
+ *        of a shared memory mapping
+ */
+class SharedMemoryLayout
+{
+public:
+    SharedMemoryLayout() : size_(0) {}
+
+    /**
+     * \brief Reserves count elements of type T and returns their offset
+     */
+    template <typename T>
+    std::size_t add(std::size_t count)
+    {
+        // cache line alignment avoids false sharing between sections
+        const std::size_t alignment = 64;
+        size_ = (size_ + alignment - 1) / alignment * alignment;
+
+        std::size_t offset = size_;
+        size_ += count * sizeof(T);
+        return offset;
+    }
+
+    std::size_t size() const { return size_; }
+
+private:
+    std::size_t size_;
+};
+}
@@ -19,8 +19,27 @@
 
 #include <dbot/simple_wavefront_object_loader.h>
 
+#include <future>
+#include <map>
+#include <utility>
+
 namespace dbot
 {
+namespace
+{
+typedef std::pair<std::vector<Eigen::Vector3d>, std::vector<std::vector<int>>>
+    Mesh;
+
+Mesh read_mesh(const std::string& path)
+{
+    ObjectFileReader file_reader;
+    file_reader.set_filename(path);
+    file_reader.Read();
+
+    return Mesh(*file_reader.get_vertices(), *file_reader.get_indices());
+}
+}
+
 SimpleWavefrontObjectModelLoader::SimpleWavefrontObjectModelLoader(
     const ObjectResourceIdentifier& ori)
     : ori_(ori)
@@ -34,14 +53,22 @@ void SimpleWavefrontObjectModelLoader::load(
     vertices.resize(ori_.count_meshes());
     triangle_indices.resize(ori_.count_meshes());
 
-    for (size_t i = 0; i < ori_.count_meshes(); i++)
+    std::map<std::string, std::shared_future<Mesh>> meshes;
+    for (int i = 0; i < ori_.count_meshes(); i++)
     {
-        ObjectFileReader file_reader;
-        file_reader.set_filename(ori_.mesh_path(i));
-        file_reader.Read();
+        const std::string path = ori_.mesh_path(i);
+        if (meshes.find(path) != meshes.end()) continue;
 
-        vertices[i] = *file_reader.get_vertices();
-        triangle_indices[i] = *file_reader.get_indices();
+        meshes[path] = std::async(std::launch::async, read_mesh, path).share();
+    }
+
+    // get() rethrows the exception of a failed read, the remaining reads
+    // are awaited by the futures on return
+    for (int i = 0; i < ori_.count_meshes(); i++)
+    {
+        const Mesh& mesh = meshes[ori_.mesh_path(i)].get();
+        vertices[i] = mesh.first;
+        triangle_indices[i] = mesh.second;
     }
 }
 }
@@ -24,6 +24,13 @@ class SimpleWavefrontObjectModelLoader : public ObjectModelLoader
 public:
     SimpleWavefrontObjectModelLoader(const ObjectResourceIdentifier& ori);
 
+    /**
+     * \brief Reads the meshes of the resource identifier. The files are
+     *        parsed concurrently, one thread per distinct file, and a file
+     *        listed several times is parsed once.
+     *
+     * \throws CannotOpenWavefrontFileException if a file cannot be opened
+     */
     void load(
         std::vector<std::vector<Eigen::Vector3d>>& vertices,
         std::vector<std::vector<std::vector<int>>>& triangle_indices) const;
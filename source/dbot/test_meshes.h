@@ -0,0 +1,83 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file test_meshes.h
+ * \date October 2016
+ *
+ * Meshes of the unit tests and benchmarks
+ */
+
+#pragma once
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+
+namespace dbot
+{
+/**
+ * \brief Vertices of an axis aligned box centered at the origin. Bits 0, 1
+ *        and 2 of the vertex index select the positive x, y and z side.
+ */
+inline std::vector<Eigen::Vector3d> box_vertices(double half_x,
+                                                 double half_y,
+                                                 double half_z)
+{
+    std::vector<Eigen::Vector3d> vertices;
+    for (int i = 0; i < 8; ++i)
+    {
+        vertices.push_back(Eigen::Vector3d((i & 1) ? half_x : -half_x,
+                                           (i & 2) ? half_y : -half_y,
+                                           (i & 4) ? half_z : -half_z));
+    }
+    return vertices;
+}
+
+inline std::vector<Eigen::Vector3d> cube_vertices(double half_size)
+{
+    return box_vertices(half_size, half_size, half_size);
+}
+
+/**
+ * \brief Outward facing triangles of box_vertices(), two per face
+ */
+inline std::vector<std::vector<int>> box_indices()
+{
+    return {{0, 2, 1}, {1, 2, 3}, {4, 5, 6}, {5, 7, 6},
+            {0, 1, 4}, {1, 5, 4}, {2, 6, 3}, {3, 6, 7},
+            {0, 4, 2}, {2, 4, 6}, {1, 3, 5}, {3, 7, 5}};
+}
+
+/**
+ * \brief Wavefront obj text of a cube, for tests which load meshes from
+ *        files
+ */
+inline std::string cube_wavefront(double half_size)
+{
+    std::ostringstream obj;
+    for (const auto& vertex : cube_vertices(half_size))
+    {
+        obj << "v " << vertex(0) << ' ' << vertex(1) << ' ' << vertex(2)
+            << '\n';
+    }
+    for (const auto& triangle : box_indices())
+    {
+        obj << "f " << triangle[0] + 1 << ' ' << triangle[1] + 1 << ' '
+            << triangle[2] + 1 << '\n';
+    }
+    return obj.str();
+}
+}
@@ -23,6 +23,12 @@
 
 #include <dbot/tracker/particle_tracker.h>
 
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+
+#include <dbot/cpu_kernels.h>
+
 namespace dbot
 {
 ParticleTracker::ParticleTracker(
@@ -33,8 +39,17 @@ ParticleTracker::ParticleTracker(
     bool center_object_frame)
     : Tracker(object_model, update_rate, center_object_frame),
       filter_(filter),
-      evaluation_count_(evaluation_count)
+      evaluation_count_(evaluation_count),
+      refined_particles_(0)
+{
+}
+
+void ParticleTracker::set_refinement(
+    const std::shared_ptr<PoseRefiner>& refiner,
+    int refined_particles)
 {
+    refiner_ = refiner;
+    refined_particles_ = refined_particles;
 }
 
 auto ParticleTracker::on_initialize(
@@ -53,12 +68,86 @@ auto ParticleTracker::on_initialize(
     auto& integrated_poses = filter_->sensor()->integrated_poses();
     integrated_poses.apply_delta(delta_mean);
 
-    return integrated_poses;
+    estimate_ = integrated_poses;
+    return estimate_;
+}
+
+void ParticleTracker::set_occluder_poses(
+    const std::vector<Eigen::Affine3d>& poses)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    filter_->sensor()->set_occluder_poses(poses);
+}
+
+auto ParticleTracker::snapshot(bool with_sensor) -> Snapshot
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    Snapshot snapshot;
+    snapshot.filter = filter_->snapshot(with_sensor);
+    snapshot.estimate = estimate_;
+    snapshot.moving_average = moving_average_;
+    return snapshot;
+}
+
+void ParticleTracker::restore(const Snapshot& snapshot)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    filter_->restore(snapshot.filter);
+    estimate_ = snapshot.estimate;
+    moving_average_ = snapshot.moving_average;
 }
 
 auto ParticleTracker::on_track(const Obsrv& image) -> State
 {
     filter_->filter(image, zero_input());
+    if (!update_estimate() || !refiner_) return estimate_;
+
+    depth_.resize(image.size());
+    convert_depth(image.data(), depth_.data(), image.size());
+
+    // the observation is back projected by the refiner
+    refine_estimate(depth_.data(), nullptr);
+    return estimate_;
+}
+
+auto ParticleTracker::on_track(
+    const std::shared_ptr<const ObservationContext>& context) -> State
+{
+    filter_->filter(context, zero_input());
+    if (!update_estimate() || !refiner_) return estimate_;
+
+    refine_estimate(
+        context->depth(),
+        context->has_point_cloud() ? &context->point_cloud() : nullptr);
+    return estimate_;
+}
+
+void ParticleTracker::subscribe(ObservationSource& source) const
+{
+    filter_->sensor()->subscribe(source);
+    if (refiner_)
+    {
+        ObservationRequirements requirements;
+        requirements.point_cloud = true;
+        source.subscribe(requirements);
+    }
+}
+
+bool ParticleTracker::update_estimate()
+{
+    timings_.propagation = filter_->timings().propagation;
+    timings_.evaluation = filter_->timings().evaluation;
+    timings_.resampling = filter_->timings().resampling;
+    timings_.refinement = 0;
+
+    auto& integrated_poses = filter_->sensor()->integrated_poses();
+
+    // the reduced update of an unchanged observation keeps the previous
+    // estimate, the particles stay relative to the integrated poses
+    if (filter_->static_frame()) return false;
 
     State delta_mean = filter_->belief().mean();
 
@@ -67,9 +156,80 @@ auto ParticleTracker::on_track(const Obsrv& image) -> State
         filter_->belief().location(i).subtract(delta_mean);
     }
 
-    auto& integrated_poses = filter_->sensor()->integrated_poses();
     integrated_poses.apply_delta(delta_mean);
 
-    return integrated_poses;
+    estimate_ = integrated_poses;
+    return true;
+}
+
+void ParticleTracker::refine_estimate(const float* depth,
+                                      const PointCloud* observed)
+{
+    const auto refinement_start = std::chrono::steady_clock::now();
+    const auto& integrated_poses = filter_->sensor()->integrated_poses();
+
+    // the particles of the highest weight are refined in place
+    auto& belief = filter_->belief();
+    int count = std::min<int>(refined_particles_, belief.size());
+    std::vector<int> order(belief.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::partial_sort(
+        order.begin(), order.begin() + count, order.end(), [&](int a, int b) {
+            return belief.log_prob_mass(a) > belief.log_prob_mass(b);
+        });
+    for (int i = 0; i < count; ++i)
+    {
+        refine(belief.location(order[i]), true, depth, observed);
+    }
+
+    // the refined mean is the estimate and replaces the weakest particle
+    refine(estimate_, false, depth, observed);
+
+    State delta = estimate_;
+    delta.subtract(integrated_poses);
+    filter_->inject_particle(delta);
+
+    timings_.refinement = std::chrono::duration<double, std::milli>(
+                              std::chrono::steady_clock::now() -
+                              refinement_start)
+                              .count();
+}
+
+void ParticleTracker::refine(State& state,
+                             bool delta,
+                             const float* depth,
+                             const PointCloud* observed)
+{
+    const auto& integrated_poses = filter_->sensor()->integrated_poses();
+
+    State poses = state;
+    if (delta)
+    {
+        poses = integrated_poses;
+        poses.apply_delta(state);
+    }
+
+    std::vector<PoseRefiner::Affine> affines(poses.count());
+    for (int i = 0; i < poses.count(); ++i)
+    {
+        affines[i] = poses.component(i).pose().affine();
+    }
+
+    if (observed)
+    {
+        refiner_->refine(depth, *observed, affines);
+    }
+    else
+    {
+        refiner_->refine(depth, affines);
+    }
+
+    for (int i = 0; i < poses.count(); ++i)
+    {
+        poses.component(i).pose().affine(affines[i]);
+    }
+
+    if (delta) poses.subtract(integrated_poses);
+    state = poses;
 }
 }
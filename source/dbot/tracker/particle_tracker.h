@@ -32,6 +32,7 @@
 
 #include <fl/model/transition/interface/transition_function.hpp>
 
+#include <dbot/tracker/pose_refiner.h>
 #include <dbot/tracker/tracker.h>
 #include <dbot/filter/rao_blackwell_coordinate_particle_filter.h>
 
@@ -48,6 +49,27 @@ public:
 
     typedef RaoBlackwellCoordinateParticleFilter<Transition, Sensor> Filter;
 
+    /**
+     * \brief Wall time of the stages of the last frame in milliseconds
+     */
+    struct Timings
+    {
+        double propagation = 0;
+        double evaluation = 0;
+        double resampling = 0;
+        double refinement = 0;
+    };
+
+    /**
+     * \brief State of the tracker between two frames, see snapshot()
+     */
+    struct Snapshot
+    {
+        Filter::Snapshot filter;
+        State estimate;
+        State moving_average;
+    };
+
 public:
     /**
      * \brief Creates the tracker
@@ -79,6 +101,18 @@ public:
      */
     State on_track(const Obsrv& image);
 
+    /**
+     * \brief perform a single filter step on a shared observation. The
+     *        sensor reads the observation and the refiner the point cloud
+     *        from the context if they subscribed to its source.
+     */
+    State on_track(const std::shared_ptr<const ObservationContext>& context);
+
+    /**
+     * \brief Subscribes the sensor and the refiner to the source
+     */
+    void subscribe(ObservationSource& source) const;
+
     /**
      * \brief Initializes the particle filter with the given initial states and
      *    the number of evaluations
@@ -87,8 +121,73 @@ public:
      */
     State on_initialize(const std::vector<State>& initial_states);
 
+    /**
+     * \brief Refines the estimate of each frame after the filter update by
+     *        aligning the rendered model with the observation. The refined
+     *        mean is the tracker output and replaces the weakest particle.
+     *        In addition, the given number of particles of the highest
+     *        weight are refined in place. A null refiner disables the
+     *        refinement.
+     */
+    void set_refinement(const std::shared_ptr<PoseRefiner>& refiner,
+                        int refined_particles = 0);
+
+    /**
+     * \brief Moves the known occluders of the sensor to the given poses, one
+     *        per occluder mesh in the camera frame. They apply from the next
+     *        track() call on, hence occluders whose poses follow e.g. the
+     *        kinematics of a robot arm are set before each frame. Sensors
+     *        without known occluders ignore them.
+     */
+    void set_occluder_poses(const std::vector<Eigen::Affine3d>& poses);
+
+    /**
+     * \brief Captures the state of the filter and of the estimates, such
+     *        that a tracker of the same configuration continues from it
+     *        with the same random samples. Without the per particle state
+     *        of the sensor, it continues from the sensor prior instead.
+     */
+    Snapshot snapshot(bool with_sensor = true);
+
+    /**
+     * \brief Continues from a snapshot, see Filter::restore()
+     */
+    void restore(const Snapshot& snapshot);
+
+    /// stage timings of the last frame
+    const Timings& timings() const { return timings_; }
+
+    /// particles of the filter and their weights
+    const Filter::Belief& belief() const { return filter_->belief(); }
+
+private:
+    /// takes the filter timings and recenters the particles on their mean,
+    /// returns false for the reduced update of an unchanged observation
+    bool update_estimate();
+
+    /// refines the estimate and the particles of the highest weight against
+    /// the depth, with its point cloud if given
+    void refine_estimate(const float* depth, const PointCloud* observed);
+
+    /// refines the poses of the given state, which is relative to the
+    /// integrated poses if delta is set
+    void refine(State& state,
+                bool delta,
+                const float* depth,
+                const PointCloud* observed);
+
 private:
     std::shared_ptr<Filter> filter_;
     int evaluation_count_;
+
+    // output of the last frame
+    State estimate_;
+
+    // refinement, disabled if null
+    std::shared_ptr<PoseRefiner> refiner_;
+    int refined_particles_;
+    std::vector<float> depth_;
+
+    Timings timings_;
 };
 }
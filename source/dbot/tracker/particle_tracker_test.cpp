@@ -0,0 +1,134 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file particle_tracker_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#include <unistd.h>
+
+#include <dbot/service/tracker_factory.h>
+#include <dbot/test_meshes.h>
+#include <dbot/tracker/particle_tracker.h>
+
+namespace
+{
+std::string working_directory()
+{
+    char path[4096];
+    return getcwd(path, sizeof(path)) ? path : "/";
+}
+
+const int rows = 24;
+const int cols = 32;
+
+// the object and the occluder are cubes of 10 cm, the occluder starts out
+// of view
+dbot::ConfigFile test_config()
+{
+    std::ofstream("particle_tracker_test.obj") << dbot::cube_wavefront(0.05);
+
+    return dbot::ConfigFile::parse(
+        "camera.rows: 24\n"
+        "camera.cols: 32\n"
+        "camera.matrix: 30 0 16  0 30 12  0 0 1\n"
+        "object.package_path: " + working_directory() + "\n"
+        "object.directory:\n"
+        "object.meshes: particle_tracker_test.obj\n"
+        "tracker.seed: 5\n"
+        "tracker.evaluation_count: 20\n"
+        "tracker.moving_average_update_rate: 1.0\n"
+        "tracker.max_kl_divergence: 0.5\n"
+        "tracker.initial_poses: 0 0 1  1 0 0 0\n"
+        "transition.linear_sigma_x: 0.002\n"
+        "transition.linear_sigma_y: 0.002\n"
+        "transition.linear_sigma_z: 0.002\n"
+        "transition.angular_sigma_x: 0.01\n"
+        "transition.angular_sigma_y: 0.01\n"
+        "transition.angular_sigma_z: 0.01\n"
+        "transition.velocity_factor: 0.8\n"
+        "sensor.sample_count: 10\n"
+        "sensor.delta_time: 0.033\n"
+        "sensor.occlusion.p_occluded_visible: 0.1\n"
+        "sensor.occlusion.p_occluded_occluded: 0.7\n"
+        "sensor.occlusion.initial_occlusion_prob: 0.1\n"
+        "sensor.kinect.tail_weight: 0.01\n"
+        "sensor.kinect.model_sigma: 0.003\n"
+        "sensor.kinect.sigma_factor: 0.00142478\n"
+        "sensor.occluders.meshes: particle_tracker_test.obj\n"
+        "sensor.occluders.poses: 5 0 1  1 0 0 0\n");
+}
+
+// a square in front of a wall, shifted to the right with the frame
+dbot::Tracker::Obsrv observation(int frame)
+{
+    dbot::Tracker::Obsrv depth =
+        dbot::Tracker::Obsrv::Constant(rows * cols, 1.2);
+    for (int row = 9; row < 15; ++row)
+    {
+        for (int col = 13 + frame; col < 19 + frame; ++col)
+        {
+            depth(row * cols + col) = 0.95;
+        }
+    }
+    return depth;
+}
+
+std::shared_ptr<dbot::ParticleTracker> create_tracker(
+    const dbot::ConfigFile& config)
+{
+    auto tracker = dbot::create_configured_tracker(
+        config, dbot::load_configured_object_model(config));
+    tracker->initialize(std::vector<dbot::Tracker::State>(
+        1, dbot::configured_initial_state(config)));
+    return tracker;
+}
+
+std::vector<Eigen::Affine3d> occluder_at(double x, double z)
+{
+    std::vector<Eigen::Affine3d> poses(1, Eigen::Affine3d::Identity());
+    poses[0].translation() = Eigen::Vector3d(x, 0, z);
+    return poses;
+}
+}
+
+TEST(ParticleTrackerTests, occluders_move_between_frames)
+{
+    const auto config = test_config();
+    auto still = create_tracker(config);
+    auto moved = create_tracker(config);
+    auto returned = create_tracker(config);
+
+    // the occluder is out of view in the first frame
+    const auto first = still->track(observation(0));
+    EXPECT_EQ(first, moved->track(observation(0)));
+    EXPECT_EQ(first, returned->track(observation(0)));
+
+    // and hides the object in the second frame of the moved tracker only
+    moved->set_occluder_poses(occluder_at(0.02, 0.8));
+    returned->set_occluder_poses(occluder_at(0.02, 0.8));
+    returned->set_occluder_poses(occluder_at(5, 1));
+
+    const auto second = still->track(observation(1));
+    EXPECT_NE(second, moved->track(observation(1)));
+    EXPECT_EQ(second, returned->track(observation(1)));
+
+    std::remove("particle_tracker_test.obj");
+}
@@ -0,0 +1,256 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file pose_refiner.cpp
+ * \date October 2016
+ */
+
+#include <dbot/tracker/pose_refiner.h>
+
+#include <cmath>
+#include <limits>
+
+#include <dbot/frame_arena.h>
+
+namespace dbot
+{
+namespace
+{
+/// smallest eigenvalue of the normal equations relative to the largest one
+/// along which a part is moved
+const double min_eigenvalue_ratio = 1e-2;
+
+PointCloud allocate_points(FrameArena& arena, int count)
+{
+    PointCloud points;
+    points.x = arena.allocate<float>(count);
+    points.y = arena.allocate<float>(count);
+    points.z = arena.allocate<float>(count);
+    points.valid = arena.allocate<unsigned char>(count);
+    return points;
+}
+}
+
+PoseRefiner::PoseRefiner(const std::shared_ptr<RigidBodyRenderer>& renderer,
+                         const Eigen::Matrix3d& camera_matrix,
+                         int rows,
+                         int cols,
+                         int iterations,
+                         double max_distance,
+                         int min_pixels)
+    : renderer_(renderer),
+      camera_matrix_(camera_matrix),
+      converter_(camera_matrix, rows, cols),
+      rows_(rows),
+      cols_(cols),
+      iterations_(iterations),
+      max_distance_(max_distance),
+      min_pixels_(min_pixels)
+{
+}
+
+auto PoseRefiner::refine(const float* depth, std::vector<Affine>& poses)
+    -> Result
+{
+    FrameArena& arena = FrameArena::local();
+    FrameArena::Scope scope(arena);
+
+    // the observation is back projected once for all iterations
+    const PointCloud observed = allocate_points(arena, rows_ * cols_);
+    converter_.to_points(depth, observed);
+
+    return refine(depth, observed, poses);
+}
+
+auto PoseRefiner::refine(const float* depth,
+                         const PointCloud& observed,
+                         std::vector<Affine>& poses) -> Result
+{
+    const size_t parts = poses.size();
+
+    std::vector<Eigen::Matrix<double, 6, 6>> hessians(parts);
+    std::vector<Eigen::Matrix<double, 6, 1>> gradients(parts);
+    std::vector<int> pixels(parts);
+
+    Result result = {0, std::numeric_limits<double>::infinity()};
+    for (int iteration = 0; iteration < iterations_; ++iteration)
+    {
+        double squared_error = 0;
+        result.pixels = accumulate(depth,
+                                   observed,
+                                   poses,
+                                   hessians,
+                                   gradients,
+                                   pixels,
+                                   squared_error);
+        if (result.pixels == 0) break;
+
+        result.residual = std::sqrt(squared_error / result.pixels);
+
+        for (size_t part = 0; part < parts; ++part)
+        {
+            if (pixels[part] < min_pixels_) continue;
+
+            // rotation vector about the part origin and translation of the
+            // motion which minimizes the linearized error. The rotation is
+            // scaled by the mean lever arm of the pixels, such that both are
+            // in meters. Directions the visible surface hardly constrains,
+            // such as sliding along a single face, are left to the filter.
+            const double lever_arm = std::sqrt(
+                hessians[part].topLeftCorner<3, 3>().trace() /
+                hessians[part].bottomRightCorner<3, 3>().trace());
+            Eigen::Matrix<double, 6, 1> scale;
+            scale << Eigen::Vector3d::Constant(1.0 / lever_arm),
+                Eigen::Vector3d::Ones();
+
+            Eigen::SelfAdjointEigenSolver<Eigen::Matrix<double, 6, 6>> eigen(
+                scale.asDiagonal() * hessians[part] * scale.asDiagonal());
+            const Eigen::Matrix<double, 6, 1>& values = eigen.eigenvalues();
+            Eigen::Matrix<double, 6, 1> inverse_values;
+            for (int i = 0; i < 6; ++i)
+            {
+                inverse_values(i) =
+                    values(i) > min_eigenvalue_ratio * values(5)
+                        ? 1.0 / values(i)
+                        : 0.0;
+            }
+            Eigen::Matrix<double, 6, 1> motion =
+                scale.asDiagonal() *
+                (eigen.eigenvectors() * inverse_values.asDiagonal() *
+                 eigen.eigenvectors().transpose()) *
+                scale.asDiagonal() * gradients[part];
+            if (!motion.allFinite()) continue;
+
+            Eigen::Vector3d rotation = motion.head<3>();
+            Affine delta = Affine::Identity();
+            if (rotation.norm() > 0)
+            {
+                delta.linear() =
+                    Eigen::AngleAxisd(rotation.norm(), rotation.normalized())
+                        .toRotationMatrix();
+            }
+            const Eigen::Vector3d origin = poses[part].translation();
+            delta.translation() =
+                origin + motion.tail<3>() - delta.linear() * origin;
+
+            // the pairs only hold within the maximum distance, a larger step
+            // has left the region the linearization holds
+            if (motion.tail<3>().norm() > max_distance_) continue;
+
+            poses[part] = delta * poses[part];
+        }
+    }
+
+    return result;
+}
+
+int PoseRefiner::accumulate(
+    const float* depth,
+    const PointCloud& observed,
+    const std::vector<Affine>& poses,
+    std::vector<Eigen::Matrix<double, 6, 6>>& hessians,
+    std::vector<Eigen::Matrix<double, 6, 1>>& gradients,
+    std::vector<int>& pixels,
+    double& squared_error)
+{
+    FrameArena& arena = FrameArena::local();
+    FrameArena::Scope scope(arena);
+
+    float* rendered = arena.allocate<float>(rows_ * cols_);
+    int* part_image = arena.allocate<int>(rows_ * cols_);
+
+    renderer_->set_poses(poses);
+    renderer_->Render(camera_matrix_, rows_, cols_, rendered, part_image);
+
+    const PointCloud surface = allocate_points(arena, rows_ * cols_);
+    converter_.to_points(rendered, surface);
+
+    for (size_t part = 0; part < poses.size(); ++part)
+    {
+        hessians[part].setZero();
+        gradients[part].setZero();
+        pixels[part] = 0;
+    }
+
+    auto point = [](const PointCloud& points, int pixel) -> Eigen::Vector3d {
+        return Eigen::Vector3d(
+            points.x[pixel], points.y[pixel], points.z[pixel]);
+    };
+
+    // whether two pixels show the same surface of the same part
+    auto same_surface = [&](int pixel, int other) {
+        return part_image[other] == part_image[pixel] &&
+               std::fabs(rendered[other] - rendered[pixel]) < max_distance_;
+    };
+
+    int count = 0;
+    for (int row = 0; row < rows_; ++row)
+    {
+        for (int col = 0; col < cols_; ++col)
+        {
+            const int pixel = row * cols_ + col;
+            const float predicted = rendered[pixel];
+
+            if (!surface.valid[pixel] || !observed.valid[pixel] ||
+                std::fabs(depth[pixel] - predicted) > max_distance_)
+            {
+                continue;
+            }
+
+            // surface normal from the rendered depth of the neighbors,
+            // preferring the right and lower ones
+            int dx = 0;
+            if (col + 1 < cols_ && same_surface(pixel, pixel + 1))
+                dx = 1;
+            else if (col > 0 && same_surface(pixel, pixel - 1))
+                dx = -1;
+
+            int dy = 0;
+            if (row + 1 < rows_ && same_surface(pixel, pixel + cols_))
+                dy = 1;
+            else if (row > 0 && same_surface(pixel, pixel - cols_))
+                dy = -1;
+
+            if (dx == 0 || dy == 0) continue;
+
+            const Eigen::Vector3d p = point(surface, pixel);
+            const Eigen::Vector3d du =
+                double(dx) * (point(surface, pixel + dx) - p);
+            const Eigen::Vector3d dv =
+                double(dy) * (point(surface, pixel + dy * cols_) - p);
+
+            Eigen::Vector3d n = du.cross(dv);
+            if (n.norm() == 0) continue;
+            n.normalize();
+            if (n.dot(p) > 0) n = -n;
+
+            const Eigen::Vector3d q = point(observed, pixel);
+            const double r = n.dot(q - p);
+
+            const int part = part_image[pixel];
+            Eigen::Matrix<double, 6, 1> jacobian;
+            jacobian << (p - poses[part].translation()).cross(n), n;
+
+            hessians[part] += jacobian * jacobian.transpose();
+            gradients[part] += jacobian * r;
+            pixels[part]++;
+
+            squared_error += r * r;
+            count++;
+        }
+    }
+
+    return count;
+}
+}
@@ -0,0 +1,117 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file pose_refiner.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <dbot/point_cloud.h>
+#include <dbot/rigid_body_renderer.h>
+
+namespace dbot
+{
+/**
+ * \brief Refines object part poses by point-to-plane alignment of the
+ *        rendered model surface with the observed depth.
+ *
+ * Each iteration renders the parts at the current poses and pairs every
+ * covered pixel with the observation at the same pixel. Pairs further apart
+ * than the maximum distance in depth are rejected as occlusions or
+ * background. The surface normals are taken from the rendered depth. The
+ * linearized point-to-plane error is then minimized for each part
+ * separately, and the poses are updated by the resulting rigid motion.
+ * Motions the visible surface does not constrain, such as sliding along a
+ * single visible face, are left out.
+ */
+class PoseRefiner
+{
+public:
+    typedef RigidBodyRenderer::Affine Affine;
+
+    /**
+     * \brief Result of a refinement
+     */
+    struct Result
+    {
+        /// pixels paired with observations in the last iteration
+        int pixels;
+
+        /// root mean square point-to-plane distance of the pairs of the last
+        /// iteration, in meters
+        double residual;
+    };
+
+public:
+    /**
+     * \param renderer      Renderer of the object parts, its poses are
+     *                      overwritten by refine()
+     * \param iterations    Gauss-Newton iterations per refinement
+     * \param max_distance  Maximum depth difference of a pixel pair in
+     *                      meters
+     * \param min_pixels    Minimum pixel pairs for a part to be moved
+     */
+    PoseRefiner(const std::shared_ptr<RigidBodyRenderer>& renderer,
+                const Eigen::Matrix3d& camera_matrix,
+                int rows,
+                int cols,
+                int iterations = 5,
+                double max_distance = 0.01,
+                int min_pixels = 50);
+
+    /**
+     * \brief Refines the poses of the parts in place against the given row
+     *        major depth image in meters. Missing measurements are NaN.
+     */
+    Result refine(const float* depth, std::vector<Affine>& poses);
+
+    /**
+     * \brief Refines as above with the point cloud of the depth given, e.g.
+     *        from a shared ObservationContext
+     */
+    Result refine(const float* depth,
+                  const PointCloud& observed,
+                  std::vector<Affine>& poses);
+
+    int iterations() const { return iterations_; }
+
+private:
+    /// renders the parts and adds the point-to-plane normal equations of
+    /// each part against the observed depth and its point cloud, returns
+    /// the number of pixel pairs
+    int accumulate(const float* depth,
+                   const PointCloud& observed,
+                   const std::vector<Affine>& poses,
+                   std::vector<Eigen::Matrix<double, 6, 6>>& hessians,
+                   std::vector<Eigen::Matrix<double, 6, 1>>& gradients,
+                   std::vector<int>& pixels,
+                   double& squared_error);
+
+private:
+    std::shared_ptr<RigidBodyRenderer> renderer_;
+    Eigen::Matrix3d camera_matrix_;
+    PointCloudConverter converter_;
+    int rows_;
+    int cols_;
+    int iterations_;
+    double max_distance_;
+    int min_pixels_;
+};
+}
@@ -0,0 +1,140 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file pose_refiner_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <dbot/test_meshes.h>
+#include <dbot/tracker/pose_refiner.h>
+
+class PoseRefinerTests : public ::testing::Test
+{
+protected:
+    typedef dbot::PoseRefiner::Affine Affine;
+
+    static const int rows = 120;
+    static const int cols = 160;
+
+    // cube of 10 cm edge length
+    PoseRefinerTests()
+        : vertices_(1, dbot::cube_vertices(0.05)),
+          indices_(1, dbot::box_indices())
+    {
+        camera_matrix_ << 320, 0, 80, 0, 320, 60, 0, 0, 1;
+
+        // three faces of the cube are visible
+        pose_ = Affine::Identity();
+        pose_.translation() = Eigen::Vector3d(0.0, 0.0, 0.6);
+        pose_.rotate(Eigen::AngleAxisd(
+            0.5, Eigen::Vector3d(1.0, 1.0, 0.0).normalized()));
+    }
+
+    std::shared_ptr<dbot::RigidBodyRenderer> renderer() const
+    {
+        return std::make_shared<dbot::RigidBodyRenderer>(vertices_, indices_);
+    }
+
+    /// depth image of the cube at the given pose, NaN off the object
+    std::vector<float> observe(const Affine& pose) const
+    {
+        auto cube = renderer();
+        cube->set_poses(std::vector<Affine>(1, pose));
+
+        std::vector<float> depth(rows * cols);
+        cube->Render(camera_matrix_, rows, cols, depth.data());
+        for (auto& d : depth)
+        {
+            if (std::isinf(d)) d = std::numeric_limits<float>::quiet_NaN();
+        }
+        return depth;
+    }
+
+    static Affine perturb(const Affine& pose)
+    {
+        Affine perturbed = pose;
+        perturbed.pretranslate(Eigen::Vector3d(0.004, -0.003, 0.005));
+        perturbed.rotate(
+            Eigen::AngleAxisd(0.05, Eigen::Vector3d(0.0, 0.0, 1.0)));
+        return perturbed;
+    }
+
+    static double position_error(const Affine& a, const Affine& b)
+    {
+        return (a.translation() - b.translation()).norm();
+    }
+
+    static double angle_error(const Affine& a, const Affine& b)
+    {
+        return Eigen::AngleAxisd(a.rotation().transpose() * b.rotation())
+            .angle();
+    }
+
+    std::vector<std::vector<Eigen::Vector3d>> vertices_;
+    std::vector<std::vector<std::vector<int>>> indices_;
+    Eigen::Matrix3d camera_matrix_;
+    Affine pose_;
+};
+
+TEST_F(PoseRefinerTests, converges_to_observed_pose)
+{
+    dbot::PoseRefiner refiner(
+        renderer(), camera_matrix_, rows, cols, 10, 0.02);
+
+    std::vector<Affine> poses(1, perturb(pose_));
+    auto result = refiner.refine(observe(pose_).data(), poses);
+
+    EXPECT_GT(result.pixels, 1000);
+    EXPECT_LT(result.residual, 0.001);
+    EXPECT_LT(position_error(poses[0], pose_), 0.0005);
+    EXPECT_LT(angle_error(poses[0], pose_), 0.005);
+}
+
+TEST_F(PoseRefinerTests, ignores_occluded_pixels)
+{
+    dbot::PoseRefiner refiner(
+        renderer(), camera_matrix_, rows, cols, 10, 0.02);
+
+    // a bar in front of the left part of the object
+    auto depth = observe(pose_);
+    for (int row = 0; row < rows; ++row)
+    {
+        for (int col = 60; col < 75; ++col) depth[row * cols + col] = 0.3f;
+    }
+
+    std::vector<Affine> poses(1, perturb(pose_));
+    refiner.refine(depth.data(), poses);
+
+    EXPECT_LT(position_error(poses[0], pose_), 0.001);
+    EXPECT_LT(angle_error(poses[0], pose_), 0.01);
+}
+
+TEST_F(PoseRefinerTests, keeps_pose_without_measurements)
+{
+    dbot::PoseRefiner refiner(renderer(), camera_matrix_, rows, cols);
+
+    std::vector<float> depth(rows * cols,
+                             std::numeric_limits<float>::quiet_NaN());
+    std::vector<Affine> poses(1, perturb(pose_));
+    auto result = refiner.refine(depth.data(), poses);
+
+    EXPECT_EQ(0, result.pixels);
+    EXPECT_TRUE(poses[0].isApprox(perturb(pose_)));
+}
@@ -79,6 +79,26 @@ auto Tracker::track(const Obsrv& image) -> State
     return moving_average_;
 }
 
+auto Tracker::track(const std::shared_ptr<const ObservationContext>& context)
+    -> State
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    move_average(to_model_coordinate_system(on_track(context)),
+                 moving_average_,
+                 update_rate_);
+
+    return moving_average_;
+}
+
+auto Tracker::on_track(const std::shared_ptr<const ObservationContext>& context)
+    -> State
+{
+    Obsrv image(context->size());
+    convert_depth(context->depth(), image.data(), context->size());
+    return on_track(image);
+}
+
 auto Tracker::to_center_coordinate_system(
     const Tracker::State& state) -> State
 {
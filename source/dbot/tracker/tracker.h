@@ -21,6 +21,7 @@
 
 #include <Eigen/Dense>
 #include <dbot/object_model.h>
+#include <dbot/observation_context.h>
 #include <dbot/pose/free_floating_rigid_bodies_state.h>
 #include <dbot/pose/pose_vector.h>
 #include <memory>
@@ -63,6 +64,14 @@ public:
      */
     virtual State on_track(const Obsrv& image) = 0;
 
+    /**
+     * \brief Hook function which is called during tracking on a shared
+     *        observation. The default tracks a copy of its depth.
+     * \return Current belief state
+     */
+    virtual State on_track(
+        const std::shared_ptr<const ObservationContext>& context);
+
     /**
      * \brief Hook function which is called during initialization
      * \return Initial belief state
@@ -77,6 +86,22 @@ public:
      */
     virtual State track(const Obsrv& image);
 
+    /**
+     * \brief perform a single filter step on an observation shared with
+     *        the other trackers of the camera
+     *
+     * \param context
+     *     Current observation, see ObservationSource::publish()
+     */
+    virtual State track(
+        const std::shared_ptr<const ObservationContext>& context);
+
+    /**
+     * \brief Adds the frame data the tracker reads from an observation
+     *        context to the requirements of the source
+     */
+    virtual void subscribe(ObservationSource&) const {}
+
     /**
      * \brief Initializes the particle filter with the given initial states and
      *     the number of evaluations
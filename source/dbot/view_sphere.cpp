@@ -0,0 +1,113 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file view_sphere.cpp
+ * \date October 2016
+ */
+
+#include <dbot/view_sphere.h>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <utility>
+
+namespace dbot
+{
+ViewSphere::ViewSphere(int subdivisions)
+    : subdivisions_(subdivisions), covering_angle_(0)
+{
+    // icosahedron
+    const double phi = (1. + std::sqrt(5.)) / 2.;
+    directions_ = {{-1, phi, 0},
+                   {1, phi, 0},
+                   {-1, -phi, 0},
+                   {1, -phi, 0},
+                   {0, -1, phi},
+                   {0, 1, phi},
+                   {0, -1, -phi},
+                   {0, 1, -phi},
+                   {phi, 0, -1},
+                   {phi, 0, 1},
+                   {-phi, 0, -1},
+                   {-phi, 0, 1}};
+    std::vector<Eigen::Vector3i> faces = {
+        {0, 11, 5}, {0, 5, 1},  {0, 1, 7},   {0, 7, 10}, {0, 10, 11},
+        {1, 5, 9},  {5, 11, 4}, {11, 10, 2}, {10, 7, 6}, {7, 1, 8},
+        {3, 9, 4},  {3, 4, 2},  {3, 2, 6},   {3, 6, 8},  {3, 8, 9},
+        {4, 9, 5},  {2, 4, 11}, {6, 2, 10},  {8, 6, 7},  {9, 8, 1}};
+    for (auto& direction : directions_) direction.normalize();
+
+    // each subdivision splits every triangle into four, sharing the
+    // midpoints of common edges
+    for (int level = 0; level < subdivisions; ++level)
+    {
+        std::map<std::pair<int, int>, int> midpoints;
+        auto midpoint = [&](int a, int b) {
+            auto key = std::make_pair(std::min(a, b), std::max(a, b));
+            auto it = midpoints.find(key);
+            if (it != midpoints.end()) return it->second;
+
+            directions_.push_back(
+                (directions_[a] + directions_[b]).normalized());
+            midpoints[key] = directions_.size() - 1;
+            return int(directions_.size() - 1);
+        };
+
+        std::vector<Eigen::Vector3i> subdivided;
+        for (auto& face : faces)
+        {
+            int ab = midpoint(face(0), face(1));
+            int bc = midpoint(face(1), face(2));
+            int ca = midpoint(face(2), face(0));
+            subdivided.push_back({face(0), ab, ca});
+            subdivided.push_back({face(1), bc, ab});
+            subdivided.push_back({face(2), ca, bc});
+            subdivided.push_back({ab, bc, ca});
+        }
+        faces.swap(subdivided);
+    }
+
+    // the direction farthest from its nearest sphere direction is the
+    // circumcenter of one of the triangles
+    for (auto& face : faces)
+    {
+        const Eigen::Vector3d& a = directions_[face(0)];
+        const Eigen::Vector3d& b = directions_[face(1)];
+        const Eigen::Vector3d& c = directions_[face(2)];
+        Eigen::Vector3d center = (b - a).cross(c - a).normalized();
+        if (center.dot(a) < 0) center = -center;
+
+        double cosine = std::min(1., center.dot(a));
+        covering_angle_ = std::max(covering_angle_, std::acos(cosine));
+    }
+}
+
+int ViewSphere::nearest(const Eigen::Vector3d& direction) const
+{
+    int nearest = 0;
+    double max_cosine = -2;
+    for (int i = 0; i < count_directions(); ++i)
+    {
+        double cosine = directions_[i].dot(direction);
+        if (cosine > max_cosine)
+        {
+            max_cosine = cosine;
+            nearest = i;
+        }
+    }
+
+    return nearest;
+}
+}
@@ -0,0 +1,62 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file view_sphere.h
+ * \date October 2016
+ */
+
+#pragma once
+
+#include <Eigen/Dense>
+#include <vector>
+
+namespace dbot
+{
+/**
+ * \brief Unit view directions evenly spread over the sphere, obtained by
+ *        subdividing an icosahedron.
+ *
+ * Subdivision s yields 10 * 4^s + 2 directions, i.e. 12, 42, 162, 642 for
+ * s = 0, 1, 2, 3.
+ */
+class ViewSphere
+{
+public:
+    explicit ViewSphere(int subdivisions);
+
+    int subdivisions() const { return subdivisions_; }
+    int count_directions() const { return directions_.size(); }
+
+    const Eigen::Vector3d& direction(int index) const
+    {
+        return directions_[index];
+    }
+
+    /**
+     * \brief Returns the direction closest to the given unit direction
+     */
+    int nearest(const Eigen::Vector3d& direction) const;
+
+    /**
+     * \brief Largest angle between any unit direction and its nearest
+     *        direction of the sphere
+     */
+    double covering_angle() const { return covering_angle_; }
+
+private:
+    int subdivisions_;
+    std::vector<Eigen::Vector3d> directions_;
+    double covering_angle_;
+};
+}
@@ -0,0 +1,49 @@
+/*
+ * This is part of the Bayesian Object Tracking (bot),
+ * (https://github.com/bayesian-object-tracking)
+ *
+ * Copyright (c) 2015 Max Planck Society,
+ * 				 Autonomous Motion Department,
+ * 			     Institute for Intelligent Systems
+ *
+ * This Source Code Form is subject to the terms of the GNU General Public
+ * License License (GNU GPL). A copy of the license can be found in the LICENSE
+ * file distributed with this source code.
+ */
+
+/**
+ * \file view_sphere_test.cpp
+ * \date October 2016
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include <dbot/view_sphere.h>
+
+TEST(ViewSphereTests, direction_counts)
+{
+    EXPECT_EQ(dbot::ViewSphere(0).count_directions(), 12);
+    EXPECT_EQ(dbot::ViewSphere(1).count_directions(), 42);
+    EXPECT_EQ(dbot::ViewSphere(2).count_directions(), 162);
+    EXPECT_EQ(dbot::ViewSphere(3).count_directions(), 642);
+}
+
+TEST(ViewSphereTests, covering_angle_bounds_nearest_direction)
+{
+    dbot::ViewSphere sphere(2);
+
+    EXPECT_GT(sphere.covering_angle(), 0);
+    EXPECT_LT(sphere.covering_angle(), dbot::ViewSphere(1).covering_angle());
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        Eigen::Vector3d direction = Eigen::Vector3d::Random().normalized();
+        int nearest = sphere.nearest(direction);
+
+        double cosine = sphere.direction(nearest).dot(direction);
+        EXPECT_LE(std::acos(std::min(1., cosine)),
+                  sphere.covering_angle() + 1e-9);
+    }
+}
@@ -4,6 +4,11 @@ dbot_add_test(
     SOURCES source/dbot/object_resource_identifier_test.cpp
     LIBS    ${dbot_LIBRARIES})
 
+dbot_add_test(
+    NAME    object_model
+    SOURCES source/dbot/object_model_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
 dbot_add_test(
     NAME 	  simple_shader_provider_test
     SOURCES source/dbot/simple_shader_provider_test.cpp
@@ -13,3 +18,128 @@ dbot_add_test(
     NAME    file_shader_provider_test
     SOURCES source/dbot/file_shader_provider_test.cpp
     LIBS	  ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    frame_arena
+    SOURCES source/dbot/frame_arena_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    executor
+    SOURCES source/dbot/executor_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    huge_page_allocator
+    SOURCES source/dbot/huge_page_allocator_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    process_pool
+    SOURCES source/dbot/process_pool_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    config_file
+    SOURCES source/dbot/service/config_file_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    frame_ring
+    SOURCES source/dbot/service/frame_ring_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    background_model
+    SOURCES source/dbot/model/background_model_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    occlusion_model
+    SOURCES source/dbot/model/occlusion_model_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    kinect_pixel_model
+    SOURCES source/dbot/model/kinect_pixel_model_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    kinect_image_model
+    SOURCES source/dbot/model/kinect_image_model_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    impostor_renderer
+    SOURCES source/dbot/impostor_renderer_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    view_sphere
+    SOURCES source/dbot/view_sphere_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    rigid_body_renderer
+    SOURCES source/dbot/rigid_body_renderer_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    halton_sequence
+    SOURCES source/dbot/filter/halton_sequence_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    rao_blackwell_coordinate_particle_filter
+    SOURCES source/dbot/filter/rao_blackwell_coordinate_particle_filter_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    scene_change_detector
+    SOURCES source/dbot/model/scene_change_detector_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    cpu_kernels
+    SOURCES source/dbot/cpu_kernels_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    point_cloud
+    SOURCES source/dbot/point_cloud_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    observation_context
+    SOURCES source/dbot/observation_context_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    pose_refiner
+    SOURCES source/dbot/tracker/pose_refiner_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    particle_tracker
+    SOURCES source/dbot/tracker/particle_tracker_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    pose_table
+    SOURCES source/dbot/service/pose_table_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    depth_recording
+    SOURCES source/dbot/service/depth_recording_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    batch_tracker
+    SOURCES source/dbot/service/batch_tracker_test.cpp
+    LIBS    ${dbot_LIBRARIES})
+
+dbot_add_test(
+    NAME    flight_recorder
+    SOURCES source/dbot/service/flight_recorder_test.cpp
+    LIBS    ${dbot_LIBRARIES})